@@ -43,6 +43,8 @@ extern "C" {
 #define ID_SCVP_PARAM_SEI_NOVELVIEW        1007
 #define ID_SCVP_BITSTREAMS_HEADER          1008
 #define ID_SCVP_RWPK_INFO                  1009
+#define ID_SCVP_PARAM_TILE_LUT             1010
+#define ID_SCVP_PARAM_VIEWPORT_SOLVER      1011
 #define DEFAULT_REGION_NUM                 1000
 
 /*!
@@ -152,6 +154,25 @@ typedef enum PluginFormat
     E_PLUGIN_FORMAT_NUM
 }PluginFormat;
 
+/*!
+ * Viewport solver definitions, which compute the footprint of the viewport in the source:
+ *
+ * E_VIEWPORT_SOLVER_PIXEL_SWEEP: Project every viewport pixel to the source (default)
+ * E_VIEWPORT_SOLVER_ANALYTIC_ERP: Project only the viewport border and check the poles,
+ *                                 for ERP source, other sources keep the pixel sweep
+ *
+ * The solver applies to I360SCVP_GetTilesByLegacyWay and to the viewport size estimated
+ * at init; I360SCVP_getTilesInViewport selects tiles from the viewport boundary points
+ * and does not use it.
+ *
+ */
+typedef enum ViewportSolver
+{
+    E_VIEWPORT_SOLVER_PIXEL_SWEEP = 0,
+    E_VIEWPORT_SOLVER_ANALYTIC_ERP,
+    E_VIEWPORT_SOLVER_NUM
+}ViewportSolver;
+
 /*!
  * Plugin Defintion for 360SCVP
  *
@@ -415,6 +436,18 @@ typedef struct PARAM_BSHEADER
     int64_t size;
 }Param_BSHeader;
 
+//!
+//! \brief  This structure is one fragment of a merged frame in the scatter-gather output
+//!
+//! \param    data,   output,   the fragment bytes, either headers written into pOutputBitstream
+//!                             or slice data inside one of the input tile bitstreams
+//! \param    size,   output,   the byte size of the fragment
+typedef struct MERGE_SPAN
+{
+    const uint8_t *data;
+    uint32_t       size;
+}MergeSpan;
+
 //!
 //! \brief  This structure is for the pitcure parameters
 //!
@@ -505,6 +538,25 @@ typedef struct PARAM_VIEWPORT_OUTPUT
     int32_t yTopLeftNet;
 }Param_ViewportOutput;
 
+//!
+//! \brief  This structure is for the pose-to-tile lookup table of the viewport tile selection.
+//!         The table stores the selected tiles of a quantized yaw/pitch grid for the configured
+//!         FOV and tile split, so that the selection of a new pose is a table lookup. Without
+//!         refinement, the tiles of a pose are exactly the tiles of the nearest grid pose, which
+//!         is at most half an angle step away in yaw and in pitch; with refinement, the tiles of
+//!         the up to four grid poses around the pose are merged.
+//!
+//! \param    memoryBudget,       input,    the maximum table size in bytes, 0 disables the table
+//! \param    angleStep,          input,    the yaw/pitch grid step in degree, 0 selects the finest step
+//!                                         among 1, 2, 3, 5 and 10 which fits into memoryBudget
+//! \param    refine,             input,    merge the tiles of the surrounding grid poses
+typedef struct PARAM_TILE_LUT
+{
+    uint32_t               memoryBudget;
+    float                  angleStep;
+    bool                   refine;
+}Param_TileLUT;
+
 //!
 //! \brief  This structure is for the view port parameters
 //!
@@ -652,6 +704,23 @@ void * I360SCVP_Init(param_360SCVP* pParam360SCVP);
 //!             null, if the creation fails
 void * I360SCVP_New(void* p360SCVPHandle);
 
+//!
+//! \brief      This function creates a lightweight session based on one existed handle for
+//!             the viewport and tile selection of one more client. The sessions of one handle
+//!             share a read-only snapshot of the parsed parameter sets and tile grid, and each
+//!             session has its own viewport, so the sessions can be used concurrently from
+//!             different threads. A session which parses new parameter sets or generates headers
+//!             gets its own copy of the stream description first. The handle itself should not
+//!             be changed while sessions are created from it. The pose-to-tile lookup table is
+//!             not inherited, it can be set with I360SCVP_SetParameter on the session.
+//!             The session is released by I360SCVP_unInit
+//! \param      void* p360SCVPHandle, input, one existed stitch library handle or session
+//!
+//! \return     void *, the new created session
+//!             not null, if the creation is ok
+//!             null, if the creation fails or the handle uses the tile selection plugin
+void * I360SCVP_NewSession(void* p360SCVPHandle);
+
 //!
 //! \brief      This function completes the stitch, this is to say, according to the viewport information to select the tiles
 //!             and then stitch each tiles into one frame bitstream.
@@ -664,6 +733,35 @@ void * I360SCVP_New(void* p360SCVPHandle);
 //!
 int32_t I360SCVP_process(param_360SCVP* pParam360SCVP, void * p360SCVPHandle);
 
+//!
+//! \brief      This function completes the stitch like I360SCVP_process, but returns the frame as a list of spans
+//!             instead of copying the tile data. Only the rewritten parameter sets, SEI and slice headers are
+//!             written into pOutputBitstream; the slice data spans point into the input tile bitstreams, so both
+//!             buffers must stay valid until the frame is consumed. outputBitstreamLen is the total frame size.
+//!             Supported for E_STREAM_STITCH_ONLY and E_MERGE_AND_VIEWPORT.
+//! \param      param_360SCVP*   pParam360SCVP,     input/output, refer to the structure param_360SCVP
+//! \param      void *           p360SCVPHandle,    input,        which is created by the I360SVCP_Init function
+//! \param      MergeSpan*       pSpans,            output,       the spans of the frame in bitstream order
+//! \param      uint32_t*        pSpanNum,          input/output, the size of pSpans, and the number of spans on return,
+//!                                                               two per merged tile and one for the headers is enough
+//!
+//! \return     int32_t, the status of the function.
+//!     0,      if succeed
+//!     not 0,  if fail
+//!
+int32_t I360SCVP_processSpans(param_360SCVP* pParam360SCVP, void * p360SCVPHandle, MergeSpan* pSpans, uint32_t* pSpanNum);
+
+//!
+//! \brief      This function copies the spans from I360SCVP_processSpans into one contiguous bitstream.
+//! \param      const MergeSpan* pSpans,            input,        the spans of the frame
+//! \param      uint32_t         spanNum,           input,        the number of spans
+//! \param      uint8_t*         pOutput,           output,       the contiguous bitstream
+//! \param      uint32_t         outputLen,         input,        the size of pOutput
+//!
+//! \return     int32_t, the frame size in bytes if succeed, less than 0 if pOutput is too small
+//!
+int32_t I360SCVP_flattenSpans(const MergeSpan* pSpans, uint32_t spanNum, uint8_t* pOutput, uint32_t outputLen);
+
 //!
 //! \brief      This function sets the parameter of the viewPort.
 //!
@@ -726,6 +824,35 @@ int32_t I360SCVP_getFixedNumTiles(TileDef* pOutTile, Param_ViewportOutput* pPara
 //!
 int32_t I360SCVP_getTilesInViewport(TileDef* pOutTile, Param_ViewportOutput* pParamViewPortOutput, void* p360SCVPHandle);
 
+//!
+//! \brief    This function outputs the selected tiles of a list of poses, the same as calling
+//!           I360SCVP_setViewPortEx, I360SCVP_process and I360SCVP_getTilesInViewport for each pose.
+//!           The poses are distributed to worker sessions of the handle which run in parallel,
+//!           the workers are kept in the handle for the next batch. The viewport of the handle
+//!           itself is not changed, except for the tile selection plugin which selects the
+//!           tiles of the poses one by one with the handle.
+//!
+//! \param    HeadPose*  pPoses,                 input,  the list of the poses
+//! \param    uint32_t   poseNum,                input,  the number of the poses
+//! \param    TileDef*   pOutTiles,              output, the tiles of the poses, the tiles of pose i
+//!                                                      start from pOutTiles[i * maxTileNum]
+//! \param    uint32_t   maxTileNum,             input,  the maximum number of the tiles of one pose
+//! \param    int32_t*   pTileNums,              output, the number of the tiles of each pose,
+//!                                                      -1 if the selection of the pose fails or
+//!                                                      exceeds maxTileNum
+//! \param    Param_ViewportOutput* pParamViewPortOutputs, output, the viewport output of each pose, can be NULL
+//! \param    CCDef*     pOutCCs,                output, the content coverage of each pose, the same as
+//!                                                      I360SCVP_getContentCoverage, can be NULL
+//! \param    void*      p360SCVPHandle,         input,  which is created by the I360SVCP_Init function
+//!
+//! \return   int32_t, the status of the function.
+//!           0,      if the tiles of all the poses are selected
+//!           -1,     if the parameters are invalid or the workers can't be created
+//!           > 0,    the number of the poses whose selection fails, the other poses
+//!                   still have their tiles and tile numbers
+//!
+int32_t I360SCVP_getTilesInViewportBatch(HeadPose* pPoses, uint32_t poseNum, TileDef* pOutTiles, uint32_t maxTileNum, int32_t* pTileNums, Param_ViewportOutput* pParamViewPortOutputs, CCDef* pOutCCs, void* p360SCVPHandle);
+
 //!
 //! \brief    This function provides the parsing NAL function, can give the slice type, tileCols number, tileRows number and nal information
 //!           if it is the Slice, must provide the slice header length; if SEI, provide the SEI payload type
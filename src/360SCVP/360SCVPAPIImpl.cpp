@@ -62,6 +62,15 @@ void* I360SCVP_New(void* p360SCVPHandle)
     return (void*)newHandle;
 }
 
+void* I360SCVP_NewSession(void* p360SCVPHandle)
+{
+    if (p360SCVPHandle == NULL)
+        return NULL;
+
+    TstitchStream* pSession = ((TstitchStream*)(p360SCVPHandle))->newSession();
+    return (void*)pSession;
+}
+
 int32_t   I360SCVP_process(param_360SCVP* pParam360SCVP, void* p360SCVPHandle)
 {
     TstitchStream* pStitch = (TstitchStream*)(p360SCVPHandle);
@@ -93,6 +102,46 @@ int32_t   I360SCVP_process(param_360SCVP* pParam360SCVP, void* p360SCVPHandle)
     return ret;
 }
 
+int32_t   I360SCVP_processSpans(param_360SCVP* pParam360SCVP, void* p360SCVPHandle, MergeSpan* pSpans, uint32_t* pSpanNum)
+{
+    TstitchStream* pStitch = (TstitchStream*)(p360SCVPHandle);
+    if (!pStitch || !pParam360SCVP || !pSpans || !pSpanNum)
+        return -1;
+    int32_t ret = 0;
+    if (pParam360SCVP->usedType == E_STREAM_STITCH_ONLY)
+    {
+        ret = pStitch->doStreamStitch(pParam360SCVP, pSpans, pSpanNum);
+    }
+    else if (pParam360SCVP->usedType == E_MERGE_AND_VIEWPORT)
+    {
+        pStitch->parseNals(pParam360SCVP, E_MERGE_AND_VIEWPORT, NULL, 0);
+        pStitch->parseNals(pParam360SCVP, E_MERGE_AND_VIEWPORT, NULL, 1);
+        ret = pStitch->feedParamToGenStream(pParam360SCVP);
+
+        ret = pStitch->doMerge(pParam360SCVP, pSpans, pSpanNum);
+    }
+    else
+    {
+        ret = -1;
+    }
+    return ret;
+}
+
+int32_t   I360SCVP_flattenSpans(const MergeSpan* pSpans, uint32_t spanNum, uint8_t* pOutput, uint32_t outputLen)
+{
+    if (!pSpans || !pOutput)
+        return -1;
+    uint32_t frameLen = 0;
+    for (uint32_t i = 0; i < spanNum; i++)
+    {
+        if (pSpans[i].size > outputLen - frameLen)
+            return -1;
+        memcpy_s(pOutput + frameLen, pSpans[i].size, pSpans[i].data, pSpans[i].size);
+        frameLen += pSpans[i].size;
+    }
+    return (int32_t)frameLen;
+}
+
 int32_t I360SCVP_setViewPort(void* p360SCVPHandle, float yaw, float pitch)
 {
     int32_t ret = 0;
@@ -165,6 +214,14 @@ int32_t I360SCVP_getTilesInViewport(TileDef* pOutTile, Param_ViewportOutput* pPa
     return ret;
 }
 
+int32_t I360SCVP_getTilesInViewportBatch(HeadPose* pPoses, uint32_t poseNum, TileDef* pOutTiles, uint32_t maxTileNum, int32_t* pTileNums, Param_ViewportOutput* pParamViewPortOutputs, CCDef* pOutCCs, void* p360SCVPHandle)
+{
+    TstitchStream* pStitch = (TstitchStream*)(p360SCVPHandle);
+    if (!pStitch)
+        return -1;
+    return pStitch->getTilesInViewportBatch(pPoses, poseNum, pOutTiles, maxTileNum, pTileNums, pParamViewPortOutputs, pOutCCs);
+}
+
 int32_t I360SCVP_ParseNAL(Nalu* pNALU, void* p360SCVPHandle)
 {
     TstitchStream* pStitch = (TstitchStream*)(p360SCVPHandle);
@@ -384,6 +441,12 @@ int32_t I360SCVP_SetParameter(void* p360SCVPHandle, int32_t paramID, void* pValu
         pViewPortInfo = (Param_ViewPortInfo*)pValue;
         ret = pStitch->setViewPortInfo(pViewPortInfo);
         break;
+    case ID_SCVP_PARAM_TILE_LUT:
+        ret = pStitch->setTileLUT((Param_TileLUT*)pValue);
+        break;
+    case ID_SCVP_PARAM_VIEWPORT_SOLVER:
+        ret = pStitch->setViewportSolver(*((int32_t*)pValue));
+        break;
     case ID_SCVP_PARAM_SEI_PROJECTION:
         projType = *((int32_t*)pValue);
         ret = pStitch->setSEIProjInfo(projType);
@@ -232,9 +232,76 @@ uint8_t gf_bs_read_bit(GTS_BitStream *bs)
 }
 
 
+/*bit offset of the next bit to be read, memory read mode only*/
+static inline uint64_t BS_GetReadBitOffset(GTS_BitStream *bs)
+{
+    return (bs->position << 3) + bs->nbBits - 8;
+}
+
+/*moves the read pointer to the given bit offset, keeping position/nbBits/current
+  consistent with the bit-by-bit reader so both paths can be mixed freely*/
+static inline void BS_SetReadBitOffset(GTS_BitStream *bs, uint64_t bitOffset)
+{
+    uint32_t bitsInByte = (uint32_t)(bitOffset & 7);
+    if (!bitsInByte) {
+        bs->position = bitOffset >> 3;
+        bs->nbBits = 8;
+        return;
+    }
+    bs->position = (bitOffset >> 3) + 1;
+    bs->nbBits = bitsInByte;
+    bs->current = ((uint32_t)(uint8_t)bs->original[bitOffset >> 3]) << bitsInByte;
+}
+
+/*makes sure the word cache holds nBits (<= 57) bits starting at bitOffset,
+  returns false if the buffer does not contain enough data*/
+static inline bool BS_FillCache(GTS_BitStream *bs, uint64_t bitOffset, uint32_t nBits)
+{
+    if ((bs->bsmode != GTS_BITSTREAM_READ) || !bs->original)
+        return false;
+    if (bitOffset + nBits > (bs->size << 3))
+        return false;
+    //the last byte is in use, leave over-read handling to the bit reader
+    if ((bs->position >= bs->size) && (bs->nbBits < 8))
+        return false;
+    if ((bitOffset >= bs->cacheBitPos) && (bitOffset + nBits <= bs->cacheBitPos + bs->cacheBits))
+        return true;
+
+    uint64_t bytePos = bitOffset >> 3;
+    uint64_t remain = bs->size - bytePos;
+    uint32_t nbBytes = (remain > 8) ? 8 : (uint32_t)remain;
+    const uint8_t *src = (const uint8_t *)bs->original + bytePos;
+    uint64_t word = 0;
+    if (nbBytes == 8) {
+        memcpy(&word, src, 8);
+        word = __builtin_bswap64(word);
+    } else {
+        for (uint32_t i = 0; i < nbBytes; i++)
+            word |= ((uint64_t)src[i]) << (56 - 8 * i);
+    }
+    bs->cache = word;
+    bs->cacheBitPos = bytePos << 3;
+    bs->cacheBits = nbBytes << 3;
+    return true;
+}
+
+/*returns nBits (1 to 32) from the cache, BS_FillCache must have succeeded*/
+static inline uint32_t BS_CacheBits(GTS_BitStream *bs, uint64_t bitOffset, uint32_t nBits)
+{
+    return (uint32_t)((bs->cache << (bitOffset - bs->cacheBitPos)) >> (64 - nBits));
+}
+
 uint32_t gts_bs_read_int(GTS_BitStream *bs, uint32_t nBits)
 {
     uint32_t ret = 0;
+    if (nBits && nBits <= 32) {
+        uint64_t bitOffset = BS_GetReadBitOffset(bs);
+        if (BS_FillCache(bs, bitOffset, nBits)) {
+            ret = BS_CacheBits(bs, bitOffset, nBits);
+            BS_SetReadBitOffset(bs, bitOffset + nBits);
+            return ret;
+        }
+    }
     while (nBits-- > 0) {
         ret <<= 1;
         ret |= gf_bs_read_bit(bs);
@@ -242,6 +309,72 @@ uint32_t gts_bs_read_int(GTS_BitStream *bs, uint32_t nBits)
     return ret;
 }
 
+static uint8_t digits_of_agm[128] = {
+    8, 7, 6, 6, 5, 5, 5, 5,  4, 4, 4, 4, 4, 4, 4, 4,
+    3, 3, 3, 3, 3, 3, 3, 3,  3, 3, 3, 3, 3, 3, 3, 3,
+    2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2,
+    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1
+};
+
+/*byte-wise Exp-Golomb decoding, used for file mode and near the end of the buffer*/
+static uint32_t BS_ReadUESlow(GTS_BitStream *bs)
+{
+    uint8_t flag_c;
+    uint32_t data = 0, flag_r = 0;
+    while (1) {
+        flag_r = gts_bs_peek_bits(bs, 8, 0);
+        if (flag_r) break;
+        //check whether we still have data once the peek is done since we may have less than 8 data available
+        if (!gts_bs_available(bs)) {
+            return 0;
+        }
+        gts_bs_read_int(bs, 8);
+        data += 8;
+    }
+    if (flag_r < 128)
+        flag_c = digits_of_agm[flag_r];
+    else
+        flag_c = 0;
+    gts_bs_read_int(bs, flag_c);
+    data += flag_c;
+    return gts_bs_read_int(bs, data + 1) - 1;
+}
+
+uint32_t gts_bs_read_ue(GTS_BitStream *bs)
+{
+    uint64_t bitOffset = BS_GetReadBitOffset(bs);
+    if (BS_FillCache(bs, bitOffset, 32)) {
+        uint32_t peek = BS_CacheBits(bs, bitOffset, 32);
+        if (peek) {
+            uint32_t leadingZeros = (uint32_t)__builtin_clz(peek);
+            uint32_t codeLen = 2 * leadingZeros + 1;
+            if (codeLen <= 32) {
+                //the whole code word was peeked already
+                BS_SetReadBitOffset(bs, bitOffset + codeLen);
+                return (peek >> (32 - codeLen)) - 1;
+            }
+            bitOffset += leadingZeros;
+            if (BS_FillCache(bs, bitOffset, leadingZeros + 1)) {
+                uint32_t value = BS_CacheBits(bs, bitOffset, leadingZeros + 1);
+                BS_SetReadBitOffset(bs, bitOffset + leadingZeros + 1);
+                return value - 1;
+            }
+        }
+    }
+    return BS_ReadUESlow(bs);
+}
+
+int32_t gts_bs_read_se(GTS_BitStream *bs)
+{
+    uint32_t v = gts_bs_read_ue(bs);
+    if ((v & 0x1) == 0) return (int32_t)(0 - (v >> 1));
+    return (v + 1) >> 1;
+}
+
 uint32_t gts_bs_read_U32(GTS_BitStream *bs)
 {
     uint32_t ret;
@@ -263,11 +396,11 @@ uint64_t gts_bs_read_long_int(GTS_BitStream *bs, uint32_t nBits)
     if (nBits>64) {
         gts_bs_read_long_int(bs, nBits-64);
         ret = gts_bs_read_long_int(bs, 64);
+    } else if (nBits > 32) {
+        ret = ((uint64_t)gts_bs_read_int(bs, nBits - 32)) << 32;
+        ret |= gts_bs_read_int(bs, 32);
     } else {
-        while (nBits-- > 0) {
-            ret <<= 1;
-            ret |= gf_bs_read_bit(bs);
-        }
+        ret = gts_bs_read_int(bs, nBits);
     }
     return ret;
 }
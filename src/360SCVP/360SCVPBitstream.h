@@ -125,6 +125,13 @@ struct __tag_bitstream
     int8_t *buffer_io;
     uint32_t buffer_io_size;
     uint32_t buffer_written;
+
+    //64-bit word cache used in memory read mode, MSB is the first cached bit
+    uint64_t cache;
+    //bit offset in the buffer of the first cached bit
+    uint64_t cacheBitPos;
+    //the number of valid bits in the cache
+    uint32_t cacheBits;
 };
 
 typedef struct __tag_bitstream GTS_BitStream;
@@ -187,6 +194,24 @@ uint64_t gts_bs_available(GTS_BitStream *bs);
  */
 uint32_t gts_bs_read_int(GTS_BitStream *bs, uint32_t nBits);
 
+/*!
+ *    \brief Reads an unsigned Exp-Golomb coded integer, ue(v).
+ *
+ *    \param GTS_BitStream *bs   input  the target bitstream
+ *
+ *    \return uint32_t the integer value read.
+ */
+uint32_t gts_bs_read_ue(GTS_BitStream *bs);
+
+/*!
+ *    \brief Reads a signed Exp-Golomb coded integer, se(v).
+ *
+ *    \param GTS_BitStream *bs   input  the target bitstream
+ *
+ *    \return int32_t the integer value read.
+ */
+int32_t gts_bs_read_se(GTS_BitStream *bs);
+
 /*!
  *    \brief Reads a large integer coded on a number of bit bigger than 32.
  *
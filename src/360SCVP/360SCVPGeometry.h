@@ -112,6 +112,8 @@ public:
     void geoInit(SVideoInfo& sVideoInfo);
     void geoUnInit(); // just use in the viewport
     GeometryType getType() { return (GeometryType)m_sVideoInfo.geoType; }
+    int32_t getFaceWidth() { return m_sVideoInfo.iFaceWidth; }
+    int32_t getFaceHeight() { return m_sVideoInfo.iFaceHeight; }
     void setPaddingFlag(bool bFlag) { m_bPadded = bFlag; }
     virtual void map2DTo3D(SPos& IPosIn, SPos *pSPosOut) = 0;
     virtual void map3DTo2D(SPos *pSPosIn, SPos *pSPosOut) = 0;
@@ -30,6 +30,7 @@
 #include "360SCVPBitstream.h"
 #include "360SCVPAPI.h"
 
+void nal_write(GTS_BitStream * const bitstream, const uint8_t nal_type, const uint8_t temporal_id, const int32_t long_start_code);
 void hevc_write_bitstream_aud(GTS_BitStream *stream,    HEVCState * const state);
 void hevc_write_parameter_sets(GTS_BitStream *stream, HEVCState * const state);
 void hevc_write_slice_header(GTS_BitStream * stream, HEVCState * state);
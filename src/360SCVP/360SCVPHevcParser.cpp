@@ -26,6 +26,7 @@
 #include "assert.h"
 #include "360SCVPHevcParser.h"
 #include "360SCVPHevcTilestream.h"
+#include "360SCVPNaluScan.h"
 
 inline uint32_t ceil_log2(uint32_t x)
 {
@@ -51,6 +52,13 @@ uint32_t gts_media_nalu_emulation_bytes_remove_count(const int8_t *buffer, uint3
 
     while (n < size_nal)
     {
+        if (!zero_counter)
+        {
+            //nothing can be removed before the next two consecutive zero bytes
+            n = (uint32_t)gts_nalu_find_zero_pair((const uint8_t *)buffer, n, size_nal);
+            if (n >= size_nal)
+                break;
+        }
         if (zero_counter == 2 && buffer[n] == 0x03 && n + 1 < size_nal && buffer[n + 1] < 0x04)
         {
             zero_counter = 0;
@@ -73,6 +81,18 @@ uint32_t gts_media_nalu_remove_emulation_bytes(const int8_t *src_buffer, int8_t
     uint8_t zero_counter = 0;
     while (n < size_nal)
     {
+        if (!zero_counter)
+        {
+            //copy everything up to the next two consecutive zero bytes at once
+            uint32_t next = (uint32_t)gts_nalu_find_zero_pair((const uint8_t *)src_buffer, n, size_nal);
+            if (next > n)
+            {
+                memcpy_s(dst_buffer + n - emulation_bytes_count, next - n, src_buffer + n, next - n);
+                n = next;
+            }
+            if (n >= size_nal)
+                break;
+        }
         if (zero_counter == 2 && src_buffer[n] == 0x03 && n + 1 < size_nal && src_buffer[n + 1] < 0x04)
         {
             zero_counter = 0;
@@ -92,46 +112,14 @@ uint32_t gts_media_nalu_remove_emulation_bytes(const int8_t *src_buffer, int8_t
 }
 
 
-static uint8_t digits_of_agm[128] = {
-    8, 7, 6, 6, 5, 5, 5, 5,  4, 4, 4, 4, 4, 4, 4, 4,
-    3, 3, 3, 3, 3, 3, 3, 3,  3, 3, 3, 3, 3, 3, 3, 3,
-    2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2,
-    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1,  1, 1, 1, 1, 1, 1, 1, 1
-};
-
 static uint32_t bs_get_ue(GTS_BitStream *gts_bitstream)
 {
-    uint8_t flag_c;
-    uint32_t data = 0, flag_r = 0;
-    while (1) {
-        flag_r = gts_bs_peek_bits(gts_bitstream, 8, 0);
-        if (flag_r) break;
-        //check whether we still have data once the peek is done since we may have less than 8 data available
-        if (!gts_bs_available(gts_bitstream)) {
-            //GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[AVC/HEVC] Not enough data in bitstream !!\n"));
-            return 0;
-        }
-        gts_bs_read_int(gts_bitstream, 8);
-        data += 8;
-    }
-    if (flag_r < 128)
-        flag_c = digits_of_agm[flag_r];
-    else
-        flag_c = 0;
-    gts_bs_read_int(gts_bitstream, flag_c);
-    data += flag_c;
-    return gts_bs_read_int(gts_bitstream, data + 1) - 1;
+    return gts_bs_read_ue(gts_bitstream);
 }
 
 static int32_t bs_get_se(GTS_BitStream *bs)
 {
-    uint32_t v = bs_get_ue(bs);
-    if ((v & 0x1) == 0) return (int32_t)(0 - (v >> 1));
-    return (v + 1) >> 1;
+    return gts_bs_read_se(bs);
 }
 
 uint32_t gts_media_nalu_is_start_code(GTS_BitStream *bs)
@@ -450,6 +438,7 @@ static int32_t hevc_parse_slice_segment(GTS_BitStream *gts_bitstream, HEVCState
             //if (!state->full_slice_header_parse) return 0;
 
         } else {
+            slice_info->poc_lsb_start_bits = ((uint32_t)gts_bs_get_position(gts_bitstream)-1)*8 + gts_bs_get_bit_position(gts_bitstream);
             slice_info->poc_lsb = gts_bs_read_int(gts_bitstream, hevc_sps->log2_max_pic_order_cnt_lsb);
 
             //if not asked to parse full header, abort once we have the poc
@@ -688,6 +677,16 @@ static uint32_t gts_media_nalu_locate_start_code_bs(GTS_BitStream *bs, bool loca
     uint64_t start = gts_bs_get_position(bs);
     if (start<3) return 0;
 
+    if ((bs->bsmode == GTS_BITSTREAM_READ) && bs->original && !locate_trailing) {
+        /*memory mode, scan the buffer in place*/
+        const uint8_t *data = (const uint8_t *)bs->original;
+        uint64_t size = gts_bs_get_size(bs);
+        end = gts_nalu_find_start_code(data, start, size);
+        if ((end < size) && (end > start) && !data[end - 1]) end--;
+        gts_bs_seek(bs, start);
+        return (uint32_t)(end - start);
+    }
+
     load_size = 0;
     bpos = 0;
     cache_start = 0;
@@ -1884,6 +1883,7 @@ int32_t gts_media_hevc_parse_nalu(hevc_specialInfo* pSpecialInfo, int8_t *data,
 
     SliceInfo = &hevc->s_info;
 
+    hevc->s_info.poc_lsb_start_bits = -1;
     hevc->s_info.entry_point_start_bits = -1;
     hevc->s_info.payload_start_offset = -1;
 
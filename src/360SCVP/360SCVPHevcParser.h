@@ -543,6 +543,8 @@ typedef struct
     uint32_t slice_segment_address;
     uint8_t prev_layer_id_plus1;
 
+    //bit offset of the pic_order_cnt_lsb (if present) field
+    int32_t poc_lsb_start_bits;
     //bit offset of the num_entry_point (if present) field
     int32_t entry_point_start_bits;
     uint32_t num_entry_point_offsets;
@@ -610,6 +612,8 @@ int32_t gts_media_hevc_stitch_pps(HEVCState *hevc, void *gentiledstream);
 int32_t gts_media_hevc_stitch_slice_segment(HEVCState *hevc, void* slice, uint32_t frameWidth, uint32_t sub_tile_index);
 
 uint32_t gts_media_nalu_next_start_code_bs(GTS_BitStream *bs);
+uint32_t gts_media_nalu_emulation_bytes_remove_count(const int8_t *buffer, uint32_t size_nal);
+uint32_t gts_media_nalu_remove_emulation_bytes(const int8_t *src_buffer, int8_t *dst_buffer, uint32_t size_nal);
 int32_t hevc_read_RwpkSEI(int8_t *pRWPKBits, uint32_t RWPKBitsSize, RegionWisePacking* pRWPK);
 int32_t hevc_read_novelViewSEI(NovelViewSEI* sei_out, uint8_t* pSEIBits, uint32_t SEIBitsSize);
 #define MAX_TILE_ROWS 64
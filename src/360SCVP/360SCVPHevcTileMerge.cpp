@@ -193,15 +193,29 @@ int32_t merge_header(GTS_BitStream *bs, oneStream_info* pSlice, uint8_t **pBitst
         hevc_write_slice_header(bs, hevc);
     }
 
+    //the written headers are one span of the scatter-gather output
+    if (mergeStream->pSpans && append_merge_span(mergeStream->pSpans, &mergeStream->spanNum, mergeStream->maxSpanNum,
+            pBitstreamCur, (uint32_t)(bs->position - bs_position)))
+        return -1;
+
     //move to current address
     pBitstreamCur += bs->position - bs_position;
     pSlice->outputBufferLen += (uint32_t)(bs->position - bs_position);
     bs_position = bs->position;
 
-    //copy slice data
-    memcpy_s(pBitstreamCur, nalsize[SLICE_DATA], pBufferSliceCur + specialLen, nalsize[SLICE_DATA]);
-    pBitstreamCur += nalsize[SLICE_DATA];
-    bs->position += nalsize[SLICE_DATA];
+    //copy slice data, or refer to it in the input for the scatter-gather output
+    if (mergeStream->pSpans)
+    {
+        if (append_merge_span(mergeStream->pSpans, &mergeStream->spanNum, mergeStream->maxSpanNum,
+                pBufferSliceCur + specialLen, nalsize[SLICE_DATA]))
+            return -1;
+    }
+    else
+    {
+        memcpy_s(pBitstreamCur, nalsize[SLICE_DATA], pBufferSliceCur + specialLen, nalsize[SLICE_DATA]);
+        pBitstreamCur += nalsize[SLICE_DATA];
+        bs->position += nalsize[SLICE_DATA];
+    }
     pSlice->outputBufferLen += nalsize[SLICE_DATA];
     pBufferSliceCur += specialLen + nalsize[SLICE_DATA];
 
@@ -519,6 +533,9 @@ int32_t tile_merge_Process(param_mergeStream *mergeStreamParams, void* handle)
     }
 
     mergeStream->pOutputBitstream = mergeStreamParams->pOutputBitstream;
+    mergeStream->pSpans = mergeStreamParams->pSpans;
+    mergeStream->maxSpanNum = mergeStreamParams->maxSpanNum;
+    mergeStream->spanNum = 0;
 
     // Get tiles merge solution
     int32_t err = get_merge_solution(mergeStream);
@@ -533,27 +550,28 @@ int32_t tile_merge_Process(param_mergeStream *mergeStreamParams, void* handle)
     HEVCState *LRhevcSlice = (HEVCState*)malloc(sizeof(HEVCState));
     HEVCState *tmpHevcSlice = NULL;
 
+    int32_t mergeErr = 0;
     if(HR_ntile)
     {
-        merge_header(bs, mergeStream->highRes.pHeader, &pOutBitstream, 1, mergeStream, HRhevcSlice);
+        mergeErr |= merge_header(bs, mergeStream->highRes.pHeader, &pOutBitstream, 1, mergeStream, HRhevcSlice);
     }
     if(LR_ntile)
     {
-        merge_header(bs, mergeStream->lowRes.pHeader, &pOutBitstream, 0, mergeStream, LRhevcSlice);
+        mergeErr |= merge_header(bs, mergeStream->lowRes.pHeader, &pOutBitstream, 0, mergeStream, LRhevcSlice);
     }
     // Just merge one frame
     for(int32_t i = 0 ; i < HR_ntile; i++)
     {
         tmpHevcSlice = mergeStream->highRes.pTiledBitstreams[i]->hevcSlice;
         mergeStream->highRes.pTiledBitstreams[i]->hevcSlice = HRhevcSlice;
-        merge_header(bs, mergeStream->highRes.pTiledBitstreams[i], &pOutBitstream, 1, mergeStream,NULL);
+        mergeErr |= merge_header(bs, mergeStream->highRes.pTiledBitstreams[i], &pOutBitstream, 1, mergeStream,NULL);
         mergeStream->highRes.pTiledBitstreams[i]->hevcSlice = tmpHevcSlice;
     }
     for(int32_t i = 0 ; i < LR_ntile; i++)
     {
         tmpHevcSlice = mergeStream->lowRes.pTiledBitstreams[i]->hevcSlice;
         mergeStream->lowRes.pTiledBitstreams[i]->hevcSlice = LRhevcSlice;
-        merge_header(bs, mergeStream->lowRes.pTiledBitstreams[i], &pOutBitstream, 0, mergeStream,NULL);
+        mergeErr |= merge_header(bs, mergeStream->lowRes.pTiledBitstreams[i], &pOutBitstream, 0, mergeStream,NULL);
         mergeStream->lowRes.pTiledBitstreams[i]->hevcSlice = tmpHevcSlice;
     }
 
@@ -577,6 +595,7 @@ int32_t tile_merge_Process(param_mergeStream *mergeStreamParams, void* handle)
     }
     mergeStream->outputiledbistreamlen = outputBufferLen;
     mergeStreamParams->outputiledbistreamlen = mergeStream->outputiledbistreamlen;
+    mergeStreamParams->spanNum = mergeStream->spanNum;
 
     if (bs) gts_bs_del(bs);
 
@@ -590,6 +609,9 @@ int32_t tile_merge_Process(param_mergeStream *mergeStreamParams, void* handle)
         free(LRhevcSlice);
         LRhevcSlice = NULL;
     }
+    // a failed tile is only fatal when the spans cannot describe the frame
+    if (mergeStream->pSpans && mergeErr)
+        return -1;
     return 0;
 }
 
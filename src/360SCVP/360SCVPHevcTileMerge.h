@@ -55,6 +55,9 @@ typedef struct HEVC_MERGEBITSTREAM
     int32_t        pic_height;
     int32_t       *slice_segment_address;
     bool           bWroteHeader;
+    MergeSpan     *pSpans;
+    uint32_t       maxSpanNum;
+    uint32_t       spanNum;
 }hevc_mergeStream;
 
 //modify resolution and tile segmentation
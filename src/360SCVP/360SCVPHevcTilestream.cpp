@@ -404,6 +404,27 @@ int32_t set_genHandle_params(oneStream_info* cur, param_oneStream_info* in)
     return 0;
 }
 
+int32_t append_merge_span(MergeSpan* pSpans, uint32_t* pSpanNum, uint32_t maxSpanNum, const uint8_t* data, uint32_t size)
+{
+    if (!pSpans || !pSpanNum)
+        return GTS_BAD_PARAM;
+    if (!size)
+        return 0;
+
+    // headers written back to back extend the last span
+    if (*pSpanNum && pSpans[*pSpanNum - 1].data + pSpans[*pSpanNum - 1].size == data)
+    {
+        pSpans[*pSpanNum - 1].size += size;
+        return 0;
+    }
+    if (*pSpanNum >= maxSpanNum)
+        return GTS_BAD_PARAM;
+    pSpans[*pSpanNum].data = data;
+    pSpans[*pSpanNum].size = size;
+    (*pSpanNum)++;
+    return 0;
+}
+
 void*   genTiledStream_Init(param_gen_tiledStream* pParamGenTiledStream)
 {
     if (!pParamGenTiledStream)
@@ -95,6 +95,7 @@ typedef struct HEVC_GEN_TILEDSTREAM
 }hevc_gen_tiledstream;
 
 int32_t set_genHandle_params(oneStream_info* cur, param_oneStream_info* in);
+int32_t append_merge_span(MergeSpan* pSpans, uint32_t* pSpanNum, uint32_t maxSpanNum, const uint8_t* data, uint32_t size);
 int32_t parse_tiles_info(hevc_gen_tiledstream* pGenTilesStream);
 int32_t hevc_import_ffextradata(hevc_specialInfo* pSpecialInfo, HEVCState* hevc, uint32_t *pSize, int32_t *spsCnt, int32_t *audCnt, int32_t bParse);
 int32_t parse_hevc_specialinfo(hevc_specialInfo* pSpecialInfo, HEVCState* hevc, uint32_t* nalsize, uint32_t* specialLen, int32_t* spsCnt, int32_t bParse);
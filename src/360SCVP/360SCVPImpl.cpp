@@ -28,6 +28,9 @@
 #include "string.h"
 #include "assert.h"
 #include <dlfcn.h>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 #include "360SCVPTiledstreamAPI.h"
 #include "360SCVPViewportAPI.h"
 #include "360SCVPMergeStreamAPI.h"
@@ -103,10 +106,15 @@ TstitchStream::TstitchStream()
     m_yTopLeftNet = 0;
     m_dstRwpk = RegionWisePacking();
     m_pTileSelection = NULL;
+    m_pSpans = NULL;
+    m_spanNum = 0;
+    m_maxSpanNum = 0;
     m_pluginLibHdl = NULL;
     m_createPlugin = NULL;
     m_destroyPlugin = NULL;
     m_bNeedPlugin = false;
+    m_bSharedDesc = false;
+    memset_s(&m_batchJob, sizeof(BatchJob), 0);
     m_tilesInfo = new ITileInfo[MAX_TILE_NUM];
     m_mapFaceInfo = new MapFaceInfo[6];
 }
@@ -186,20 +194,121 @@ TstitchStream::TstitchStream(TstitchStream& other)
     m_dstRwpk = RegionWisePacking();
     m_dstRwpk = other.m_dstRwpk;
     m_pTileSelection = NULL;
+    m_pSpans = NULL;
+    m_spanNum = 0;
+    m_maxSpanNum = 0;
     m_pluginLibHdl = NULL;
     m_createPlugin = NULL;
     m_destroyPlugin = NULL;
     m_bNeedPlugin = false;
+    m_bSharedDesc = false;
+    memset_s(&m_batchJob, sizeof(BatchJob), 0);
     m_tilesInfo = new ITileInfo[MAX_TILE_NUM];
     memcpy_s(m_tilesInfo, MAX_TILE_NUM * sizeof(ITileInfo), other.m_tilesInfo, MAX_TILE_NUM * sizeof(ITileInfo));
     m_mapFaceInfo = new MapFaceInfo[6];
     memcpy_s(m_mapFaceInfo, 6 * sizeof(int32_t), other.m_mapFaceInfo, 6 * sizeof(int32_t));
 }
 
+TstitchStream::TstitchStream(const TstitchStream& parent, const std::shared_ptr<const StreamDesc>& desc)
+{
+    // the parsed stream is shared, only the selection state is per session
+    m_streamDesc = desc;
+    m_bSharedDesc = true;
+    memset_s(&m_batchJob, sizeof(BatchJob), 0);
+    m_hevcState = const_cast<HEVCState*>(&desc->hevcState);
+    m_tilesInfo = const_cast<ITileInfo*>(desc->tilesInfo);
+    m_mapFaceInfo = const_cast<MapFaceInfo*>(desc->mapFaceInfo);
+
+    m_pOutTile = new TileDef[MAX_TILE_NUM];
+    m_pUpLeft = new point[6];
+    memcpy_s(m_pUpLeft, 6 * sizeof(point), parent.m_pUpLeft, 6 * sizeof(point));
+    m_pDownRight = new point[6];
+    memcpy_s(m_pDownRight, 6 * sizeof(point), parent.m_pDownRight, 6 * sizeof(point));
+    m_pNalInfo[0] = new nal_info[MAX_TILE_NUM]();
+    m_pNalInfo[1] = new nal_info[MAX_TILE_NUM]();
+
+    memcpy_s(&m_pViewportParam, sizeof(generateViewPortParam), &(parent.m_pViewportParam), sizeof(generateViewPortParam));
+    m_pViewportParam.m_pUpLeft = m_pUpLeft;
+    m_pViewportParam.m_pDownRight = m_pDownRight;
+    // the lookup table is per viewport, it is only built when asked for by the session
+    memset_s(&m_pViewportParam.m_tileLUT, sizeof(Param_TileLUT), 0);
+    memset_s(&m_mergeStreamParam, sizeof(param_mergeStream), 0);
+    memset_s(&m_streamStitch, sizeof(param_gen_tiledStream), 0);
+    m_pViewport = NULL;
+    m_pMergeStream = NULL;
+    m_pSteamStitch = NULL;
+    m_seiFramePacking_enable = parent.m_seiFramePacking_enable;
+    m_seiPayloadType = parent.m_seiPayloadType;
+    m_seiProj_enable = parent.m_seiProj_enable;
+    m_seiSphereRot_enable = parent.m_seiSphereRot_enable;
+    m_seiRWPK_enable = parent.m_seiRWPK_enable;
+    m_seiViewport_enable = parent.m_seiViewport_enable;
+    m_seiNovelView_enable = parent.m_seiNovelView_enable;
+    m_projType = parent.m_projType;
+    m_specialDataLen[0] = parent.m_specialDataLen[0];
+    m_specialDataLen[1] = parent.m_specialDataLen[1];
+    m_hrTilesInRow = parent.m_hrTilesInRow;
+    m_hrTilesInCol = parent.m_hrTilesInCol;
+    m_lrTilesInRow = parent.m_lrTilesInRow;
+    m_lrTilesInCol = parent.m_lrTilesInCol;
+    m_bVPSReady = parent.m_bVPSReady;
+    m_bSPSReady = parent.m_bSPSReady;
+    m_bPPSReady = parent.m_bPPSReady;
+    m_tileWidthCountSel[0] = parent.m_tileWidthCountSel[0];
+    m_tileWidthCountSel[1] = parent.m_tileWidthCountSel[1];
+    m_tileHeightCountSel[0] = parent.m_tileHeightCountSel[0];
+    m_tileHeightCountSel[1] = parent.m_tileHeightCountSel[1];
+    m_tileWidthCountOri[0] = parent.m_tileWidthCountOri[0];
+    m_tileWidthCountOri[1] = parent.m_tileWidthCountOri[1];
+    m_tileHeightCountOri[0] = parent.m_tileHeightCountOri[0];
+    m_tileHeightCountOri[1] = parent.m_tileHeightCountOri[1];
+    m_specialInfo[0] = new unsigned char[200];
+    memcpy_s(m_specialInfo[0], 200 * sizeof(unsigned char), parent.m_specialInfo[0], 200 * sizeof(unsigned char));
+    m_specialInfo[1] = new unsigned char[200];
+    memcpy_s(m_specialInfo[1], 200 * sizeof(unsigned char), parent.m_specialInfo[1], 200 * sizeof(unsigned char));
+    m_sliceHeaderLen = parent.m_sliceHeaderLen;
+    m_dstWidthNet = parent.m_dstWidthNet;
+    m_dstHeightNet = parent.m_dstHeightNet;
+    m_maxSelTiles = parent.m_maxSelTiles;
+    m_pRWPK = NULL;
+    m_pFramePacking = parent.m_pFramePacking;
+    m_pSphereRot = parent.m_pSphereRot;
+    m_pSeiViewport = parent.m_pSeiViewport;
+    m_pNovelView = parent.m_pNovelView;
+    m_viewportDestWidth = parent.m_viewportDestWidth;
+    m_viewportDestHeight = parent.m_viewportDestHeight;
+    m_dataSize = 0;
+    m_data = NULL;
+    m_startCodesSize = parent.m_startCodesSize;
+    m_nalType = parent.m_nalType;
+    memcpy_s(&m_sliceType, sizeof(SliceType), &(parent.m_sliceType), sizeof(SliceType));
+    m_usedType = parent.m_usedType;
+    m_xTopLeftNet = parent.m_xTopLeftNet;
+    m_yTopLeftNet = parent.m_yTopLeftNet;
+    m_dstRwpk = RegionWisePacking();
+    m_pTileSelection = NULL;
+    m_pSpans = NULL;
+    m_spanNum = 0;
+    m_maxSpanNum = 0;
+    m_pluginLibHdl = NULL;
+    m_createPlugin = NULL;
+    m_destroyPlugin = NULL;
+    m_bNeedPlugin = false;
+
+    if (parent.m_pViewport)
+    {
+        m_pViewport = genViewport_Init(&m_pViewportParam);
+        if (m_usedType == E_MERGE_AND_VIEWPORT)
+            genViewport_setMaxSelTiles(m_pViewport, m_maxSelTiles);
+    }
+}
+
 TstitchStream& TstitchStream::operator=(const TstitchStream& other)
 {
     if (&other == this)
         return *this;
+    releaseBatchSessions();
+    releaseStreamDesc();
     SAFE_DELETE_ARRAY(m_pOutTile);
     m_pOutTile = new TileDef[MAX_TILE_NUM];
     memcpy_s(m_pOutTile, MAX_TILE_NUM * sizeof(TileDef), other.m_pOutTile, MAX_TILE_NUM * sizeof(TileDef));
@@ -281,6 +390,10 @@ TstitchStream& TstitchStream::operator=(const TstitchStream& other)
     m_dstRwpk = RegionWisePacking();
     m_dstRwpk = other.m_dstRwpk;
     m_pTileSelection = NULL;
+    m_pSpans = NULL;
+    m_spanNum = 0;
+    m_maxSpanNum = 0;
+    m_sliceHdrCache.clear();
     m_pluginLibHdl = NULL;
     m_createPlugin = NULL;
     m_destroyPlugin = NULL;
@@ -297,6 +410,8 @@ TstitchStream& TstitchStream::operator=(const TstitchStream& other)
 
 TstitchStream::~TstitchStream()
 {
+    releaseBatchSessions();
+    releaseStreamDesc();
     SAFE_DELETE_ARRAY(m_pOutTile);
     SAFE_DELETE_ARRAY(m_pUpLeft);
     SAFE_DELETE_ARRAY(m_pDownRight);
@@ -314,6 +429,7 @@ int32_t TstitchStream::initViewport(Param_ViewPortInfo* pViewPortInfo, int32_t t
 {
     if (pViewPortInfo == NULL)
         return -1;
+    releaseBatchSessions();
     m_pViewportParam.m_pDownRight = m_pDownRight;
     m_pViewportParam.m_pUpLeft = m_pUpLeft;
     m_pViewportParam.m_iInputHeight = pViewPortInfo->faceHeight;
@@ -391,6 +507,63 @@ int32_t TstitchStream::SetLogCallBack(LogFunction logFunction)
     return ERROR_NONE;
 }
 
+TstitchStream* TstitchStream::newSession()
+{
+    if (m_bNeedPlugin || m_pTileSelection)
+    {
+        SCVP_LOG(LOG_ERROR, "Session is not supported for the tile selection plugin!\n");
+        return NULL;
+    }
+    if (!m_hevcState || !m_tilesInfo || !m_mapFaceInfo)
+        return NULL;
+
+    std::shared_ptr<const StreamDesc> desc;
+    {
+        std::lock_guard<std::mutex> lock(m_streamDescMutex);
+        if (!m_streamDesc)
+        {
+            StreamDesc* pDesc = new StreamDesc;
+            memcpy_s(&pDesc->hevcState, sizeof(HEVCState), m_hevcState, sizeof(HEVCState));
+            memcpy_s(pDesc->tilesInfo, MAX_TILE_NUM * sizeof(ITileInfo), m_tilesInfo, MAX_TILE_NUM * sizeof(ITileInfo));
+            memcpy_s(pDesc->mapFaceInfo, 6 * sizeof(MapFaceInfo), m_mapFaceInfo, 6 * sizeof(MapFaceInfo));
+            m_streamDesc.reset(pDesc);
+        }
+        desc = m_streamDesc;
+    }
+    return new TstitchStream(*this, desc);
+}
+
+void TstitchStream::detachStreamDesc()
+{
+    if (!m_bSharedDesc)
+        return;
+
+    HEVCState* hevcState = new HEVCState;
+    memcpy_s(hevcState, sizeof(HEVCState), m_hevcState, sizeof(HEVCState));
+    ITileInfo* tilesInfo = new ITileInfo[MAX_TILE_NUM];
+    memcpy_s(tilesInfo, MAX_TILE_NUM * sizeof(ITileInfo), m_tilesInfo, MAX_TILE_NUM * sizeof(ITileInfo));
+    MapFaceInfo* mapFaceInfo = new MapFaceInfo[6];
+    memcpy_s(mapFaceInfo, 6 * sizeof(MapFaceInfo), m_mapFaceInfo, 6 * sizeof(MapFaceInfo));
+    m_hevcState = hevcState;
+    m_tilesInfo = tilesInfo;
+    m_mapFaceInfo = mapFaceInfo;
+    m_bSharedDesc = false;
+    m_streamDesc.reset();
+}
+
+void TstitchStream::releaseStreamDesc()
+{
+    // the shared members are owned by the snapshot
+    if (m_bSharedDesc)
+    {
+        m_hevcState = NULL;
+        m_tilesInfo = NULL;
+        m_mapFaceInfo = NULL;
+        m_bSharedDesc = false;
+    }
+    m_streamDesc.reset();
+}
+
 static int32_t tile_faceId_init(param_360SCVP* pParamStitchStream, int32_t* tileNumCol, int32_t* tileNumRow, ITileInfo* dstTileInfo)
 {
     ITileInfo* tileInfo = dstTileInfo;
@@ -522,6 +695,7 @@ int32_t TstitchStream::initTileInfo(param_360SCVP* pParamStitchStream)
         SCVP_LOG(LOG_ERROR, "TilesInfo is not allocated!\n");
         return ERROR_NULL_PTR;
     }
+    m_streamDesc.reset();
     tile_faceId_init(pParamStitchStream, m_tileWidthCountOri, m_tileHeightCountOri, m_tilesInfo);
 
     if (pParamStitchStream->paramViewPort.usageType == E_MERGE_AND_VIEWPORT) {
@@ -784,6 +958,7 @@ int32_t TstitchStream::init(param_360SCVP* pParamStitchStream)
 {
     if (pParamStitchStream == NULL)
         return -1;
+    detachStreamDesc();
     int32_t ret = 0;
     m_specialDataLen[0] = 0;
     m_specialDataLen[1] = 0;
@@ -926,6 +1101,8 @@ int32_t TstitchStream::uninit()
     int32_t LR_ntile = m_mergeStreamParam.lowRes.selectedTilesCount;
     int32_t ret = 0;
 
+    releaseBatchSessions();
+
     if (m_pMergeStream)
     {
         if (m_mergeStreamParam.highRes.pHeader)
@@ -978,6 +1155,7 @@ int32_t TstitchStream::uninit()
     SAFE_DELETE_ARRAY(m_pNalInfo[0]);
     SAFE_DELETE_ARRAY(m_pNalInfo[1]);
 
+    releaseStreamDesc();
     SAFE_DELETE(m_hevcState);
     SAFE_DELETE_ARRAY(m_specialInfo[0]);
     SAFE_DELETE_ARRAY(m_specialInfo[1]);
@@ -1015,6 +1193,7 @@ int32_t TstitchStream::parseNals(param_360SCVP* pParamStitchStream, int32_t pars
 {
     if (!pParamStitchStream && !pNALU)
         return -1;
+    detachStreamDesc();
     param_gen_tiledStream GenStreamParam;
     param_oneStream_info  TileBitstreamList;
     param_oneStream_info  TiledBitstream;
@@ -1080,9 +1259,21 @@ int32_t TstitchStream::parseNals(param_360SCVP* pParamStitchStream, int32_t pars
         genTiledStream_parseNals(&GenStreamParam, pGenStream);
 
         if(pGenTilesStream->parseType != E_PARSER_ONENAL)
+        {
             memcpy_s(m_hevcState, sizeof(HEVCState), pSlice->hevcSlice, sizeof(HEVCState));
+            m_sliceHdrCache.clear();
+            m_streamDesc.reset();
+        }
         else
         {
+            if (GenStreamParam.nalType == GTS_HEVC_NALU_VID_PARAM
+                || GenStreamParam.nalType == GTS_HEVC_NALU_SEQ_PARAM
+                || GenStreamParam.nalType == GTS_HEVC_NALU_PIC_PARAM)
+            {
+                m_sliceHdrCache.clear();
+                m_streamDesc.reset();
+            }
+
             if (GenStreamParam.nalType == GTS_HEVC_NALU_VID_PARAM)
             {
                 memcpy_s(m_hevcState->vps, 16 * sizeof(HEVC_VPS), pSlice->hevcSlice->vps, 16 * sizeof(HEVC_VPS));
@@ -1298,12 +1489,26 @@ int32_t TstitchStream::setViewPort(HeadPose *pose)
         return genViewport_setViewPort(m_pViewport, pose->yaw, pose->pitch);
 }
 
-int32_t TstitchStream::doMerge(param_360SCVP* pParamStitchStream)
+int32_t TstitchStream::doMerge(param_360SCVP* pParamStitchStream, MergeSpan* pSpans, uint32_t* pSpanNum)
 {
     int32_t ret = 0;
     if (pParamStitchStream == NULL)
         return -1;
+    // in span mode the headers go to the caller's buffer of this frame,
+    // the tile data is referenced from the input bitstreams
+    uint8_t *pMergeOutput = m_mergeStreamParam.pOutputBitstream;
+    if (pSpans)
+    {
+        if (!pSpanNum)
+            return -1;
+        m_mergeStreamParam.pOutputBitstream = pParamStitchStream->pOutputBitstream;
+    }
+    m_mergeStreamParam.pSpans = pSpans;
+    m_mergeStreamParam.maxSpanNum = pSpans ? *pSpanNum : 0;
     ret = tile_merge_Process(&m_mergeStreamParam, m_pMergeStream);
+    m_mergeStreamParam.pOutputBitstream = pMergeOutput;
+    m_mergeStreamParam.pSpans = NULL;
+    m_mergeStreamParam.maxSpanNum = 0;
 
     if (ret < 0)
         return -1;
@@ -1330,7 +1535,10 @@ int32_t TstitchStream::doMerge(param_360SCVP* pParamStitchStream)
     if(GenerateRwpkInfo(&m_dstRwpk) == 0)
         ret = EncRWPKSEI(&m_dstRwpk, pParamStitchStream->pOutputSEI, &pParamStitchStream->outputSEILen);
     pParamStitchStream->outputBitstreamLen = m_mergeStreamParam.outputiledbistreamlen;
-    memcpy_s(pParamStitchStream->pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen, m_mergeStreamParam.pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen);
+    if (pSpans)
+        *pSpanNum = m_mergeStreamParam.spanNum;
+    else
+        memcpy_s(pParamStitchStream->pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen, m_mergeStreamParam.pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen);
 
     return ret;
 }
@@ -1805,12 +2013,177 @@ int32_t TstitchStream::getTilesInViewport(TileDef* pOutTile)
     return ret;
 }
 
-int32_t  TstitchStream::doStreamStitch(param_360SCVP* pParamStitchStream)
+int32_t TstitchStream::getTilesForPose(HeadPose* pPose, TileDef* pTmpTiles, TileDef* pOutTile, uint32_t maxTileNum, Param_ViewportOutput* pOutput, CCDef* pOutCC)
+{
+    if (setViewPort(pPose))
+        return -1;
+    getViewPortTiles();
+    int32_t tileNum = getTilesInViewport(pTmpTiles);
+    if (tileNum < 0 || (uint32_t)tileNum > maxTileNum)
+        return -1;
+    memcpy_s(pOutTile, maxTileNum * sizeof(TileDef), pTmpTiles, tileNum * sizeof(TileDef));
+    if (pOutput)
+    {
+        pOutput->dstWidthAlignTile = m_viewportDestWidth;
+        pOutput->dstHeightAlignTile = m_viewportDestHeight;
+        pOutput->dstWidthNet = m_dstWidthNet;
+        pOutput->dstHeightNet = m_dstHeightNet;
+        pOutput->xTopLeftNet = m_xTopLeftNet;
+        pOutput->yTopLeftNet = m_yTopLeftNet;
+    }
+    if (pOutCC && getContentCoverage(pOutCC))
+        return -1;
+    return tileNum;
+}
+
+int32_t TstitchStream::getTilesInViewportBatch(HeadPose* pPoses, uint32_t poseNum, TileDef* pOutTiles, uint32_t maxTileNum, int32_t* pTileNums, Param_ViewportOutput* pOutputs, CCDef* pOutCCs)
+{
+    if (!pPoses || !pOutTiles || !pTileNums || !maxTileNum)
+        return -1;
+    if (!poseNum)
+        return ERROR_NONE;
+
+    // the plugin keeps its own selection state, so the poses go through this handle one by one
+    if (m_pTileSelection || m_bNeedPlugin)
+    {
+        TileDef* pTmpTiles = new TileDef[MAX_TILE_NUM];
+        for (uint32_t i = 0; i < poseNum; i++)
+            pTileNums[i] = getTilesForPose(&pPoses[i], pTmpTiles, pOutTiles + i * maxTileNum, maxTileNum, pOutputs ? &pOutputs[i] : NULL,
+                pOutCCs ? &pOutCCs[i] : NULL);
+        delete[] pTmpTiles;
+        return countFailedPoses(pTileNums, poseNum);
+    }
+
+    // small batches run on the calling thread only
+    uint32_t workerNum = std::max(std::thread::hardware_concurrency(), 1u);
+    workerNum = std::min(workerNum, std::max(poseNum / MIN_BATCH_POSES_PER_WORKER, 1u));
+    workerNum = std::min(workerNum, (uint32_t)MAX_BATCH_WORKER_NUM);
+
+    // the workers are sessions of this handle, they are kept until the stream or the viewport setting changes
+    if (!m_batchSessions.empty() && m_batchSessions[0]->m_streamDesc != m_streamDesc)
+        releaseBatchSessions();
+    while (m_batchSessions.size() < workerNum)
+    {
+        TstitchStream* pSession = newSession();
+        if (!pSession)
+            break;
+        // the lookup table of the handle is read only, so the sessions use it instead of building their own
+        if (m_pViewport && pSession->m_pViewport)
+            genViewport_shareTileLUT(pSession->m_pViewport, m_pViewport);
+        m_batchSessions.push_back(pSession);
+    }
+    if (m_batchSessions.empty())
+        return -1;
+    workerNum = std::min(workerNum, (uint32_t)m_batchSessions.size());
+
+    // session 0 runs on the calling thread, the other sessions keep a worker thread for the next batches
+    while (m_batchWorkers.size() + 1 < workerNum)
+    {
+        try
+        {
+            m_batchWorkers.push_back(std::thread(&TstitchStream::batchWorkerLoop, this, (uint32_t)m_batchWorkers.size() + 1));
+        }
+        catch (const std::exception& ex)
+        {
+            SCVP_LOG(LOG_WARNING, "Failed to create the batch worker, exception: %s\n", ex.what());
+            break;
+        }
+    }
+    workerNum = std::min(workerNum, (uint32_t)m_batchWorkers.size() + 1);
+
+    std::unique_lock<std::mutex> lock(m_batchMutex);
+    m_batchJob.pPoses = pPoses;
+    m_batchJob.poseNum = poseNum;
+    m_batchJob.pOutTiles = pOutTiles;
+    m_batchJob.maxTileNum = maxTileNum;
+    m_batchJob.pTileNums = pTileNums;
+    m_batchJob.pOutputs = pOutputs;
+    m_batchJob.pOutCCs = pOutCCs;
+    m_batchJob.workerNum = workerNum;
+    m_batchJob.nextPose = 0;
+    m_batchJob.unfinishedPoses = poseNum;
+    if (workerNum > 1)
+        m_batchCv.notify_all();
+    runBatchPoses(0, lock);
+    m_batchDoneCv.wait(lock, [this] { return 0 == m_batchJob.unfinishedPoses; });
+    m_batchJob.poseNum = 0;
+    return countFailedPoses(pTileNums, poseNum);
+}
+
+int32_t TstitchStream::countFailedPoses(int32_t* pTileNums, uint32_t poseNum)
+{
+    int32_t failedNum = 0;
+    for (uint32_t i = 0; i < poseNum; i++)
+    {
+        if (pTileNums[i] < 0)
+            failedNum++;
+    }
+    if (failedNum)
+        SCVP_LOG(LOG_WARNING, "Tile selection failed for %d of %u poses\n", failedNum, poseNum);
+    return failedNum;
+}
+
+void TstitchStream::runBatchPoses(uint32_t sessionIdx, std::unique_lock<std::mutex>& lock)
+{
+    TstitchStream* pSession = m_batchSessions[sessionIdx];
+    while (m_batchJob.nextPose < m_batchJob.poseNum)
+    {
+        uint32_t i = m_batchJob.nextPose++;
+        BatchJob job = m_batchJob;
+        lock.unlock();
+        job.pTileNums[i] = pSession->getTilesForPose(&job.pPoses[i], pSession->m_pOutTile, job.pOutTiles + i * job.maxTileNum,
+            job.maxTileNum, job.pOutputs ? &job.pOutputs[i] : NULL, job.pOutCCs ? &job.pOutCCs[i] : NULL);
+        lock.lock();
+        if (0 == --m_batchJob.unfinishedPoses)
+            m_batchDoneCv.notify_all();
+    }
+}
+
+void TstitchStream::batchWorkerLoop(uint32_t sessionIdx)
+{
+    std::unique_lock<std::mutex> lock(m_batchMutex);
+    while (true)
+    {
+        m_batchCv.wait(lock, [this, sessionIdx] {
+            return m_batchJob.quit || (sessionIdx < m_batchJob.workerNum && m_batchJob.nextPose < m_batchJob.poseNum);
+        });
+        if (m_batchJob.quit)
+            break;
+        runBatchPoses(sessionIdx, lock);
+    }
+}
+
+void TstitchStream::releaseBatchSessions()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_batchMutex);
+        m_batchJob.quit = true;
+    }
+    m_batchCv.notify_all();
+    for (auto& worker : m_batchWorkers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_batchWorkers.clear();
+    m_batchJob.quit = false;
+
+    for (auto pSession : m_batchSessions)
+    {
+        pSession->uninit();
+        delete pSession;
+    }
+    m_batchSessions.clear();
+}
+
+int32_t  TstitchStream::doStreamStitch(param_360SCVP* pParamStitchStream, MergeSpan* pSpans, uint32_t* pSpanNum)
 {
     int32_t ret = 0;
     int32_t outputlen = 0;
     if (pParamStitchStream == NULL)
         return -1;
+    if (pSpans && !pSpanNum)
+        return -1;
 
     m_streamStitch.inputBistreamsLen = pParamStitchStream->inputBitstreamLen;
     m_streamStitch.outputiledbistreamlen = pParamStitchStream->outputBitstreamLen;
@@ -1835,7 +2208,14 @@ int32_t  TstitchStream::doStreamStitch(param_360SCVP* pParamStitchStream)
 
     pGenTilesStream->pOutputTiledBitstream = pParamStitchStream->pOutputBitstream;
 
+    m_pSpans = pSpans;
+    m_spanNum = 0;
+    m_maxSpanNum = pSpans ? *pSpanNum : 0;
     ret = merge_partstream_into1bitstream(pParamStitchStream->inputBitstreamLen);
+    if (pSpans)
+        *pSpanNum = m_spanNum;
+    m_pSpans = NULL;
+    m_maxSpanNum = 0;
 
   //  int32_t tiled_idx = 0;
     input_count = 0;
@@ -1963,14 +2343,26 @@ int32_t TstitchStream::merge_one_tile(uint8_t **pBitstream, oneStream_info* pSli
     gts_media_hevc_stitch_slice_segment(hevc, pSlice, pGenTilesStream->frameWidth, (uint32_t)pSlice->currentTileIdx);
     hevc_write_slice_header(bs, hevc);
 
-    //move to current address
-    pBitstreamCur += bs->position - bs_position;
-    bs_position = bs->position;
+    if (m_pSpans)
+    {
+        // reference the slice data in place instead of copying it
+        if (append_merge_span(m_pSpans, &m_spanNum, m_maxSpanNum, pBitstreamCur, (uint32_t)(bs->position - bs_position))
+            || append_merge_span(m_pSpans, &m_spanNum, m_maxSpanNum, pBufferSliceCur + specialLen, nalsize[SLICE_DATA]))
+            return GTS_BAD_PARAM;
+        pBitstreamCur += bs->position - bs_position;
+        pSlice->outputBufferLen += nalsize[SLICE_DATA];
+    }
+    else
+    {
+        //move to current address
+        pBitstreamCur += bs->position - bs_position;
+        bs_position = bs->position;
 
-    //copy slice data
-    memcpy_s(pBitstreamCur, nalsize[SLICE_DATA], pBufferSliceCur + specialLen, nalsize[SLICE_DATA]);
-    pBitstreamCur += nalsize[SLICE_DATA];
-    bs->position += nalsize[SLICE_DATA];
+        //copy slice data
+        memcpy_s(pBitstreamCur, nalsize[SLICE_DATA], pBufferSliceCur + specialLen, nalsize[SLICE_DATA]);
+        pBitstreamCur += nalsize[SLICE_DATA];
+        bs->position += nalsize[SLICE_DATA];
+    }
     pBufferSliceCur += specialLen + nalsize[SLICE_DATA];
 
     pSlice->currentTileIdx++;
@@ -2027,6 +2419,11 @@ int32_t TstitchStream::merge_partstream_into1bitstream(int32_t totalInputLen)
             if (bs) bspos = bs->position;
             bool bFirstTile = (bool)((i == 0 && j == 0) == 1 ? 1 : 0);
             int32_t curframesize = merge_one_tile(&pBitstreamCur, pSliceCur, bs, bFirstTile);
+            if (curframesize < 0)
+            {
+                gts_bs_del(bs);
+                return curframesize;
+            }
             pSliceCur->curBufferLen += curframesize;
             pSliceCur->outputBufferLen += (uint32_t)(bs->position - bspos);
         }
@@ -2095,6 +2492,31 @@ int32_t TstitchStream::setViewPortInfo(Param_ViewPortInfo* pViewPortInfo)
     return ret;
 }
 
+int32_t TstitchStream::setTileLUT(Param_TileLUT* pTileLUT)
+{
+    if (pTileLUT == NULL)
+        return -1;
+
+    releaseBatchSessions();
+    m_pViewportParam.m_tileLUT = *pTileLUT;
+    // the table is built in genViewport_Init if the viewport is not initialized yet
+    if (!m_pViewport)
+        return 0;
+    return genViewport_buildTileLUT(&m_pViewportParam, m_pViewport);
+}
+
+int32_t TstitchStream::setViewportSolver(int32_t solver)
+{
+    if (solver < E_VIEWPORT_SOLVER_PIXEL_SWEEP || solver >= E_VIEWPORT_SOLVER_NUM)
+        return -1;
+
+    releaseBatchSessions();
+    m_pViewportParam.m_viewportSolver = (ViewportSolver)solver;
+    if (!m_pViewport)
+        return 0;
+    return genViewport_setViewportSolver(m_pViewport, solver);
+}
+
 int32_t  TstitchStream::setSEIProjInfo(int32_t projType)
 {
     int32_t ret = 0;
@@ -2171,6 +2593,7 @@ int32_t  TstitchStream::GeneratePPS(param_360SCVP* pParamStitchStream, TileArran
 
     if (!pParamStitchStream || !pTileArrange || !pTileArrange->tileColWidth || !pTileArrange->tileRowHeight)
         return -1;
+    detachStreamDesc();
 
     bs = gts_bs_new((const int8_t*)pParamStitchStream->pInputBitstream, pParamStitchStream->inputBitstreamLen, GTS_BITSTREAM_READ);
     // new bs
@@ -2188,6 +2611,8 @@ int32_t  TstitchStream::GeneratePPS(param_360SCVP* pParamStitchStream, TileArran
         int32_t spsCnt;
         int32_t audCnt;
         ret = hevc_import_ffextradata(&specialInfo, m_hevcState, nalsize, &spsCnt, &audCnt, 0);
+        m_sliceHdrCache.clear();
+        m_streamDesc.reset();
         if (ret < 0)
         {
             gts_bs_del(bs);
@@ -2266,6 +2691,7 @@ int32_t  TstitchStream::GenerateSPS(param_360SCVP* pParamStitchStream)
     HEVCState hevcTmp;
     if (pParamStitchStream == NULL)
         return -1;
+    detachStreamDesc();
 
     bs = gts_bs_new((const int8_t*)pParamStitchStream->pInputBitstream, pParamStitchStream->inputBitstreamLen, GTS_BITSTREAM_READ);
     // new bs
@@ -2283,6 +2709,8 @@ int32_t  TstitchStream::GenerateSPS(param_360SCVP* pParamStitchStream)
         int32_t spsCnt;
         int32_t audCnt;
         ret = hevc_import_ffextradata(&specialInfo, m_hevcState, nalsize, &spsCnt, &audCnt, 0);
+        m_sliceHdrCache.clear();
+        m_streamDesc.reset();
         if (ret < 0)
         {
             if(bs)
@@ -2351,6 +2779,247 @@ int32_t  TstitchStream::GenerateSPS(param_360SCVP* pParamStitchStream)
     return ret;
 }
 
+// byte stream nal header written by nal_write for the slice header, 4 bytes start code and 2 bytes nal header
+#define SLICEHDR_NAL_HEADER_LEN 2
+#define SLICEHDR_NAL_PREFIX_LEN 6
+
+static uint32_t sliceHdr_read_bits(const uint8_t *buf, uint32_t bitPos, uint32_t bits)
+{
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < bits; i++, bitPos++)
+        value = (value << 1) | ((buf[bitPos >> 3] >> (7 - (bitPos & 7))) & 1);
+    return value;
+}
+
+static void sliceHdr_write_bits(uint8_t *buf, uint32_t bitPos, uint32_t bits, uint32_t value)
+{
+    for (uint32_t i = 0; i < bits; i++, bitPos++)
+    {
+        uint8_t mask = (uint8_t)(1 << (7 - (bitPos & 7)));
+        if ((value >> (bits - 1 - i)) & 1)
+            buf[bitPos >> 3] |= mask;
+        else
+            buf[bitPos >> 3] &= (uint8_t)~mask;
+    }
+}
+
+// copy at most dstLen rbsp bytes of the nal payload, dropping the emulation prevention bytes
+static uint32_t sliceHdr_extract_rbsp(const uint8_t *src, uint32_t srcLen, uint8_t *dst, uint32_t dstLen)
+{
+    uint32_t zeroCount = 0;
+    uint32_t dstPos = 0;
+    for (uint32_t i = 0; i < srcLen && dstPos < dstLen; i++)
+    {
+        if (zeroCount == 2 && src[i] == 0x03)
+        {
+            zeroCount = 0;
+            continue;
+        }
+        dst[dstPos++] = src[i];
+        zeroCount = src[i] ? 0 : zeroCount + 1;
+    }
+    return dstPos;
+}
+
+// skip the start code of the byte stream nal, return NULL if there is none
+static const uint8_t* sliceHdr_skip_start_code(const uint8_t *data, uint32_t *len)
+{
+    if (!data || *len < 4)
+        return NULL;
+    if (data[0] == 0 && data[1] == 0 && data[2] == 1)
+    {
+        *len -= 3;
+        return data + 3;
+    }
+    if (data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 1)
+    {
+        *len -= 4;
+        return data + 4;
+    }
+    return NULL;
+}
+
+// slice_pic_parameter_set_id of the slice nal, -1 if it can not be read from the rbsp prefix
+static int32_t sliceHdr_get_pps_id(const uint8_t *rbsp, uint32_t rbspLen)
+{
+    uint8_t nalType = (rbsp[0] >> 1) & 0x3f;
+    uint32_t bitPos = SLICEHDR_NAL_HEADER_LEN * 8 + 1;
+    if (nalType >= GTS_HEVC_NALU_SLICE_BLA_W_LP && nalType <= GTS_HEVC_NALU_SLICE_CRA)
+        bitPos++;
+    uint32_t leadingZeros = 0;
+    while (bitPos < rbspLen * 8 && !sliceHdr_read_bits(rbsp, bitPos, 1))
+    {
+        leadingZeros++;
+        bitPos++;
+    }
+    if (leadingZeros > 6 || bitPos + 1 + leadingZeros > rbspLen * 8)
+        return -1;
+    bitPos++;
+    return (int32_t)((1 << leadingZeros) - 1 + sliceHdr_read_bits(rbsp, bitPos, leadingZeros));
+}
+
+int32_t TstitchStream::generateSliceHdrByTemplate(param_360SCVP* pParam360SCVP, int32_t newSliceAddr)
+{
+    if (m_sliceHdrCache.empty() || !pParam360SCVP->pOutputBitstream)
+        return -1;
+
+    uint32_t nalLen = pParam360SCVP->inputBitstreamLen;
+    const uint8_t *pNal = sliceHdr_skip_start_code(pParam360SCVP->pInputBitstream, &nalLen);
+    if (!pNal)
+        return -1;
+
+    uint8_t prefix[16];
+    uint32_t prefixLen = sliceHdr_extract_rbsp(pNal, nalLen, prefix, sizeof(prefix));
+    if (prefixLen <= SLICEHDR_NAL_HEADER_LEN)
+        return -1;
+    int32_t ppsId = sliceHdr_get_pps_id(prefix, prefixLen);
+    if (ppsId < 0 || ppsId >= 64)
+        return -1;
+
+    SliceHdrKey key;
+    key.ppsId = ppsId;
+    key.spsId = m_hevcState->pps[ppsId].sps_id;
+    key.destWidth = pParam360SCVP->destWidth;
+    key.destHeight = pParam360SCVP->destHeight;
+    key.sliceAddr = newSliceAddr;
+    std::map<SliceHdrKey, std::vector<SliceHdrTemplate> >::iterator it = m_sliceHdrCache.find(key);
+    if (it == m_sliceHdrCache.end())
+        return -1;
+
+    // the source header must match one variant except for the poc lsb
+    SliceHdrTemplate *pTmpl = NULL;
+    uint32_t poc = 0;
+    for (size_t i = 0; i < it->second.size() && !pTmpl; i++)
+    {
+        SliceHdrTemplate &tmpl = it->second[i];
+        uint32_t srcLen = (uint32_t)tmpl.srcHeader.size();
+        if (srcLen > m_sliceHdrScratch.size())
+            m_sliceHdrScratch.resize(srcLen);
+        uint8_t *scratch = m_sliceHdrScratch.data();
+        if (sliceHdr_extract_rbsp(pNal, nalLen, scratch, srcLen) != srcLen)
+            continue;
+        poc = 0;
+        if (tmpl.srcPocStart >= 0)
+        {
+            poc = sliceHdr_read_bits(scratch, tmpl.srcPocStart, tmpl.srcPocBits);
+            sliceHdr_write_bits(scratch, tmpl.srcPocStart, tmpl.srcPocBits, 0);
+        }
+        if (!memcmp(scratch, tmpl.srcHeader.data(), srcLen))
+            pTmpl = &tmpl;
+    }
+    if (!pTmpl)
+        return -1;
+    SliceHdrTemplate &tmpl = *pTmpl;
+    uint32_t dstLen = (uint32_t)tmpl.dstHeader.size();
+    if (dstLen > m_sliceHdrScratch.size())
+        m_sliceHdrScratch.resize(dstLen);
+    uint8_t *scratch = m_sliceHdrScratch.data();
+
+    GTS_BitStream *bsWrite = gts_bs_new((const int8_t *)pParam360SCVP->pOutputBitstream, 2 * pParam360SCVP->inputBitstreamLen, GTS_BITSTREAM_WRITE);
+    if (!bsWrite)
+        return -1;
+
+    memcpy_s(scratch, dstLen, tmpl.dstHeader.data(), dstLen);
+    if (tmpl.dstPocStart >= 0)
+        sliceHdr_write_bits(scratch, tmpl.dstPocStart, tmpl.dstPocBits, poc & ((1 << tmpl.dstPocBits) - 1));
+
+    nal_write(bsWrite, (prefix[0] >> 1) & 0x3f, (prefix[1] & 7) - 1, 1);
+    for (uint32_t i = 0; i < dstLen; i++)
+        gts_bs_write_int(bsWrite, scratch[i], 8);
+
+    pParam360SCVP->outputBitstreamLen = gts_bs_get_position(bsWrite);
+    gts_bs_del(bsWrite);
+    return 0;
+}
+
+void TstitchStream::addSliceHdrTemplate(param_360SCVP* pParam360SCVP, int32_t newSliceAddr)
+{
+    HEVCSliceInfo *si = &(m_hevcState->s_info);
+    if (!si->sps || si->payload_start_offset <= SLICEHDR_NAL_HEADER_LEN || si->index_hevc_pps >= 64)
+        return;
+    if (pParam360SCVP->outputBitstreamLen <= SLICEHDR_NAL_PREFIX_LEN)
+        return;
+
+    uint32_t nalLen = pParam360SCVP->inputBitstreamLen;
+    const uint8_t *pNal = sliceHdr_skip_start_code(pParam360SCVP->pInputBitstream, &nalLen);
+    if (!pNal)
+        return;
+
+    SliceHdrTemplate tmpl;
+    tmpl.srcHeader.resize(si->payload_start_offset);
+    if (sliceHdr_extract_rbsp(pNal, nalLen, tmpl.srcHeader.data(), si->payload_start_offset) != (uint32_t)si->payload_start_offset)
+        return;
+    uint32_t outLen = pParam360SCVP->outputBitstreamLen - SLICEHDR_NAL_PREFIX_LEN;
+    tmpl.dstHeader.resize(outLen);
+    tmpl.dstHeader.resize(sliceHdr_extract_rbsp(pParam360SCVP->pOutputBitstream + SLICEHDR_NAL_PREFIX_LEN, outLen, tmpl.dstHeader.data(), outLen));
+
+    tmpl.srcPocStart = -1;
+    tmpl.dstPocStart = -1;
+    tmpl.srcPocBits = 0;
+    tmpl.dstPocBits = 0;
+    if (si->poc_lsb_start_bits >= 0)
+    {
+        tmpl.srcPocStart = si->poc_lsb_start_bits;
+        tmpl.srcPocBits = si->sps->log2_max_pic_order_cnt_lsb;
+        tmpl.dstPocBits = m_hevcState->sps[m_hevcState->last_parsed_sps_id].log2_max_pic_order_cnt_lsb;
+        if (!tmpl.srcPocBits || !tmpl.dstPocBits || tmpl.srcPocBits > 16 || tmpl.dstPocBits > 16
+            || (uint32_t)tmpl.srcPocStart + tmpl.srcPocBits > tmpl.srcHeader.size() * 8
+            || sliceHdr_read_bits(tmpl.srcHeader.data(), tmpl.srcPocStart, tmpl.srcPocBits) != si->poc_lsb)
+            return;
+
+        // locate the poc lsb in the generated header by writing it again with the lowest bit flipped
+        std::vector<uint8_t> probe(pParam360SCVP->outputBitstreamLen + 16);
+        GTS_BitStream *bs = gts_bs_new((const int8_t *)probe.data(), probe.size(), GTS_BITSTREAM_WRITE);
+        if (!bs)
+            return;
+        si->poc_lsb ^= 1;
+        hevc_write_slice_header(bs, m_hevcState);
+        si->poc_lsb ^= 1;
+        uint32_t probeLen = (uint32_t)gts_bs_get_position(bs);
+        gts_bs_del(bs);
+        if (probeLen <= SLICEHDR_NAL_PREFIX_LEN)
+            return;
+        std::vector<uint8_t> probeRbsp(probeLen - SLICEHDR_NAL_PREFIX_LEN);
+        probeRbsp.resize(sliceHdr_extract_rbsp(probe.data() + SLICEHDR_NAL_PREFIX_LEN, probeLen - SLICEHDR_NAL_PREFIX_LEN, probeRbsp.data(), probeRbsp.size()));
+        if (probeRbsp.size() != tmpl.dstHeader.size())
+            return;
+        int32_t diffBit = -1;
+        for (uint32_t i = 0; i < probeRbsp.size() && diffBit < 0; i++)
+        {
+            uint8_t diff = probeRbsp[i] ^ tmpl.dstHeader[i];
+            if (diff)
+            {
+                diffBit = i * 8;
+                while (!(diff & 0x80))
+                {
+                    diff <<= 1;
+                    diffBit++;
+                }
+            }
+        }
+        tmpl.dstPocStart = diffBit - (int32_t)(tmpl.dstPocBits - 1);
+        if (diffBit < 0 || tmpl.dstPocStart < 0
+            || sliceHdr_read_bits(tmpl.dstHeader.data(), tmpl.dstPocStart, tmpl.dstPocBits) != (si->poc_lsb & ((1u << tmpl.dstPocBits) - 1)))
+            return;
+
+        sliceHdr_write_bits(tmpl.srcHeader.data(), tmpl.srcPocStart, tmpl.srcPocBits, 0);
+        sliceHdr_write_bits(tmpl.dstHeader.data(), tmpl.dstPocStart, tmpl.dstPocBits, 0);
+    }
+
+    SliceHdrKey key;
+    key.ppsId = si->index_hevc_pps;
+    key.spsId = m_hevcState->pps[si->index_hevc_pps].sps_id;
+    key.destWidth = pParam360SCVP->destWidth;
+    key.destHeight = pParam360SCVP->destHeight;
+    key.sliceAddr = newSliceAddr;
+    if (m_sliceHdrCache.size() >= MAX_SLICEHDR_TEMPLATE_NUM && !m_sliceHdrCache.count(key))
+        m_sliceHdrCache.clear();
+    std::vector<SliceHdrTemplate> &variants = m_sliceHdrCache[key];
+    if (variants.size() >= MAX_SLICEHDR_TEMPLATE_VARIANTS)
+        variants.erase(variants.begin());
+    variants.push_back(tmpl);
+}
+
 int32_t  TstitchStream::GenerateSliceHdr(param_360SCVP* pParam360SCVP, int32_t newSliceAddr)
 {
     int32_t ret = -1;
@@ -2361,6 +3030,12 @@ int32_t  TstitchStream::GenerateSliceHdr(param_360SCVP* pParam360SCVP, int32_t n
     uint32_t origSliceSegAddr;
     if (!pParam360SCVP)
         return -1;
+    detachStreamDesc();
+
+    // the tile layout is normally stable, so only the poc of the
+    // slice header needs to be patched into the last generated one
+    if (generateSliceHdrByTemplate(pParam360SCVP, newSliceAddr) == 0)
+        return 0;
 
     // new bs
     bsWrite = gts_bs_new((const int8_t *)pParam360SCVP->pOutputBitstream, 2 * pParam360SCVP->inputBitstreamLen, GTS_BITSTREAM_WRITE);
@@ -2406,12 +3081,20 @@ int32_t  TstitchStream::GenerateSliceHdr(param_360SCVP* pParam360SCVP, int32_t n
 
         // write the new sliceheader
         hevc_write_slice_header(bsWrite, hevcTmp);
+        pParam360SCVP->outputBitstreamLen = gts_bs_get_position(bsWrite);
+        if (nalsize[VID_PARAM_SET] || nalsize[SEQ_PARAM_SET] || nalsize[PIC_PARAM_SET])
+        {
+            m_sliceHdrCache.clear();
+            m_streamDesc.reset();
+        }
+        else
+            addSliceHdrTemplate(pParam360SCVP, newSliceAddr);
+
         m_hevcState->sps[0].width = origWidth;
         m_hevcState->sps[0].height = origHeight;
         m_hevcState->s_info.first_slice_segment_in_pic_flag = origFirstSliceFlag;
         m_hevcState->s_info.slice_segment_address = origSliceSegAddr;
 
-        pParam360SCVP->outputBitstreamLen = gts_bs_get_position(bsWrite);
         gts_bs_del(bsWrite);
         ret = 0;
     }
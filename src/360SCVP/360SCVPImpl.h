@@ -29,8 +29,18 @@
 #include "../utils/data_type.h"
 #include "TileSelectionPlugins_API.h"
 #include "360SCVPViewportImpl.h"
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #define MAX_TILE_NUM 1000
+#define MAX_SLICEHDR_TEMPLATE_NUM 1024
+#define MAX_SLICEHDR_TEMPLATE_VARIANTS 16
+#define MAX_BATCH_WORKER_NUM 8
+#define MIN_BATCH_POSES_PER_WORKER 4  //a pose takes microseconds with the tile lookup table, fewer poses don't pay waking a worker
 //!
 //! \struct: MapFaceInfo
 //! \brief:  define the information of one face from input
@@ -45,6 +55,80 @@ typedef struct MapFaceInfo
     E_TransformType transformType; //face transform type
 }MapFaceInfo;
 
+//!
+//! \struct: SliceHdrKey
+//! \brief:  key of one slice header template, the parameter sets of the
+//!          source slice, the destination picture size and the new CTU address
+//!
+typedef struct SliceHdrKey
+{
+    int32_t  ppsId;
+    int32_t  spsId;
+    uint32_t destWidth;
+    uint32_t destHeight;
+    int32_t  sliceAddr;
+
+    bool operator<(const SliceHdrKey& other) const
+    {
+        if (ppsId != other.ppsId) return ppsId < other.ppsId;
+        if (spsId != other.spsId) return spsId < other.spsId;
+        if (destWidth != other.destWidth) return destWidth < other.destWidth;
+        if (destHeight != other.destHeight) return destHeight < other.destHeight;
+        return sliceAddr < other.sliceAddr;
+    }
+}SliceHdrKey;
+
+//!
+//! \struct: SliceHdrTemplate
+//! \brief:  pre-encoded slice header generated by GenerateSliceHdr. A source
+//!          slice whose header only differs in pic_order_cnt_lsb reuses the
+//!          destination bits with the new value patched in. One key keeps a
+//!          few variants since nal type and rps follow the position in the GOP
+//!
+typedef struct SliceHdrTemplate
+{
+    std::vector<uint8_t> srcHeader;   //rbsp of the source nal header and slice header, poc lsb cleared
+    std::vector<uint8_t> dstHeader;   //rbsp of the generated slice header after the nal header, poc lsb cleared
+    int32_t              srcPocStart; //bit offset of pic_order_cnt_lsb in srcHeader, -1 if not present
+    int32_t              dstPocStart; //bit offset of pic_order_cnt_lsb in dstHeader, -1 if not present
+    uint32_t             srcPocBits;
+    uint32_t             dstPocBits;
+}SliceHdrTemplate;
+
+//!
+//! \struct: StreamDesc
+//! \brief:  immutable description of the parsed stream, the parameter sets,
+//!          the tile grid and the face mapping. It is a snapshot of one handle
+//!          shared by all the sessions created from it, a session copies it
+//!          into its own memory before changing any of them
+//!
+typedef struct StreamDesc
+{
+    HEVCState    hevcState;
+    ITileInfo    tilesInfo[MAX_TILE_NUM];
+    MapFaceInfo  mapFaceInfo[6];
+}StreamDesc;
+
+//!
+//! \struct: BatchJob
+//! \brief:  the poses of one getTilesInViewportBatch call, which the
+//!          batch workers take one by one
+//!
+typedef struct BatchJob
+{
+    HeadPose*             pPoses;
+    uint32_t              poseNum;
+    TileDef*              pOutTiles;
+    uint32_t              maxTileNum;
+    int32_t*              pTileNums;
+    Param_ViewportOutput* pOutputs;
+    CCDef*                pOutCCs;
+    uint32_t              workerNum;        //the sessions taking part in the batch, session 0 is the caller
+    uint32_t              nextPose;
+    uint32_t              unfinishedPoses;
+    bool                  quit;             //the batch workers exit
+}BatchJob;
+
 class TstitchStream
 {
 protected:
@@ -98,6 +182,20 @@ protected:
     int32_t         m_hrTilesInCol;
     RegionWisePacking     m_dstRwpk;
     TileSelection  *m_pTileSelection;
+    MergeSpan      *m_pSpans;         //span list of the current frame, only set in doStreamStitch with spans
+    uint32_t        m_spanNum;
+    uint32_t        m_maxSpanNum;
+    std::map<SliceHdrKey, std::vector<SliceHdrTemplate> > m_sliceHdrCache; //templates of GenerateSliceHdr, cleared when parameter sets change
+    std::vector<uint8_t> m_sliceHdrScratch;
+    std::shared_ptr<const StreamDesc> m_streamDesc; //snapshot for the sessions, dropped when parameter sets change
+    bool            m_bSharedDesc;    //m_hevcState, m_tilesInfo and m_mapFaceInfo point into m_streamDesc
+    std::mutex      m_streamDescMutex;
+    std::vector<TstitchStream*> m_batchSessions; //worker sessions of getTilesInViewportBatch, created on first use
+    std::vector<std::thread> m_batchWorkers;     //threads of m_batchSessions[1..], kept with the sessions
+    std::mutex      m_batchMutex;
+    std::condition_variable m_batchCv;           //notifies the batch workers of new poses
+    std::condition_variable m_batchDoneCv;       //notifies the caller that all the poses are done
+    BatchJob        m_batchJob;                  //guarded by m_batchMutex
 
 public:
     uint16_t        m_nalType;
@@ -116,6 +214,7 @@ public:
 
     TstitchStream();
     TstitchStream(TstitchStream& other);
+    TstitchStream(const TstitchStream& parent, const std::shared_ptr<const StreamDesc>& desc);
     TstitchStream& operator=(const TstitchStream& other);
     virtual ~TstitchStream();
     int32_t  init(param_360SCVP* pParamStitchStream);
@@ -123,9 +222,10 @@ public:
     int32_t  getViewPortTiles();
     int32_t  feedParamToGenStream(param_360SCVP* pParamStitchStream);
     int32_t  setViewPort(HeadPose *pose);
-    int32_t  doMerge(param_360SCVP* pParamStitchStream);
+    int32_t  doMerge(param_360SCVP* pParamStitchStream, MergeSpan* pSpans = NULL, uint32_t* pSpanNum = NULL);
     int32_t  getFixedNumTiles(TileDef* pOutTile);
     int32_t  getTilesInViewport(TileDef* pOutTile);
+    int32_t  getTilesInViewportBatch(HeadPose* pPoses, uint32_t poseNum, TileDef* pOutTiles, uint32_t maxTileNum, int32_t* pTileNums, Param_ViewportOutput* pOutputs, CCDef* pOutCCs);
     int32_t  parseNals(param_360SCVP* pParamStitchStream, int32_t parseType, Nalu* pNALU, int32_t streamIdx);
     int32_t  GenerateRWPK(RegionWisePacking* pRWPK, uint8_t *pRWPKBits, int32_t* pRWPKBitsSize);
     int32_t  GenerateNovelViewSEI(NovelViewSEI* pNVSEI, uint8_t* pNVBits, uint32_t* NVBitsSize);
@@ -137,13 +237,15 @@ public:
     int32_t  getBSHeader(Param_BSHeader * bsHeader);
     int32_t  getRWPKInfo(RegionWisePacking *pRWPK);
     int32_t  setViewPortInfo(Param_ViewPortInfo* pViewPortInfo);
+    int32_t  setTileLUT(Param_TileLUT* pTileLUT);
+    int32_t  setViewportSolver(int32_t solver);
     int32_t  setSEIProjInfo(int32_t projType);
     int32_t  setSEIRWPKInfo(RegionWisePacking* pRWPK);
     int32_t  setSphereRot(SphereRotation* pSphereRot);
     int32_t  setFramePacking(FramePacking* pFramePacking);
     int32_t  setViewportSEI(OMNIViewPort* pSeiViewport);
     int32_t  setSEINovelView(NovelViewSEI* pNovelView);
-    int32_t  doStreamStitch(param_360SCVP* pParamStitchStream);
+    int32_t  doStreamStitch(param_360SCVP* pParamStitchStream, MergeSpan* pSpans = NULL, uint32_t* pSpanNum = NULL);
     int32_t  merge_one_tile(uint8_t **pBitstream, oneStream_info* pSlice, GTS_BitStream *bs, bool bFirstTile);
     int32_t  GenerateRwpkInfo(RegionWisePacking *dstRwpk);
     int32_t  EncRWPKSEI(RegionWisePacking* pRWPK, uint8_t *pRWPKBits, uint32_t* pRWPKBitsSize);
@@ -158,6 +260,7 @@ public:
     TileDef* getSelectedTile();
     int32_t  getTilesByLegacyWay(TileDef* pOutTile);
     int32_t  SetLogCallBack(LogFunction logFunction);
+    TstitchStream* newSession();
 
 protected:
     int32_t initMerge(param_360SCVP* pParamStitchStream, int32_t sliceSize);
@@ -165,6 +268,15 @@ protected:
     int32_t merge_partstream_into1bitstream(int32_t totalInputLen);
     int32_t ConvertTilesIdx(uint16_t tilesNum);
     int32_t initTileInfo(param_360SCVP* pParamStitchStream);
+    int32_t generateSliceHdrByTemplate(param_360SCVP* pParam360SCVP, int32_t newSliceAddr);
+    void    addSliceHdrTemplate(param_360SCVP* pParam360SCVP, int32_t newSliceAddr);
+    void    detachStreamDesc();
+    void    releaseStreamDesc();
+    int32_t getTilesForPose(HeadPose* pPose, TileDef* pTmpTiles, TileDef* pOutTile, uint32_t maxTileNum, Param_ViewportOutput* pOutput, CCDef* pOutCC);
+    void    runBatchPoses(uint32_t sessionIdx, std::unique_lock<std::mutex>& lock);
+    int32_t countFailedPoses(int32_t* pTileNums, uint32_t poseNum);
+    void    batchWorkerLoop(uint32_t sessionIdx);
+    void    releaseBatchSessions();
 
 private:
     void* m_pluginLibHdl;
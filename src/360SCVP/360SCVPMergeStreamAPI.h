@@ -57,6 +57,9 @@ typedef struct PARAM_MERGEBITSTREAM
     uint8_t               *pOutputBitstream;       //!< pointer to output bitstream
     uint32_t               outputiledbistreamlen;  //!< length of output bitstream
     bool                   bWroteHeader;           //!< flag for whether Headers need to be wrote
+    MergeSpan             *pSpans;                 //!< spans of the merged stream, NULL to copy all into pOutputBitstream
+    uint32_t               maxSpanNum;             //!< size of pSpans
+    uint32_t               spanNum;                //!< number of spans of the merged stream
 }param_mergeStream;
 
 //!
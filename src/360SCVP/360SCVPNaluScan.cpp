@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <atomic>
+#include "360SCVPNaluScan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GTS_SCAN_X86
+#include <immintrin.h>
+#endif
+
+//-1 means not detected yet
+static std::atomic<int32_t> g_scanLevel(-1);
+
+static uint64_t FindZeroPairScalar(const uint8_t *buffer, uint64_t from, uint64_t size)
+{
+    for (uint64_t i = from; i + 1 < size; i++)
+    {
+        if (!buffer[i] && !buffer[i + 1])
+            return i;
+    }
+    return size;
+}
+
+static uint64_t FindStartCodeScalar(const uint8_t *buffer, uint64_t from, uint64_t size)
+{
+    for (uint64_t i = from; i + 2 < size; i++)
+    {
+        if (!buffer[i] && !buffer[i + 1] && buffer[i + 2] == 0x01)
+            return i;
+    }
+    return size;
+}
+
+#ifdef GTS_SCAN_X86
+__attribute__((target("sse2")))
+static uint64_t FindZeroPairSSE2(const uint8_t *buffer, uint64_t from, uint64_t size)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t i = from;
+    for (; i + 17 <= size; i += 16)
+    {
+        __m128i cur  = _mm_loadu_si128((const __m128i *)(buffer + i));
+        __m128i next = _mm_loadu_si128((const __m128i *)(buffer + i + 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(cur, zero), _mm_cmpeq_epi8(next, zero)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return FindZeroPairScalar(buffer, i, size);
+}
+
+__attribute__((target("sse2")))
+static uint64_t FindStartCodeSSE2(const uint8_t *buffer, uint64_t from, uint64_t size)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi8(1);
+    uint64_t i = from;
+    for (; i + 18 <= size; i += 16)
+    {
+        __m128i b0 = _mm_loadu_si128((const __m128i *)(buffer + i));
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(buffer + i + 1));
+        __m128i b2 = _mm_loadu_si128((const __m128i *)(buffer + i + 2));
+        __m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+                                      _mm_cmpeq_epi8(b2, one));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(match);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return FindStartCodeScalar(buffer, i, size);
+}
+
+__attribute__((target("avx2")))
+static uint64_t FindZeroPairAVX2(const uint8_t *buffer, uint64_t from, uint64_t size)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    uint64_t i = from;
+    for (; i + 33 <= size; i += 32)
+    {
+        __m256i cur  = _mm256_loadu_si256((const __m256i *)(buffer + i));
+        __m256i next = _mm256_loadu_si256((const __m256i *)(buffer + i + 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(cur, zero), _mm256_cmpeq_epi8(next, zero)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return FindZeroPairSSE2(buffer, i, size);
+}
+
+__attribute__((target("avx2")))
+static uint64_t FindStartCodeAVX2(const uint8_t *buffer, uint64_t from, uint64_t size)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one  = _mm256_set1_epi8(1);
+    uint64_t i = from;
+    for (; i + 34 <= size; i += 32)
+    {
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)(buffer + i));
+        __m256i b1 = _mm256_loadu_si256((const __m256i *)(buffer + i + 1));
+        __m256i b2 = _mm256_loadu_si256((const __m256i *)(buffer + i + 2));
+        __m256i match = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)),
+                                         _mm256_cmpeq_epi8(b2, one));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(match);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return FindStartCodeSSE2(buffer, i, size);
+}
+#endif
+
+GTS_ScanLevel gts_nalu_scan_detect_level()
+{
+#ifdef GTS_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return GTS_SCAN_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return GTS_SCAN_SSE2;
+#endif
+    return GTS_SCAN_SCALAR;
+}
+
+GTS_ScanLevel gts_nalu_scan_get_level()
+{
+    int32_t level = g_scanLevel.load(std::memory_order_relaxed);
+    if (level < 0)
+    {
+        level = gts_nalu_scan_detect_level();
+        g_scanLevel.store(level, std::memory_order_relaxed);
+    }
+    return (GTS_ScanLevel)level;
+}
+
+void gts_nalu_scan_set_level(GTS_ScanLevel level)
+{
+    GTS_ScanLevel detected = gts_nalu_scan_detect_level();
+    if (level > detected)
+        level = detected;
+    g_scanLevel.store(level, std::memory_order_relaxed);
+}
+
+uint64_t gts_nalu_find_zero_pair(const uint8_t *buffer, uint64_t from, uint64_t size)
+{
+    if (!buffer || from >= size)
+        return size;
+
+    switch (gts_nalu_scan_get_level())
+    {
+#ifdef GTS_SCAN_X86
+    case GTS_SCAN_AVX2:
+        return FindZeroPairAVX2(buffer, from, size);
+    case GTS_SCAN_SSE2:
+        return FindZeroPairSSE2(buffer, from, size);
+#endif
+    default:
+        return FindZeroPairScalar(buffer, from, size);
+    }
+}
+
+uint64_t gts_nalu_find_start_code(const uint8_t *buffer, uint64_t from, uint64_t size)
+{
+    if (!buffer || from >= size)
+        return size;
+
+    switch (gts_nalu_scan_get_level())
+    {
+#ifdef GTS_SCAN_X86
+    case GTS_SCAN_AVX2:
+        return FindStartCodeAVX2(buffer, from, size);
+    case GTS_SCAN_SSE2:
+        return FindStartCodeSSE2(buffer, from, size);
+#endif
+    default:
+        return FindStartCodeScalar(buffer, from, size);
+    }
+}
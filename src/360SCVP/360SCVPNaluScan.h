@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _360SCVP_NALU_SCAN_H_
+#define _360SCVP_NALU_SCAN_H_
+
+#include "stdint.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ *    instruction set used by the NAL unit byte scanning kernels
+ */
+typedef enum
+{
+    GTS_SCAN_SCALAR = 0,
+    GTS_SCAN_SSE2,
+    GTS_SCAN_AVX2,
+} GTS_ScanLevel;
+
+/*!
+ *    \brief Returns the best scanning level supported by the running CPU
+ *
+ *    \return GTS_ScanLevel the detected level
+ */
+GTS_ScanLevel gts_nalu_scan_detect_level();
+
+/*!
+ *    \brief Returns the scanning level currently in use
+ *
+ *    \return GTS_ScanLevel the level in use, detected at first call unless forced
+ */
+GTS_ScanLevel gts_nalu_scan_get_level();
+
+/*!
+ *    \brief Forces the scanning level, mainly for testing and benchmarking.
+ *           Levels not supported by the running CPU are lowered to the detected one.
+ *
+ *    \param GTS_ScanLevel level  input the level to use
+ */
+void gts_nalu_scan_set_level(GTS_ScanLevel level);
+
+/*!
+ *    \brief Locates the first two consecutive zero bytes in a buffer
+ *
+ *    \param const uint8_t *buffer  input the buffer to scan
+ *    \param uint64_t       from    input the offset to start scanning from
+ *    \param uint64_t       size    input the size of the buffer
+ *
+ *    \return uint64_t the offset i >= from where buffer[i] and buffer[i+1] are zero, size if not found
+ */
+uint64_t gts_nalu_find_zero_pair(const uint8_t *buffer, uint64_t from, uint64_t size);
+
+/*!
+ *    \brief Locates the first 0x000001 start code prefix in a buffer
+ *
+ *    \param const uint8_t *buffer  input the buffer to scan
+ *    \param uint64_t       from    input the offset to start scanning from
+ *    \param uint64_t       size    input the size of the buffer
+ *
+ *    \return uint64_t the offset i >= from of the first byte of the prefix, size if not found
+ */
+uint64_t gts_nalu_find_start_code(const uint8_t *buffer, uint64_t from, uint64_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif        /*_360SCVP_NALU_SCAN_H_*/
@@ -115,3 +115,142 @@ void ViewPort::map3DTo2D(SPos *,SPos *)
     assert(0 && "Viewport 3D to 2D is not supported ");
 }
 
+
+void ViewPort::erpBoundaryMapping(Geometry *pGeoSrc)
+{
+    assert(!m_bGeometryMapping);
+    assert(pGeoSrc->getType() == SVIDEO_EQUIRECT);
+    int32_t iWidth = m_sVideoInfo.iFaceWidth;
+    int32_t iHeight = m_sVideoInfo.iFaceHeight;
+    if (iWidth < 2 || iHeight < 2)
+        return;
+    setRotMat();
+    setInvK();
+
+    int32_t iSrcWidth = pGeoSrc->getFaceWidth();
+    int32_t iSrcHeight = pGeoSrc->getFaceHeight();
+    int32_t *pRot = m_sVideoInfo.sVideoRotation.degree;
+    int32_t numPoints = 2 * (iWidth + iHeight) - 4;
+
+    // walk the viewport border clockwise and back to the first point; longitude and
+    // lattitude have no extremum inside a region which does not contain a pole, so
+    // the border gives the footprint. The longitude is unwrapped along the border,
+    // and the lattitude range is kept per band left of, inside and right of [0, width)
+    POSType xFirst = 0, xPrev = 0, xUnwrap = 0;
+    POSType xMin = 0, xMax = 0;
+    int32_t yPrev = 0;
+    int32_t bandPrev = 1;
+    int32_t yMin[3] = { iSrcHeight, iSrcHeight, iSrcHeight };
+    int32_t yMax[3] = { -1, -1, -1 };
+    for (int32_t n = 0; n <= numPoints; n++)
+    {
+        int32_t k = n % numPoints;
+        int32_t i, j;
+        if (k < iWidth)
+        {
+            i = k; j = 0;
+        }
+        else if (k < iWidth + iHeight - 1)
+        {
+            i = iWidth - 1; j = k - iWidth + 1;
+        }
+        else if (k < 2 * iWidth + iHeight - 2)
+        {
+            i = 2 * iWidth + iHeight - 3 - k; j = iHeight - 1;
+        }
+        else
+        {
+            i = 0; j = numPoints - k;
+        }
+        SPos in(0, (POSType)i, (POSType)j, 0), pos3D;
+        map2DTo3D(in, &pos3D);
+        rotate3D(pos3D, pRot[0], pRot[1], pRot[2]);
+        pGeoSrc->map3DTo2D(&pos3D, &pos3D);
+
+        if (n == 0)
+        {
+            xFirst = xUnwrap = xMin = xMax = pos3D.x;
+        }
+        else
+        {
+            // keep the border continuous across the 0/360 seam
+            POSType delta = pos3D.x - xPrev;
+            if (delta > iSrcWidth / 2)
+                delta -= iSrcWidth;
+            else if (delta < -iSrcWidth / 2)
+                delta += iSrcWidth;
+            xUnwrap += delta;
+        }
+        xPrev = pos3D.x;
+        if (xMin > xUnwrap)
+            xMin = xUnwrap;
+        if (xMax < xUnwrap)
+            xMax = xUnwrap;
+
+        int32_t yTmp = (int32_t)pos3D.y;
+        int32_t band = (xUnwrap < -0.5) ? 0 : ((xUnwrap < iSrcWidth - 0.5) ? 1 : 2);
+        if (yMin[band] > yTmp)
+            yMin[band] = yTmp;
+        if (yMax[band] < yTmp)
+            yMax[band] = yTmp;
+        // the seam closes both parts between the two points crossing it
+        if (n && band != bandPrev)
+        {
+            yMin[band] = yMin[band] < yPrev ? yMin[band] : yPrev;
+            yMax[band] = yMax[band] > yPrev ? yMax[band] : yPrev;
+            yMin[bandPrev] = yMin[bandPrev] < yTmp ? yMin[bandPrev] : yTmp;
+            yMax[bandPrev] = yMax[bandPrev] > yTmp ? yMax[bandPrev] : yTmp;
+        }
+        yPrev = yTmp;
+        bandPrev = band;
+    }
+
+    SPos *pUpLeft = m_upLeft;
+    SPos *pDownRight = m_downRight;
+    pUpLeft[0].faceIdx = pDownRight[0].faceIdx = 0;
+    if (sfabs(xUnwrap - xFirst) > iSrcWidth / 2 || xMax - xMin >= iSrcWidth - 1)
+    {
+        // the border winds around a pole, which is inside the viewport
+        SPos in(0, (POSType)(iWidth / 2), (POSType)(iHeight / 2), 0), center;
+        map2DTo3D(in, &center);
+        rotate3D(center, pRot[0], pRot[1], pRot[2]);
+        int32_t yMinAll = yMin[0] < yMin[1] ? yMin[0] : yMin[1];
+        int32_t yMaxAll = yMax[0] > yMax[1] ? yMax[0] : yMax[1];
+        yMinAll = yMinAll < yMin[2] ? yMinAll : yMin[2];
+        yMaxAll = yMaxAll > yMax[2] ? yMaxAll : yMax[2];
+        pUpLeft[0].x = 0;
+        pUpLeft[0].y = (center.y > 0) ? 0 : yMinAll;
+        pDownRight[0].x = iSrcWidth - 1;
+        pDownRight[0].y = (center.y > 0) ? yMaxAll : iSrcHeight - 1;
+    }
+    else if (xMin >= -0.5 && xMax < iSrcWidth - 0.5)
+    {
+        pUpLeft[0].x = (int32_t)xMin;
+        pUpLeft[0].y = yMin[1];
+        pDownRight[0].x = (int32_t)xMax;
+        pDownRight[0].y = yMax[1];
+    }
+    else
+    {
+        // split at the seam like the pixel sweep: the part left of the seam in the
+        // viewport goes to the first face, the rest to the second one
+        int32_t bandLeft = (xMin < -0.5) ? 0 : 1;
+        pUpLeft[0].x = (int32_t)((xMin < -0.5) ? xMin + iSrcWidth : xMin);
+        pUpLeft[0].y = yMin[bandLeft];
+        pDownRight[0].x = iSrcWidth - 1;
+        pDownRight[0].y = yMax[bandLeft];
+        pUpLeft[1].faceIdx = pDownRight[1].faceIdx = 0;
+        pUpLeft[1].x = 0;
+        pUpLeft[1].y = yMin[bandLeft + 1];
+        pDownRight[1].x = (int32_t)((xMin < -0.5) ? xMax : xMax - iSrcWidth);
+        pDownRight[1].y = yMax[bandLeft + 1];
+    }
+
+    m_numFaces = 0;
+    for (int32_t i = 0; i < FACE_NUMBER; i++)
+    {
+        if (m_upLeft[i].faceIdx >= 0)
+            m_numFaces++;
+    }
+    m_bGeometryMapping = true;
+}
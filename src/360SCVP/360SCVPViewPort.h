@@ -39,6 +39,8 @@
 #define RAD2DEG_FACTOR (PI_IN_DEGREE/S_PI)
 #define HORZ_BOUNDING_STEP 5
 #define VERT_BOUNDING_STEP 5
+// center point, boundary points of the widest viewport and two face crossing points per boundary point
+#define CUBEMAP_MAX_REF_POINTS (1 + 3 * (2 * (ERP_VERT_ANGLE / HORZ_BOUNDING_STEP + 1) + 2 * (ERP_HORZ_ANGLE / VERT_BOUNDING_STEP + 1)))
 
 // ====================================================================================================================
 // Class definition
@@ -60,6 +62,8 @@ public:
     void setRotMat();
     void setInvK();
     void matInv(POSType[3][3]);
+    //analytic footprint on an ERP source from the viewport border, instead of geometryMapping
+    void erpBoundaryMapping(Geometry *pGeoSrc);
 };
 
 #endif // __T360SCVP_GEOMETRY__
@@ -62,6 +62,8 @@ typedef struct POINTDEF
 //! \param    m_pDownRight,          output,   the list of the down right point for each face in the input according to the view port information
 //! \param    viewportDestWidth,     output,    the destination width of the viewport
 //! \param    viewportDestHeight,    output,    the destination height of the viewport
+//! \param    m_tileLUT,             input,    the pose-to-tile lookup table configuration, disabled if memoryBudget is 0
+//! \param    m_viewportSolver,      input,    the way to compute m_pUpLeft/m_pDownRight, refer to ViewportSolver
 typedef struct GENERATE_VIEWPORT_PARAM
 {
     int32_t m_iViewportWidth;
@@ -83,6 +85,8 @@ typedef struct GENERATE_VIEWPORT_PARAM
     int32_t m_viewportDestHeight;
     UsageType m_usageType;
     Param_VideoFPStruct m_paramVideoFP;
+    Param_TileLUT m_tileLUT;
+    ViewportSolver m_viewportSolver;
 } generateViewPortParam;
 
 //!
@@ -120,6 +124,47 @@ int32_t   genViewport_process(generateViewPortParam* pParamGenViewport, void* pG
 //!
 int32_t   genViewport_postprocess(generateViewPortParam* pParamGenViewport, void* pGenHandle);
 
+//!
+//! \brief    This function builds the pose-to-tile lookup table according to m_tileLUT, or releases it
+//!           when m_tileLUT.memoryBudget is 0. genViewport_postprocess then takes the tile selection
+//!           from the table instead of computing the viewport boundary for every pose.
+//!
+//! \param    generateViewPortParam* pParamGenViewport, input, refer to the structure generateViewPortParam
+//! \param    void*                 pGenHandle,            input, which is created by the genTiledStream_Init function
+//!
+//! \return   s32, the status of the function.
+//!           0,     if succeed
+//!           not 0, if fail, and the table is disabled
+//!
+int32_t   genViewport_buildTileLUT(generateViewPortParam* pParamGenViewport, void* pGenHandle);
+
+//!
+//! \brief    This function makes the viewport use the pose-to-tile lookup table of another viewport
+//!           with the same tile layout instead of building its own. The table is read only, and the
+//!           source viewport must keep it until this viewport is destroyed or builds its own table.
+//!
+//! \param    void*                 pGenHandle,            input, which is created by the genTiledStream_Init function
+//! \param    void*                 pSrcGenHandle,         input, the viewport owning the table
+//!
+//! \return   s32, the status of the function.
+//!           0,     if succeed
+//!           not 0, if fail
+//!
+int32_t   genViewport_shareTileLUT(void* pGenHandle, void* pSrcGenHandle);
+
+//!
+//! \brief    This function selects how genViewport_process computes the viewport range in the input.
+//!           The analytic ERP solver only projects the viewport border instead of every pixel.
+//!
+//! \param    void*                 pGenHandle,            input, which is created by the genTiledStream_Init function
+//! \param    int32_t               solver,                input, refer to ViewportSolver
+//!
+//! \return   s32, the status of the function.
+//!           0,     if succeed
+//!           not 0, if fail
+//!
+int32_t   genViewport_setViewportSolver(void* pGenHandle, int32_t solver);
+
 //!
 //! \brief    This function sets the parameter of the viewPort.
 //!
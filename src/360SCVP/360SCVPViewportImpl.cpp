@@ -93,6 +93,7 @@ void* genViewport_Init(generateViewPortParam* pParamGenViewport)
     cTAppConvCfg->m_sourceSVideoInfo.geoType = pParamGenViewport->m_input_geoType;
     cTAppConvCfg->m_iInputWidth = pParamGenViewport->m_iInputWidth;
     cTAppConvCfg->m_iInputHeight = pParamGenViewport->m_iInputHeight;
+    cTAppConvCfg->m_viewportSolver = pParamGenViewport->m_viewportSolver;
     if (cTAppConvCfg->create(pParamGenViewport->m_tileNumRow / cTAppConvCfg->m_paramVideoFP.rows, pParamGenViewport->m_tileNumCol / cTAppConvCfg->m_paramVideoFP.cols) < 0)
     {
         SAFE_DELETE(cTAppConvCfg);
@@ -215,6 +216,9 @@ void* genViewport_Init(generateViewPortParam* pParamGenViewport)
         pParamGenViewport->m_viewportDestHeight = maxTileNumRow * cTAppConvCfg->m_srd[0].tileheight;
     }
     cTAppConvCfg->m_maxTileNum = maxTileNum;
+
+    if (pParamGenViewport->m_tileLUT.memoryBudget)
+        genViewport_buildTileLUT(pParamGenViewport, (void*)cTAppConvCfg);
     return (void*)cTAppConvCfg;
 }
 
@@ -264,13 +268,8 @@ int32_t   genViewport_postprocess(generateViewPortParam* pParamGenViewport, void
     TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
     if (!cTAppConvCfg || !pParamGenViewport)
         return -1;
-    cTAppConvCfg->CalculateViewportBoundaryPoints();
-    if (cTAppConvCfg->m_sourceSVideoInfo.geoType == E_SVIDEO_EQUIRECT)
-        cTAppConvCfg->ERPSelectRegion(pParamGenViewport->m_iInputWidth, pParamGenViewport->m_iInputHeight, pParamGenViewport->m_viewportDestWidth, pParamGenViewport->m_viewportDestHeight);
-    else if (cTAppConvCfg->m_sourceSVideoInfo.geoType == E_SVIDEO_CUBEMAP)
-        cTAppConvCfg->cubemapSelectRegion();
-    else
-        SCVP_LOG(LOG_WARNING, "Not support projection mode %d\n", cTAppConvCfg->m_sourceSVideoInfo.geoType);
+    if (cTAppConvCfg->selectRegionByTileLUT() < 0)
+        cTAppConvCfg->selectRegion(pParamGenViewport->m_iInputWidth, pParamGenViewport->m_iInputHeight, pParamGenViewport->m_viewportDestWidth, pParamGenViewport->m_viewportDestHeight);
 
     pParamGenViewport->m_numFaces = cTAppConvCfg->m_numFaces;
     point* pTmpUpleftDst = pParamGenViewport->m_pUpLeft;
@@ -299,6 +298,35 @@ int32_t   genViewport_postprocess(generateViewPortParam* pParamGenViewport, void
 }
 
 
+int32_t   genViewport_buildTileLUT(generateViewPortParam* pParamGenViewport, void* pGenHandle)
+{
+    TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
+    if (!cTAppConvCfg || !pParamGenViewport)
+        return -1;
+    return cTAppConvCfg->buildTileLUT(pParamGenViewport->m_tileLUT.memoryBudget, pParamGenViewport->m_tileLUT.angleStep,
+        pParamGenViewport->m_tileLUT.refine, pParamGenViewport->m_iInputWidth, pParamGenViewport->m_iInputHeight,
+        pParamGenViewport->m_viewportDestWidth, pParamGenViewport->m_viewportDestHeight);
+}
+
+int32_t   genViewport_shareTileLUT(void* pGenHandle, void* pSrcGenHandle)
+{
+    TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
+    TgenViewport* cTAppSrcCfg = (TgenViewport*)(pSrcGenHandle);
+    if (!cTAppConvCfg || !cTAppSrcCfg)
+        return -1;
+    cTAppConvCfg->shareTileLUT(*cTAppSrcCfg);
+    return 0;
+}
+
+int32_t genViewport_setViewportSolver(void* pGenHandle, int32_t solver)
+{
+    TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
+    if (!cTAppConvCfg)
+        return -1;
+    cTAppConvCfg->m_viewportSolver = (ViewportSolver)solver;
+    return 0;
+}
+
 int32_t genViewport_setMaxSelTiles(void* pGenHandle, int32_t maxSelTiles)
 {
     TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
@@ -731,6 +759,8 @@ TgenViewport::TgenViewport()
     m_pViewportVerticalBoundaryPoints = NULL;
     m_paramVideoFP.cols = 0;
     m_paramVideoFP.rows = 0;
+    memset_s(&m_tileLUT, sizeof(TileLUT), 0);
+    m_viewportSolver = E_VIEWPORT_SOLVER_PIXEL_SWEEP;
 }
 
 TgenViewport::TgenViewport(TgenViewport& src)
@@ -759,6 +789,8 @@ TgenViewport::TgenViewport(TgenViewport& src)
     m_pViewportVerticalBoundaryPoints = NULL;
     m_paramVideoFP.cols = src.m_paramVideoFP.cols;
     m_paramVideoFP.rows = src.m_paramVideoFP.rows;
+    memset_s(&m_tileLUT, sizeof(TileLUT), 0);
+    m_viewportSolver = src.m_viewportSolver;
 }
 
 TgenViewport::~TgenViewport()
@@ -768,6 +800,7 @@ TgenViewport::~TgenViewport()
     SAFE_DELETE_ARRAY(m_srd);
     SAFE_DELETE_ARRAY(m_pViewportHorizontalBoundaryPoints);
     SAFE_DELETE_ARRAY(m_pViewportVerticalBoundaryPoints);
+    releaseTileLUT();
 }
 
 TgenViewport& TgenViewport::operator=(const TgenViewport& src)
@@ -790,6 +823,8 @@ TgenViewport& TgenViewport::operator=(const TgenViewport& src)
     this->m_iInputWidth = src.m_iInputWidth;
     this->m_iInputHeight = src.m_iInputHeight;
     this->m_usageType = src.m_usageType;
+    this->m_viewportSolver = src.m_viewportSolver;
+    releaseTileLUT();
     if (this->m_srd && src.m_srd)
     {
         int32_t totalTileInfoSize = FACE_NUMBER*m_tileNumRow*m_tileNumCol*sizeof(ITileInfo);
@@ -804,7 +839,7 @@ int32_t TgenViewport::create(uint32_t tileNumRow, uint32_t tileNumCol)
     m_tileNumCol = tileNumCol;
     if (!m_srd)
     {
-        m_srd = new ITileInfo[FACE_NUMBER*m_tileNumRow*m_tileNumCol];
+        m_srd = new ITileInfo[FACE_NUMBER*m_tileNumRow*m_tileNumCol]();
         if (!m_srd)
             return -1;
     }
@@ -831,6 +866,7 @@ void TgenViewport::destroy()
     SAFE_DELETE_ARRAY(m_srd);
     SAFE_DELETE_ARRAY(m_pViewportHorizontalBoundaryPoints);
     SAFE_DELETE_ARRAY(m_pViewportVerticalBoundaryPoints);
+    releaseTileLUT();
 }
 
 
@@ -1141,7 +1177,6 @@ int32_t TgenViewport::CalculateViewportBoundaryPoints()
     double fPitch = m_codingSVideoInfo.viewPort.fPitch;
     double vFOV = m_codingSVideoInfo.viewPort.vFOV;
     double hFOV = m_codingSVideoInfo.viewPort.hFOV;
-    std::list<SpherePoint> referencePoints;
 
     SCVP_LOG(LOG_INFO, "Yaw is %f and Pitch is %f\n", fYaw, fPitch);
 
@@ -1338,7 +1373,6 @@ int32_t  TgenViewport::ERPSelectRegion(short inputWidth, short inputHeight, shor
     SpherePoint* pHorzBoundaryPoint = m_pViewportHorizontalBoundaryPoints;
     SpherePoint* pVertBoundaryPoint = m_pViewportVerticalBoundaryPoints;
 
-    std::list<SpherePoint> referencePoints;
     SPos* pTmpUpLeft = m_pUpLeft;
     SPos* pTmpDownRight = m_pDownRight;
     pHorzBoundaryPoint = m_pViewportHorizontalBoundaryPoints;
@@ -1351,6 +1385,9 @@ int32_t  TgenViewport::ERPSelectRegion(short inputWidth, short inputHeight, shor
         m_srd[i].vertPosTopRight = m_srd[i].vertPos;
         m_srd[i].isOccupy = 0;
     }
+    /* boundary points at the south pole fall one row below the grid, into the second face */
+    for (uint32_t i = m_tileNumCol * m_tileNumRow; i < 2 * m_tileNumCol * m_tileNumRow; i++)
+        m_srd[i].isOccupy = 0;
     for (uint32_t i = 0; i < FACE_NUMBER; i++)
     {
         m_pUpLeft[i].x = 0;
@@ -1622,7 +1659,12 @@ int32_t  TgenViewport::convert()
     double dResult;
     clock_t lBefore = clock();
 
-    pcInputGeomtry->geoConvert(pcCodingGeomtry);
+    if (m_viewportSolver == E_VIEWPORT_SOLVER_ANALYTIC_ERP
+        && pcInputGeomtry->getType() == SVIDEO_EQUIRECT
+        && pcCodingGeomtry->getType() == SVIDEO_VIEWPORT)
+        ((ViewPort*)pcCodingGeomtry)->erpBoundaryMapping(pcInputGeomtry);
+    else
+        pcInputGeomtry->geoConvert(pcCodingGeomtry);
 
     if (pcCodingGeomtry->getType() == SVIDEO_VIEWPORT)
     {
@@ -1655,6 +1697,225 @@ int32_t  TgenViewport::convert()
     SAFE_DELETE(pcCodingGeomtry);
     return 0;
 }
+int32_t TgenViewport::selectRegion(short inputWidth, short inputHeight, short dstWidth, short dstHeight)
+{
+    CalculateViewportBoundaryPoints();
+    if (m_sourceSVideoInfo.geoType == E_SVIDEO_EQUIRECT)
+        return ERPSelectRegion(inputWidth, inputHeight, dstWidth, dstHeight);
+    else if (m_sourceSVideoInfo.geoType == E_SVIDEO_CUBEMAP)
+        return cubemapSelectRegion();
+
+    SCVP_LOG(LOG_WARNING, "Not support projection mode %d\n", m_sourceSVideoInfo.geoType);
+    return ERROR_INVALID;
+}
+
+int32_t TgenViewport::buildTileLUT(uint32_t memoryBudget, float angleStep, bool refine, short inputWidth, short inputHeight, short dstWidth, short dstHeight)
+{
+    const float candidateSteps[] = { 1, 2, 3, 5, 10 };
+    uint32_t candidateNum = sizeof(candidateSteps) / sizeof(candidateSteps[0]);
+    uint32_t yawNum = 0, pitchNum = 0;
+    uint64_t tableSize = 0;
+
+    releaseTileLUT();
+    if (!memoryBudget)
+        return ERROR_NONE;
+    if (m_sourceSVideoInfo.geoType != SVIDEO_EQUIRECT && m_sourceSVideoInfo.geoType != SVIDEO_CUBEMAP)
+    {
+        SCVP_LOG(LOG_WARNING, "Tile lookup table doesn't support projection mode %d\n", m_sourceSVideoInfo.geoType);
+        return ERROR_INVALID;
+    }
+    if (angleStep < 0 || angleStep > ERP_VERT_ANGLE)
+    {
+        SCVP_LOG(LOG_WARNING, "Tile lookup table angle step %f is illegal\n", angleStep);
+        return ERROR_BAD_PARAM;
+    }
+
+    /* ERP selection may also mark tiles one row below the grid, which belong to the second face */
+    uint32_t faceNum = (m_sourceSVideoInfo.geoType == SVIDEO_CUBEMAP) ? FACE_NUMBER : 2;
+    uint32_t tileNum = faceNum * m_tileNumRow * m_tileNumCol;
+    uint32_t tileBytes = (tileNum + 7) / 8;
+    for (uint32_t i = 0; i < candidateNum; i++)
+    {
+        float step = (angleStep > 0) ? angleStep : candidateSteps[i];
+        yawNum = (uint32_t)ceil(ERP_HORZ_ANGLE / step - 1e-3);
+        pitchNum = (uint32_t)ceil(ERP_VERT_ANGLE / step - 1e-3) + 1;
+        tableSize = (uint64_t)yawNum * pitchNum * (tileBytes + 1);
+        if (angleStep > 0 || tableSize <= memoryBudget)
+            break;
+    }
+    if (tableSize > memoryBudget)
+    {
+        SCVP_LOG(LOG_WARNING, "Tile lookup table needs %lu bytes, which exceeds the budget %u\n", (unsigned long)tableSize, memoryBudget);
+        return ERROR_INVALID;
+    }
+
+    m_tileLUT.occupancy = new uint8_t[(uint64_t)yawNum * pitchNum * tileBytes]();
+    m_tileLUT.faceMask = new uint8_t[(uint64_t)yawNum * pitchNum]();
+    m_tileLUT.upLeft = new SPos[FACE_NUMBER];
+    m_tileLUT.downRight = new SPos[FACE_NUMBER];
+    m_tileLUT.yawNum = yawNum;
+    m_tileLUT.pitchNum = pitchNum;
+    m_tileLUT.yawStep = (float)ERP_HORZ_ANGLE / yawNum;
+    m_tileLUT.pitchStep = (float)ERP_VERT_ANGLE / (pitchNum - 1);
+    m_tileLUT.tileNum = tileNum;
+    m_tileLUT.tileBytes = tileBytes;
+    m_tileLUT.refine = refine;
+
+    float yaw = m_codingSVideoInfo.viewPort.fYaw;
+    float pitch = m_codingSVideoInfo.viewPort.fPitch;
+    SPos upLeft[FACE_NUMBER], downRight[FACE_NUMBER];
+    for (int32_t i = 0; i < FACE_NUMBER; i++)
+    {
+        upLeft[i] = m_pUpLeft[i];
+        downRight[i] = m_pDownRight[i];
+    }
+
+    clock_t lBefore = clock();
+    int32_t ret = ERROR_NONE;
+    uint8_t *pOccupancy = m_tileLUT.occupancy;
+    uint8_t *pFaceMask = m_tileLUT.faceMask;
+    for (uint32_t j = 0; j < pitchNum && ret == ERROR_NONE; j++)
+    {
+        for (uint32_t i = 0; i < yawNum; i++)
+        {
+            m_codingSVideoInfo.viewPort.fYaw = -ERP_HORZ_ANGLE / 2 + i * m_tileLUT.yawStep;
+            m_codingSVideoInfo.viewPort.fPitch = -ERP_VERT_ANGLE / 2 + j * m_tileLUT.pitchStep;
+            if (selectRegion(inputWidth, inputHeight, dstWidth, dstHeight) < 0)
+            {
+                ret = ERROR_INVALID;
+                break;
+            }
+            for (uint32_t idx = 0; idx < tileNum; idx++)
+            {
+                if (m_srd[idx].isOccupy)
+                    pOccupancy[idx >> 3] |= (uint8_t)(1 << (idx & 7));
+            }
+            /* only the selected faces change with the pose, the face regions are the same for all the entries */
+            for (int32_t face = 0; face < FACE_NUMBER; face++)
+            {
+                if (m_pUpLeft[face].faceIdx >= 0)
+                    *pFaceMask |= (uint8_t)(1 << face);
+                if (!i && !j)
+                {
+                    m_tileLUT.upLeft[face] = m_pUpLeft[face];
+                    m_tileLUT.downRight[face] = m_pDownRight[face];
+                }
+                else if (m_pUpLeft[face].x != m_tileLUT.upLeft[face].x || m_pUpLeft[face].y != m_tileLUT.upLeft[face].y
+                    || m_pDownRight[face].x != m_tileLUT.downRight[face].x || m_pDownRight[face].y != m_tileLUT.downRight[face].y)
+                {
+                    ret = ERROR_INVALID;
+                }
+            }
+            if (ret != ERROR_NONE)
+                break;
+            pOccupancy += tileBytes;
+            pFaceMask++;
+        }
+    }
+
+    /* restore the current pose and the initial tile state */
+    m_codingSVideoInfo.viewPort.fYaw = yaw;
+    m_codingSVideoInfo.viewPort.fPitch = pitch;
+    for (int32_t i = 0; i < FACE_NUMBER; i++)
+    {
+        m_pUpLeft[i] = upLeft[i];
+        m_pDownRight[i] = downRight[i];
+    }
+    for (uint32_t idx = 0; idx < tileNum; idx++)
+    {
+        m_srd[idx].isOccupy = 0;
+        if (m_sourceSVideoInfo.geoType == SVIDEO_CUBEMAP)
+            m_srd[idx].faceId = idx / (m_tileNumRow * m_tileNumCol);
+    }
+
+    if (ret != ERROR_NONE)
+    {
+        SCVP_LOG(LOG_WARNING, "Failed to build the tile lookup table!\n");
+        releaseTileLUT();
+        return ret;
+    }
+    SCVP_LOG(LOG_INFO, "Tile lookup table of %u x %u poses, %lu bytes, built in %f ms\n", yawNum, pitchNum,
+        (unsigned long)tableSize, (double)(clock() - lBefore) * 1000 / CLOCKS_PER_SEC);
+    return ERROR_NONE;
+}
+
+int32_t TgenViewport::selectRegionByTileLUT()
+{
+    if (!m_tileLUT.occupancy)
+        return ERROR_INVALID;
+
+    float yawPos = (clampAngle(m_codingSVideoInfo.viewPort.fYaw, -ERP_HORZ_ANGLE / 2, ERP_HORZ_ANGLE / 2) + ERP_HORZ_ANGLE / 2) / m_tileLUT.yawStep;
+    float pitch = m_codingSVideoInfo.viewPort.fPitch;
+    if (pitch > ERP_VERT_ANGLE / 2)
+        pitch = ERP_VERT_ANGLE / 2;
+    else if (pitch < -ERP_VERT_ANGLE / 2)
+        pitch = -ERP_VERT_ANGLE / 2;
+    float pitchPos = (pitch + ERP_VERT_ANGLE / 2) / m_tileLUT.pitchStep;
+
+    /* nearest grid pose, or the grid poses around the pose when refining */
+    uint32_t yawIdx[2], pitchIdx[2];
+    if (m_tileLUT.refine)
+    {
+        yawIdx[0] = (uint32_t)floor(yawPos) % m_tileLUT.yawNum;
+        yawIdx[1] = (yawIdx[0] + 1) % m_tileLUT.yawNum;
+        pitchIdx[0] = min((uint32_t)floor(pitchPos), m_tileLUT.pitchNum - 1);
+        pitchIdx[1] = min(pitchIdx[0] + 1, m_tileLUT.pitchNum - 1);
+    }
+    else
+    {
+        yawIdx[0] = yawIdx[1] = (uint32_t)floor(yawPos + 0.5) % m_tileLUT.yawNum;
+        pitchIdx[0] = pitchIdx[1] = min((uint32_t)floor(pitchPos + 0.5), m_tileLUT.pitchNum - 1);
+    }
+
+    const uint8_t *pEntry[4];
+    uint8_t faceMask = 0;
+    for (int32_t i = 0; i < 4; i++)
+    {
+        uint32_t entryIdx = pitchIdx[i >> 1] * m_tileLUT.yawNum + yawIdx[i & 1];
+        pEntry[i] = m_tileLUT.occupancy + (uint64_t)entryIdx * m_tileLUT.tileBytes;
+        faceMask |= m_tileLUT.faceMask[entryIdx];
+    }
+
+    uint32_t faceTileNum = m_tileNumRow * m_tileNumCol;
+    for (uint32_t idx = 0; idx < m_tileLUT.tileNum; idx++)
+    {
+        uint8_t bits = pEntry[0][idx >> 3] | pEntry[1][idx >> 3] | pEntry[2][idx >> 3] | pEntry[3][idx >> 3];
+        m_srd[idx].isOccupy = (bits >> (idx & 7)) & 1;
+        if (m_sourceSVideoInfo.geoType == SVIDEO_CUBEMAP)
+            m_srd[idx].faceId = m_srd[idx].isOccupy ? (int32_t)(idx / faceTileNum) : -1;
+    }
+    for (int32_t face = 0; face < FACE_NUMBER; face++)
+    {
+        m_pUpLeft[face] = m_tileLUT.upLeft[face];
+        m_pDownRight[face] = m_tileLUT.downRight[face];
+        m_pUpLeft[face].faceIdx = m_pDownRight[face].faceIdx = ((faceMask >> face) & 1) ? face : -1;
+    }
+    return ERROR_NONE;
+}
+
+void TgenViewport::shareTileLUT(const TgenViewport& src)
+{
+    releaseTileLUT();
+    if (!src.m_tileLUT.occupancy)
+        return;
+    /* the table is only read after it is built, the source keeps it until the sharing viewports are gone */
+    m_tileLUT = src.m_tileLUT;
+    m_tileLUT.shared = true;
+}
+
+void TgenViewport::releaseTileLUT()
+{
+    if (m_tileLUT.shared)
+    {
+        memset_s(&m_tileLUT, sizeof(TileLUT), 0);
+        return;
+    }
+    SAFE_DELETE_ARRAY(m_tileLUT.occupancy);
+    SAFE_DELETE_ARRAY(m_tileLUT.faceMask);
+    SAFE_DELETE_ARRAY(m_tileLUT.upLeft);
+    SAFE_DELETE_ARRAY(m_tileLUT.downRight);
+}
+
 bool TgenViewport::isInside(int32_t x, int32_t y, int32_t width, int32_t height, int32_t faceId)
 {
     bool ret = 0;
@@ -1735,7 +1996,7 @@ bool TgenViewport::isInside(int32_t x, int32_t y, int32_t width, int32_t height,
     return ret;
 }
 
-int32_t TgenViewport::CubemapGetFaceBoundaryCrossingPoints(SpherePoint* firstPoint, SpherePoint* secondPoint, std::list<SpherePoint>* crossBoundaryPoints)
+int32_t TgenViewport::CubemapGetFaceBoundaryCrossingPoints(SpherePoint* firstPoint, SpherePoint* secondPoint, CubemapFacePoint* crossBoundaryPoints, int32_t* pPointNum)
 {
     SpherePoint crossUpLeftPoint, crossDownRightPoint;
     SpherePoint *upLeftPoint, *downRightPoint;
@@ -1743,7 +2004,7 @@ int32_t TgenViewport::CubemapGetFaceBoundaryCrossingPoints(SpherePoint* firstPoi
     int32_t faceWidth = m_sourceSVideoInfo.iFaceWidth;
     int32_t faceHeight = m_sourceSVideoInfo.iFaceHeight;
 
-    if ( !firstPoint || !secondPoint) {
+    if ( !firstPoint || !secondPoint || !crossBoundaryPoints || !pPointNum) {
         SCVP_LOG(LOG_ERROR, "The given sphere point is NULL!\n");
         return ERROR_NULL_PTR;
     }
@@ -1962,35 +2223,28 @@ int32_t TgenViewport::CubemapGetFaceBoundaryCrossingPoints(SpherePoint* firstPoi
     else {
         return ERROR_NONE;
     }
-    crossBoundaryPoints->push_back(crossUpLeftPoint);
-    crossBoundaryPoints->push_back(crossDownRightPoint);
+    if (*pPointNum + 2 > CUBEMAP_MAX_REF_POINTS)
+        return ERROR_INVALID;
+    CubemapFacePoint* pCross = crossBoundaryPoints + *pPointNum;
+    pCross[0].faceIdx = crossUpLeftPoint.cord2D.faceIdx;
+    pCross[0].x = crossUpLeftPoint.cord2D.x;
+    pCross[0].y = crossUpLeftPoint.cord2D.y;
+    pCross[1].faceIdx = crossDownRightPoint.cord2D.faceIdx;
+    pCross[1].x = crossDownRightPoint.cord2D.x;
+    pCross[1].y = crossDownRightPoint.cord2D.y;
+    *pPointNum += 2;
     return ERROR_NONE;
 }
 
-int32_t TgenViewport::CubemapGetViewportProjInFace(int32_t faceId, std::list<SpherePoint>* Points)
+int32_t TgenViewport::CubemapGetViewportProjInFace(int32_t faceId, CubemapFacePoint* pointsInFace, int32_t pointNum, CubemapFacePoint* lastPoint)
 {
-    SpherePoint point;
     int32_t tileWidth = m_srd[0].tilewidth;
     int32_t tileHeight = m_srd[0].tileheight;
     SPos* pTmpUpLeft = &m_pUpLeft[faceId];
     SPos* pTmpDownRight = &m_pDownRight[faceId];
-    SPos TmpUpRight;
-    SPos TmpDownLeft;
-    SPos upPoint, leftPoint;
-    SPos downPoint, rightPoint;
-    std::list<SpherePoint> pointsInFace;
     int32_t leftCol[m_tileNumRow], rightCol[m_tileNumRow];
 
     float slope;
-    TmpUpRight.x = 0;
-    TmpUpRight.y = m_sourceSVideoInfo.iFaceHeight;
-    TmpDownLeft.x = m_sourceSVideoInfo.iFaceWidth;
-    TmpDownLeft.y = 0;
-
-    if (Points->size() == 0) {
-        SCVP_LOG(LOG_WARNING, "Cubemap viewport projection reference points list is NULL!\n")
-        return ERROR_NO_VALUE;
-    }
 
     for (uint32_t i = 0; i < m_tileNumRow; i++) {
         leftCol[i] = m_tileNumCol - 1;
@@ -2000,18 +2254,13 @@ int32_t TgenViewport::CubemapGetViewportProjInFace(int32_t faceId, std::list<Sph
     pTmpUpLeft->y = m_sourceSVideoInfo.iFaceHeight;
     pTmpDownRight->x = 0;
     pTmpDownRight->y = 0;
-    for (auto it = Points->begin(); it != Points->end(); it++) {
-        point = *it;
-        if (point.cord2D.faceIdx == faceId) {
-            pointsInFace.push_back(point);
-        }
-    }
-    if (pointsInFace.size() == 0) {
+    if (pointNum == 0) {
         return ERROR_NONE;
     }
-    else if (pointsInFace.size() == 1) {
-        int32_t colNum = max(0, (int32_t)(point.cord2D.x / tileWidth));
-        int32_t rowNum = max(0, (int32_t)(point.cord2D.y / tileHeight));
+    else if (pointNum == 1) {
+        CubemapFacePoint* point = lastPoint;
+        int32_t colNum = max(0, (int32_t)(point->x / tileWidth));
+        int32_t rowNum = max(0, (int32_t)(point->y / tileHeight));
         if (rowNum >= (int32_t)m_tileNumRow)
             rowNum = m_tileNumRow - 1;
         if (colNum >= (int32_t)m_tileNumCol)
@@ -2020,38 +2269,38 @@ int32_t TgenViewport::CubemapGetViewportProjInFace(int32_t faceId, std::list<Sph
         rightCol[rowNum] = max(rightCol[rowNum], colNum);
     }
     else {
-        for (auto it = pointsInFace.begin(); it != pointsInFace.end(); it++) {
-            point = *it;
-            int32_t colNum = max(0, (int32_t)(point.cord2D.x / tileWidth));
-            int32_t rowNum = max(0, (int32_t)(point.cord2D.y / tileHeight));
+        for (int32_t idx = 0; idx < pointNum; idx++) {
+            CubemapFacePoint* point = &pointsInFace[idx];
+            int32_t colNum = max(0, (int32_t)(point->x / tileWidth));
+            int32_t rowNum = max(0, (int32_t)(point->y / tileHeight));
             if (rowNum == (int32_t)m_tileNumRow)
                 rowNum--;
             if (colNum == (int32_t)m_tileNumCol)
                 colNum--;
             leftCol[rowNum] = min(leftCol[rowNum], colNum);
             rightCol[rowNum] = max(rightCol[rowNum], colNum);
-            for (auto itSecond = it; itSecond != pointsInFace.end(); itSecond++) {
-                SpherePoint pointSecond = *itSecond;
-                if (fabs(point.cord2D.y - pointSecond.cord2D.y) <= 0.001) {
-                    colNum = max(0, (int32_t)(point.cord2D.x / tileWidth));
-		    colNum = min((int32_t)m_tileNumCol -1, colNum);
+            for (int32_t idxSecond = idx; idxSecond < pointNum; idxSecond++) {
+                CubemapFacePoint* pointSecond = &pointsInFace[idxSecond];
+                if (fabs(point->y - pointSecond->y) <= 0.001) {
+                    colNum = max(0, (int32_t)(point->x / tileWidth));
+                    colNum = min((int32_t)m_tileNumCol -1, colNum);
                     leftCol[rowNum] = min(leftCol[rowNum], colNum);
                     rightCol[rowNum] = max(rightCol[rowNum], colNum);
                 }
                 else {
-                    slope = (point.cord2D.x - pointSecond.cord2D.x) / (point.cord2D.y - pointSecond.cord2D.y);
-                    if ((int32_t)(point.cord2D.y / tileHeight) > (int32_t)(pointSecond.cord2D.y / tileHeight)) {
-                        for (int32_t i = rowNum - 1; i >= max(0, (int32_t)(pointSecond.cord2D.y / tileHeight)); i--) {
-                            float localX = slope * (i * tileHeight - pointSecond.cord2D.y) + pointSecond.cord2D.x;
+                    slope = (point->x - pointSecond->x) / (point->y - pointSecond->y);
+                    if ((int32_t)(point->y / tileHeight) > (int32_t)(pointSecond->y / tileHeight)) {
+                        for (int32_t i = rowNum - 1; i >= max(0, (int32_t)(pointSecond->y / tileHeight)); i--) {
+                            float localX = slope * (i * tileHeight - pointSecond->y) + pointSecond->x;
                             colNum = max(0, (int32_t)(localX / tileWidth));
                             colNum = min((int32_t)m_tileNumCol - 1, colNum);
                             leftCol[i] = min(leftCol[i], colNum);
                             rightCol[i] = max(rightCol[i], colNum);
                         }
                     }
-                    else if ((int32_t)(point.cord2D.y / tileHeight) < (int32_t)(pointSecond.cord2D.y / tileHeight)) {
-                        for (int32_t i = rowNum + 1; i <= min((int32_t)(m_tileNumRow-1), (int32_t)(pointSecond.cord2D.y / tileHeight)); i++) {
-                             float localX = slope * (i * tileHeight - pointSecond.cord2D.y) + pointSecond.cord2D.x;
+                    else if ((int32_t)(point->y / tileHeight) < (int32_t)(pointSecond->y / tileHeight)) {
+                        for (int32_t i = rowNum + 1; i <= min((int32_t)(m_tileNumRow-1), (int32_t)(pointSecond->y / tileHeight)); i++) {
+                             float localX = slope * (i * tileHeight - pointSecond->y) + pointSecond->x;
                              colNum = max(0, (int32_t)(localX / tileWidth));
                              colNum = min((int32_t)m_tileNumCol - 1, colNum);
                              leftCol[i] = min(leftCol[i], colNum);
@@ -2070,7 +2319,6 @@ int32_t TgenViewport::CubemapGetViewportProjInFace(int32_t faceId, std::list<Sph
     }
     pTmpUpLeft->faceIdx = faceId;
     pTmpDownRight->faceIdx = faceId;
-    pointsInFace.clear();
     return ERROR_NONE;
 }
 
@@ -2156,7 +2404,12 @@ int32_t TgenViewport::cubemapSelectRegion()
     double vFOV = m_codingSVideoInfo.viewPort.vFOV;
     SpherePoint centerPoint;
 
-    std::list<SpherePoint> referencePoints;
+    /* Reference points live on the stack, the capacity covers the widest viewport */
+    CubemapFacePoint referencePoints[CUBEMAP_MAX_REF_POINTS];
+    CubemapFacePoint facePoints[CUBEMAP_MAX_REF_POINTS];
+    int32_t faceStart[FACE_NUMBER + 1];
+    int32_t faceFill[FACE_NUMBER];
+    int32_t pointNum = 0;
     SpherePoint* pPoint;
 
     /* Reset viewport area */
@@ -2173,7 +2426,10 @@ int32_t TgenViewport::cubemapSelectRegion()
     centerPoint.thita = m_codingSVideoInfo.viewPort.fPitch;
     centerPoint.alpha = m_codingSVideoInfo.viewPort.fYaw;
     CubemapPolar2Cartesian(&centerPoint);
-    referencePoints.push_back(centerPoint);
+    referencePoints[pointNum].faceIdx = centerPoint.cord2D.faceIdx;
+    referencePoints[pointNum].x = centerPoint.cord2D.x;
+    referencePoints[pointNum].y = centerPoint.cord2D.y;
+    pointNum++;
 
     /* Add the points on the viewport horizontal boudary into reference list */
     pPoint = m_pViewportHorizontalBoundaryPoints;
@@ -2181,14 +2437,24 @@ int32_t TgenViewport::cubemapSelectRegion()
     for (float offsetAngle = vFOV/2; offsetAngle >= -vFOV/2; offsetAngle -= HORZ_BOUNDING_STEP)
     {
         CubemapPolar2Cartesian(pPoint);
-        referencePoints.push_back(*pPoint);
+        if (pointNum < CUBEMAP_MAX_REF_POINTS) {
+            referencePoints[pointNum].faceIdx = pPoint->cord2D.faceIdx;
+            referencePoints[pointNum].x = pPoint->cord2D.x;
+            referencePoints[pointNum].y = pPoint->cord2D.y;
+            pointNum++;
+        }
         pPoint++;
     }
     /* Left Boundary */
     for (float offsetAngle = vFOV/2; offsetAngle >= -vFOV/2; offsetAngle -= HORZ_BOUNDING_STEP)
     {
         CubemapPolar2Cartesian(pPoint);
-        referencePoints.push_back(*pPoint);
+        if (pointNum < CUBEMAP_MAX_REF_POINTS) {
+            referencePoints[pointNum].faceIdx = pPoint->cord2D.faceIdx;
+            referencePoints[pointNum].x = pPoint->cord2D.x;
+            referencePoints[pointNum].y = pPoint->cord2D.y;
+            pointNum++;
+        }
         pPoint++;
     }
     /* Add the points on the viewport vertical boudary into reference list */
@@ -2197,14 +2463,24 @@ int32_t TgenViewport::cubemapSelectRegion()
     for (float offsetAngle = hFOV/2; offsetAngle >= -hFOV/2; offsetAngle -= VERT_BOUNDING_STEP)
     {
         CubemapPolar2Cartesian(pPoint);
-        referencePoints.push_back(*pPoint);
+        if (pointNum < CUBEMAP_MAX_REF_POINTS) {
+            referencePoints[pointNum].faceIdx = pPoint->cord2D.faceIdx;
+            referencePoints[pointNum].x = pPoint->cord2D.x;
+            referencePoints[pointNum].y = pPoint->cord2D.y;
+            pointNum++;
+        }
         pPoint++;
     }
     /* Bottom Boundary */
     for (float offsetAngle = hFOV/2; offsetAngle >= -hFOV/2; offsetAngle -= VERT_BOUNDING_STEP)
     {
         CubemapPolar2Cartesian(pPoint);
-        referencePoints.push_back(*pPoint);
+        if (pointNum < CUBEMAP_MAX_REF_POINTS) {
+            referencePoints[pointNum].faceIdx = pPoint->cord2D.faceIdx;
+            referencePoints[pointNum].x = pPoint->cord2D.x;
+            referencePoints[pointNum].y = pPoint->cord2D.y;
+            pointNum++;
+        }
         pPoint++;
     }
 
@@ -2214,32 +2490,47 @@ int32_t TgenViewport::cubemapSelectRegion()
     /* Right Boundary */
     for (float offsetAngle = vFOV/2; offsetAngle >= -vFOV/2; offsetAngle -= HORZ_BOUNDING_STEP)
     {
-        CubemapGetFaceBoundaryCrossingPoints(&centerPoint, pPoint, &referencePoints);
+        CubemapGetFaceBoundaryCrossingPoints(&centerPoint, pPoint, referencePoints, &pointNum);
         pPoint++;
     }
     /* Left Boundary */
     for (float offsetAngle = vFOV/2; offsetAngle >= -vFOV/2; offsetAngle -= HORZ_BOUNDING_STEP)
     {
-        CubemapGetFaceBoundaryCrossingPoints(pPoint, &centerPoint, &referencePoints);
+        CubemapGetFaceBoundaryCrossingPoints(pPoint, &centerPoint, referencePoints, &pointNum);
         pPoint++;
     }
     /* Top Boundary */
     pPoint = m_pViewportVerticalBoundaryPoints;
     for (float offsetAngle = hFOV/2; offsetAngle >= -hFOV/2; offsetAngle -= VERT_BOUNDING_STEP)
     {
-        CubemapGetFaceBoundaryCrossingPoints(pPoint, &centerPoint, &referencePoints);
+        CubemapGetFaceBoundaryCrossingPoints(pPoint, &centerPoint, referencePoints, &pointNum);
         pPoint++;
     }
     /* Bottom Boundary */
     for (float offsetAngle = hFOV/2; offsetAngle >= -hFOV/2; offsetAngle -= VERT_BOUNDING_STEP)
     {
-        CubemapGetFaceBoundaryCrossingPoints(&centerPoint, pPoint, &referencePoints);
+        CubemapGetFaceBoundaryCrossingPoints(&centerPoint, pPoint, referencePoints, &pointNum);
         pPoint++;
     }
 
     /* Get the tile selection on each face */
+    /* Bucket the points by face, keeping their order inside each face */
+    memset(faceStart, 0, sizeof(faceStart));
+    for (int32_t idx = 0; idx < pointNum; idx++) {
+        int32_t faceIdx = referencePoints[idx].faceIdx;
+        if (faceIdx >= 0 && faceIdx < FACE_NUMBER)
+            faceStart[faceIdx + 1]++;
+    }
+    for (int32_t faceIdx = 0; faceIdx < FACE_NUMBER; faceIdx++)
+        faceStart[faceIdx + 1] += faceStart[faceIdx];
+    memcpy(faceFill, faceStart, sizeof(faceFill));
+    for (int32_t idx = 0; idx < pointNum; idx++) {
+        int32_t faceIdx = referencePoints[idx].faceIdx;
+        if (faceIdx >= 0 && faceIdx < FACE_NUMBER)
+            facePoints[faceFill[faceIdx]++] = referencePoints[idx];
+    }
     for (int32_t faceIdx = 0; faceIdx < FACE_NUMBER; faceIdx++)
-        CubemapGetViewportProjInFace(faceIdx, &referencePoints);
+        CubemapGetViewportProjInFace(faceIdx, facePoints + faceStart[faceIdx], faceStart[faceIdx + 1] - faceStart[faceIdx], &referencePoints[pointNum - 1]);
 
     ITileInfo* pTileInfoTmp = m_srd;
     int32_t selectedTilesNum = 0;
@@ -2257,7 +2548,6 @@ int32_t TgenViewport::cubemapSelectRegion()
             }
         }
     }
-    referencePoints.clear();
     dResult = (double)(clock() - lBefore) / CLOCKS_PER_SEC;
     SCVP_LOG(LOG_INFO, "Total Time for Cubemap tile selection: %f ms to find inside tile number is %d\n", dResult*1000, selectedTilesNum);
 
@@ -31,7 +31,6 @@
 
 #include <sstream>
 #include <vector>
-#include <list>
 
 /* The compare threshold of two double variables */
 #define DOUBLE_COMPARE_THRESH (-double(1e-8))
@@ -97,6 +96,31 @@ typedef struct SPHEREPOINT
     SPos cord2D;
 } SpherePoint;
 
+/*  Point projected to one cube face, the reference points of the cubemap tile selection */
+typedef struct CUBEMAPFACEPOINT
+{
+    int32_t  faceIdx;
+    POSType  x;
+    POSType  y;
+} CubemapFacePoint;
+
+/*  Pose-to-tile lookup table, one entry per quantized yaw/pitch */
+typedef struct TILELUT
+{
+    uint8_t  *occupancy;       ///< tileBytes per entry, one bit per tile in m_srd order
+    uint8_t  *faceMask;        ///< one byte per entry, bit i is set if face i has selected tiles
+    SPos     *upLeft;          ///< face regions shared by all the entries
+    SPos     *downRight;
+    uint32_t  yawNum;
+    uint32_t  pitchNum;
+    float     yawStep;
+    float     pitchStep;
+    uint32_t  tileNum;
+    uint32_t  tileBytes;
+    bool      refine;
+    bool      shared;          ///< the arrays belong to the viewport the table is shared from
+} TileLUT;
+
 /// generate viewport class
 class TgenViewport
 {
@@ -125,6 +149,8 @@ public:
     Param_VideoFPStruct m_paramVideoFP;
     SpherePoint   *m_pViewportHorizontalBoundaryPoints;
     SpherePoint   *m_pViewportVerticalBoundaryPoints;
+    TileLUT        m_tileLUT;
+    ViewportSolver m_viewportSolver;
     inline int32_t round(POSType t) { return (int32_t)(t+ (t>=0? 0.5 :-0.5)); }
 
 public:
@@ -140,6 +166,11 @@ public:
     int32_t  convert();
     int32_t  ERPSelectRegion(short inputWidth, short inputHeight, short dstWidth, short dstHeight);
     int32_t  cubemapSelectRegion();
+    int32_t  selectRegion(short inputWidth, short inputHeight, short dstWidth, short dstHeight);
+    int32_t  buildTileLUT(uint32_t memoryBudget, float angleStep, bool refine, short inputWidth, short inputHeight, short dstWidth, short dstHeight);
+    int32_t  selectRegionByTileLUT();
+    void     shareTileLUT(const TgenViewport& src);
+    void     releaseTileLUT();
     //analysis;
     bool     isInside(int32_t x, int32_t y, int32_t width, int32_t height, int32_t faceId);
     //int32_t  CubemapIsInsideFaces();
@@ -209,24 +240,29 @@ private:
      *                             offen in the up or left direction  *
      *        downRightPoint:      The second given point which is    *
      *                             in the down or right direction     *
-     *        crossBoundaryPoints: The list which stores the crossing *
+     *        crossBoundaryPoints: The array which stores the crossing*
      *                             point of the cube's boundary and   *
      *                             connection line of the two input   *
-     *                             points                             *
+     *                             points, the points are appended    *
+     *        pPointNum:           The point number in the array      *
      *    Return:                                                     *
      *        Error code                                              */
-    int32_t CubemapGetFaceBoundaryCrossingPoints(SpherePoint* upLeftPoint, SpherePoint* downRightPoint, std::list<SpherePoint>* crossBoundaryPoints);
+    int32_t CubemapGetFaceBoundaryCrossingPoints(SpherePoint* upLeftPoint, SpherePoint* downRightPoint, CubemapFacePoint* crossBoundaryPoints, int32_t* pPointNum);
      /* CubemapGetViewportProjInFace:  Calculate the projection of   *
       *                                the viewport on the give      *
       *                                cube face                     *
       *    Param:                                                    *
       *        faceId:            The face Id                        *
-      *        refBoundaryPoints: The reference points in a list     *
+      *        pointsInFace:      The reference points on the face   *
       *                           which can provide the              *
-      *                           projection area on each face       *
+      *                           projection area on the face        *
+      *        pointNum:          The reference point number         *
+      *        lastPoint:         The last reference point of all    *
+      *                           faces, it gives the tile of a face *
+      *                           with a single reference point      *
       *    Return:                                                   *
       *        error code                                            */
-    int32_t CubemapGetViewportProjInFace(int32_t faceId, std::list<SpherePoint>* crossBoundaryPoints);
+    int32_t CubemapGetViewportProjInFace(int32_t faceId, CubemapFacePoint* pointsInFace, int32_t pointNum, CubemapFacePoint* lastPoint);
 };// END CLASS DEFINITION
 
 //! \}
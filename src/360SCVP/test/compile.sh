@@ -8,6 +8,9 @@ g++ -I../../google_test -std=c++11 -I../util/ -g  -c testI360SCVP_cubemap.cpp -D
 g++ -I../../google_test -std=c++11 -I../util/ -g  -c testI360SCVP_novelview.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../../google_test -std=c++11 -I../util/ -g  -c testI360SCVP_rotationConvert.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../../google_test -std=c++11 -I../util/ -g  -c testI360SCVP_xmlParsing.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../google_test -std=c++11 -I../util/ -g  -c testI360SCVP_bitstream.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../google_test -std=c++11 -I../util/ -g  -c testI360SCVP_naluScan.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../google_test -std=c++11 -I../util/ -O2 -g  -c testI360SCVP_perf.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 
 LD_FLAGS="-I/usr/local/include/ -l360SCVP -lstdc++ -lpthread -lm -L/usr/local/lib -D_GLIBCXX_DEBUG=1"
 g++ -L/usr/local/lib testI360SCVP_common.o libgtest.a -o testI360SCVP_common ${LD_FLAGS}
@@ -16,6 +19,9 @@ g++ -L/usr/local/lib testI360SCVP_cubemap.o libgtest.a -o testI360SCVP_cubemap $
 g++ -L/usr/local/lib testI360SCVP_novelview.o libgtest.a -o testI360SCVP_novelview ${LD_FLAGS}
 g++ -L/usr/local/lib testI360SCVP_rotationConvert.o libgtest.a -o testI360SCVP_rotationConvert ${LD_FLAGS}
 g++ -L/usr/local/lib testI360SCVP_xmlParsing.o libgtest.a -o testI360SCVP_xmlParsing ${LD_FLAGS}
+g++ -L/usr/local/lib testI360SCVP_bitstream.o libgtest.a -o testI360SCVP_bitstream ${LD_FLAGS}
+g++ -L/usr/local/lib testI360SCVP_naluScan.o libgtest.a -o testI360SCVP_naluScan ${LD_FLAGS}
+g++ -L/usr/local/lib testI360SCVP_perf.o libgtest.a -o testI360SCVP_perf ${LD_FLAGS}
 
 ./testI360SCVP_common
 ./testI360SCVP_erp
@@ -23,3 +29,6 @@ g++ -L/usr/local/lib testI360SCVP_xmlParsing.o libgtest.a -o testI360SCVP_xmlPar
 ./testI360SCVP_novelview
 ./testI360SCVP_rotationConvert
 ./testI360SCVP_xmlParsing
+./testI360SCVP_bitstream
+./testI360SCVP_naluScan
+./testI360SCVP_perf --gtest_output=xml:testI360SCVP_perf.xml
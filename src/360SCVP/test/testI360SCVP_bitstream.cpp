@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+#include "../360SCVPAPI.h"
+#include "../360SCVPBitstream.h"
+#include "../../utils/PerfBench.h"
+
+#include "../../utils/safe_mem.h"
+
+namespace{
+
+//bit-by-bit reader, same behavior as the reader before the word cache was added
+class RefBitReader
+{
+public:
+    RefBitReader(const uint8_t *data, uint64_t size) : m_data(data), m_size(size), m_bitPos(0) {}
+
+    uint32_t ReadBit()
+    {
+        if ((m_bitPos >> 3) >= m_size)
+            return 0;
+        uint32_t bit = (m_data[m_bitPos >> 3] >> (7 - (m_bitPos & 7))) & 1;
+        m_bitPos++;
+        return bit;
+    }
+
+    uint32_t ReadInt(uint32_t nBits)
+    {
+        uint32_t ret = 0;
+        while (nBits-- > 0)
+            ret = (ret << 1) | ReadBit();
+        return ret;
+    }
+
+    uint32_t ReadUE()
+    {
+        uint32_t leadingZeros = 0;
+        while (!ReadBit() && leadingZeros < 32)
+            leadingZeros++;
+        return ((1u << leadingZeros) | ReadInt(leadingZeros)) - 1;
+    }
+
+    uint64_t BitPos() { return m_bitPos; }
+
+private:
+    const uint8_t *m_data;
+    uint64_t       m_size;
+    uint64_t       m_bitPos;
+};
+
+//plain bit writer without emulation prevention, used to build test patterns
+class RefBitWriter
+{
+public:
+    void WriteInt(uint32_t value, uint32_t nBits)
+    {
+        while (nBits-- > 0)
+        {
+            if (!(m_bitPos & 7))
+                m_data.push_back(0);
+            if ((value >> nBits) & 1)
+                m_data.back() |= (uint8_t)(0x80 >> (m_bitPos & 7));
+            m_bitPos++;
+        }
+    }
+
+    void WriteUE(uint32_t value)
+    {
+        uint64_t codeNum = (uint64_t)value + 1;
+        uint32_t len = 0;
+        while ((codeNum >> (len + 1)) != 0)
+            len++;
+        WriteInt(0, len);
+        WriteInt(1, 1);
+        WriteInt((uint32_t)(codeNum & ((1ull << len) - 1)), len);
+    }
+
+    std::vector<uint8_t> m_data;
+    uint64_t             m_bitPos = 0;
+};
+
+class I360SCVPTest_bitstream : public testing::Test {
+public:
+    virtual void SetUp()
+    {
+      m_seed = 0x1234567;
+    }
+    virtual void TearDown()
+    {
+    }
+
+    uint32_t Random()
+    {
+      m_seed = m_seed * 1103515245 + 12345;
+      return (m_seed >> 8);
+    }
+
+    std::vector<uint8_t> ReadFile(const char *name)
+    {
+      std::vector<uint8_t> data;
+      FILE *pFile = fopen(name, "rb");
+      if (!pFile)
+        return data;
+      fseek(pFile, 0, SEEK_END);
+      long size = ftell(pFile);
+      fseek(pFile, 0, SEEK_SET);
+      data.resize(size);
+      size = fread(data.data(), 1, size, pFile);
+      data.resize(size);
+      fclose(pFile);
+      return data;
+    }
+
+    uint32_t m_seed;
+};
+
+TEST_F(I360SCVPTest_bitstream, ReadInt)
+{
+    std::vector<uint8_t> data(65536);
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = (uint8_t)Random();
+
+    GTS_BitStream *bs = gts_bs_new((const int8_t*)data.data(), data.size(), GTS_BITSTREAM_READ);
+    EXPECT_TRUE(bs != NULL);
+    if (!bs)
+      return;
+    RefBitReader ref(data.data(), data.size());
+
+    int ret = 0;
+    //read to the end, mixing in single bit reads
+    while (ref.BitPos() < data.size() * 8)
+    {
+      uint32_t nBits = (Random() % 4) ? (Random() % 32 + 1) : 1;
+      if (ref.BitPos() + nBits > data.size() * 8)
+        nBits = (uint32_t)(data.size() * 8 - ref.BitPos());
+      if (gts_bs_read_int(bs, nBits) != ref.ReadInt(nBits))
+        ret = 1;
+      if (gts_bs_get_bit_offset(bs) != ref.BitPos())
+        ret = 1;
+      if (ret)
+        break;
+    }
+    gts_bs_del(bs);
+    EXPECT_TRUE(ret == 0);
+}
+
+TEST_F(I360SCVPTest_bitstream, SeekAndPeek)
+{
+    std::vector<uint8_t> data(4096);
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = (uint8_t)Random();
+
+    GTS_BitStream *bs = gts_bs_new((const int8_t*)data.data(), data.size(), GTS_BITSTREAM_READ);
+    EXPECT_TRUE(bs != NULL);
+    if (!bs)
+      return;
+
+    int ret = 0;
+    for (int loop = 0; loop < 1000; loop++)
+    {
+      uint64_t offset = Random() % (data.size() - 8);
+      uint32_t skip = Random() % 8;
+      gts_bs_seek(bs, offset);
+      gts_bs_read_int(bs, skip);
+
+      RefBitReader ref(data.data(), data.size());
+      for (uint64_t bit = 0; bit < offset * 8 + skip; bit++)
+        ref.ReadBit();
+      uint32_t nBits = Random() % 24 + 1;
+      uint32_t expected = ref.ReadInt(nBits);
+
+      if (gts_bs_peek_bits(bs, nBits, 0) != expected)
+        ret = 1;
+      if (gts_bs_read_int(bs, nBits) != expected)
+        ret = 1;
+      if (gts_bs_align(bs) != (uint8_t)(8 - ((skip + nBits) & 7)) && ((skip + nBits) & 7))
+        ret = 1;
+      if (ret)
+        break;
+    }
+    gts_bs_del(bs);
+    EXPECT_TRUE(ret == 0);
+}
+
+TEST_F(I360SCVPTest_bitstream, ReadExpGolomb)
+{
+    RefBitWriter writer;
+    std::vector<uint32_t> values;
+    for (int i = 0; i < 100000; i++)
+    {
+      uint32_t shift = Random() % 32;
+      uint32_t value = (Random() & ((1u << shift) - 1)) + ((shift == 31) ? Random() : 0);
+      if (value == 0xFFFFFFFF)
+        value--;
+      values.push_back(value);
+      writer.WriteUE(value);
+      //break the byte alignment between the code words
+      writer.WriteInt(Random() & 1, 1);
+    }
+
+    GTS_BitStream *bs = gts_bs_new((const int8_t*)writer.m_data.data(), writer.m_data.size(), GTS_BITSTREAM_READ);
+    EXPECT_TRUE(bs != NULL);
+    if (!bs)
+      return;
+    RefBitReader ref(writer.m_data.data(), writer.m_data.size());
+
+    int ret = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      uint32_t ue = gts_bs_read_ue(bs);
+      if ((ue != values[i]) || (ue != ref.ReadUE()))
+        ret = 1;
+      if (gts_bs_read_int(bs, 1) != ref.ReadInt(1))
+        ret = 1;
+      if (ret)
+        break;
+    }
+    EXPECT_TRUE(gts_bs_get_bit_offset(bs) == writer.m_bitPos);
+    gts_bs_del(bs);
+    EXPECT_TRUE(ret == 0);
+
+    //se(v) mapping: 0, 1, -1, 2, -2 ...
+    RefBitWriter seWriter;
+    for (uint32_t i = 0; i < 5; i++)
+      seWriter.WriteUE(i);
+    bs = gts_bs_new((const int8_t*)seWriter.m_data.data(), seWriter.m_data.size(), GTS_BITSTREAM_READ);
+    EXPECT_TRUE(bs != NULL);
+    if (!bs)
+      return;
+    EXPECT_TRUE(gts_bs_read_se(bs) == 0);
+    EXPECT_TRUE(gts_bs_read_se(bs) == 1);
+    EXPECT_TRUE(gts_bs_read_se(bs) == -1);
+    EXPECT_TRUE(gts_bs_read_se(bs) == 2);
+    EXPECT_TRUE(gts_bs_read_se(bs) == -2);
+    gts_bs_del(bs);
+}
+
+TEST_F(I360SCVPTest_bitstream, ExpGolombMatchesReference)
+{
+    RefBitWriter writer;
+    const int valueNum = 20000;
+    for (int i = 0; i < valueNum; i++)
+      writer.WriteUE(Random() & ((1u << (Random() % 12)) - 1));
+
+    RefBitReader ref(writer.m_data.data(), writer.m_data.size());
+    uint32_t refSum = 0;
+    for (int i = 0; i < valueNum; i++)
+      refSum += ref.ReadUE();
+
+    GTS_BitStream *bs = gts_bs_new((const int8_t*)writer.m_data.data(), writer.m_data.size(), GTS_BITSTREAM_READ);
+    EXPECT_TRUE(bs != NULL);
+    if (!bs)
+      return;
+    uint32_t sum = 0;
+    for (int i = 0; i < valueNum; i++)
+      sum += gts_bs_read_ue(bs);
+    gts_bs_del(bs);
+
+    EXPECT_TRUE(sum == refSum);
+}
+
+TEST_F(I360SCVPTest_bitstream, ExpGolombPerf)
+{
+    if (!VCD::PerfBench::Enabled())
+      return;
+
+    RefBitWriter writer;
+    const int valueNum = 1000000;
+    for (int i = 0; i < valueNum; i++)
+      writer.WriteUE(Random() & ((1u << (Random() % 12)) - 1));
+
+    uint32_t refSum = 0;
+    double refMs = VCD::PerfBench::MeasureMs([&]() {
+      RefBitReader ref(writer.m_data.data(), writer.m_data.size());
+      for (int i = 0; i < valueNum; i++)
+        refSum += ref.ReadUE();
+    });
+
+    GTS_BitStream *bs = gts_bs_new((const int8_t*)writer.m_data.data(), writer.m_data.size(), GTS_BITSTREAM_READ);
+    EXPECT_TRUE(bs != NULL);
+    if (!bs)
+      return;
+    uint32_t sum = 0;
+    double ms = VCD::PerfBench::MeasureMs([&]() {
+      for (int i = 0; i < valueNum; i++)
+        sum += gts_bs_read_ue(bs);
+    });
+    gts_bs_del(bs);
+
+    EXPECT_TRUE(sum == refSum);
+    VCD::PerfBench::PerfReport("ExpGolomb")
+      .Add("bit_by_bit_ns_per_op", refMs * 1000000 / valueNum)
+      .Add("word_cache_ns_per_op", ms * 1000000 / valueNum)
+      .Print();
+}
+
+TEST_F(I360SCVPTest_bitstream, ParseNALPerf)
+{
+    const char *files[] = { "./test.265", "./test_low.265", "./testCube.265", "./testCube_low.265" };
+    for (uint32_t fileIdx = 0; fileIdx < sizeof(files) / sizeof(files[0]); fileIdx++)
+    {
+      std::vector<uint8_t> data = ReadFile(files[fileIdx]);
+      if (data.empty())
+        continue;
+
+      param_360SCVP param;
+      memset_s((void*)&param, sizeof(param_360SCVP), 0);
+      param.usedType = E_PARSER_ONENAL;
+      param.frameWidth = 3840;
+      param.frameHeight = 2048;
+      param.frameWidthLow = 1280;
+      param.frameHeightLow = 768;
+      void* pI360SCVP = I360SCVP_Init(&param);
+      EXPECT_TRUE(pI360SCVP != NULL);
+      if (!pI360SCVP)
+        return;
+
+      //the unit run parses the file once, the benchmark repeats it
+      const int loopNum = VCD::PerfBench::Enabled() ? 20 : 1;
+      uint64_t parsedBytes = 0;
+      uint32_t nalNum = 0;
+      int ret = 0;
+      double ms = VCD::PerfBench::MeasureMs([&]() {
+        for (int loop = 0; loop < loopNum && !ret; loop++)
+        {
+          uint64_t offset = 0;
+          while (offset + 4 < data.size())
+          {
+            Nalu nal;
+            nal.data = data.data() + offset;
+            nal.dataSize = (int32_t)(data.size() - offset);
+            ret = I360SCVP_ParseNAL(&nal, pI360SCVP);
+            if (ret || nal.dataSize <= 0)
+              break;
+            offset += nal.dataSize;
+            nalNum++;
+          }
+          parsedBytes += offset;
+        }
+      });
+      I360SCVP_unInit(pI360SCVP);
+      EXPECT_TRUE(ret == 0);
+      EXPECT_TRUE(nalNum > 0);
+
+      if (VCD::PerfBench::Enabled())
+      {
+        std::string caseName = std::string("ParseNAL_") + (files[fileIdx] + 2);
+        VCD::PerfBench::PerfReport(caseName.c_str())
+          .Add("nals", (uint64_t)nalNum)
+          .Add("us_per_nal", nalNum ? ms * 1000 / nalNum : 0)
+          .Add("mb_per_s", ms > 0 ? parsedBytes / (ms * 1000) : 0)
+          .Print();
+      }
+    }
+}
+
+}
@@ -280,6 +280,78 @@ TEST_F(I360SCVPTest_common, GenerateSPS_PPS_SliceHdr)
     EXPECT_TRUE(ret == 0);
 }
 
+TEST_F(I360SCVPTest_common, SliceHdrTemplate)
+{
+    param.usedType = E_PARSER_ONENAL;
+    void* pCached = I360SCVP_Init(&param);
+    void* pFull = I360SCVP_Init(&param);
+    EXPECT_TRUE(pCached != NULL);
+    EXPECT_TRUE(pFull != NULL);
+    if (!pCached || !pFull)
+    {
+        I360SCVP_unInit(pCached);
+        I360SCVP_unInit(pFull);
+        return;
+    }
+
+    unsigned char* pFullOutput = new unsigned char[bufferlen];
+    unsigned char* pInputBufferTmp = pInputBuffer;
+    int32_t left = bufferlen;
+    int32_t tileIdx = 0;
+    int32_t sliceNum = 0;
+    Nalu ppsNal;
+    memset_s(&ppsNal, sizeof(Nalu), 0);
+
+    while (left > 0)
+    {
+        Nalu nal;
+        nal.data = pInputBufferTmp;
+        nal.dataSize = left;
+        if (I360SCVP_ParseNAL(&nal, pCached))
+            break;
+        Nalu nalFull = nal;
+        nalFull.dataSize = left;
+        I360SCVP_ParseNAL(&nalFull, pFull);
+        if (nal.naluType == 34)
+            ppsNal = nal;
+
+        if (nal.naluType < 32 && ppsNal.data)
+        {
+            tileIdx = (nal.data[nal.startCodesSize + 2] & 0x80) ? 0 : tileIdx + 1;
+
+            param_360SCVP paramCached = param;
+            paramCached.pInputBitstream = nal.data;
+            paramCached.inputBitstreamLen = nal.dataSize;
+            paramCached.destWidth = 1920;
+            paramCached.destHeight = 1024;
+            param_360SCVP paramFull = paramCached;
+            paramFull.pOutputBitstream = pFullOutput;
+
+            //the second call of the same slice always uses the template
+            EXPECT_TRUE(I360SCVP_GenerateSliceHdr(&paramCached, tileIdx * 2, pCached) == 0);
+            EXPECT_TRUE(I360SCVP_GenerateSliceHdr(&paramCached, tileIdx * 2, pCached) == 0);
+
+            //parsing a parameter set drops the templates, so the full path generates the reference
+            Nalu ppsFull = ppsNal;
+            I360SCVP_ParseNAL(&ppsFull, pFull);
+            EXPECT_TRUE(I360SCVP_GenerateSliceHdr(&paramFull, tileIdx * 2, pFull) == 0);
+
+            EXPECT_TRUE(paramCached.outputBitstreamLen == paramFull.outputBitstreamLen);
+            if (paramCached.outputBitstreamLen == paramFull.outputBitstreamLen)
+                EXPECT_TRUE(memcmp(pOutputBuffer, pFullOutput, paramFull.outputBitstreamLen) == 0);
+            sliceNum++;
+        }
+
+        pInputBufferTmp += nal.dataSize;
+        left -= nal.dataSize;
+    }
+    EXPECT_TRUE(sliceNum > 0);
+
+    delete[] pFullOutput;
+    I360SCVP_unInit(pCached);
+    I360SCVP_unInit(pFull);
+}
+
 TEST_F(I360SCVPTest_common, GetParameter_PicInfo_type0)
 {
     int ret = 0;
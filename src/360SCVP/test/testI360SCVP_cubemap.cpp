@@ -27,11 +27,97 @@
 #include "gtest/gtest.h"
 #include <string>
 #include <fstream>
+#include <set>
 #include "../360SCVPAPI.h"
+#include "../../utils/PerfBench.h"
 
 #include "../../utils/safe_mem.h"
 
 namespace{
+
+//selected tiles of the handle for one pose, keyed by tile index and face
+std::set<int32_t> SelectTiles(void* pI360SCVP, param_360SCVP* pParam, float yaw, float pitch)
+{
+    std::set<int32_t> tiles;
+    TileDef pOutTile[1024];
+    Param_ViewportOutput paramViewportOutput;
+    I360SCVP_setViewPort(pI360SCVP, yaw, pitch);
+    I360SCVP_process(pParam, pI360SCVP);
+    int32_t tileNum = I360SCVP_getTilesInViewport(pOutTile, &paramViewportOutput, pI360SCVP);
+    for (int32_t i = 0; i < tileNum; i++)
+        tiles.insert(pOutTile[i].idx * 8 + pOutTile[i].faceId);
+    return tiles;
+}
+
+//tiles selected on a 4x4-tile 2048x2048 face cubemap before the reference
+//points were bucketed by face, one bit per tile index
+struct CubemapPoseTiles
+{
+    int16_t  fov;
+    int16_t  yaw;
+    int16_t  pitch;
+    uint32_t tiles[3];
+};
+
+const CubemapPoseTiles cubemapRefTiles[] = {
+    {  80, -180, -90, 0x00000000, 0xffff0000, 0x00000000 }, {  80, -140, -90, 0x60006000, 0xffff0000, 0x60006000 },
+    {  80,  -95, -90, 0x00000000, 0xffff0000, 0x00000000 }, {  80,  -50, -90, 0x60006000, 0xffff0000, 0x60006000 },
+    {  80,   -5, -90, 0x00000000, 0xffff0000, 0x00000000 }, {  80,   40, -90, 0x60006000, 0xffff0000, 0x60006000 },
+    {  80,   85, -90, 0x00000000, 0xffff0000, 0x00000000 }, {  80,  130, -90, 0x60006000, 0xffff0000, 0x60006000 },
+    {  80, -180, -60, 0xff000000, 0x7fff0000, 0x80001000 }, {  80, -140, -60, 0xee000000, 0x3fff0000, 0x00007300 },
+    {  80,  -95, -60, 0xc0001000, 0x0fff0000, 0x0000ff00 }, {  80,  -50, -60, 0x00007300, 0x4fff0000, 0x0000ee00 },
+    {  80,   -5, -60, 0x0000ff00, 0xefff0000, 0x1000c000 }, {  80,   40, -60, 0x0000ee00, 0xefff0000, 0x73000000 },
+    {  80,   85, -60, 0x1000c000, 0xfff00000, 0xff000000 }, {  80,  130, -60, 0x73000000, 0xfff70000, 0xee000000 },
+    {  80, -180, -35, 0xfff00000, 0x37330000, 0x80001000 }, {  80, -140, -35, 0xefe00000, 0x037f0000, 0x00007330 },
+    {  80,  -95, -35, 0x88000000, 0x00fe0000, 0x0000fff0 }, {  80,  -50, -35, 0x00007330, 0x0cff0000, 0x0000efe0 },
+    {  80,   -5, -35, 0x0000fff0, 0xceec0000, 0x00008800 }, {  80,   40, -35, 0x0000efe0, 0xeec00000, 0x73300000 },
+    {  80,   85, -35, 0x00008800, 0xff000000, 0xfff00000 }, {  80,  130, -35, 0x73300000, 0x77300000, 0xefe00000 },
+    {  80, -180, -10, 0xffff0000, 0x11110000, 0x00000000 }, {  80, -140, -10, 0xeefe0000, 0x00130000, 0x00002333 },
+    {  80,  -95, -10, 0x88000000, 0x000f0000, 0x0000ffff }, {  80,  -50, -10, 0x00002333, 0x008c0000, 0x0000eefe },
+    {  80,   -5, -10, 0x0000ffff, 0x88880000, 0x00008800 }, {  80,   40, -10, 0x0000eefe, 0xc8000000, 0x23330000 },
+    {  80,   85, -10, 0x00008800, 0xf0000000, 0xffff0000 }, {  80,  130, -10, 0x23330000, 0x31000000, 0xeefe0000 },
+    {  80, -180,  15, 0x0fff0000, 0x00001111, 0x00080001 }, {  80, -140,  15, 0xccef0000, 0x00003110, 0x00001f32 },
+    {  80,  -95,  15, 0x00880000, 0x0000f000, 0x00000fff }, {  80,  -50,  15, 0x00001f32, 0x0000e800, 0x0000ccef },
+    {  80,   -5,  15, 0x00000fff, 0x00008888, 0x00000088 }, {  80,   40,  15, 0x0000ccef, 0x000008cc, 0x1f320000 },
+    {  80,   85,  15, 0x00000088, 0x0000000f, 0x0fff0000 }, {  80,  130,  15, 0x1f320000, 0x00000037, 0xccef0000 },
+    {  80, -180,  45, 0x00ff0000, 0x00003777, 0x00080001 }, {  80, -140,  45, 0x00ee0000, 0x00007f70, 0x00000037 },
+    {  80,  -95,  45, 0x00880001, 0x0000ff00, 0x000000fe }, {  80,  -50,  45, 0x00000037, 0x0000efe0, 0x000000ee },
+    {  80,   -5,  45, 0x000000fe, 0x0000ceff, 0x00010088 }, {  80,   40,  45, 0x000000ee, 0x00000cff, 0x00370000 },
+    {  80,   85,  45, 0x00010088, 0x000000ff, 0x00fe0000 }, {  80,  130,  45, 0x00370000, 0x000003ff, 0x00ee0000 },
+    {  80, -180,  75, 0x000f0000, 0x00007fff, 0x00080001 }, {  80, -140,  75, 0x000e0000, 0x0000ffff, 0x00000007 },
+    {  80,  -95,  75, 0x00080000, 0x0000ffff, 0x0000000f }, {  80,  -50,  75, 0x00000007, 0x0000ffff, 0x0000000e },
+    {  80,   -5,  75, 0x0000000f, 0x0000ffff, 0x00000008 }, {  80,   40,  75, 0x0000000e, 0x0000efff, 0x00070000 },
+    {  80,   85,  75, 0x00000008, 0x0000cfff, 0x000f0000 }, {  80,  130,  75, 0x00070000, 0x00007fff, 0x000e0000 },
+    { 170, -180, -90, 0xff00ff00, 0xffff0000, 0x66006600 }, { 170, -140, -90, 0xff00ff00, 0xffff0000, 0xff00ff00 },
+    { 170,  -95, -90, 0xef00ef00, 0xfff60000, 0xef00ef00 }, { 170,  -50, -90, 0xff00ff00, 0xffff0000, 0xff00ff00 },
+    { 170,   -5, -90, 0xef00ef00, 0xfff60000, 0xef00ef00 }, { 170,   40, -90, 0xff00ff00, 0xffff0000, 0xff00ff00 },
+    { 170,   85, -90, 0xef00ef00, 0xfff60000, 0xef00ef00 }, { 170,  130, -90, 0xff00ff00, 0xffff0000, 0xff00ff00 },
+    { 170, -180, -60, 0x66f0f000, 0xffff0000, 0xfec0f730 }, { 170, -140, -60, 0xfff8f300, 0xffff0000, 0xfc00fff1 },
+    { 170,  -95, -60, 0xfec0f730, 0xffff0000, 0x70006ff0 }, { 170,  -50, -60, 0xfc00fff1, 0xffff0000, 0xf300fff8 },
+    { 170,   -5, -60, 0x70006ff0, 0xffff0000, 0xf730fec0 }, { 170,   40, -60, 0xf300fff8, 0xffff0000, 0xfff1fc00 },
+    { 170,   85, -60, 0xf730fec0, 0xffff0000, 0x6ff07000 }, { 170,  130, -60, 0xfff1fc00, 0xffff0000, 0xfff8f300 },
+    { 170, -180, -35, 0xffff0000, 0x8ff81111, 0xfec8f731 }, { 170, -140, -35, 0xfffff100, 0x4ef13100, 0xc8007fe6 },
+    { 170,  -95, -35, 0xfec87731, 0xf666f000, 0x0000ffff }, { 170,  -50, -35, 0xc8007fe6, 0x67c8c800, 0xf100ffff },
+    { 170,   -5, -35, 0x0000ffff, 0x1ff18888, 0x7731fec8 }, { 170,   40, -35, 0xf100ffff, 0xc772008c, 0x7fe6c800 },
+    { 170,   85, -35, 0x7731fec8, 0x667f000f, 0xffff0000 }, { 170,  130, -35, 0x7fe6c800, 0x3ee60013, 0xfffff100 },
+    { 170, -180, -10, 0xfff60000, 0x47742332, 0x6cc42332 }, { 170, -140, -10, 0xffff0000, 0x37ff7731, 0x88008fc8 },
+    { 170,  -95, -10, 0x2ec43333, 0x0f766700, 0x0000fffe }, { 170,  -50, -10, 0x88008fc8, 0xcefffec0, 0x0000ffff },
+    { 170,   -5, -10, 0x0000fffe, 0x2ee24cc0, 0x33332ec4 }, { 170,   40, -10, 0x0000ffff, 0xfee88cee, 0x8fc88800 },
+    { 170,   85, -10, 0x33332ec4, 0xeef000e6, 0xfffe0000 }, { 170,  130, -10, 0x8fc88800, 0xf771037f, 0xffff0000 },
+    { 170, -180,  15, 0xffff0000, 0x23324774, 0x4cee2377 }, { 170, -140,  15, 0xffff0000, 0x1337f771, 0x0088cff8 },
+    { 170,  -95,  15, 0x4ce23337, 0x007677f0, 0x0000fffe }, { 170,  -50,  15, 0x0088cff8, 0x08effee8, 0x0000ffff },
+    { 170,   -5,  15, 0x0000fffe, 0x0cc42ee2, 0x33374ce2 }, { 170,   40,  15, 0x0000ffff, 0xec88ceff, 0xcff80088 },
+    { 170,   85,  15, 0x33374ce2, 0xee000fe6, 0xfffe0000 }, { 170,  130,  15, 0xcff80088, 0xf31037ff, 0xffff0000 },
+    { 170, -180,  45, 0xffff0000, 0x00008ff8, 0x8cef137f }, { 170, -140,  45, 0xeffc0017, 0x0001ffff, 0x00ce7ff3 },
+    { 170,  -95,  45, 0x8cef137f, 0x0000ffff, 0x0000f662 }, { 170,  -50,  45, 0x00ce7ff3, 0x0008ffff, 0x0017effc },
+    { 170,   -5,  45, 0x0000f662, 0x0000ffff, 0x137f8cef }, { 170,   40,  45, 0x0017effc, 0x8c46ffff, 0x7ff300ce },
+    { 170,   85,  45, 0x137f8cef, 0x0000ffff, 0xf6620000 }, { 170,  130,  45, 0x7ff300ce, 0x1111ffff, 0xeffc0017 },
+    { 170, -180,  75, 0x0f6600f6, 0x0000fff7, 0x0cfe03f7 }, { 170, -140,  75, 0x0ff600ff, 0x0000ffff, 0x00ff07f7 },
+    { 170,  -95,  75, 0x0cfe03f6, 0x0000fff7, 0x00fe0fe6 }, { 170,  -50,  75, 0x00ff07f7, 0x0000ffff, 0x00ff0ff6 },
+    { 170,   -5,  75, 0x00fe0fe6, 0x0000fff6, 0x03f60cfe }, { 170,   40,  75, 0x00ff0ff6, 0x0000ffff, 0x07f700ff },
+    { 170,   85,  75, 0x03f60cfe, 0x0000fffe, 0x0fe600fe }, { 170,  130,  75, 0x07f700ff, 0x0000ffff, 0x0ff600ff }
+};
+
 class I360SCVPTest_cubemap : public testing::Test {
 public:
     virtual void SetUp()
@@ -290,4 +376,179 @@ TEST_F(I360SCVPTest_cubemap, GetTilesInViewport)
     EXPECT_TRUE(ret >= 0);
 }
 
+TEST_F(I360SCVPTest_cubemap, TileLookupTable)
+{
+    param.paramViewPort.faceWidth = 512 * 4;
+    param.paramViewPort.faceHeight = 512 * 4;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_CUBEMAP);
+    param.paramViewPort.viewportHeight = 960;
+    param.paramViewPort.viewportWidth = 960;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 4;
+    param.paramViewPort.tileNumRow = 4;
+    param.paramViewPort.paramVideoFP.cols = 3;
+    param.paramViewPort.paramVideoFP.rows = 2;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 4;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[0][1].idFace = 0;
+    param.paramViewPort.paramVideoFP.faces[0][1].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[0][2].idFace = 5;
+    param.paramViewPort.paramVideoFP.faces[0][2].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[1][0].idFace = 3;
+    param.paramViewPort.paramVideoFP.faces[1][0].rotFace = ROTATION_180_ANTICLOCKWISE;
+    param.paramViewPort.paramVideoFP.faces[1][1].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[1][1].rotFace = ROTATION_270_ANTICLOCKWISE;
+    param.paramViewPort.paramVideoFP.faces[1][2].idFace = 2;
+    param.paramViewPort.paramVideoFP.faces[1][2].rotFace = NO_TRANSFORM;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 90;
+    param.usedType = E_VIEWPORT_ONLY;
+
+    void* pExact = I360SCVP_Init(&param);
+    void* pLookup = I360SCVP_Init(&param);
+    EXPECT_TRUE(pExact != NULL);
+    EXPECT_TRUE(pLookup != NULL);
+    if (!pExact || !pLookup)
+    {
+        I360SCVP_unInit(pExact);
+        I360SCVP_unInit(pLookup);
+        return;
+    }
+    param.usedType = E_PARSER_ONENAL;
+
+    //a budget too small for the coarsest step keeps the exact selection
+    Param_TileLUT paramLUT;
+    paramLUT.memoryBudget = 100;
+    paramLUT.angleStep = 0;
+    paramLUT.refine = false;
+    EXPECT_TRUE(I360SCVP_SetParameter(pLookup, ID_SCVP_PARAM_TILE_LUT, &paramLUT) != 0);
+
+    paramLUT.memoryBudget = 1 << 20;
+    paramLUT.angleStep = 10;
+    EXPECT_TRUE(I360SCVP_SetParameter(pLookup, ID_SCVP_PARAM_TILE_LUT, &paramLUT) == 0);
+
+    //grid poses are exact, other poses take the nearest grid pose
+    int ret = 0;
+    for (float pitch = -90; pitch <= 90 && !ret; pitch += 10)
+    {
+        for (float yaw = -180; yaw < 180 && !ret; yaw += 10)
+        {
+            if (SelectTiles(pExact, &param, yaw, pitch) != SelectTiles(pLookup, &param, yaw, pitch)
+                || SelectTiles(pExact, &param, yaw, pitch) != SelectTiles(pLookup, &param, yaw + 4.5, pitch - 4.5))
+            {
+                printf("tile lookup table mismatch at yaw %f pitch %f\n", yaw, pitch);
+                ret = 1;
+            }
+        }
+    }
+    EXPECT_TRUE(ret == 0);
+
+    if (VCD::PerfBench::Enabled())
+    {
+        const int loopNum = 1000;
+        double us[2];
+        void* handles[2] = { pExact, pLookup };
+        for (int i = 0; i < 2; i++)
+        {
+            us[i] = VCD::PerfBench::MeasureMs([&]() {
+                for (int loop = 0; loop < loopNum; loop++)
+                    SelectTiles(handles[i], &param, (float)(loop % 360 - 180), (float)(loop % 170 - 85));
+            }) * 1000 / loopNum;
+        }
+        VCD::PerfBench::PerfReport("CubemapTileLookupTable").Add("exact_us_per_pose", us[0]).Add("lut_us_per_pose", us[1]).Print();
+    }
+
+    I360SCVP_unInit(pExact);
+    I360SCVP_unInit(pLookup);
+}
+
+
+TEST_F(I360SCVPTest_cubemap, FaceCrossingSelection)
+{
+    param.paramViewPort.faceWidth = 512 * 4;
+    param.paramViewPort.faceHeight = 512 * 4;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_CUBEMAP);
+    param.paramViewPort.viewportHeight = 960;
+    param.paramViewPort.viewportWidth = 960;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 4;
+    param.paramViewPort.tileNumRow = 4;
+    param.paramViewPort.paramVideoFP.cols = 3;
+    param.paramViewPort.paramVideoFP.rows = 2;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 4;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[0][1].idFace = 0;
+    param.paramViewPort.paramVideoFP.faces[0][1].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[0][2].idFace = 5;
+    param.paramViewPort.paramVideoFP.faces[0][2].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[1][0].idFace = 3;
+    param.paramViewPort.paramVideoFP.faces[1][0].rotFace = ROTATION_180_ANTICLOCKWISE;
+    param.paramViewPort.paramVideoFP.faces[1][1].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[1][1].rotFace = ROTATION_270_ANTICLOCKWISE;
+    param.paramViewPort.paramVideoFP.faces[1][2].idFace = 2;
+    param.paramViewPort.paramVideoFP.faces[1][2].rotFace = NO_TRANSFORM;
+    param.usedType = E_VIEWPORT_ONLY;
+
+    //the widest viewport fills the reference point buffers of the face crossing search
+    float fov[2] = { 80, 170 };
+    for (int i = 0; i < 2; i++)
+    {
+        param.paramViewPort.viewPortFOVH = fov[i];
+        param.paramViewPort.viewPortFOVV = fov[i];
+        param.usedType = E_VIEWPORT_ONLY;
+        void* pI360SCVP = I360SCVP_Init(&param);
+        EXPECT_TRUE(pI360SCVP != NULL);
+        if (!pI360SCVP)
+            return;
+        param.usedType = E_PARSER_ONENAL;
+
+        TileDef pOutTile[1024];
+        Param_ViewportOutput paramViewportOutput;
+        int32_t faultNum = 0;
+        for (uint32_t pose = 0; pose < sizeof(cubemapRefTiles) / sizeof(cubemapRefTiles[0]); pose++)
+        {
+            const CubemapPoseTiles* pRef = &cubemapRefTiles[pose];
+            if (pRef->fov != fov[i])
+                continue;
+            I360SCVP_setViewPort(pI360SCVP, (float)pRef->yaw, (float)pRef->pitch);
+            int32_t tileNum = I360SCVP_getTilesInViewport(pOutTile, &paramViewportOutput, pI360SCVP);
+            uint32_t tiles[3] = { 0, 0, 0 };
+            for (int32_t k = 0; k < tileNum; k++)
+            {
+                if (pOutTile[k].idx >= 0 && pOutTile[k].idx < 96)
+                    tiles[pOutTile[k].idx / 32] |= 1u << (pOutTile[k].idx % 32);
+            }
+            if (tileNum <= 0 || tileNum > 6 * 16
+                || tiles[0] != pRef->tiles[0] || tiles[1] != pRef->tiles[1] || tiles[2] != pRef->tiles[2])
+            {
+                printf("cubemap tile selection mismatch with fov %.0f at yaw %d pitch %d\n", fov[i], pRef->yaw, pRef->pitch);
+                faultNum++;
+            }
+        }
+        EXPECT_TRUE(faultNum == 0);
+
+        if (VCD::PerfBench::Enabled())
+        {
+            int32_t poseNum = 0;
+            double ms = VCD::PerfBench::MeasureMs([&]() {
+                for (int pitch = -90; pitch <= 90; pitch += 5)
+                {
+                    for (int yaw = -180; yaw < 180; yaw += 5)
+                    {
+                        I360SCVP_setViewPort(pI360SCVP, (float)yaw, (float)pitch);
+                        I360SCVP_getTilesInViewport(pOutTile, &paramViewportOutput, pI360SCVP);
+                        poseNum++;
+                    }
+                }
+            });
+            VCD::PerfBench::PerfReport("FaceCrossingSelection")
+                .Add("fov", (double)fov[i])
+                .Add("us_per_pose", ms * 1000 / poseNum)
+                .Print();
+        }
+
+        I360SCVP_unInit(pI360SCVP);
+    }
+}
+
 }
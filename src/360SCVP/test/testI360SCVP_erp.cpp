@@ -27,11 +27,45 @@
 #include "gtest/gtest.h"
 #include <string>
 #include <fstream>
+#include <set>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <atomic>
+#include <vector>
 #include "../360SCVPAPI.h"
 
 #include "../../utils/safe_mem.h"
+#include "../../utils/PerfBench.h"
 
 namespace{
+
+//selected tiles of the handle for one pose, keyed by tile index and face
+std::set<int32_t> SelectTiles(void* pI360SCVP, param_360SCVP* pParam, float yaw, float pitch)
+{
+    std::set<int32_t> tiles;
+    TileDef pOutTile[1024];
+    Param_ViewportOutput paramViewportOutput;
+    I360SCVP_setViewPort(pI360SCVP, yaw, pitch);
+    I360SCVP_process(pParam, pI360SCVP);
+    int32_t tileNum = I360SCVP_getTilesInViewport(pOutTile, &paramViewportOutput, pI360SCVP);
+    for (int32_t i = 0; i < tileNum; i++)
+        tiles.insert(pOutTile[i].idx * 8 + pOutTile[i].faceId);
+    return tiles;
+}
+
+//tiles selected by the legacy way for one pose, which follow the viewport footprint in the source
+std::set<int32_t> SelectTilesByLegacyWay(void* pI360SCVP, float yaw, float pitch)
+{
+    std::set<int32_t> tiles;
+    TileDef pOutTile[1024];
+    I360SCVP_setViewPort(pI360SCVP, yaw, pitch);
+    int32_t tileNum = I360SCVP_GetTilesByLegacyWay(pOutTile, pI360SCVP);
+    for (int32_t i = 0; i < tileNum; i++)
+        tiles.insert(pOutTile[i].idx);
+    return tiles;
+}
+
 class I360SCVPTest_erp : public testing::Test {
 public:
     virtual void SetUp()
@@ -236,6 +270,70 @@ TEST_F(I360SCVPTest_erp, SetviewportAndMergeProcess)
     EXPECT_TRUE(ret == 0);
 }
 
+TEST_F(I360SCVPTest_erp, MergeSpans)
+{
+    param.paramViewPort.faceWidth = 3840;
+    param.paramViewPort.faceHeight = 2048;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+    param.paramViewPort.viewportHeight = 960;
+    param.paramViewPort.viewportWidth = 960;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.viewPortYaw = -90;
+    param.paramViewPort.viewPortPitch = 0;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 80;
+    param.usedType = E_MERGE_AND_VIEWPORT;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 0;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+
+    param_360SCVP paramSpan = param;
+    unsigned char* pHeaderBuffer = new unsigned char[bufferlen];
+    unsigned char* pFlatBuffer = new unsigned char[bufferlen];
+    paramSpan.pOutputBitstream = pHeaderBuffer;
+
+    void* pContiguous = I360SCVP_Init(&param);
+    void* pScatter = I360SCVP_Init(&paramSpan);
+    EXPECT_TRUE(pContiguous != NULL);
+    EXPECT_TRUE(pScatter != NULL);
+    if (!pContiguous || !pScatter)
+    {
+        I360SCVP_unInit(pContiguous);
+        I360SCVP_unInit(pScatter);
+        delete[] pHeaderBuffer;
+        delete[] pFlatBuffer;
+        return;
+    }
+
+    I360SCVP_setViewPort(pContiguous, param.paramViewPort.viewPortYaw, param.paramViewPort.viewPortPitch);
+    I360SCVP_setViewPort(pScatter, param.paramViewPort.viewPortYaw, param.paramViewPort.viewPortPitch);
+    int32_t ret = I360SCVP_process(&param, pContiguous);
+    EXPECT_TRUE(ret == 0);
+
+    MergeSpan spans[1024];
+    uint32_t spanNum = 1024;
+    ret = I360SCVP_processSpans(&paramSpan, pScatter, spans, &spanNum);
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(spanNum > 1);
+    EXPECT_TRUE(paramSpan.outputBitstreamLen == param.outputBitstreamLen);
+
+    int32_t flatLen = I360SCVP_flattenSpans(spans, spanNum, pFlatBuffer, bufferlen);
+    EXPECT_TRUE(flatLen == (int32_t)param.outputBitstreamLen);
+    if (flatLen == (int32_t)param.outputBitstreamLen)
+        EXPECT_TRUE(memcmp(pFlatBuffer, pOutputBuffer, flatLen) == 0);
+    EXPECT_TRUE(I360SCVP_flattenSpans(spans, spanNum, pFlatBuffer, flatLen - 1) < 0);
+
+    //too few spans must fail instead of truncating the frame
+    uint32_t fewSpans = 2;
+    I360SCVP_setViewPort(pScatter, param.paramViewPort.viewPortYaw, param.paramViewPort.viewPortPitch);
+    ret = I360SCVP_processSpans(&paramSpan, pScatter, spans, &fewSpans);
+    EXPECT_TRUE(ret != 0);
+
+    I360SCVP_unInit(pContiguous);
+    I360SCVP_unInit(pScatter);
+    delete[] pHeaderBuffer;
+    delete[] pFlatBuffer;
+}
+
 TEST_F(I360SCVPTest_erp, GetTilesInViewport)
 {
     int32_t tileNum_fast, tileNum_legacy;
@@ -282,4 +380,400 @@ TEST_F(I360SCVPTest_erp, GetTilesInViewport)
     EXPECT_TRUE(tileNum_legacy >= 0);
 }
 
+TEST_F(I360SCVPTest_erp, TileLookupTable)
+{
+    param.paramViewPort.faceWidth = 7680;
+    param.paramViewPort.faceHeight = 3840;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+    param.paramViewPort.viewportHeight = 1024;
+    param.paramViewPort.viewportWidth = 1024;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 20;
+    param.paramViewPort.tileNumRow = 10;
+    param.paramViewPort.paramVideoFP.cols = 1;
+    param.paramViewPort.paramVideoFP.rows = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceWidth = param.paramViewPort.faceWidth;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceHeight = param.paramViewPort.faceHeight;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 90;
+    param.usedType = E_VIEWPORT_ONLY;
+
+    void* pExact = I360SCVP_Init(&param);
+    void* pLookup = I360SCVP_Init(&param);
+    EXPECT_TRUE(pExact != NULL);
+    EXPECT_TRUE(pLookup != NULL);
+    if (!pExact || !pLookup)
+    {
+        I360SCVP_unInit(pExact);
+        I360SCVP_unInit(pLookup);
+        return;
+    }
+    param.usedType = E_PARSER_ONENAL;
+
+    //a budget too small for the coarsest step keeps the exact selection
+    Param_TileLUT paramLUT;
+    paramLUT.memoryBudget = 100;
+    paramLUT.angleStep = 0;
+    paramLUT.refine = false;
+    EXPECT_TRUE(I360SCVP_SetParameter(pLookup, ID_SCVP_PARAM_TILE_LUT, &paramLUT) != 0);
+
+    paramLUT.memoryBudget = 1 << 20;
+    paramLUT.angleStep = 10;
+    EXPECT_TRUE(I360SCVP_SetParameter(pLookup, ID_SCVP_PARAM_TILE_LUT, &paramLUT) == 0);
+
+    //grid poses are exact, other poses take the nearest grid pose
+    int ret = 0;
+    for (float pitch = -90; pitch <= 90 && !ret; pitch += 10)
+    {
+        for (float yaw = -180; yaw < 180 && !ret; yaw += 10)
+        {
+            if (SelectTiles(pExact, &param, yaw, pitch) != SelectTiles(pLookup, &param, yaw, pitch)
+                || SelectTiles(pExact, &param, yaw, pitch) != SelectTiles(pLookup, &param, yaw + 4.5, pitch - 4.5))
+            {
+                printf("tile lookup table mismatch at yaw %f pitch %f\n", yaw, pitch);
+                ret = 1;
+            }
+        }
+    }
+    EXPECT_TRUE(ret == 0);
+
+    if (VCD::PerfBench::Enabled())
+    {
+        const int loopNum = 1000;
+        double us[2];
+        void* handles[2] = { pExact, pLookup };
+        for (int i = 0; i < 2; i++)
+        {
+            us[i] = VCD::PerfBench::MeasureMs([&]() {
+                for (int loop = 0; loop < loopNum; loop++)
+                    SelectTiles(handles[i], &param, (float)(loop % 360 - 180), (float)(loop % 170 - 85));
+            }) * 1000 / loopNum;
+        }
+        VCD::PerfBench::PerfReport("TileLookupTable").Add("exact_us_per_pose", us[0]).Add("lut_us_per_pose", us[1]).Print();
+    }
+
+    I360SCVP_unInit(pExact);
+    I360SCVP_unInit(pLookup);
+}
+
+TEST_F(I360SCVPTest_erp, AnalyticViewportSolver)
+{
+    param.paramViewPort.faceWidth = 7680;
+    param.paramViewPort.faceHeight = 3840;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+    param.paramViewPort.viewportHeight = 512;
+    param.paramViewPort.viewportWidth = 512;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 20;
+    param.paramViewPort.tileNumRow = 10;
+    param.paramViewPort.paramVideoFP.cols = 1;
+    param.paramViewPort.paramVideoFP.rows = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceWidth = param.paramViewPort.faceWidth;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceHeight = param.paramViewPort.faceHeight;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 90;
+    param.usedType = E_VIEWPORT_ONLY;
+
+    void* pSweep = I360SCVP_Init(&param);
+    void* pAnalytic = I360SCVP_Init(&param);
+    EXPECT_TRUE(pSweep != NULL);
+    EXPECT_TRUE(pAnalytic != NULL);
+    if (!pSweep || !pAnalytic)
+    {
+        I360SCVP_unInit(pSweep);
+        I360SCVP_unInit(pAnalytic);
+        return;
+    }
+
+    int32_t solver = E_VIEWPORT_SOLVER_NUM;
+    EXPECT_TRUE(I360SCVP_SetParameter(pAnalytic, ID_SCVP_PARAM_VIEWPORT_SOLVER, &solver) != 0);
+    solver = E_VIEWPORT_SOLVER_ANALYTIC_ERP;
+    EXPECT_TRUE(I360SCVP_SetParameter(pAnalytic, ID_SCVP_PARAM_VIEWPORT_SOLVER, &solver) == 0);
+
+    //the sweep only splits the footprint at the seam if a pixel maps exactly to column 0,
+    //otherwise it takes the whole width, and the analytic tiles of such a pose are a part of
+    //it; away from the seam both ways select the same tiles. The poses are half a grid step
+    //off the ones whose footprint edges fall on tile borders, where rounding decides the tile
+    int32_t tileNumCol = param.paramViewPort.tileNumCol;
+    int32_t seamNum = 0;
+    auto checkPose = [&](float yaw, float pitch) {
+        std::set<int32_t> sweep = SelectTilesByLegacyWay(pSweep, yaw, pitch);
+        std::set<int32_t> analytic = SelectTilesByLegacyWay(pAnalytic, yaw, pitch);
+        std::set<int32_t> cols;
+        for (auto idx : sweep)
+            cols.insert(idx % tileNumCol);
+        if (cols.size() < (size_t)tileNumCol)
+            return analytic == sweep;
+        seamNum++;
+        return !analytic.empty() && std::includes(sweep.begin(), sweep.end(), analytic.begin(), analytic.end());
+    };
+
+    const float yaws[] = { -175, -135, -45, 5, 95, 155 };
+    const float pitches[] = { -67.5, -37.5, -7.5, 22.5, 52.5, 82.5 };
+    for (auto pitch : pitches)
+    {
+        for (auto yaw : yaws)
+        {
+            bool bMatch = checkPose(yaw, pitch);
+            if (!bMatch)
+                printf("analytic viewport solver mismatch at yaw %f pitch %f\n", yaw, pitch);
+            EXPECT_TRUE(bMatch);
+        }
+    }
+    //the poses have footprints across the seam and away from it
+    EXPECT_TRUE(seamNum > 0 && seamNum < 36);
+
+    if (VCD::PerfBench::Enabled())
+    {
+        //the whole grid, and the time per pose of both ways
+        int32_t poseNum = 0;
+        int32_t mismatchNum = 0;
+        for (float pitch = -82.5; pitch < 90; pitch += 15)
+        {
+            for (float yaw = -175; yaw < 180; yaw += 10)
+            {
+                poseNum++;
+                if (!checkPose(yaw, pitch))
+                {
+                    printf("analytic viewport solver mismatch at yaw %f pitch %f\n", yaw, pitch);
+                    mismatchNum++;
+                }
+            }
+        }
+        EXPECT_EQ(mismatchNum, 0);
+
+        const int loopNum = 20;
+        double us[2];
+        void* handles[2] = { pSweep, pAnalytic };
+        for (int i = 0; i < 2; i++)
+        {
+            us[i] = VCD::PerfBench::MeasureMs([&]() {
+                for (int loop = 0; loop < loopNum; loop++)
+                    SelectTilesByLegacyWay(handles[i], (float)(loop * 7 % 360 - 180), (float)(loop * 3 % 170 - 85));
+            }) * 1000 / loopNum;
+        }
+        VCD::PerfBench::PerfReport("AnalyticViewportSolver")
+            .Add("poses", (uint64_t)poseNum)
+            .Add("mismatches", (uint64_t)mismatchNum)
+            .Add("sweep_us_per_pose", us[0])
+            .Add("analytic_us_per_pose", us[1])
+            .Print();
+    }
+
+    I360SCVP_unInit(pSweep);
+    I360SCVP_unInit(pAnalytic);
+}
+
+TEST_F(I360SCVPTest_erp, ConcurrentSessions)
+{
+    param.paramViewPort.faceWidth = 7680;
+    param.paramViewPort.faceHeight = 3840;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+    param.paramViewPort.viewportHeight = 1024;
+    param.paramViewPort.viewportWidth = 1024;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 20;
+    param.paramViewPort.tileNumRow = 10;
+    param.paramViewPort.paramVideoFP.cols = 1;
+    param.paramViewPort.paramVideoFP.rows = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceWidth = param.paramViewPort.faceWidth;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceHeight = param.paramViewPort.faceHeight;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 90;
+    param.usedType = E_VIEWPORT_ONLY;
+
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+    param.usedType = E_PARSER_ONENAL;
+
+    //single thread reference of all the poses
+    const int poseNum = 64;
+    std::vector<std::set<int32_t>> reference;
+    for (int i = 0; i < poseNum; i++)
+        reference.push_back(SelectTiles(pI360SCVP, &param, (float)(i * 37 % 360 - 180), (float)(i * 23 % 170 - 85)));
+
+    //every thread walks through the poses from its own start on its own session
+    const int threadNum = 8;
+    std::vector<void*> sessions;
+    for (int i = 0; i < threadNum; i++)
+    {
+        void* pSession = I360SCVP_NewSession(pI360SCVP);
+        EXPECT_TRUE(pSession != NULL);
+        if (pSession)
+            sessions.push_back(pSession);
+    }
+    std::atomic<int> mismatchNum(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < sessions.size(); t++)
+    {
+        void* pSession = sessions[t];
+        param_360SCVP* pParam = &param;
+        threads.push_back(std::thread([pSession, pParam, t, &reference, &mismatchNum]() {
+            for (int loop = 0; loop < 4 * poseNum; loop++)
+            {
+                int i = (int)(loop + t * 7) % poseNum;
+                if (SelectTiles(pSession, pParam, (float)(i * 37 % 360 - 180), (float)(i * 23 % 170 - 85)) != reference[i])
+                    mismatchNum++;
+            }
+        }));
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_TRUE(mismatchNum == 0);
+
+    //a session created from a session shares the same stream
+    void* pSubSession = I360SCVP_NewSession(sessions.empty() ? pI360SCVP : sessions[0]);
+    EXPECT_TRUE(pSubSession != NULL);
+    if (pSubSession)
+    {
+        EXPECT_TRUE(SelectTiles(pSubSession, &param, -180, -85) == reference[0]);
+        I360SCVP_unInit(pSubSession);
+    }
+
+    for (auto pSession : sessions)
+        I360SCVP_unInit(pSession);
+    I360SCVP_unInit(pI360SCVP);
+}
+
+TEST_F(I360SCVPTest_erp, GetTilesInViewportBatch)
+{
+    param.paramViewPort.faceWidth = 7680;
+    param.paramViewPort.faceHeight = 3840;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+    param.paramViewPort.viewportHeight = 1024;
+    param.paramViewPort.viewportWidth = 1024;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 20;
+    param.paramViewPort.tileNumRow = 10;
+    param.paramViewPort.paramVideoFP.cols = 1;
+    param.paramViewPort.paramVideoFP.rows = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceWidth = param.paramViewPort.faceWidth;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceHeight = param.paramViewPort.faceHeight;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 90;
+    param.usedType = E_VIEWPORT_ONLY;
+
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+    param.usedType = E_PARSER_ONENAL;
+
+    const uint32_t poseNum = 100;
+    const uint32_t maxTileNum = 200;
+    HeadPose poses[poseNum];
+    memset_s(poses, sizeof(poses), 0);
+    for (int i = 0; i < (int)poseNum; i++)
+    {
+        poses[i].yaw = (float)(i * 37 % 360 - 180);
+        poses[i].pitch = (float)(i * 23 % 170 - 85);
+    }
+    TileDef* pOutTiles = new TileDef[poseNum * maxTileNum];
+    int32_t tileNums[poseNum];
+    Param_ViewportOutput outputs[poseNum];
+    CCDef ccs[poseNum];
+
+    EXPECT_TRUE(I360SCVP_getTilesInViewportBatch(NULL, poseNum, pOutTiles, maxTileNum, tileNums, outputs, ccs, pI360SCVP) != 0);
+    EXPECT_TRUE(I360SCVP_getTilesInViewportBatch(poses, poseNum, pOutTiles, maxTileNum, tileNums, outputs, ccs, NULL) == -1);
+    EXPECT_TRUE(I360SCVP_getTilesInViewportBatch(poses, poseNum, pOutTiles, maxTileNum, tileNums, outputs, ccs, pI360SCVP) == 0);
+
+    //every pose selects the same tiles and content coverage as the single pose functions
+    int ret = 0;
+    for (uint32_t i = 0; i < poseNum && !ret; i++)
+    {
+        std::set<int32_t> batch;
+        for (int32_t j = 0; j < tileNums[i]; j++)
+            batch.insert(pOutTiles[i * maxTileNum + j].idx * 8 + pOutTiles[i * maxTileNum + j].faceId);
+        CCDef cc;
+        if (tileNums[i] <= 0 || batch != SelectTiles(pI360SCVP, &param, poses[i].yaw, poses[i].pitch)
+            || I360SCVP_getContentCoverage(pI360SCVP, &cc) != 0
+            || cc.centreAzimuth != ccs[i].centreAzimuth || cc.centreElevation != ccs[i].centreElevation
+            || cc.azimuthRange != ccs[i].azimuthRange || cc.elevationRange != ccs[i].elevationRange)
+        {
+            printf("batch tile selection mismatch at yaw %f pitch %f\n", poses[i].yaw, poses[i].pitch);
+            ret = 1;
+        }
+    }
+    EXPECT_TRUE(ret == 0);
+
+    //poses with more tiles than the output room fail with -1, the other poses keep their tiles
+    int32_t fullNums[poseNum];
+    int32_t minNum = maxTileNum;
+    for (uint32_t i = 0; i < poseNum; i++)
+    {
+        fullNums[i] = tileNums[i];
+        minNum = std::min(minNum, tileNums[i]);
+    }
+    int32_t failNum = 0;
+    for (uint32_t i = 0; i < poseNum; i++)
+        failNum += fullNums[i] > minNum ? 1 : 0;
+    EXPECT_TRUE(I360SCVP_getTilesInViewportBatch(poses, poseNum, pOutTiles, minNum, tileNums, NULL, NULL, pI360SCVP) == failNum);
+    for (uint32_t i = 0; i < poseNum; i++)
+        EXPECT_TRUE(tileNums[i] == (fullNums[i] > minNum ? -1 : fullNums[i]));
+
+    //a batch smaller than MIN_BATCH_POSES_PER_WORKER poses per worker runs on the calling thread
+    EXPECT_TRUE(I360SCVP_getTilesInViewportBatch(poses + 10, 3, pOutTiles, maxTileNum, tileNums, NULL, NULL, pI360SCVP) == 0);
+    for (uint32_t i = 0; i < 3 && !ret; i++)
+    {
+        std::set<int32_t> batch;
+        for (int32_t j = 0; j < tileNums[i]; j++)
+            batch.insert(pOutTiles[i * maxTileNum + j].idx * 8 + pOutTiles[i * maxTileNum + j].faceId);
+        ret = batch != SelectTiles(pI360SCVP, &param, poses[10 + i].yaw, poses[10 + i].pitch);
+    }
+    EXPECT_TRUE(ret == 0);
+
+    //the sessions share the lookup table of the handle, and are rebuilt when the table changes
+    Param_TileLUT paramLUT;
+    paramLUT.memoryBudget = 1 << 20;
+    paramLUT.angleStep = 10;
+    paramLUT.refine = false;
+    EXPECT_TRUE(I360SCVP_SetParameter(pI360SCVP, ID_SCVP_PARAM_TILE_LUT, &paramLUT) == 0);
+    for (int loop = 0; loop < 2; loop++)
+    {
+        EXPECT_TRUE(I360SCVP_getTilesInViewportBatch(poses, poseNum, pOutTiles, maxTileNum, tileNums, NULL, NULL, pI360SCVP) == 0);
+        for (uint32_t i = 0; i < poseNum && !ret; i++)
+        {
+            std::set<int32_t> batch;
+            for (int32_t j = 0; j < tileNums[i]; j++)
+                batch.insert(pOutTiles[i * maxTileNum + j].idx * 8 + pOutTiles[i * maxTileNum + j].faceId);
+            if (tileNums[i] <= 0 || batch != SelectTiles(pI360SCVP, &param, poses[i].yaw, poses[i].pitch))
+            {
+                printf("batch tile lookup mismatch at yaw %f pitch %f\n", poses[i].yaw, poses[i].pitch);
+                ret = 1;
+            }
+        }
+    }
+    EXPECT_TRUE(ret == 0);
+
+    //too small output of one pose
+    EXPECT_TRUE(I360SCVP_getTilesInViewportBatch(poses, 1, pOutTiles, 1, tileNums, NULL, NULL, pI360SCVP) == 1);
+    EXPECT_TRUE(tileNums[0] == -1);
+
+    if (VCD::PerfBench::Enabled())
+    {
+        double us[2];
+        us[0] = VCD::PerfBench::MeasureMs([&]() {
+            for (uint32_t i = 0; i < poseNum; i++)
+                SelectTiles(pI360SCVP, &param, poses[i].yaw, poses[i].pitch);
+        }) * 1000 / poseNum;
+        us[1] = VCD::PerfBench::MeasureMs([&]() {
+            I360SCVP_getTilesInViewportBatch(poses, poseNum, pOutTiles, maxTileNum, tileNums, outputs, NULL, pI360SCVP);
+        }) * 1000 / poseNum;
+        VCD::PerfBench::PerfReport("GetTilesInViewportBatch").Add("single_us_per_pose", us[0]).Add("batch_us_per_pose", us[1]).Print();
+    }
+
+    delete[] pOutTiles;
+    I360SCVP_unInit(pI360SCVP);
+}
+
 }
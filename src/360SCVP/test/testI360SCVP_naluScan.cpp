@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+#include "../360SCVPAPI.h"
+#include "../360SCVPHevcParser.h"
+#include "../360SCVPNaluScan.h"
+#include "../../utils/PerfBench.h"
+
+#include "../../utils/safe_mem.h"
+
+namespace{
+
+//byte-by-byte emulation prevention removal, same behavior as the parser before the scan kernels were added
+uint32_t RefRemoveEmulationBytes(const int8_t *src, int8_t *dst, uint32_t size, uint32_t *removed)
+{
+    uint32_t n = 0, count = 0;
+    uint8_t zeroCounter = 0;
+    while (n < size)
+    {
+        if (zeroCounter == 2 && src[n] == 0x03 && n + 1 < size && src[n + 1] < 0x04)
+        {
+            zeroCounter = 0;
+            count++;
+            n++;
+        }
+        dst[n - count] = src[n];
+        if (!src[n])
+            zeroCounter++;
+        else
+            zeroCounter = 0;
+        n++;
+    }
+    *removed = count;
+    return size - count;
+}
+
+//byte-by-byte start code search, returns the offset of the leading zero of 0x00000001 or 0x000001
+uint64_t RefNextStartCode(const uint8_t *data, uint64_t start, uint64_t size)
+{
+    for (uint64_t i = start; i + 2 < size; i++)
+    {
+        if (!data[i] && !data[i + 1] && data[i + 2] == 0x01)
+            return (i > start && !data[i - 1]) ? i - 1 : i;
+    }
+    return size;
+}
+
+class I360SCVPTest_naluScan : public testing::Test {
+public:
+    virtual void SetUp()
+    {
+      m_seed = 0x7654321;
+      m_defaultLevel = gts_nalu_scan_get_level();
+    }
+    virtual void TearDown()
+    {
+      gts_nalu_scan_set_level(m_defaultLevel);
+    }
+
+    uint32_t Random()
+    {
+      m_seed = m_seed * 1103515245 + 12345;
+      return (m_seed >> 8);
+    }
+
+    //random payload biased towards 0x00, 0x01 and 0x03 so that start codes and emulation bytes show up often
+    void FillBuffer(std::vector<uint8_t> &data, uint32_t zeroPercent)
+    {
+      const uint8_t special[] = { 0x00, 0x00, 0x00, 0x01, 0x03 };
+      for (uint32_t i = 0; i < data.size(); i++)
+      {
+        if (Random() % 100 < zeroPercent)
+          data[i] = special[Random() % sizeof(special)];
+        else
+          data[i] = (uint8_t)Random();
+      }
+    }
+
+    std::vector<uint8_t> ReadFile(const char *name)
+    {
+      std::vector<uint8_t> data;
+      FILE *pFile = fopen(name, "rb");
+      if (!pFile)
+        return data;
+      fseek(pFile, 0, SEEK_END);
+      long size = ftell(pFile);
+      fseek(pFile, 0, SEEK_SET);
+      data.resize(size);
+      size = fread(data.data(), 1, size, pFile);
+      data.resize(size);
+      fclose(pFile);
+      return data;
+    }
+
+    uint32_t      m_seed;
+    GTS_ScanLevel m_defaultLevel;
+};
+
+TEST_F(I360SCVPTest_naluScan, EmulationBytes)
+{
+    int ret = 0;
+    const uint32_t zeroPercents[] = { 0, 5, 30, 90, 100 };
+    for (int32_t level = GTS_SCAN_SCALAR; level <= gts_nalu_scan_detect_level(); level++)
+    {
+      gts_nalu_scan_set_level((GTS_ScanLevel)level);
+      for (uint32_t round = 0; round < 500 && !ret; round++)
+      {
+        std::vector<uint8_t> src(Random() % 300);
+        FillBuffer(src, zeroPercents[round % 5]);
+        uint32_t size = (uint32_t)src.size();
+
+        std::vector<uint8_t> dstRef(size + 1), dst(size + 1);
+        uint32_t removedRef = 0;
+        uint32_t sizeRef = RefRemoveEmulationBytes((const int8_t*)src.data(), (int8_t*)dstRef.data(), size, &removedRef);
+
+        uint32_t removed = gts_media_nalu_emulation_bytes_remove_count((const int8_t*)src.data(), size);
+        uint32_t sizeOut = gts_media_nalu_remove_emulation_bytes((const int8_t*)src.data(), (int8_t*)dst.data(), size);
+        if (removed != removedRef || sizeOut != sizeRef || memcmp(dst.data(), dstRef.data(), sizeRef))
+        {
+          printf("level %d round %u: emulation bytes mismatch\n", level, round);
+          ret = 1;
+        }
+      }
+    }
+    EXPECT_TRUE(ret == 0);
+}
+
+TEST_F(I360SCVPTest_naluScan, StartCode)
+{
+    int ret = 0;
+    const uint32_t zeroPercents[] = { 0, 5, 30, 90, 100 };
+    for (int32_t level = GTS_SCAN_SCALAR; level <= gts_nalu_scan_detect_level(); level++)
+    {
+      gts_nalu_scan_set_level((GTS_ScanLevel)level);
+      for (uint32_t round = 0; round < 500 && !ret; round++)
+      {
+        std::vector<uint8_t> data(4 + Random() % 300);
+        FillBuffer(data, zeroPercents[round % 5]);
+        data[0] = data[1] = data[2] = 0;
+        data[3] = 1;
+
+        for (uint64_t start = 4; start < data.size() && !ret; start += 1 + Random() % 16)
+        {
+          GTS_BitStream *bs = gts_bs_new((const int8_t*)data.data(), data.size(), GTS_BITSTREAM_READ);
+          if (!bs)
+          {
+            ret = 1;
+            break;
+          }
+          gts_bs_seek(bs, start);
+          uint32_t length = gts_media_nalu_next_start_code_bs(bs);
+          if (length != RefNextStartCode(data.data(), start, data.size()) - start
+              || gts_bs_get_position(bs) != start)
+          {
+            printf("level %d round %u start %lu: start code mismatch\n", level, round, (unsigned long)start);
+            ret = 1;
+          }
+          gts_bs_del(bs);
+        }
+      }
+    }
+    EXPECT_TRUE(ret == 0);
+}
+
+TEST_F(I360SCVPTest_naluScan, ScanPerf)
+{
+    if (!VCD::PerfBench::Enabled())
+      return;
+
+    const char *files[] = { "./test.265", "./testCube.265" };
+    for (uint32_t fileIdx = 0; fileIdx < sizeof(files) / sizeof(files[0]); fileIdx++)
+    {
+      std::vector<uint8_t> data = ReadFile(files[fileIdx]);
+      if (data.empty())
+        continue;
+      std::vector<uint8_t> dst(data.size());
+
+      for (int32_t level = GTS_SCAN_SCALAR; level <= gts_nalu_scan_detect_level(); level++)
+      {
+        gts_nalu_scan_set_level((GTS_ScanLevel)level);
+        const int loopNum = 20;
+        uint64_t nalNum = 0;
+        double ms = VCD::PerfBench::MeasureMs([&]() {
+          for (int loop = 0; loop < loopNum; loop++)
+          {
+            GTS_BitStream *bs = gts_bs_new((const int8_t*)data.data(), data.size(), GTS_BITSTREAM_READ);
+            if (!bs)
+              break;
+            uint64_t offset = 4;
+            while (offset < data.size())
+            {
+              gts_bs_seek(bs, offset);
+              uint32_t length = gts_media_nalu_next_start_code_bs(bs);
+              gts_media_nalu_remove_emulation_bytes((const int8_t*)data.data() + offset, (int8_t*)dst.data(), length);
+              offset += length + 3;
+              nalNum++;
+            }
+            gts_bs_del(bs);
+          }
+        });
+
+        std::string caseName = std::string("NaluScan_") + (files[fileIdx] + 2);
+        VCD::PerfBench::PerfReport(caseName.c_str())
+          .Add("level", (uint64_t)level)
+          .Add("nals", nalNum)
+          .Add("mb_per_s", ms > 0 ? (double)data.size() * loopNum / (ms * 1000) : 0)
+          .Print();
+      }
+    }
+}
+}
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//! Micro benchmarks of the 360SCVP hot paths on the bundled test streams.
+//! Timing and reporting are shared with the other unit tests in PerfBench.h,
+//! VR_PERF_MIN_MS sets the minimum measuring time of one benchmark (default 200 ms).
+
+#include "gtest/gtest.h"
+#include <string>
+#include <stdlib.h>
+#include "../360SCVPAPI.h"
+
+#include "../../utils/safe_mem.h"
+#include "../../utils/PerfBench.h"
+
+namespace{
+
+using VCD::PerfBench::RunPerf;
+
+struct PerfStream
+{
+    unsigned char*  data;
+    int32_t         len;
+};
+
+bool LoadStream(const char* fileName, int32_t maxLen, PerfStream* pStream)
+{
+    pStream->data = NULL;
+    pStream->len = 0;
+    FILE* pFile = fopen(fileName, "rb");
+    if (!pFile)
+        return false;
+    pStream->data = new unsigned char[maxLen];
+    pStream->len = fread(pStream->data, 1, maxLen, pFile);
+    fclose(pFile);
+    return pStream->len > 0;
+}
+
+//parses every nal of the stream, returns the number of parsed nals
+int32_t ParseStream(void* pI360SCVP, PerfStream* pStream)
+{
+    unsigned char* pData = pStream->data;
+    int32_t left = pStream->len;
+    int32_t nalNum = 0;
+    while (left > 0)
+    {
+        Nalu nal;
+        nal.data = pData;
+        nal.dataSize = left;
+        if (I360SCVP_ParseNAL(&nal, pI360SCVP) || nal.dataSize <= 0)
+            break;
+        pData += nal.dataSize;
+        left -= nal.dataSize;
+        nalNum++;
+    }
+    return nalNum;
+}
+
+class I360SCVPTest_perf : public testing::Test {
+public:
+    virtual void SetUp()
+    {
+      memset_s((void*)&param, sizeof(param_360SCVP), 0);
+      bLoaded = LoadStream("./test.265", 3840 * 2048 * 3 / 2, &erpStream)
+          && LoadStream("./test_low.265", 1280 * 768 * 3 / 2, &erpStreamLow)
+          && LoadStream("./testCube.265", 2880 * 1920 * 3 / 2, &cubeStream)
+          && LoadStream("./testCube_low.265", 960 * 640 * 3 / 2, &cubeStreamLow);
+      pOutputBuffer = new unsigned char[3840 * 2048 * 3 / 2];
+      pOutputSEI = new unsigned char[2000];
+      param.pOutputBitstream = pOutputBuffer;
+      param.pOutputSEI = pOutputSEI;
+    }
+    virtual void TearDown()
+    {
+      PerfStream* streams[4] = { &erpStream, &erpStreamLow, &cubeStream, &cubeStreamLow };
+      for (int i = 0; i < 4; i++)
+      {
+        delete[] streams[i]->data;
+        streams[i]->data = NULL;
+      }
+      delete[] pOutputBuffer;
+      pOutputBuffer = NULL;
+      delete[] pOutputSEI;
+      pOutputSEI = NULL;
+    }
+
+    //merge of the high and low resolution erp streams, as in I360SCVPTest_erp
+    void SetErpMergeParam()
+    {
+      param.pInputBitstream = erpStream.data;
+      param.inputBitstreamLen = erpStream.len;
+      param.pInputLowBitstream = erpStreamLow.data;
+      param.inputLowBistreamLen = erpStreamLow.len;
+      param.frameWidth = 3840;
+      param.frameHeight = 2048;
+      param.frameWidthLow = 1280;
+      param.frameHeightLow = 768;
+      param.paramViewPort.faceWidth = 3840;
+      param.paramViewPort.faceHeight = 2048;
+      param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+      param.paramViewPort.viewportHeight = 960;
+      param.paramViewPort.viewportWidth = 960;
+      param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+      param.paramViewPort.viewPortYaw = -90;
+      param.paramViewPort.viewPortPitch = 0;
+      param.paramViewPort.viewPortFOVH = 80;
+      param.paramViewPort.viewPortFOVV = 80;
+      param.paramViewPort.paramVideoFP.cols = 1;
+      param.paramViewPort.paramVideoFP.rows = 1;
+      param.paramViewPort.paramVideoFP.faces[0][0].idFace = 0;
+      param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+      param.usedType = E_MERGE_AND_VIEWPORT;
+    }
+
+    //merge of the high and low resolution cubemap streams, as in I360SCVPTest_cubemap
+    void SetCubemapMergeParam()
+    {
+      param.pInputBitstream = cubeStream.data;
+      param.inputBitstreamLen = cubeStream.len;
+      param.pInputLowBitstream = cubeStreamLow.data;
+      param.inputLowBistreamLen = cubeStreamLow.len;
+      param.frameWidth = 2880;
+      param.frameHeight = 1920;
+      param.frameWidthLow = 960;
+      param.frameHeightLow = 640;
+      param.paramViewPort.faceWidth = 960;
+      param.paramViewPort.faceHeight = 960;
+      param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_CUBEMAP);
+      param.paramViewPort.viewportHeight = 1024;
+      param.paramViewPort.viewportWidth = 1024;
+      param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+      param.paramViewPort.viewPortYaw = 0;
+      param.paramViewPort.viewPortPitch = 0;
+      param.paramViewPort.viewPortFOVH = 90;
+      param.paramViewPort.viewPortFOVV = 90;
+      param.paramViewPort.tileNumCol = 3;
+      param.paramViewPort.tileNumRow = 3;
+      param.paramViewPort.paramVideoFP.cols = 3;
+      param.paramViewPort.paramVideoFP.rows = 2;
+      param.paramViewPort.paramVideoFP.faces[0][0].idFace = OMAF_FACE_PX;
+      param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+      param.paramViewPort.paramVideoFP.faces[0][1].idFace = OMAF_FACE_NX;
+      param.paramViewPort.paramVideoFP.faces[0][1].rotFace = NO_TRANSFORM;
+      param.paramViewPort.paramVideoFP.faces[0][2].idFace = OMAF_FACE_PY;
+      param.paramViewPort.paramVideoFP.faces[0][2].rotFace = NO_TRANSFORM;
+      param.paramViewPort.paramVideoFP.faces[1][0].idFace = OMAF_FACE_NY;
+      param.paramViewPort.paramVideoFP.faces[1][0].rotFace = NO_TRANSFORM;
+      param.paramViewPort.paramVideoFP.faces[1][1].idFace = OMAF_FACE_PZ;
+      param.paramViewPort.paramVideoFP.faces[1][1].rotFace = NO_TRANSFORM;
+      param.paramViewPort.paramVideoFP.faces[1][2].idFace = OMAF_FACE_NZ;
+      param.paramViewPort.paramVideoFP.faces[1][2].rotFace = NO_TRANSFORM;
+      param.usedType = E_MERGE_AND_VIEWPORT;
+    }
+
+    param_360SCVP           param;
+    PerfStream              erpStream;
+    PerfStream              erpStreamLow;
+    PerfStream              cubeStream;
+    PerfStream              cubeStreamLow;
+    unsigned char*          pOutputBuffer;
+    unsigned char*          pOutputSEI;
+    bool                    bLoaded;
+};
+
+TEST_F(I360SCVPTest_perf, ParseNAL)
+{
+    EXPECT_TRUE(bLoaded);
+    if (!bLoaded)
+        return;
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+
+    PerfStream* streams[4] = { &erpStream, &erpStreamLow, &cubeStream, &cubeStreamLow };
+    const char* names[4] = { "parse_nal_erp", "parse_nal_erp_low", "parse_nal_cubemap", "parse_nal_cubemap_low" };
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(ParseStream(pI360SCVP, streams[i]) > 0);
+        RunPerf(names[i], streams[i]->len, [&]() { ParseStream(pI360SCVP, streams[i]); });
+    }
+
+    I360SCVP_unInit(pI360SCVP);
+}
+
+TEST_F(I360SCVPTest_perf, MergeProcess)
+{
+    EXPECT_TRUE(bLoaded);
+    if (!bLoaded)
+        return;
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (i == 0)
+            SetErpMergeParam();
+        else
+            SetCubemapMergeParam();
+        void* pI360SCVP = I360SCVP_Init(&param);
+        EXPECT_TRUE(pI360SCVP != NULL);
+        if (!pI360SCVP)
+            return;
+        I360SCVP_setViewPort(pI360SCVP, param.paramViewPort.viewPortYaw, param.paramViewPort.viewPortPitch);
+        EXPECT_TRUE(I360SCVP_process(&param, pI360SCVP) == 0);
+        EXPECT_TRUE(param.outputBitstreamLen > 0);
+
+        int32_t ret = 0;
+        RunPerf(i == 0 ? "merge_erp" : "merge_cubemap", param.inputBitstreamLen + param.inputLowBistreamLen,
+            [&]() { ret |= I360SCVP_process(&param, pI360SCVP); });
+        EXPECT_TRUE(ret == 0);
+
+        I360SCVP_unInit(pI360SCVP);
+    }
+}
+
+TEST_F(I360SCVPTest_perf, GetTilesInViewport)
+{
+    TileDef pOutTile[1024];
+    Param_ViewportOutput paramViewportOutput;
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (i == 0)
+        {
+            param.paramViewPort.faceWidth = 3840;
+            param.paramViewPort.faceHeight = 2048;
+            param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+            param.paramViewPort.tileNumCol = 10;
+            param.paramViewPort.tileNumRow = 8;
+            param.paramViewPort.paramVideoFP.cols = 1;
+            param.paramViewPort.paramVideoFP.rows = 1;
+            param.paramViewPort.paramVideoFP.faces[0][0].idFace = 0;
+            param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+        }
+        else
+        {
+            param.paramViewPort.faceWidth = 512 * 4;
+            param.paramViewPort.faceHeight = 512 * 4;
+            param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_CUBEMAP);
+            param.paramViewPort.tileNumCol = 4;
+            param.paramViewPort.tileNumRow = 4;
+            param.paramViewPort.paramVideoFP.cols = 3;
+            param.paramViewPort.paramVideoFP.rows = 2;
+            param.paramViewPort.paramVideoFP.faces[0][0].idFace = 4;
+            param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+            param.paramViewPort.paramVideoFP.faces[0][1].idFace = 0;
+            param.paramViewPort.paramVideoFP.faces[0][1].rotFace = NO_TRANSFORM;
+            param.paramViewPort.paramVideoFP.faces[0][2].idFace = 5;
+            param.paramViewPort.paramVideoFP.faces[0][2].rotFace = NO_TRANSFORM;
+            param.paramViewPort.paramVideoFP.faces[1][0].idFace = 3;
+            param.paramViewPort.paramVideoFP.faces[1][0].rotFace = ROTATION_180_ANTICLOCKWISE;
+            param.paramViewPort.paramVideoFP.faces[1][1].idFace = 1;
+            param.paramViewPort.paramVideoFP.faces[1][1].rotFace = ROTATION_270_ANTICLOCKWISE;
+            param.paramViewPort.paramVideoFP.faces[1][2].idFace = 2;
+            param.paramViewPort.paramVideoFP.faces[1][2].rotFace = NO_TRANSFORM;
+        }
+        param.paramViewPort.viewportHeight = 960;
+        param.paramViewPort.viewportWidth = 960;
+        param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+        param.paramViewPort.viewPortFOVH = 80;
+        param.paramViewPort.viewPortFOVV = 90;
+        param.usedType = E_VIEWPORT_ONLY;
+        void* pI360SCVP = I360SCVP_Init(&param);
+        EXPECT_TRUE(pI360SCVP != NULL);
+        if (!pI360SCVP)
+            return;
+
+        //one op is one pose of a sweep over the whole sphere
+        int32_t poseIdx = 0;
+        int32_t tileNum = 0;
+        RunPerf(i == 0 ? "viewport_tiles_erp" : "viewport_tiles_cubemap", 0, [&]() {
+            int32_t yaw = (poseIdx * 37) % 360 - 180;
+            int32_t pitch = (poseIdx * 13) % 180 - 90;
+            poseIdx++;
+            I360SCVP_setViewPort(pI360SCVP, (float)yaw, (float)pitch);
+            tileNum = I360SCVP_getTilesInViewport(pOutTile, &paramViewportOutput, pI360SCVP);
+        });
+        EXPECT_TRUE(tileNum > 0);
+
+        I360SCVP_unInit(pI360SCVP);
+    }
+}
+
+TEST_F(I360SCVPTest_perf, GenerateParamSetAndSliceHdr)
+{
+    EXPECT_TRUE(bLoaded);
+    if (!bLoaded)
+        return;
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+
+    //keep the first pps and the first slice of the erp stream
+    Nalu ppsNal, sliceNal;
+    memset_s(&ppsNal, sizeof(Nalu), 0);
+    memset_s(&sliceNal, sizeof(Nalu), 0);
+    unsigned char* pData = erpStream.data;
+    int32_t left = erpStream.len;
+    while (left > 0 && !sliceNal.data)
+    {
+        Nalu nal;
+        nal.data = pData;
+        nal.dataSize = left;
+        if (I360SCVP_ParseNAL(&nal, pI360SCVP) || nal.dataSize <= 0)
+            break;
+        if (nal.naluType == 34)
+            ppsNal = nal;
+        else if (nal.naluType < 32 && ppsNal.data)
+            sliceNal = nal;
+        pData += nal.dataSize;
+        left -= nal.dataSize;
+    }
+    EXPECT_TRUE(ppsNal.data != NULL);
+    EXPECT_TRUE(sliceNal.data != NULL);
+    if (!ppsNal.data || !sliceNal.data)
+    {
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+
+    uint16_t width[2] = { 1920, 1920 };
+    uint16_t height[2] = { 1024, 1024 };
+    TileArrangement tileArr;
+    tileArr.tileColsNum = 2;
+    tileArr.tileRowsNum = 2;
+    tileArr.tileColWidth = width;
+    tileArr.tileRowHeight = height;
+    int32_t ret = 0;
+    RunPerf("generate_pps", ppsNal.dataSize, [&]() {
+        param.pInputBitstream = ppsNal.data;
+        param.inputBitstreamLen = ppsNal.dataSize;
+        ret |= I360SCVP_GeneratePPS(&param, &tileArr, pI360SCVP);
+    });
+    EXPECT_TRUE(ret == 0);
+
+    //the pps generation above does not replace the parsed pps the slice header refers to
+    RunPerf("generate_slice_hdr", sliceNal.dataSize, [&]() {
+        param.pInputBitstream = sliceNal.data;
+        param.inputBitstreamLen = sliceNal.dataSize;
+        param.destWidth = 1920;
+        param.destHeight = 1024;
+        ret |= I360SCVP_GenerateSliceHdr(&param, 0, pI360SCVP);
+    });
+    EXPECT_TRUE(ret == 0);
+
+    I360SCVP_unInit(pI360SCVP);
+}
+
+TEST_F(I360SCVPTest_perf, RWPKEncodeAndDecode)
+{
+    EXPECT_TRUE(bLoaded);
+    if (!bLoaded)
+        return;
+    SetErpMergeParam();
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+    I360SCVP_setViewPort(pI360SCVP, param.paramViewPort.viewPortYaw, param.paramViewPort.viewPortPitch);
+    int32_t ret = I360SCVP_process(&param, pI360SCVP);
+    EXPECT_TRUE(ret == 0);
+
+    //the rwpk of the merged erp stream is the encoding input
+    RegionWisePacking* pOriRWPK = new RegionWisePacking;
+    ret |= I360SCVP_GetParameter(pI360SCVP, ID_SCVP_RWPK_INFO, (void**)&pOriRWPK);
+    EXPECT_TRUE(ret == 0);
+    if (ret)
+    {
+        delete pOriRWPK;
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+
+    uint8_t rwpkBits[2000];
+    int32_t rwpkBitsSize = 0;
+    ret |= I360SCVP_GenerateRWPK(pI360SCVP, pOriRWPK, rwpkBits, &rwpkBitsSize);
+    RunPerf("rwpk_encode", rwpkBitsSize, [&]() {
+        ret |= I360SCVP_GenerateRWPK(pI360SCVP, pOriRWPK, rwpkBits, &rwpkBitsSize);
+    });
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(rwpkBitsSize > 0);
+
+    RegionWisePacking RWPK;
+    RWPK.rectRegionPacking = new RectangularRegionWisePacking[DEFAULT_REGION_NUM];
+    RunPerf("rwpk_decode", rwpkBitsSize, [&]() {
+        ret |= I360SCVP_ParseRWPK(pI360SCVP, &RWPK, rwpkBits, rwpkBitsSize);
+    });
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(RWPK.numRegions == pOriRWPK->numRegions);
+
+    delete[] RWPK.rectRegionPacking;
+    RWPK.rectRegionPacking = NULL;
+    delete pOriRWPK;
+    pOriRWPK = NULL;
+    I360SCVP_unInit(pI360SCVP);
+}
+
+}
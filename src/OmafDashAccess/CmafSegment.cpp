@@ -35,6 +35,7 @@
 
 #include "CmafSegment.h"
 #include <algorithm>
+#include <cstring>
 
 VCD_OMAF_BEGIN
 
@@ -104,6 +105,7 @@ int CmafSegment::Open(std::shared_ptr<OmafDashSegmentClient> dash_client) noexce
             default:
               break;
           }
+          this->AbortProgressiveChunk();
         });
     return ERROR_NONE;
   } catch (const std::exception& ex) {
@@ -158,6 +160,18 @@ int32_t CmafSegment::GenerateChunkStream() {
     return ERROR_INVALID;
   }
 
+  // the next chunks start after the progressive one completes
+  if (progressive_chunk_.get() != nullptr) {
+    int32_t ret = FeedProgressiveChunk();
+    if (ret != ERROR_NONE || progressive_chunk_.get() != nullptr) {
+      return ret;
+    }
+    if (processed_chunk_id_ == (int32_t)chunk_num_ - 1) {
+      dash_stream_.clear();
+      return ERROR_NONE;
+    }
+  }
+
   if (processed_chunk_id_ >= (int32_t)chunk_num_ - 1) {
     OMAF_LOG(LOG_WARNING, "available chunk id %d is greater than chunk num %d\n", processed_chunk_id_, chunk_num_);
     return ERROR_INVALID;
@@ -193,6 +207,12 @@ int32_t CmafSegment::GenerateChunkStream() {
     }
   }
 
+  // 2.3 hand out the incomplete chunk once its moof is present
+  if (ds_params_.progressive_parse_ && processed_chunk_id_ < (int32_t)chunk_num_ - 1 &&
+      index_range_[processed_chunk_id_ + 1] != 0) {
+    return StartProgressiveChunk(bytesProcessed);
+  }
+
   if (processed_chunk_id_ == (int32_t)chunk_num_ - 1) {
     dash_stream_.clear();
   }
@@ -200,6 +220,109 @@ int32_t CmafSegment::GenerateChunkStream() {
   return ERROR_NONE;
 }
 
+bool CmafSegment::HasChunkHeader(size_t offset, int64_t available) {
+  bool moof_found = false;
+  int64_t pos = 0;
+  uint8_t header[16];
+  // walk the top level boxes of the chunk, styp/prft may come before the moof
+  while (pos + 8 <= available) {
+    if (dash_stream_.ReadStreamFromOffset(reinterpret_cast<char *>(header), offset + pos, 8) != 8) {
+      return false;
+    }
+    if (memcmp(header + 4, "mdat", 4) == 0) {
+      return moof_found;
+    }
+    if (memcmp(header + 4, "moof", 4) == 0) {
+      moof_found = true;
+    }
+    uint64_t box_size = ((uint64_t)header[0] << 24) | ((uint64_t)header[1] << 16) | ((uint64_t)header[2] << 8) | header[3];
+    if (box_size == 1) {
+      if (pos + 16 > available) return false;
+      if (dash_stream_.ReadStreamFromOffset(reinterpret_cast<char *>(header), offset + pos, 16) != 16) {
+        return false;
+      }
+      box_size = 0;
+      for (int i = 8; i < 16; i++) {
+        box_size = (box_size << 8) | header[i];
+      }
+    }
+    // only the mdat may extend to the end of the chunk
+    if (box_size < 8) return false;
+    pos += box_size;
+  }
+  return false;
+}
+
+int32_t CmafSegment::StartProgressiveChunk(size_t offset) {
+  const int64_t chunk_size = index_range_[processed_chunk_id_ + 1];
+  const int64_t available = std::min<int64_t>(dash_stream_.GetStreamSize() - offset, chunk_size);
+  if (available <= 0 || !HasChunkHeader(offset, available)) {
+    return ERROR_NONE;
+  }
+
+  char *buf = new char[available];
+  size_t readSize = dash_stream_.ReadStreamFromOffset(buf, offset, available);
+  if (readSize != (size_t)available) {
+    DELETE_ARRAY(buf);
+    OMAF_LOG(LOG_WARNING, "dash stream has not enough data\n");
+    return ERROR_NO_VALUE;
+  }
+  progressive_chunk_ = std::make_shared<OmafSegment>(this->shared_from_this(),
+                                                     make_unique_vcd<StreamBlock>(std::move(buf), available));
+  progressive_chunk_->SetExpectedSize(chunk_size);
+  progressive_offset_ = offset;
+  progressive_size_ = available;
+  processed_chunk_id_++;
+
+  // chunk state change: generate node from the progressive chunk
+  progressive_handout_ = progressive_chunk_;
+  if (this->state_change_cb_) {
+    this->state_change_cb_(this->shared_from_this(), State::OPEN_SUCCES);
+  }
+  return ERROR_NONE;
+}
+
+int32_t CmafSegment::FeedProgressiveChunk() {
+  const int64_t chunk_size = progressive_chunk_->GetStreamSize();
+  const int64_t available = std::min<int64_t>(dash_stream_.GetStreamSize() - progressive_offset_, chunk_size);
+  if (available > progressive_size_) {
+    const int64_t append_size = available - progressive_size_;
+    char *buf = new char[append_size];
+    size_t readSize = dash_stream_.ReadStreamFromOffset(buf, progressive_offset_ + progressive_size_, append_size);
+    if (readSize != (size_t)append_size) {
+      DELETE_ARRAY(buf);
+      OMAF_LOG(LOG_WARNING, "dash stream has not enough data\n");
+      return ERROR_NO_VALUE;
+    }
+    progressive_chunk_->AppendStreamBlock(make_unique_vcd<StreamBlock>(std::move(buf), append_size));
+    progressive_size_ = available;
+    // wake up the parser to release the samples which are present now
+    if (this->state_change_cb_) {
+      this->state_change_cb_(this->shared_from_this(), State::OPEN);
+    }
+  }
+
+  if (progressive_size_ == chunk_size) {
+    progressive_chunk_.reset();
+    progressive_size_ = 0;
+  }
+  return ERROR_NONE;
+}
+
+void CmafSegment::AbortProgressiveChunk() {
+  if (progressive_chunk_.get() == nullptr) {
+    return;
+  }
+  OMAF_LOG(LOG_WARNING, "Segment download ended with %lld of %lld bytes in the progressive chunk\n",
+           (long long)progressive_size_, (long long)progressive_chunk_->GetStreamSize());
+  progressive_chunk_->SetState(State::OPEN_FAILED);
+  progressive_chunk_.reset();
+  progressive_size_ = 0;
+  if (this->state_change_cb_) {
+    this->state_change_cb_(this->shared_from_this(), State::OPEN);
+  }
+}
+
 int32_t CmafSegment::UpdateIndexStream(std::unique_ptr<StreamBlock> sb)
 {
   if (reader_ == nullptr) return ERROR_NULL_PTR;
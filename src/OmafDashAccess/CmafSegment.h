@@ -79,6 +79,12 @@ class CmafSegment : public OmafSegment {
     return nullptr;
   }
 
+  virtual OmafSegment::Ptr PopProgressiveChunk() noexcept {
+    OmafSegment::Ptr chunk = std::move(progressive_handout_);
+    progressive_handout_.reset();
+    return chunk;
+  }
+
   inline map<uint32_t, uint32_t> GetIndexRange() { return index_range_; };
 
   //!
@@ -88,7 +94,7 @@ class CmafSegment : public OmafSegment {
 
   virtual bool HasProcessDone() { if (processed_chunk_id_ == (int32_t)chunk_num_ - 1) return true; else return false; };
 
-private:
+protected:
 
   //!
   //! \brief  get segment index box length according to chunk num
@@ -110,7 +116,28 @@ private:
   //!
   bool CheckIndexBuf(char *index_buf, size_t index_size);
 
- private:
+  //!
+  //! \brief  check the chunk at offset of dash stream has its movie fragment
+  //!         header complete, i.e. the mdat header is present after a moof
+  //!
+  bool HasChunkHeader(size_t offset, int64_t available);
+
+  //!
+  //! \brief  hand out the next chunk before its media data completes
+  //!
+  int32_t StartProgressiveChunk(size_t offset);
+
+  //!
+  //! \brief  append newly downloaded bytes to the progressive chunk
+  //!
+  int32_t FeedProgressiveChunk();
+
+  //!
+  //! \brief  stop the progressive chunk when the download ends before it completes
+  //!
+  void AbortProgressiveChunk();
+
+ protected:
 
   StreamBlocks index_stream_; //<! segment index stream
   StreamBlocks chunk_stream_; //<! output chunk stream
@@ -124,6 +151,11 @@ private:
 
   uint32_t start_chunk_id_ = 0;
 
+  OmafSegment::Ptr progressive_chunk_;   //<! chunk handed out before all its bytes arrived
+  OmafSegment::Ptr progressive_handout_; //<! progressive chunk waiting for the reader manager
+  size_t progressive_offset_ = 0;        //<! offset of the progressive chunk in dash stream
+  int64_t progressive_size_ = 0;         //<! bytes of the progressive chunk copied so far
+
 };
 
 VCD_OMAF_END
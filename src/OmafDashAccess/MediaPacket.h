@@ -41,7 +41,10 @@
 #include "common.h"
 #include "general.h"
 #include "iso_structure.h"
+#include "MediaPacketPool.h"
+#include "../isolib/dash_parser/Mp4StreamIO.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace VCD {
@@ -69,7 +72,7 @@ class MediaPacket : public VCD::NonCopyable {
   //!
   virtual ~MediaPacket() {
     if (nullptr != m_pPayload) {
-      free(m_pPayload);
+      releaseBuffer(m_pPayload, m_nAllocSize);
       m_pPayload = nullptr;
       m_nAllocSize = 0;
       m_type = -1;
@@ -82,7 +85,9 @@ class MediaPacket : public VCD::NonCopyable {
   };
 
   MediaPacket* InsertParams(std::vector<uint8_t> params) {
+    if (!materializeSpans(params.size())) return this;
     char* new_dest = nullptr;
+    size_t old_alloc_size = m_nAllocSize;
     // FIXME align size?
     if (m_nAllocSize >= m_nRealSize + params.size()) {
       new_dest = m_pPayload;
@@ -99,14 +104,16 @@ class MediaPacket : public VCD::NonCopyable {
 
     // this is a new buffer
     if (new_dest != m_pPayload) {
-      free(m_pPayload);
+      releaseBuffer(m_pPayload, old_alloc_size);
       m_pPayload = new_dest;
     }
     return this;
   }
 
   MediaPacket* InsertADTSHdr() {
+    if (!materializeSpans(m_audioADTSHdr.size())) return this;
     char* new_dest = nullptr;
+    size_t old_alloc_size = m_nAllocSize;
     // FIXME align size?
     if (m_nAllocSize >= m_nRealSize + m_audioADTSHdr.size()) {
       new_dest = m_pPayload;
@@ -123,7 +130,7 @@ class MediaPacket : public VCD::NonCopyable {
 
     // this is a new buffer
     if (new_dest != m_pPayload) {
-      free(m_pPayload);
+      releaseBuffer(m_pPayload, old_alloc_size);
       m_pPayload = new_dest;
     }
     return this;
@@ -141,8 +148,9 @@ class MediaPacket : public VCD::NonCopyable {
   //!         size of new allocated packet
   //!
   int AllocatePacket(int size, char fill = 0) {
+    clearSpans();
     if (nullptr != m_pPayload) {
-      free(m_pPayload);
+      releaseBuffer(m_pPayload, m_nAllocSize);
       m_pPayload = nullptr;
       m_nAllocSize = 0;
     }
@@ -158,15 +166,147 @@ class MediaPacket : public VCD::NonCopyable {
   };
 
   //!
-  //! \brief  get the buffer pointer of the packet
+  //! \brief  Allocate the packet buffer from the pool, the buffer is not initialized
+  //!         and goes back to the pool when the packet releases it
+  //!
+  //! \param  [in] pool
+  //!         the pool to get the buffer from
+  //! \param  [in] size
+  //!         the buffer size to be allocated
+  //!
+  //! \return
+  //!         size of new allocated packet
+  //!
+  int AllocatePacket(std::shared_ptr<MediaPacketPool> pool, size_t size) {
+    if (pool.get() == nullptr) return AllocatePacket(static_cast<int>(size));
+
+    clearSpans();
+    if (nullptr != m_pPayload) {
+      releaseBuffer(m_pPayload, m_nAllocSize);
+      m_pPayload = nullptr;
+      m_nAllocSize = 0;
+    }
+
+    size_t capacity = 0;
+    m_pPayload = pool->Acquire(size, capacity);
+
+    if (nullptr == m_pPayload) return -1;
+
+    m_pool = std::move(pool);
+    m_nAllocSize = capacity;
+    m_nRealSize = 0;
+    return static_cast<int>(size);
+  };
+
+  //!
+  //! \brief  get the size of the allocated buffer
+  //!
+  size_t AllocatedSize() { return m_nAllocSize; };
+
+  //!
+  //! \brief  Let the packet reference the sample data in place instead of
+  //!         owning a copy, the data is only copied into a buffer when the
+  //!         payload is required to be contiguous
+  //!
+  //! \param  [in] pool
+  //!         the pool to get the buffer from when the data is copied
+  //! \param  [in] spans
+  //!         views of the sample data, in order
+  //! \param  [in] holder
+  //!         the owner of the viewed memory, kept alive with the packet
+  //! \param  [in] lengthPrefixed
+  //!         whether the NAL unit length prefixes are to be replaced by
+  //!         start codes when the data is copied
+  //!
+  //! \return
+  //!         size of the referenced sample data
+  //!
+  size_t SetPayloadSpans(std::shared_ptr<MediaPacketPool> pool, std::vector<VCD::MP4::StreamSpan> spans,
+                         std::shared_ptr<void> holder, bool lengthPrefixed) {
+    if (nullptr != m_pPayload) {
+      releaseBuffer(m_pPayload, m_nAllocSize);
+      m_pPayload = nullptr;
+      m_nAllocSize = 0;
+    }
+    m_nRealSize = 0;
+    for (auto& span : spans) {
+      m_nRealSize += static_cast<size_t>(span.size);
+    }
+    m_spans = std::move(spans);
+    m_spanHolder = std::move(holder);
+    m_spanPool = std::move(pool);
+    m_bLengthPrefixed = lengthPrefixed;
+    return m_nRealSize;
+  };
+
+  //!
+  //! \brief  whether the payload is still referenced in place
+  //!
+  bool HasPayloadSpans() const { return !m_spans.empty(); };
+
+  //!
+  //! \brief  copy bytes of the payload in Annex-B form, the data referenced
+  //!         in place is read without being copied into the packet, so the
+  //!         packet can be read from several threads at the same time
+  //!
+  //! \param  [in] offset
+  //!         offset in the payload to copy from
+  //! \param  [in] size
+  //!         number of bytes to copy
+  //! \param  [out] dst
+  //!         buffer with room for size bytes
+  //!
+  //! \return
+  //!         number of bytes copied
+  //!
+  size_t CopyPayload(size_t offset, size_t size, char* dst) const {
+    if (m_spans.empty()) {
+      if (nullptr == m_pPayload || offset >= m_nRealSize) return 0;
+      size = std::min(size, m_nRealSize - offset);
+      memcpy_s(dst, size, m_pPayload + offset, size);
+      return size;
+    }
+    size_t copied = static_cast<size_t>(VCD::MP4::CopyStreamSpans(m_spans, offset, size, dst));
+    if (m_bLengthPrefixed) {
+      // replace the length prefixes falling into the copied range by start codes
+      size_t pos = 0;
+      while (pos + 4 <= m_nRealSize && pos < offset + copied) {
+        for (size_t i = 0; i < 4; i++) {
+          if (pos + i >= offset && pos + i < offset + copied) dst[pos + i - offset] = (i == 3) ? 1 : 0;
+        }
+        pos += 4 + nalLengthAt(pos);
+      }
+    }
+    return copied;
+  };
+
+  //!
+  //! \brief  get the size of the first NAL unit of the payload with its
+  //!         start code, which is the whole payload unless the NAL units
+  //!         referenced in place are length prefixed
+  //!
+  size_t FirstNalSize() const {
+    if (m_spans.empty() || !m_bLengthPrefixed) return m_nRealSize;
+    return std::min(m_nRealSize, 4 + nalLengthAt(0));
+  };
+
+  //!
+  //! \brief  get the buffer pointer of the packet, the data referenced in
+  //!         place is copied into the packet buffer at the first call
   //!
   //! \return
   //!         the buffer pointer
   //!
-  char* Payload() { return m_pPayload; };
+  char* Payload() {
+    materializeSpans(0);
+    return m_pPayload;
+  };
+  // the moved payload is allocated by malloc, and to be freed by the caller
   char* MovePayload() {
+    materializeSpans(0);
     char* tmp = m_pPayload;
     m_pPayload = nullptr;
+    m_pool.reset();
     return tmp;
   }
   //!
@@ -197,7 +337,7 @@ class MediaPacket : public VCD::NonCopyable {
 
     memcpy_s(m_pPayload, m_nAllocSize, buf, m_nAllocSize);
 
-    free(buf);
+    releaseBuffer(buf, m_nAllocSize);
 
     m_nAllocSize = size;
     m_nRealSize = 0;
@@ -377,8 +517,61 @@ private:
     MediaPacket& operator=(const MediaPacket& other) { return *this; };
     MediaPacket(const MediaPacket& other) { /* do not create copies */ };
 
+    void clearSpans() {
+      m_spans.clear();
+      m_spanHolder.reset();
+      m_spanPool.reset();
+      m_bLengthPrefixed = false;
+    }
+
+    // copy the data referenced in place into an owned buffer with headroom
+    // bytes spare at the end, converting length prefixes into start codes
+    bool materializeSpans(size_t headroom) {
+      if (m_spans.empty()) return true;
+
+      std::vector<VCD::MP4::StreamSpan> spans;
+      spans.swap(m_spans);
+      std::shared_ptr<void> holder = std::move(m_spanHolder);
+      bool lengthPrefixed = m_bLengthPrefixed;
+      size_t size = m_nRealSize;
+      if (AllocatePacket(std::move(m_spanPool), size + headroom) < 0) {
+        OMAF_LOG(LOG_ERROR, "Failed to allocate the packet buffer with size %lu!\n", size + headroom);
+        return false;
+      }
+
+      size_t copied = static_cast<size_t>(VCD::MP4::CopyStreamSpans(spans, 0, size, m_pPayload));
+      m_nRealSize = copied;
+
+      if (lengthPrefixed) {
+        VCD::MP4::NalLengthToStartCodes(m_pPayload, copied);
+      }
+      return true;
+    }
+
+    // read the NAL unit length prefix at pos of the data referenced in place
+    size_t nalLengthAt(size_t pos) const {
+      uint8_t hdr[4] = {0};
+      if (VCD::MP4::CopyStreamSpans(m_spans, pos, 4, reinterpret_cast<char*>(hdr)) != 4) return m_nRealSize;
+      return (size_t(hdr[0]) << 24) | (size_t(hdr[1]) << 16) | (size_t(hdr[2]) << 8) | size_t(hdr[3]);
+    }
+
+    // give the buffer back to the pool it comes from, or free it
+    void releaseBuffer(char* buf, size_t allocSize) {
+      if (m_pool) {
+        m_pool->Release(buf, allocSize);
+        m_pool.reset();
+      } else {
+        free(buf);
+      }
+    }
+
  private:
   char* m_pPayload = nullptr;  //!< the payload buffer of the packet
+  std::shared_ptr<MediaPacketPool> m_pool;  //!< the pool of the payload buffer, null if it is from malloc
+  std::vector<VCD::MP4::StreamSpan> m_spans;  //!< payload referenced in place, empty once copied
+  std::shared_ptr<void> m_spanHolder;         //!< owner of the memory m_spans points to
+  std::shared_ptr<MediaPacketPool> m_spanPool;  //!< the pool for the buffer m_spans is copied into
+  bool m_bLengthPrefixed = false;             //!< whether NAL units in m_spans are length prefixed
   size_t m_nAllocSize = 0;     //!< the allocated size of packet
   size_t m_nRealSize = 0;      //!< real size of packet
   int m_type = -1;             //!< the type of the payload
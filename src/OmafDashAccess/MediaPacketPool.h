@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+//!
+
+//!
+//! \file:   MediaPacketPool.h
+//! \brief:  the pool of payload buffers for media packets
+//! \detail: buffers are grouped into size classes and kept for reusing after
+//!          the packet releases them, so caching the samples of one track does
+//!          not need one malloc for each sample.
+//!
+
+#ifndef MEDIAPACKETPOOL_H_
+#define MEDIAPACKETPOOL_H_
+
+#include "../utils/ns_def.h"
+#include "general.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VCD {
+namespace OMAF {
+
+const size_t DEFAULT_PACKET_POOL_CACHED_BYTES = 8 * 1024 * 1024;
+
+class MediaPacketPool : public VCD::NonCopyable {
+ public:
+  using Ptr = std::shared_ptr<MediaPacketPool>;
+
+  //!
+  //! \brief  construct
+  //!
+  //! \param  [in] max_cached_bytes
+  //!         the max bytes of idle buffers kept in the pool
+  //!
+  MediaPacketPool(size_t max_cached_bytes = DEFAULT_PACKET_POOL_CACHED_BYTES)
+      : max_cached_bytes_(max_cached_bytes), free_buffers_(kClassNum) {}
+
+  //!
+  //! \brief  de-construct
+  //!
+  virtual ~MediaPacketPool() {
+    for (auto &buffers : free_buffers_) {
+      for (auto buf : buffers) {
+        free(buf);
+      }
+    }
+  }
+
+  //!
+  //! \brief  Get one buffer which is able to hold size bytes, the buffer is not initialized
+  //!
+  //! \param  [in] size
+  //!         the bytes to be held
+  //! \param  [out] capacity
+  //!         the real size of the buffer, it is needed when releasing the buffer
+  //!
+  //! \return
+  //!         the buffer, it is allocated by malloc, so it can also be freed by free
+  //!
+  char *Acquire(size_t size, size_t &capacity) noexcept {
+    capacity = classCapacity(size);
+    size_t idx = classIndex(capacity);
+    if (idx < kClassNum) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto &buffers = free_buffers_[idx];
+      if (!buffers.empty()) {
+        char *buf = buffers.back();
+        buffers.pop_back();
+        cached_bytes_ -= capacity;
+        reused_num_++;
+        return buf;
+      }
+    }
+    char *buf = reinterpret_cast<char *>(malloc(capacity));
+    if (buf == nullptr) {
+      capacity = 0;
+      return nullptr;
+    }
+    allocated_num_++;
+    return buf;
+  }
+
+  //!
+  //! \brief  Give back the buffer got from Acquire
+  //!
+  //! \param  [in] buf
+  //!         the buffer
+  //! \param  [in] capacity
+  //!         the capacity returned by Acquire
+  //!
+  void Release(char *buf, size_t capacity) noexcept {
+    if (buf == nullptr) return;
+    size_t idx = classIndex(capacity);
+    if (idx < kClassNum && classCapacity(capacity) == capacity) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (cached_bytes_ + capacity <= max_cached_bytes_) {
+        try {
+          free_buffers_[idx].push_back(buf);
+          cached_bytes_ += capacity;
+          return;
+        } catch (const std::exception &) {
+        }
+      }
+    }
+    free(buf);
+  }
+
+  //!
+  //! \brief  Get the bytes of idle buffers in the pool
+  //!
+  size_t CachedBytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cached_bytes_;
+  }
+
+  //!
+  //! \brief  Get the number of buffers allocated by malloc and the number of reused ones
+  //!
+  size_t AllocatedNum() { return allocated_num_; }
+  size_t ReusedNum() { return reused_num_; }
+
+ private:
+  // size classes go from 4KB to 64MB, each power of two is split into 4 steps,
+  // so at most 1/4 of one buffer is wasted. larger buffers are not cached.
+  enum : size_t {
+    kMinClassBits = 12,
+    kMaxClassBits = 26,
+    kClassSteps = 4,
+    kClassNum = (kMaxClassBits - kMinClassBits) * kClassSteps + 1,
+  };
+
+  static size_t highestBit(size_t size) noexcept {
+    size_t bits = 0;
+    while (size >>= 1) bits++;
+    return bits;
+  }
+
+  static size_t classCapacity(size_t size) noexcept {
+    if (size <= (static_cast<size_t>(1) << kMinClassBits)) return static_cast<size_t>(1) << kMinClassBits;
+    size_t bits = highestBit(size - 1);
+    if (bits >= kMaxClassBits) return size;
+    size_t step = static_cast<size_t>(1) << (bits - 2);
+    return (size + step - 1) / step * step;
+  }
+
+  static size_t classIndex(size_t capacity) noexcept {
+    if (capacity <= (static_cast<size_t>(1) << kMinClassBits)) return 0;
+    size_t bits = highestBit(capacity - 1);
+    if (bits >= kMaxClassBits) return kClassNum;
+    size_t step = static_cast<size_t>(1) << (bits - 2);
+    return (bits - kMinClassBits) * kClassSteps + (capacity - (static_cast<size_t>(1) << bits) + step - 1) / step;
+  }
+
+ private:
+  std::mutex mutex_;
+  size_t max_cached_bytes_;
+  size_t cached_bytes_ = 0;
+  std::vector<std::vector<char *>> free_buffers_;
+  std::atomic<size_t> allocated_num_{0};
+  std::atomic<size_t> reused_num_{0};
+};
+
+}  // namespace OMAF
+}  // namespace VCD
+
+#endif /* MEDIAPACKETPOOL_H_ */
@@ -67,6 +67,7 @@ OmafAdaptationSet::OmafAdaptationSet() {
   mStartChunkId = 0;
   mChunkInfoType = ChunkInfoType::NO_CHUNKINFO;
   mReEnable = false;
+  mDownloadPriority = TaskPriority::NORMAL;
   mPF = PF_UNKNOWN;
   mSegmentDuration = 0;
   mChunkDuration = 0;
@@ -475,13 +476,14 @@ int OmafAdaptationSet::DownloadSegment(bool enableCMAF) {
   DashSegmentSourceParams params;
 
   params.dash_url_ = seg->GenerateCompleteURL(mBaseURL, repID, mActiveSegNum);
-  params.priority_ = TaskPriority::NORMAL;
+  params.priority_ = mDownloadPriority.load();
   params.timeline_point_ = static_cast<int64_t>(mSegNum);
   params.start_chunk_id_ = (mSegNum == 1) ? mStartChunkId : 0; // start chunk from 0
   params.chunk_num_ = (mChunkDuration == 0) ? 1 : mSegmentDuration * 1000 / mChunkDuration;
   params.header_size_ = 0;
   params.cloc_size_ = 0;
   params.stream_type_ = omaf_reader_mgr_->GetStreamType();
+  params.progressive_parse_ = omaf_reader_mgr_->IsProgressiveParse();
 
   OmafSegment::Ptr pSegment = nullptr;
   if (enableCMAF) {
@@ -588,13 +590,14 @@ int OmafAdaptationSet::DownloadAssignedSegment(uint32_t trackID, uint32_t segID,
   DashSegmentSourceParams params;
 
   params.dash_url_ = seg->GenerateCompleteURL(mBaseURL, repID, realSegNum);
-  params.priority_ = TaskPriority::NORMAL;
+  params.priority_ = TaskPriority::HIGH; // catch-up segment is due for playback soon
   params.timeline_point_ = static_cast<int64_t>(segID);
   params.start_chunk_id_ = start_chunk_id;
   params.chunk_num_ = (mChunkDuration == 0) ? 1 : mSegmentDuration * 1000 / mChunkDuration;
   params.header_size_ = 0;
   params.cloc_size_ = 0;
   params.stream_type_ = omaf_reader_mgr_->GetStreamType();
+  params.progressive_parse_ = omaf_reader_mgr_->IsProgressiveParse();
 
   OmafSegment::Ptr pSegment = nullptr;
   if (enableCMAF) {
@@ -49,6 +49,7 @@
 #include <string>
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 using namespace VCD::VRVideo;
 
@@ -221,6 +222,14 @@ class OmafAdaptationSet {
   };
   bool IsEnabled() { return mEnable; };
 
+  //!
+  //! \brief  Set the priority of the following segment download tasks,
+  //!         the tracks selector updates it with the viewport priority
+  //!         while the download thread reads it
+  //!
+  void SetDownloadPriority(TaskPriority priority) { mDownloadPriority.store(priority); };
+  TaskPriority GetDownloadPriority() { return mDownloadPriority.load(); };
+
   virtual OmafAdaptationSet* GetClassType() { return this; };
   TileDef*                   GetTileInfo()                               { return mTileInfo;            };
   virtual bool IsExtractor() { return mIsExtractorTrack; }
@@ -282,6 +291,7 @@ class OmafAdaptationSet {
   bool mEnable;                     //<! is Adaptation Set enabled
   bool mReEnable;                   //<! flag for Adaption Set is re-enabled
   std::list<bool> mEnableRecord;    //<! record the last 3 enable changes
+  std::atomic<TaskPriority> mDownloadPriority;   //<! priority of segment download tasks
   uint32_t mGopSize;                //<! gop size of stream
   OmafDashMode mMode;               //<! dash mode of stream
 
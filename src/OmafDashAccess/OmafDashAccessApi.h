@@ -78,6 +78,12 @@ typedef struct _omafPredictorParams {
   int enable;
 } OmafPredictorParams;
 
+/*
+ * max_parse_workers and enable_progressive_parse are appended to OmafParams,
+ * so callers built with an older header must be rebuilt. Callers shall
+ * memset the structure to 0 before setting it, 0 keeps the default of
+ * each parameter.
+ */
 typedef struct _omafDashParams {
   //for download
   OmafHttpProxy proxy;
@@ -95,6 +101,10 @@ typedef struct _omafDashParams {
   uint32_t max_response_times_in_seg;
   uint32_t max_catchup_width;
   uint32_t max_catchup_height;
+  //for segment parsing, 0 or a number above 64 means default
+  uint32_t max_parse_workers;
+  //parse cmaf chunks while their media data is downloading
+  bool enable_progressive_parse;
 } OmafParams;
 
 /*
@@ -215,11 +225,24 @@ int OmafAccess_ChangeViewport(Handler hdl, HeadPose* pose);
 /*
  * description: API to get statistic data such as bandwith etc.
  * params: hdl - [in] handler created with DashStreaming_Init
- *         info - [out] the information current statistic data
+ *         info - [out] the information current statistic data, only the
+ *                first DASH_STATISTIC_INFO_BASE_SIZE bytes are written
  * return: the error return from the API
  */
 int OmafAccess_Statistic(Handler hdl, DashStatisticInfo* info);
 
+/*
+ * description: API to get statistic data with the stitch time and the
+ *              cancelled segments
+ * params: hdl - [in] handler created with DashStreaming_Init
+ *         info - [out] the information current statistic data
+ *         info_size - [in] size of the structure of the caller, which is
+ *                     sizeof(DashStatisticInfo) of its header. Only the
+ *                     fields that fit in it are written
+ * return: the error return from the API
+ */
+int OmafAccess_StatisticEx(Handler hdl, DashStatisticInfo* info, uint32_t info_size);
+
 /*
  * description: API to Close the Handle and release relative resources after dealing with
  * the media
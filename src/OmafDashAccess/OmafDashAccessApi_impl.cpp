@@ -130,6 +130,13 @@ Handler OmafAccess_Init(DashStreamingClient *pCtx) {
   omaf_dash_params.max_response_times_in_seg = omaf_params.max_response_times_in_seg;
   omaf_dash_params.max_catchup_width = omaf_params.max_catchup_width;
   omaf_dash_params.max_catchup_height = omaf_params.max_catchup_height;
+  // for segment parsing
+  if (omaf_params.max_parse_workers > MAX_PARSE_WORKERS) {
+    OMAF_LOG(LOG_WARNING, "Parse worker number %u is out of range, the default is used\n", omaf_params.max_parse_workers);
+  } else if (omaf_params.max_parse_workers > 0) {
+    omaf_dash_params.max_parse_workers_ = omaf_params.max_parse_workers;
+  }
+  omaf_dash_params.enable_progressive_parse_ = omaf_params.enable_progressive_parse == 0 ? false : true;
 
   OMAF_LOG(LOG_INFO,"Dash parameter %s\n", omaf_dash_params.to_string().c_str());
   pSource->SetOmafDashParams(omaf_dash_params);
@@ -287,9 +294,21 @@ int OmafAccess_ChangeViewport(Handler hdl, HeadPose *pose) {
 }
 
 int OmafAccess_Statistic(Handler hdl, DashStatisticInfo *info) {
+  return OmafAccess_StatisticEx(hdl, info, DASH_STATISTIC_INFO_BASE_SIZE);
+}
+
+int OmafAccess_StatisticEx(Handler hdl, DashStatisticInfo *info, uint32_t info_size) {
+  if (hdl == nullptr || info == nullptr || info_size < DASH_STATISTIC_INFO_BASE_SIZE) {
+    return ERROR_INVALID;
+  }
   OmafMediaSource *pSource = (OmafMediaSource *)hdl;
 
-  return pSource->GetStatistic(info);
+  // callers built with an older header have a smaller structure
+  DashStatisticInfo statistic;
+  memset_s(&statistic, sizeof(DashStatisticInfo), 0);
+  int ret = pSource->GetStatistic(&statistic);
+  memcpy_s(info, info_size, &statistic, std::min<size_t>(info_size, sizeof(DashStatisticInfo)));
+  return ret;
 }
 
 int OmafAccess_Close(Handler hdl) {
@@ -31,13 +31,27 @@
 //!
 
 #include "OmafCurlMultiHandler.h"
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <iterator>
+#include <thread>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace VCD {
 namespace OMAF {
 
 std::atomic_size_t OmafDownloadTask::TASK_ID(0);
 
+static int64_t steadyNowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 OmafCurlMultiDownloader::OmafCurlMultiDownloader(long max_parallel_transfers)
     : max_parallel_transfers_(max_parallel_transfers) {}
 OmafCurlMultiDownloader::~OmafCurlMultiDownloader() { close(); }
@@ -53,6 +67,25 @@ OMAF_STATUS OmafCurlMultiDownloader::init(const CurlParams& p, OmafDownloadTask:
     OMAF_LOG(LOG_INFO, "Set max transfer to %ld\n", max_parallel_);
     curl_multi_setopt(curl_multi_, CURLMOPT_MAXCONNECTS, max_parallel_ << 1);
 
+    // 2.1 event loop, curl sockets and the wakeup eventfd share one epoll set
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wakeup_fd_ < 0) {
+      OMAF_LOG(LOG_ERROR, "Failed to create the epoll/eventfd for multi handler!\n");
+      return ERROR_INVALID;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeup_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) != 0) {
+      OMAF_LOG(LOG_ERROR, "Failed to add the wakeup eventfd to epoll!\n");
+      return ERROR_INVALID;
+    }
+    curl_multi_setopt(curl_multi_, CURLMOPT_SOCKETFUNCTION, &OmafCurlMultiDownloader::onSocket);
+    curl_multi_setopt(curl_multi_, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(curl_multi_, CURLMOPT_TIMERFUNCTION, &OmafCurlMultiDownloader::onTimer);
+    curl_multi_setopt(curl_multi_, CURLMOPT_TIMERDATA, this);
+
     // 3. create the easy downloader pool
     downloader_pool_ = std::move(make_unique_vcd<OmafCurlEasyDownloaderPool>(max_parallel_ << 1));
     if (downloader_pool_ == NULL) {
@@ -80,6 +113,7 @@ OMAF_STATUS OmafCurlMultiDownloader::close() noexcept {
     // 2. detach the thread
     if (worker_.joinable()) {
       bworking_ = false;
+      wakeup();
       worker_.join();
     }
     // 3. clean up
@@ -87,6 +121,14 @@ OMAF_STATUS OmafCurlMultiDownloader::close() noexcept {
       curl_multi_cleanup(curl_multi_);
       curl_multi_ = nullptr;
     }
+    if (wakeup_fd_ >= 0) {
+      ::close(wakeup_fd_);
+      wakeup_fd_ = -1;
+    }
+    if (epoll_fd_ >= 0) {
+      ::close(epoll_fd_);
+      epoll_fd_ = -1;
+    }
     return ERROR_NONE;
   } catch (const std::exception& ex) {
     OMAF_LOG(LOG_ERROR, "Exception when close curl multi handler, ex: %s\n", ex.what());
@@ -104,9 +146,10 @@ OMAF_STATUS OmafCurlMultiDownloader::addTask(OmafDownloadTask::Ptr task) noexcep
     task->state(OmafDownloadTask::State::READY);
     {
       std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
-      ready_task_list_.push_back(task);
+      insertReadyTask(task);
     }
     task_size_.fetch_add(1);
+    wakeup();
     OMAF_LOG(LOG_INFO, "02-task id %lld,  task count=%d\n", task->id(), task.use_count());
     return ERROR_NONE;
   } catch (const std::exception& ex) {
@@ -121,14 +164,13 @@ OMAF_STATUS OmafCurlMultiDownloader::removeTask(OmafDownloadTask::Ptr task) noex
       return ERROR_INVALID;
     }
 
-    // FIXME, the task state may change when processing, skip this issue now
-    if (task->state() == OmafDownloadTask::State::READY) {
-      removeReadyTask(task);
-    }
-
-    if (task->state() == OmafDownloadTask::State::RUNNING) {
-      removeRunningTask(task);
+    // the task state is only changed in the runner thread, so hand the
+    // removal over to it instead of touching the multi handle here
+    {
+      std::lock_guard<std::mutex> lock(cancel_task_list_mutex_);
+      cancel_tasks_.push_back(std::move(task));
     }
+    wakeup();
 
     return ERROR_NONE;
   } catch (const std::exception& ex) {
@@ -242,6 +284,8 @@ OMAF_STATUS OmafCurlMultiDownloader::startTransfer(OmafDownloadTask::Ptr task, O
     // multi hanlder will manager the life cycle of curl easy hanlder,
     // so, we won't send the state callback to downloader.
     if (downloader->getType() == OmafCurlEasyDownloader::Type::DATA) {
+      // full range transfer may resume from the received size after timeout or preemption
+      if (!task->enable_byte_range_) task->resume_offset_ = task->stream_size_;
       std::chrono::high_resolution_clock clock;
       uint64_t start = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
       task->setStartTime(start);
@@ -286,9 +330,8 @@ OMAF_STATUS OmafCurlMultiDownloader::startTransfer(OmafDownloadTask::Ptr task, O
         task->transfer_times_ += 1;
       }
     }
-
-    int still_alive = 0;
-    curl_multi_perform(curl_multi_, &still_alive);
+    // curl_multi_add_handle arms a zero timeout through onTimer, the runner
+    // kicks off the new transfer on its next poll.
     return ERROR_NONE;
   } catch (const std::exception& ex) {
     OMAF_LOG(LOG_ERROR, "Exception when start curl transfer task, ex: %s\n", ex.what());
@@ -350,9 +393,74 @@ OMAF_STATUS OmafCurlMultiDownloader::removeRunningTask(OmafDownloadTask::Ptr tas
   }
 }
 
+void OmafCurlMultiDownloader::processCancelTasks(void) noexcept {
+  std::vector<OmafDownloadTask::Ptr> tasks;
+  {
+    std::lock_guard<std::mutex> lock(cancel_task_list_mutex_);
+    if (cancel_tasks_.empty()) return;
+    tasks.swap(cancel_tasks_);
+  }
+
+  for (auto& task : tasks) {
+    try {
+      switch (task->state()) {
+        case OmafDownloadTask::State::CREATE:
+          // not handed to the downloader yet
+          markTaskCancelled(task);
+          task->state(OmafDownloadTask::State::STOPPED);
+          if (task_done_cb_) task_done_cb_(std::move(task));
+          break;
+        case OmafDownloadTask::State::READY:
+          markTaskCancelled(task);
+          removeReadyTask(task);
+          processTaskDone(std::move(task));
+          break;
+        case OmafDownloadTask::State::RUNNING: {
+          markTaskCancelled(task);
+          removeRunningTask(task);
+          {
+            std::lock_guard<std::mutex> lock(pending_data_task_list_mutex);
+            auto it = std::find(pending_data_tasks_.begin(), pending_data_tasks_.end(), task);
+            if (it != pending_data_tasks_.end()) pending_data_tasks_.erase(it);
+          }
+          task->state(OmafDownloadTask::State::STOPPED);
+          processTaskDone(std::move(task));
+          break;
+        }
+        default:
+          // the task is done already
+          break;
+      }
+    } catch (const std::exception& ex) {
+      OMAF_LOG(LOG_ERROR, "Exception when cancel task, ex: %s\n", ex.what());
+    }
+  }
+}
+
+void OmafCurlMultiDownloader::markTaskCancelled(OmafDownloadTask::Ptr task) noexcept {
+  size_t saved = 0;
+  int64_t received = task->streamSize() - static_cast<int64_t>(task->resume_offset_);
+  int64_t expected = -1;
+  if (task->state() == OmafDownloadTask::State::RUNNING && !task->enable_byte_range_ && task->easy_d_downloader_) {
+    expected = task->easy_d_downloader_->header().content_length_;
+  }
+  if (expected >= 0) {
+    saved = expected > received ? static_cast<size_t>(expected - received) : 0;
+  } else {
+    size_t count = finished_count_.load();
+    size_t average = count ? finished_bytes_.load() / count : 0;
+    saved = average > static_cast<size_t>(task->streamSize()) ? average - task->streamSize() : 0;
+  }
+  cancelled_count_.fetch_add(1);
+  cancelled_bytes_.fetch_add(saved);
+  OMAF_LOG(LOG_INFO, "Cancel task %s, saved %lld bytes\n", task->to_string().c_str(), static_cast<int64_t>(saved));
+}
+
 OMAF_STATUS OmafCurlMultiDownloader::markTaskFinish(OmafDownloadTask::Ptr task) noexcept {
   try {
     OMAF_LOG(LOG_INFO, "Task finish, url=%s\n", task->url().c_str());
+    finished_count_.fetch_add(1);
+    finished_bytes_.fetch_add(task->streamSize());
 
     moveDataTaskFromRun(task, OmafDownloadTask::State::FINISH);
     moveHeaderTaskFromRun(task, OmafDownloadTask::State::FINISH);
@@ -542,15 +650,11 @@ OMAF_STATUS OmafCurlMultiDownloader::moveHeaderTaskFromRun(OmafDownloadTask::Ptr
 void OmafCurlMultiDownloader::threadRunner(void) noexcept {
   try {
     while (bworking_) {
-      startTaskDownload();
+      processCancelTasks();
 
-      int still_alive = 0;
-      curl_multi_perform(curl_multi_, &still_alive);
+      startTaskDownload();
 
-      if (still_alive == max_parallel_) {
-        int numfds;
-        curl_multi_wait(curl_multi_, nullptr, 0, 100, &numfds);
-      }
+      pollTransfers();
 
       retriveDoneTask();
 
@@ -561,35 +665,130 @@ void OmafCurlMultiDownloader::threadRunner(void) noexcept {
   }
 }
 
+void OmafCurlMultiDownloader::pollTransfers(void) noexcept {
+  int still_alive = 0;
+  // 1. block until a socket is ready, the curl timer expires or we are woken up
+  int timeout = -1;
+  int64_t deadline = timer_deadline_ms_.load();
+  if (deadline >= 0) {
+    int64_t left = deadline - steadyNowMs();
+    timeout = left > 0 ? static_cast<int>(left) : 0;
+  }
+
+  struct epoll_event events[MAX_EPOLL_EVENTS];
+  int num = epoll_wait(epoll_fd_, events, MAX_EPOLL_EVENTS, timeout);
+  if (num < 0 && errno != EINTR) {
+    OMAF_LOG(LOG_ERROR, "Failed to wait on epoll, errno=%d\n", errno);
+  }
+
+  // 2. hand the ready sockets to curl
+  for (int i = 0; i < num; i++) {
+    if (events[i].data.fd == wakeup_fd_) {
+      eventfd_t value = 0;
+      eventfd_read(wakeup_fd_, &value);
+      continue;
+    }
+    int flags = 0;
+    if (events[i].events & EPOLLIN) flags |= CURL_CSELECT_IN;
+    if (events[i].events & EPOLLOUT) flags |= CURL_CSELECT_OUT;
+    if (events[i].events & (EPOLLERR | EPOLLHUP)) flags |= CURL_CSELECT_ERR;
+    curl_multi_socket_action(curl_multi_, events[i].data.fd, flags, &still_alive);
+  }
+
+  // 3. fire the curl timeout when due
+  deadline = timer_deadline_ms_.load();
+  if (deadline >= 0 && steadyNowMs() >= deadline) {
+    timer_deadline_ms_ = -1;
+    curl_multi_socket_action(curl_multi_, CURL_SOCKET_TIMEOUT, 0, &still_alive);
+  }
+}
+
+void OmafCurlMultiDownloader::wakeup(void) noexcept {
+  if (wakeup_fd_ >= 0) {
+    eventfd_write(wakeup_fd_, 1);
+  }
+}
+
+int OmafCurlMultiDownloader::onSocket(CURL* easy, curl_socket_t s, int what, void* userp, void* socketp) {
+  UNUSED(easy);
+  UNUSED(socketp);
+  OmafCurlMultiDownloader* self = static_cast<OmafCurlMultiDownloader*>(userp);
+  if (self == nullptr || self->epoll_fd_ < 0) return -1;
+
+  if (what == CURL_POLL_REMOVE) {
+    epoll_ctl(self->epoll_fd_, EPOLL_CTL_DEL, s, nullptr);
+    return 0;
+  }
+
+  struct epoll_event ev;
+  ev.events = 0;
+  ev.data.fd = s;
+  if (what == CURL_POLL_IN || what == CURL_POLL_INOUT) ev.events |= EPOLLIN;
+  if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) ev.events |= EPOLLOUT;
+  if (epoll_ctl(self->epoll_fd_, EPOLL_CTL_MOD, s, &ev) != 0) {
+    if (epoll_ctl(self->epoll_fd_, EPOLL_CTL_ADD, s, &ev) != 0) {
+      OMAF_LOG(LOG_ERROR, "Failed to add curl socket %d to epoll, errno=%d\n", s, errno);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int OmafCurlMultiDownloader::onTimer(CURLM* multi, long timeout_ms, void* userp) {
+  UNUSED(multi);
+  OmafCurlMultiDownloader* self = static_cast<OmafCurlMultiDownloader*>(userp);
+  if (self == nullptr) return -1;
+
+  self->timer_deadline_ms_ = (timeout_ms < 0) ? -1 : steadyNowMs() + timeout_ms;
+  // the timer may be armed from a caller thread (e.g. removeTask), make the runner re-arm its wait
+  if (std::this_thread::get_id() != self->worker_.get_id()) {
+    self->wakeup();
+  }
+  return 0;
+}
+
 OMAF_STATUS OmafCurlMultiDownloader::startTaskDownload(void) noexcept {
   try {
-    // start a new task
-    if ((run_task_map_.size() < static_cast<size_t>(max_parallel_transfers_)) && (ready_task_list_.size() > 0)) {
+    // admit all ready tasks up to the parallel limit in one pass
+    while (true) {
+      bool full = false;
+      {
+        std::lock_guard<std::mutex> lock(run_task_map_mutex_);
+        full = run_task_map_.size() >= static_cast<size_t>(max_parallel_);
+      }
+      if (full) {
+        // let the urgent task take the connection of a background transfer
+        bool urgent = false;
+        {
+          std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
+          urgent = !ready_task_list_.empty() && ready_task_list_.front()->priority() == TaskPriority::HIGH;
+        }
+        if (!urgent || !preemptRunningTask()) break;
+      }
+
       OmafDownloadTask::Ptr task = NULL;
       {
         std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
+        if (ready_task_list_.empty()) break;
         task = std::move(ready_task_list_.front());
-        OMAF_LOG(LOG_INFO, "1-task id %lld, task count=%d\n", task->id(),  task.use_count());
         ready_task_list_.pop_front();
       }
 
-      OMAF_STATUS ret = ERROR_NONE;
-      if (task != NULL) {
-        ret = createTransferForTask(task);
-        if (ret == ERROR_NONE) {
-          ret = startTransferForTask(task);
-          if (ret != ERROR_NONE) {
-            OMAF_LOG(LOG_ERROR, "Failed to start the transfer!\n");
-            removeRunningTask(task);
-          }
-        } else {
-          OMAF_LOG(LOG_ERROR, "Failed to create the transfer!\n");
-        }
-      }
-      else
-      {
+      if (task == NULL) {
         OMAF_LOG(LOG_ERROR, "Download task failed to create!\n");
-        return ERROR_NULL_PTR;
+        continue;
+      }
+      OMAF_LOG(LOG_INFO, "1-task id %lld, task count=%d\n", task->id(), task.use_count());
+
+      OMAF_STATUS ret = createTransferForTask(task);
+      if (ret == ERROR_NONE) {
+        ret = startTransferForTask(task);
+        if (ret != ERROR_NONE) {
+          OMAF_LOG(LOG_ERROR, "Failed to start the transfer!\n");
+          removeRunningTask(task);
+        }
+      } else {
+        OMAF_LOG(LOG_ERROR, "Failed to create the transfer!\n");
       }
       OMAF_LOG(LOG_INFO, "2-task id %lld, task count=%d\n", task->id(), task.use_count());
     }
@@ -600,6 +799,55 @@ OMAF_STATUS OmafCurlMultiDownloader::startTaskDownload(void) noexcept {
   }
 }
 
+void OmafCurlMultiDownloader::insertReadyTask(OmafDownloadTask::Ptr task) noexcept {
+  auto it = ready_task_list_.end();
+  while (it != ready_task_list_.begin()) {
+    auto prev = std::prev(it);
+    if (!OmafDownloadTask::moreUrgent(task, *prev)) break;
+    it = prev;
+  }
+  ready_task_list_.insert(it, std::move(task));
+}
+
+bool OmafCurlMultiDownloader::preemptRunningTask(void) noexcept {
+  try {
+    OmafDownloadTask::Ptr victim;
+    OmafCurlEasyDownloader::Ptr downloader;
+    {
+      std::lock_guard<std::mutex> lock(run_task_map_mutex_);
+      for (auto& run : run_task_map_) {
+        auto& task = run.second;
+        // only full range background transfers can be resumed later
+        if (task->priority() != TaskPriority::LOW || task->enable_byte_range_ ||
+            run.first != task->easy_d_downloader_) {
+          continue;
+        }
+        if (victim.get() == nullptr || victim->timeline_point_ < task->timeline_point_) {
+          victim = task;
+          downloader = run.first;
+        }
+      }
+      if (victim.get() == nullptr) return false;
+      run_task_map_.erase(downloader);
+    }
+
+    OMAF_LOG(LOG_INFO, "Preempt background task %s\n", victim->to_string().c_str());
+    removeTransfer(victim, downloader);
+    downloader->setState(OmafCurlEasyDownloader::State::IDLE);
+    // the resumed transfer shall not consume the retry budget
+    victim->transfer_times_ -= 1;
+    victim->state(OmafDownloadTask::State::READY);
+    {
+      std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
+      insertReadyTask(std::move(victim));
+    }
+    return true;
+  } catch (const std::exception& ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when preempt running task, ex: %s\n", ex.what());
+    return false;
+  }
+}
+
 size_t OmafCurlMultiDownloader::retriveDoneTask(int msgNum) noexcept {
   try {
     UNUSED(msgNum);
@@ -635,7 +883,8 @@ size_t OmafCurlMultiDownloader::retriveDoneTask(int msgNum) noexcept {
           // 3.1 disable byte range mode, to mark task finish or timeout
           std::chrono::high_resolution_clock clock;
           if (!task->enable_byte_range_) {
-            if (OmafCurlEasyHelper::success(header.http_status_code_) && (header.content_length_ == task->streamSize())) {
+            if (OmafCurlEasyHelper::success(header.http_status_code_) &&
+                (header.content_length_ == task->streamSize() - static_cast<int64_t>(task->resume_offset_))) {
               uint64_t end = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
               task->setEndTime(end);
               markTaskFinish(std::move(task));
@@ -53,6 +53,7 @@ class OmafCurlMultiDownloader;
 class OmafDownloadTask;
 
 const int DEFAULT_MAX_PARALLER_TRANSFERS = 50;
+const int MAX_EPOLL_EVENTS = 64;
 
 class OmafDownloadTaskPerfCounter : public VCD::NonCopyable {
  public:
@@ -106,7 +107,8 @@ class OmafDownloadTask : public VCD::NonCopyable {
   OmafDownloadTask(const SourceParams &params, OmafDashSegmentClient::OnData dcb, OmafDashSegmentClient::OnChunkData cdcb, OmafDashSegmentClient::OnState scb)
       : url_(params.dash_url_), dcb_(dcb), cdcb_(cdcb), scb_(scb), header_size_(params.header_size_), cloc_size_(params.cloc_size_),
         chunk_num_(params.chunk_num_), enable_byte_range_(params.enable_byte_range_), downloaded_chunk_id_(params.start_chunk_id_ - 1),
-        stream_type_(params.stream_type_), chunk_info_type_(params.chunk_info_type_) {
+        stream_type_(params.stream_type_), chunk_info_type_(params.chunk_info_type_), priority_(params.priority_),
+        timeline_point_(params.timeline_point_) {
     id_ = TASK_ID.fetch_add(1);
     parseTask();
   };
@@ -132,10 +134,29 @@ class OmafDownloadTask : public VCD::NonCopyable {
   inline size_t headerSize(void) const noexcept { return header_size_; }
   inline size_t id() const noexcept { return id_; }
   inline bool enableByteRange() const noexcept { return enable_byte_range_; }
+  inline TaskPriority priority() const noexcept { return priority_; }
+  inline int64_t timelinePoint() const noexcept { return timeline_point_; }
+
+  //!
+  //! \brief whether task a should be scheduled before task b. urgent tasks
+  //!        (catch-up) go first, then the earliest playback deadline, then
+  //!        the viewport priority, then the arrival order.
+  //!
+  static bool moreUrgent(const Ptr &a, const Ptr &b) noexcept {
+    bool a_urgent = a->priority_ == TaskPriority::HIGH;
+    bool b_urgent = b->priority_ == TaskPriority::HIGH;
+    if (a_urgent != b_urgent) return a_urgent;
+    if (a->timeline_point_ != b->timeline_point_) return a->timeline_point_ < b->timeline_point_;
+    if (a->priority_ != b->priority_) return a->priority_ < b->priority_;
+    return a->id_ < b->id_;
+  }
+
   std::string to_string() const noexcept {
     std::stringstream ss;
     ss << "task, id=" << id_;
     ss << ", url=" << url_;
+    ss << ", priority=" << VCD::OMAF::priority(priority_);
+    ss << ", timeline_point=" << timeline_point_;
     ss << ", header_size=" << header_size_;
     ss << ", cloc_size=" << cloc_size_;
     ss << ", stream_size=" << stream_size_;
@@ -167,7 +188,7 @@ class OmafDownloadTask : public VCD::NonCopyable {
       case State::STOPPED:
       case State::TIMEOUT:
       case State::FINISH:
-        if (perf_counter_) {
+        if (perf_counter_ && easy_d_downloader_) {
           perf_counter_->downloadTime(easy_d_downloader_->downloadTime());
           perf_counter_->downloadSpeed(easy_d_downloader_->speed());
         }
@@ -262,6 +283,9 @@ class OmafDownloadTask : public VCD::NonCopyable {
   map<uint32_t, uint32_t> index_range_;
   DashStreamType stream_type_ = DASH_STREAM_STATIC;
   ChunkInfoType chunk_info_type_ = ChunkInfoType::NO_CHUNKINFO;
+  TaskPriority priority_ = TaskPriority::NORMAL;
+  int64_t timeline_point_ = -1;
+  size_t resume_offset_ = 0; // stream size when the current full range transfer started
 
  private:
   static std::atomic_size_t TASK_ID;
@@ -297,6 +321,12 @@ class OmafCurlMultiDownloader : public VCD::NonCopyable {
     return static_cast<size_t>(size);
   }
 
+  //! \brief number of cancelled tasks and the bytes they did not download,
+  //!        the size of a not started task is estimated by the average size
+  //!        of finished tasks
+  inline size_t cancelledCount() const noexcept { return cancelled_count_.load(); }
+  inline size_t cancelledBytes() const noexcept { return cancelled_bytes_.load(); }
+
  private:
   OMAF_STATUS removeReadyTask(OmafDownloadTask::Ptr task) noexcept;
   OMAF_STATUS removeRunningTask(OmafDownloadTask::Ptr task) noexcept;
@@ -305,10 +335,27 @@ class OmafCurlMultiDownloader : public VCD::NonCopyable {
   OMAF_STATUS markTaskFinish(OmafDownloadTask::Ptr task) noexcept;
   OMAF_STATUS markTaskTimeout(OmafDownloadTask::Ptr task) noexcept;
   OMAF_STATUS markTaskContinue(OmafDownloadTask::Ptr task) noexcept;
+  //! \brief stop the tasks requested by removeTask in the runner thread
+  void processCancelTasks(void) noexcept;
+  void markTaskCancelled(OmafDownloadTask::Ptr task) noexcept;
 
  private:
   void threadRunner(void) noexcept;
+  //! \brief wait for socket events, curl timer expiry or a wakeup, then drive
+  //!        the multi handle with curl_multi_socket_action
+  void pollTransfers(void) noexcept;
+  //! \brief wake up the runner thread blocked in epoll_wait
+  void wakeup(void) noexcept;
+  //! \brief libcurl socket callback, keeps the epoll set in sync with curl sockets
+  static int onSocket(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp);
+  //! \brief libcurl timer callback, records the deadline for the next timeout action
+  static int onTimer(CURLM *multi, long timeout_ms, void *userp);
   OMAF_STATUS startTaskDownload(void) noexcept;
+  //! \brief insert the task into the ready list by urgency, the caller holds ready_task_list_mutex_
+  void insertReadyTask(OmafDownloadTask::Ptr task) noexcept;
+  //! \brief stop one low priority full range transfer and return it to the ready list
+  //!        so that the urgent task can take over its connection
+  bool preemptRunningTask(void) noexcept;
   size_t retriveDoneTask(int msgNum = -1) noexcept;
   OMAF_STATUS ProcessDataTasks() noexcept;
   OMAF_STATUS createTransferForTask(OmafDownloadTask::Ptr task) noexcept;
@@ -333,9 +380,19 @@ class OmafCurlMultiDownloader : public VCD::NonCopyable {
   std::thread worker_;
   std::atomic_int32_t task_size_{0};
   long max_parallel_ = DEFAULT_MAX_PARALLER_TRANSFERS;
-  bool bworking_ = false;
+  std::atomic_bool bworking_{false};
+  int epoll_fd_ = -1;
+  int wakeup_fd_ = -1;
+  // steady clock deadline in ms requested by curl timer callback, -1 for none
+  std::atomic<int64_t> timer_deadline_ms_{-1};
   std::mutex pending_data_task_list_mutex;
   std::vector<OmafDownloadTask::Ptr> pending_data_tasks_;
+  std::mutex cancel_task_list_mutex_;
+  std::vector<OmafDownloadTask::Ptr> cancel_tasks_;
+  std::atomic_size_t cancelled_count_{0};
+  std::atomic_size_t cancelled_bytes_{0};
+  std::atomic_size_t finished_count_{0};
+  std::atomic_size_t finished_bytes_{0};
 };
 
 }  // namespace OMAF
@@ -35,6 +35,7 @@
 #include "performance.h"
 
 #include <chrono>
+#include <iterator>
 #include <list>
 #include <map>
 #include <mutex>
@@ -289,15 +290,13 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::open(const SourceParams &ds_params, O
         return ERROR_INVALID;
       }
 
-      // Since there exists catch up download tasks, remove this condition
-      // if (!task_queue_.empty()) {
-      //   auto &tail_tasks = task_queue_.back();
-      //   if (tail_tasks->timeline_point_ >= ds_params.timeline_point_) {
-      //     OMAF_LOG(LOG_FATAL, "Invalid timeline point happen! < %ld, %ld>\n", tail_tasks->timeline_point_, ds_params.timeline_point_);
-      //   }
-      // }
-
-      task_queue_.push_back(tl);
+      // catch up download tasks may come with an earlier timeline point,
+      // keep the queue ordered by playback deadline
+      auto pos = task_queue_.end();
+      while (pos != task_queue_.begin() && (*std::prev(pos))->timeline_point_ > ds_params.timeline_point_) {
+        --pos;
+      }
+      task_queue_.insert(pos, tl);
     }
     task_queue_cv_.notify_all();
     return ERROR_NONE;
@@ -328,6 +327,7 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::remove(const SourceParams &ds_params)
                 break;
               }
             }
+            it++;
           }
           break;
         }
@@ -336,18 +336,17 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::remove(const SourceParams &ds_params)
 
     // 2. remove it from downloading task list
     if (to_remove_task.get() == nullptr) {
-      {
-        std::lock_guard<std::mutex> lock(downloading_task_mutex_);
-        auto it = downloading_tasks_.find(ds_params.dash_url_);
-        if (it != downloading_tasks_.end()) {
-          to_remove_task = std::move(it->second);
-          downloading_tasks_.erase(it);
-        }
-      }
-      if (to_remove_task.get() != nullptr) {
-        segment_downloader_->removeTask(to_remove_task);
+      std::lock_guard<std::mutex> lock(downloading_task_mutex_);
+      auto it = downloading_tasks_.find(ds_params.dash_url_);
+      if (it != downloading_tasks_.end()) {
+        to_remove_task = std::move(it->second);
+        downloading_tasks_.erase(it);
       }
     }
+    // 3. the downloader stops the task and reports it as STOPPED
+    if (to_remove_task.get() != nullptr && segment_downloader_.get() != nullptr) {
+      segment_downloader_->removeTask(to_remove_task);
+    }
     // Remove the task in processDoneTask func
     // if (to_remove_task.get() == nullptr) {
     //   OMAF_LOG(LOG_ERROR, "Failed to remove the task for the dash: %s\n", ds_params.dash_url_.c_str());
@@ -377,7 +376,12 @@ inline void OmafDashSegmentHttpClientImpl::setStatisticsWindows(int32_t time_win
 };
 inline std::unique_ptr<OmafDashSegmentClient::PerfStatistics> OmafDashSegmentHttpClientImpl::statistics(void) noexcept {
   if (perf_stats_ != nullptr) {
-    return std::move(perf_stats_->statistics());
+    std::unique_ptr<PerfStatistics> stats = perf_stats_->statistics();
+    if (stats && segment_downloader_) {
+      stats->cancelled_count_ = segment_downloader_->cancelledCount();
+      stats->cancelled_bytes_ = segment_downloader_->cancelledBytes();
+    }
+    return stats;
   }
   return nullptr;
 };
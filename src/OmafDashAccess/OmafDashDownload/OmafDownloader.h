@@ -83,6 +83,9 @@ class OmafDashSegmentClient : public VCD::NonCopyable {
     PerfNode timeout_;
     PerfNode failure_;
     float download_speed_bps_ = 0.0f;
+    // segment downloads cancelled before completion and the bytes they did not transfer
+    size_t cancelled_count_ = 0;
+    size_t cancelled_bytes_ = 0;
 
     std::string serializeTimePoint(const std::chrono::system_clock::time_point &time) {
       auto t_sec = std::chrono::time_point_cast<std::chrono::seconds>(time);
@@ -103,6 +106,7 @@ class OmafDashSegmentClient : public VCD::NonCopyable {
       ss << "success segment transfer: " << success_.to_string() << std::endl;
       ss << "timeout segment transfer: " << timeout_.to_string() << std::endl;
       ss << "failure segment transfer: " << failure_.to_string() << std::endl;
+      ss << "cancelled segment transfer: { count=" << cancelled_count_ << ", saved=" << cancelled_bytes_ << " bytes}" << std::endl;
       return ss.str();
     }
   };
@@ -33,8 +33,11 @@
 #ifndef STREAM_H
 #define STREAM_H
 
+#include <algorithm>
+#include <deque>
 #include <fstream>
 #include <mutex>  //std::mutex, std::unique_lock
+#include <vector>
 
 #include "../OmafDashParser/Common.h"
 #include "../common.h"
@@ -103,6 +106,12 @@ private:
   const bool bOwner_ = true;
 };
 
+//!
+//! \class  StreamBlocks
+//! \brief  Stream made of the downloaded blocks in order. The start offset of
+//!         each block is indexed, so any offset is located by binary search,
+//!         and sequential reads go on from the block of the last read.
+//!
 class StreamBlocks : public VCD::MP4::StreamIO {
  public:
   StreamBlocks() = default;
@@ -114,35 +123,7 @@ class StreamBlocks : public VCD::MP4::StreamIO {
   offset_t ReadStream(char *buffer, offset_t size) {
     std::lock_guard<std::mutex> lock(stream_mutex_);
 
-    offset_t offset = offset_;
-
-    std::list<std::unique_ptr<StreamBlock>>::const_iterator it = stream_blocks_.cbegin();
-    while (it != stream_blocks_.cend()) {
-      if (offset < (*it)->size()) {
-        break;
-      }
-      offset -= (*it)->size();
-      ++it;
-    }
-
-    offset_t readSize = 0;
-    while (it != stream_blocks_.cend()) {
-      if (readSize >= size) break;
-
-      offset_t copySize = 0;
-      offset_t dataSize = (*it)->size() - offset;
-      if ((size - readSize) >= dataSize) {
-        copySize = dataSize;
-      } else {
-        copySize = size - readSize;
-      }
-
-      memcpy_s(buffer + readSize, copySize, (*it)->cbuf() + offset, copySize);
-      readSize += copySize;
-      offset = 0;  // set offset to 0 for coming blocks
-      ++it;
-    }
-
+    offset_t readSize = copyStream(buffer, offset_, size);
     offset_ += readSize;
 
     return readSize;
@@ -151,41 +132,38 @@ class StreamBlocks : public VCD::MP4::StreamIO {
   offset_t ReadStreamFromOffset(char *buffer, offset_t input_offset, offset_t size) {
     std::lock_guard<std::mutex> lock(stream_mutex_);
 
-    offset_t offset = input_offset;
-
     if (stream_size_ < input_offset + size) {
       OMAF_LOG(LOG_WARNING, "dash stream has not enough data for offset %ld, size %ld\n", input_offset, size);
       return 0;
     }
 
-    std::list<std::unique_ptr<StreamBlock>>::const_iterator it = stream_blocks_.cbegin();
-    while (it != stream_blocks_.cend()) {
-      if (offset < (*it)->size()) {
-        break;
-      }
-      offset -= (*it)->size();
-      ++it;
-    }
+    return copyStream(buffer, input_offset, size);
+  };
 
-    offset_t readSize = 0;
-    while (it != stream_blocks_.cend()) {
-      if (readSize >= size) break;
+  bool GetStreamSpans(offset_t input_offset, offset_t size, std::vector<VCD::MP4::StreamSpan> &spans) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
 
-      offset_t copySize = 0;
-      offset_t dataSize = (*it)->size() - offset;
-      if ((size - readSize) >= dataSize) {
-        copySize = dataSize;
-      } else {
-        copySize = size - readSize;
-      }
+    spans.clear();
+    if (input_offset < 0 || size <= 0 || stream_size_ < input_offset + size) {
+      return false;
+    }
 
-      memcpy_s(buffer + readSize, copySize, (*it)->cbuf() + offset, copySize);
-      readSize += copySize;
-      offset = 0;  // set offset to 0 for coming blocks
-      ++it;
+    offset_t offset = 0;
+    size_t index = locateBlock(input_offset, offset);
+
+    // blocks are never modified once pushed, so the views stay valid
+    // until the blocks are released with the stream
+    offset_t viewSize = 0;
+    while (index < stream_blocks_.size() && viewSize < size) {
+      offset_t dataSize = stream_blocks_[index]->size() - offset;
+      offset_t spanSize = (size - viewSize) >= dataSize ? dataSize : size - viewSize;
+      spans.push_back(VCD::MP4::StreamSpan{stream_blocks_[index]->cbuf() + offset, spanSize});
+      viewSize += spanSize;
+      offset = 0;
+      ++index;
     }
 
-    return readSize;
+    return viewSize == size;
   };
 
   bool SeekAbsoluteOffset(offset_t offset) {
@@ -204,6 +182,7 @@ class StreamBlocks : public VCD::MP4::StreamIO {
  public:
   void push_back(std::unique_ptr<StreamBlock> sb) noexcept {
     std::lock_guard<std::mutex> lock(stream_mutex_);
+    block_starts_.push_back(stream_start_ + stream_size_);
     stream_size_ += sb->size();
     stream_blocks_.push_back(std::move(sb));
   }
@@ -212,15 +191,19 @@ class StreamBlocks : public VCD::MP4::StreamIO {
     std::lock_guard<std::mutex> lock(stream_mutex_);
     std::unique_ptr<StreamBlock> sb = std::move(stream_blocks_.front());
     stream_size_ -= sb->size();
+    stream_start_ += sb->size();
     stream_blocks_.pop_front();
+    block_starts_.pop_front();
+    if (last_block_ > 0) last_block_--;
     return sb;
   }
 
   void clear() noexcept {
-    while (!stream_blocks_.empty()) {
-      stream_blocks_.pop_front();
-    }
     std::lock_guard<std::mutex> lock(stream_mutex_);
+    stream_blocks_.clear();
+    block_starts_.clear();
+    stream_start_ = 0;
+    last_block_ = 0;
     stream_size_ = 0;
     offset_ = 0;
   }
@@ -247,12 +230,79 @@ class StreamBlocks : public VCD::MP4::StreamIO {
 
   uint32_t GetStreamBlockSize() { return stream_blocks_.size(); }
 
+ private:
+  //!
+  //! \brief  Find the block holding the offset, stream_mutex_ must be held
+  //!
+  //! \param  [in] offset
+  //!         offset in the stream
+  //! \param  [out] inner
+  //!         offset inside the found block
+  //!
+  //! \return size_t
+  //!         index of the block, or the block number if offset is out of stream
+  //!
+  size_t locateBlock(offset_t offset, offset_t &inner) noexcept {
+    if (offset < 0 || offset >= stream_size_) return stream_blocks_.size();
+
+    offset_t pos = stream_start_ + offset;
+    // box by box parsing reads on in the block of the last read, or the next one
+    for (size_t index = last_block_; index < last_block_ + 2 && index < stream_blocks_.size(); index++) {
+      if (block_starts_[index] <= pos && pos < block_starts_[index] + stream_blocks_[index]->size()) {
+        inner = pos - block_starts_[index];
+        last_block_ = index;
+        return index;
+      }
+    }
+    // the last block starting at or before pos, empty blocks are skipped
+    auto it = std::upper_bound(block_starts_.begin(), block_starts_.end(), pos);
+    size_t index = static_cast<size_t>(it - block_starts_.begin()) - 1;
+    inner = pos - block_starts_[index];
+    last_block_ = index;
+    return index;
+  }
+
+  //!
+  //! \brief  Copy the data from the offset, stream_mutex_ must be held
+  //!
+  //! \return offset_t
+  //!         the number of bytes copied
+  //!
+  offset_t copyStream(char *buffer, offset_t input_offset, offset_t size) noexcept {
+    offset_t offset = 0;
+    size_t index = locateBlock(input_offset, offset);
+
+    offset_t readSize = 0;
+    while (index < stream_blocks_.size() && readSize < size) {
+      offset_t copySize = 0;
+      offset_t dataSize = stream_blocks_[index]->size() - offset;
+      if ((size - readSize) >= dataSize) {
+        copySize = dataSize;
+      } else {
+        copySize = size - readSize;
+      }
+
+      memcpy_s(buffer + readSize, copySize, stream_blocks_[index]->cbuf() + offset, copySize);
+      readSize += copySize;
+      offset = 0;  // set offset to 0 for coming blocks
+      ++index;
+    }
+    if (index > 0 && readSize > 0) last_block_ = index - 1;
+
+    return readSize;
+  }
+
  public:
-  std::list<std::unique_ptr<StreamBlock>> stream_blocks_;
+  std::deque<std::unique_ptr<StreamBlock>> stream_blocks_;
 
   std::mutex stream_mutex_;
   offset_t stream_size_ = 0;
   offset_t offset_ = 0;
+
+ private:
+  std::deque<offset_t> block_starts_;  //!< start of each block, counted from the first block ever pushed
+  offset_t stream_start_ = 0;          //!< start of the front block, moves on with pop_front
+  size_t last_block_ = 0;              //!< the block of the last read
 };
 }  // namespace OMAF
 }  // namespace VCD
@@ -250,11 +250,15 @@ int OmafDashSource::OpenMedia(std::string url, std::string cacheDir, void* exter
     params.mode_ = mode;
     params.proj_fmt_ = projFmt;
     params.segment_timeout_ms_ = mMPDinfo->max_segment_duration;
+    params.parse_worker_num_ = omaf_dash_params_.max_parse_workers_;
+    params.progressive_parse_ = omaf_dash_params_.enable_progressive_parse_;
 
     OMAF_LOG(LOG_INFO, "media stream type=%s\n", mMPDinfo->type.c_str());
     OMAF_LOG(LOG_INFO, "media stream duration=%lld\n", mMPDinfo->media_presentation_duration);
     OMAF_LOG(LOG_INFO, "media stream extractor=%d\n", enableExtractor);
     OMAF_LOG(LOG_INFO, "media mode=%d\n", params.mode_);
+    OMAF_LOG(LOG_INFO, "max parse workers=%u\n", params.parse_worker_num_);
+    OMAF_LOG(LOG_INFO, "progressive parse=%d\n", params.progressive_parse_);
 
     OmafReaderManager::Ptr omaf_reader_mgr = std::make_shared<OmafReaderManager>(dash_client_, params);
     ret = omaf_reader_mgr->Initialize(this);
@@ -498,10 +502,28 @@ int OmafDashSource::GetStatistic(DashStatisticInfo* dsInfo) {
   dsInfo->avg_bandwidth = pDM->GetAverageBitrate();
   dsInfo->immediate_bandwidth = pDM->GetImmediateBitrate();
 #else
+  if (dsInfo) {
+    dsInfo->cancelled_segments_num = 0;
+    dsInfo->cancelled_bytes_saved = 0;
+  }
   if (dsInfo && dash_client_) {
     std::unique_ptr<OmafDashSegmentClient::PerfStatistics> perf_stats = dash_client_->statistics();
     if (perf_stats) {
       dsInfo->avg_bandwidth = static_cast<int32_t>(perf_stats->download_speed_bps_);
+      dsInfo->cancelled_segments_num = static_cast<int32_t>(perf_stats->cancelled_count_);
+      dsInfo->cancelled_bytes_saved = static_cast<int64_t>(perf_stats->cancelled_bytes_);
+    }
+  }
+  if (dsInfo) {
+    dsInfo->avg_stitch_time_us = 0;
+    dsInfo->immediate_stitch_time_us = 0;
+    for (auto it = mMapStream.begin(); it != mMapStream.end(); it++) {
+      if (!it->second) continue;
+      uint64_t avgTimeUs = 0;
+      uint64_t lastTimeUs = 0;
+      it->second->GetStitchTime(avgTimeUs, lastTimeUs);
+      dsInfo->avg_stitch_time_us = std::max(dsInfo->avg_stitch_time_us, static_cast<int32_t>(avgTimeUs));
+      dsInfo->immediate_stitch_time_us = std::max(dsInfo->immediate_stitch_time_us, static_cast<int32_t>(lastTimeUs));
     }
   }
 
@@ -1027,7 +1049,13 @@ void OmafDashSource::thread_catchup()
       //2. check if the viewport is changed and get the different tracks map
       uint64_t currentTimeLine = 0;
       // pair<segID, tracks_list>
-      std::map<uint32_t, std::map<int, OmafAdaptationSet*>> additional_tracks = m_selector->CompareTracksAndGetDifference(pStream, &currentTimeLine);
+      // pair<segID, tracks_list> of future segments not selected any more
+      std::map<uint32_t, TracksMap> obsolete_tracks;
+      std::map<uint32_t, std::map<int, OmafAdaptationSet*>> additional_tracks = m_selector->CompareTracksAndGetDifference(pStream, &currentTimeLine, &obsolete_tracks);
+      // cancel their downloading to save the bandwidth for catch up
+      if (!obsolete_tracks.empty()) {
+        pStream->CancelObsoleteSegments(obsolete_tracks);
+      }
       // remove already downloaded tracks
       std::map<uint32_t, std::map<int, OmafAdaptationSet*>> new_tracks = GetNewTracksFromDownloaded(additional_tracks, downloadedCatchupTracks, catchupTimesInSeg);
 
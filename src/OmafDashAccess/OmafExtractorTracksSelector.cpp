@@ -246,72 +246,32 @@ OmafExtractor* OmafExtractorTracksSelector::SelectExtractor(OmafMediaStream* pSt
   ret = I360SCVP_process(mParamViewport, m360ViewPortHandle);
   if (ret != 0) return NULL;
 
-  TileDef *tilesInViewport = new TileDef[1024];
+  std::lock_guard<std::mutex> lock(mASMutex);
+  if (mTilesInViewport.size() < MAX_TILES_IN_VIEWPORT)
+      mTilesInViewport.resize(MAX_TILES_IN_VIEWPORT);
+  TileDef *tilesInViewport = mTilesInViewport.data();
   Param_ViewportOutput paramViewportOutput;
   int32_t selectedTilesNum = I360SCVP_getTilesInViewport(
           tilesInViewport, &paramViewportOutput, m360ViewPortHandle);
+  if (selectedTilesNum > MAX_TILES_IN_VIEWPORT)
+      selectedTilesNum = MAX_TILES_IN_VIEWPORT;
 
-  std::lock_guard<std::mutex> lock(mASMutex);
   mSelectedTracks.clear();
-  mASMap.clear();
-  mASMap = pStream->GetMediaAdaptationSet();
-  std::map<int, OmafAdaptationSet*>::iterator itAS;
+  const OmafTileIndex &tileIndex = pStream->GetTileIndex();
 
-  if (mProjFmt == ProjectionFormat::PF_ERP)
+  if (mProjFmt == ProjectionFormat::PF_ERP || mProjFmt == ProjectionFormat::PF_CUBEMAP)
   {
       for (int32_t index = 0; index < selectedTilesNum; index++)
       {
           int32_t left = tilesInViewport[index].x;
           int32_t top  = tilesInViewport[index].y;
+          int32_t faceId = (mProjFmt == ProjectionFormat::PF_CUBEMAP) ? tilesInViewport[index].faceId : 0;
 
-          for (itAS = mASMap.begin(); itAS != mASMap.end(); itAS++)
-          {
-              OmafAdaptationSet *adaptationSet = itAS->second;
-              OmafSrd *srd = adaptationSet->GetSRD();
-              int32_t tileLeft = srd->get_X();
-              int32_t tileTop  = srd->get_Y();
-              uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-
-              if ((qualityRanking == HIGHEST_QUALITY_RANKING) && (tileLeft == left) && (tileTop == top))
-              {
-                  int trackID = adaptationSet->GetID();
-                  mSelectedTracks.push_back(trackID);
-                  break;
-              }
-          }
-      }
-  }
-  else if (mProjFmt == ProjectionFormat::PF_CUBEMAP)
-  {
-      for (int32_t index = 0; index < selectedTilesNum; index++)
-      {
-          int32_t left = tilesInViewport[index].x;
-          int32_t top  = tilesInViewport[index].y;
-          int32_t faceId = tilesInViewport[index].faceId;
-          for (itAS = mASMap.begin(); itAS != mASMap.end(); itAS++)
+          OmafAdaptationSet *adaptationSet = tileIndex.Find(HIGHEST_QUALITY_RANKING, faceId, left, top);
+          if (adaptationSet)
           {
-              OmafAdaptationSet *adaptationSet = itAS->second;
-              uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-
-              if (qualityRanking == HIGHEST_QUALITY_RANKING)
-              {
-                  TileDef *tileInfo = adaptationSet->GetTileInfo();
-                  if (!tileInfo)
-                  {
-                      OMAF_LOG(LOG_ERROR, "NULL tile information for Cubemap !\n");
-                      DELETE_ARRAY(tilesInViewport);
-                      return NULL;
-                  }
-                  int32_t tileLeft = tileInfo->x;
-                  int32_t tileTop  = tileInfo->y;
-                  int32_t tileFaceId = tileInfo->faceId;
-                  if ((tileLeft == left) && (tileTop == top) && (tileFaceId == faceId))
-                  {
-                      int trackID = adaptationSet->GetID();
-                      mSelectedTracks.push_back(trackID);
-                      break;
-                  }
-              }
+              int trackID = adaptationSet->GetID();
+              mSelectedTracks.push_back(trackID);
           }
       }
   }
@@ -347,7 +307,6 @@ OmafExtractor* OmafExtractorTracksSelector::SelectExtractor(OmafMediaStream* pSt
   }
 
   SAFE_DELETE(outCC);
-  DELETE_ARRAY(tilesInViewport);
 
   return selectedExtractor;
 }
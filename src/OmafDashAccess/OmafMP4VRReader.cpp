@@ -104,6 +104,17 @@ class SegmentStream : public VCD::MP4::StreamIO {
     return mSegment->GetStreamSize();
   };
 
+  //!
+  //! \brief Get views of the segment memory for the given range
+  //!
+  //! \return bool
+  //!         true if the range is held in memory and fully covered
+  virtual bool GetStreamSpans(offset_t offset, offset_t size, std::vector<VCD::MP4::StreamSpan>& spans) {
+    if (nullptr == mSegment) return false;
+
+    return mSegment->GetStreamSpans(offset, size, spans);
+  };
+
  private:
   OmafSegment* mSegment = nullptr;
 };
@@ -413,6 +424,65 @@ int32_t OmafMP4VRReader::getTrackSampleOffset(uint32_t trackId, uint32_t sampleI
   return pReader->GetSampOffset(trackId, sampleId, sampleOffset, sampleLength);
 }
 
+int32_t OmafMP4VRReader::getTrackSampleSpans(uint32_t trackId, uint32_t sampleId,
+                                             std::vector<VCD::MP4::StreamSpan>& spans, bool& lengthPrefixed) {
+  if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
+  VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
+
+  return pReader->GetSampSpans(trackId, sampleId, spans, lengthPrefixed);
+}
+
+int32_t OmafMP4VRReader::getTrackSampleCursor(uint32_t trackId, uint32_t sampleId, VCD::MP4::SampleCursor& cursor) {
+  if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
+  VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
+
+  return pReader->GetSampCursor(trackId, sampleId, cursor);
+}
+
+int32_t OmafMP4VRReader::getTrackSampleOffset(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId,
+                                              uint64_t& sampleOffset, uint32_t& sampleLength) {
+  if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
+  VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
+
+  return pReader->GetSampOffset(cursor, sampleId, sampleOffset, sampleLength);
+}
+
+int32_t OmafMP4VRReader::getTrackSampleSpans(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId,
+                                             std::vector<VCD::MP4::StreamSpan>& spans, bool& lengthPrefixed) {
+  if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
+  VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
+
+  return pReader->GetSampSpans(cursor, sampleId, spans, lengthPrefixed);
+}
+
+int32_t OmafMP4VRReader::getTrackSampleData(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId,
+                                            char* memoryBuffer, uint32_t& memoryBufferSize,
+                                            bool videoByteStreamHeaders) {
+  if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
+  VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
+
+  return pReader->GetSampData(cursor, sampleId, memoryBuffer, memoryBufferSize, videoByteStreamHeaders);
+}
+
+int32_t OmafMP4VRReader::getExtractorTrackSampleData(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId,
+                                                     char* memoryBuffer, uint32_t& memoryBufferSize,
+                                                     bool videoByteStreamHeaders) {
+  if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
+  VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
+
+  return pReader->GetExtractorTrackSampData(cursor, sampleId, memoryBuffer, memoryBufferSize, videoByteStreamHeaders);
+}
+
+int32_t OmafMP4VRReader::getTrackSamplesData(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId,
+                                             uint32_t sampleCount, char* const* memoryBuffers,
+                                             uint32_t* memoryBufferSizes, bool videoByteStreamHeaders) {
+  if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
+  VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
+
+  return pReader->GetSampsData(cursor, sampleId, sampleCount, memoryBuffers, memoryBufferSizes,
+                               videoByteStreamHeaders);
+}
+
 int32_t OmafMP4VRReader::getDecoderConfiguration(uint32_t trackId, uint32_t sampleId,
                                                  std::vector<VCD::OMAF::DecoderSpecificInfo>& decoderInfos) const {
   if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
@@ -730,6 +800,17 @@ int32_t OmafMP4VRReader::parseSegment(OmafSegment* streamInterface, uint32_t ini
   return pReader->ParseSeg(segment, initSegmentId, segmentId, earliestPTSinTS);
 }
 
+int32_t OmafMP4VRReader::parseSegmentHeader(OmafSegment* streamInterface, uint32_t initSegmentId, uint32_t segmentId,
+                                            uint64_t earliestPTSinTS) {
+  if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
+  VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
+
+  SegmentStream* segment = new SegmentStream(streamInterface);
+  if (nullptr == segment) return ERROR_NULL_PTR;
+
+  return pReader->ParseSeg(segment, initSegmentId, segmentId, earliestPTSinTS, true);
+}
+
 int32_t OmafMP4VRReader::getSegmentHeaderSize(bool hasSidx, uint32_t ref_cnt, uint64_t& size, uint8_t version) {
   if (nullptr == mMP4ReaderImpl) return ERROR_NULL_PTR;
   VCD::MP4::Mp4Reader* pReader = (VCD::MP4::Mp4Reader*)mMP4ReaderImpl;
@@ -102,6 +102,33 @@ public:
 
     virtual int32_t getTrackSampleOffset(uint32_t trackId, uint32_t sampleId, uint64_t& sampleOffset, uint32_t& sampleLength)  ;
 
+    virtual int32_t getTrackSampleSpans(uint32_t trackId, uint32_t sampleId, std::vector<VCD::MP4::StreamSpan>& spans, bool& lengthPrefixed)  ;
+
+    virtual int32_t getTrackSampleCursor(uint32_t trackId, uint32_t sampleId, VCD::MP4::SampleCursor& cursor);
+
+    virtual int32_t getTrackSampleOffset(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId, uint64_t& sampleOffset, uint32_t& sampleLength);
+
+    virtual int32_t getTrackSampleSpans(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId, std::vector<VCD::MP4::StreamSpan>& spans, bool& lengthPrefixed);
+
+    virtual int32_t getTrackSampleData(const VCD::MP4::SampleCursor& cursor,
+                                       uint32_t sampleId,
+                                       char* memoryBuffer,
+                                       uint32_t& memoryBufferSize,
+                                       bool videoByteStreamHeaders = true);
+
+    virtual int32_t getExtractorTrackSampleData(const VCD::MP4::SampleCursor& cursor,
+                                                uint32_t sampleId,
+                                                char* memoryBuffer,
+                                                uint32_t& memoryBufferSize,
+                                                bool videoByteStreamHeaders = true);
+
+    virtual int32_t getTrackSamplesData(const VCD::MP4::SampleCursor& cursor,
+                                        uint32_t sampleId,
+                                        uint32_t sampleCount,
+                                        char* const* memoryBuffers,
+                                        uint32_t* memoryBufferSizes,
+                                        bool videoByteStreamHeaders = true);
+
     virtual int32_t getDecoderConfiguration(uint32_t trackId, uint32_t sampleId, std::vector<VCD::OMAF::DecoderSpecificInfo>& decoderInfos) const  ;
 
     virtual int32_t getTrackTimestamps(uint32_t trackId, std::vector<VCD::OMAF::TimestampIDPair>& timestamps) const  ;
@@ -151,6 +178,11 @@ public:  // MP4VR segment parsing methods (DASH/Streaming)
                                   uint32_t segmentId,
                                   uint64_t earliestPTSinTS = UINT64_MAX) ;
 
+    virtual int32_t parseSegmentHeader( OmafSegment* streamInterface,
+                                        uint32_t initSegmentId,
+                                        uint32_t segmentId,
+                                        uint64_t earliestPTSinTS = UINT64_MAX) ;
+
     virtual int32_t invalidateSegment(uint32_t initSegmentId, uint32_t segmentId) ;
     //!
     //! \brief  get segment header size
@@ -88,7 +88,6 @@ OmafMediaStream::~OmafMediaStream() {
   if (mMediaAdaptationSet.size()) {
     for (auto& it : mMediaAdaptationSet) {
       SAFE_DELETE(it.second);
-      mMediaAdaptationSet.erase(it.first);
     }
     mMediaAdaptationSet.clear();
   }
@@ -97,7 +96,6 @@ OmafMediaStream::~OmafMediaStream() {
   if (mExtractors.size()) {
     for (auto& it : mExtractors) {
       SAFE_DELETE(it.second);
-      mExtractors.erase(it.first);
     }
     mExtractors.clear();
   }
@@ -216,6 +214,8 @@ int OmafMediaStream::InitStream(std::string type) {
   {
       SetupExtratorDependency();
 
+      BuildTileIndex();
+
       if (mode_ == OmafDashMode::LATER_BINDING) {
         int32_t ret = StartTilesStitching();
         if (ret) {
@@ -489,6 +489,29 @@ OMAF_STATUS OmafMediaStream::UpdateStreamInfo() {
   return ERROR_NONE;
 }
 
+void OmafMediaStream::BuildTileIndex() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mTileIndex.Clear();
+  bool isCubeMap = m_pStreamInfo && (m_pStreamInfo->mProjFormat == VCD::OMAF::ProjectionFormat::PF_CUBEMAP);
+  for (auto& it : mMediaAdaptationSet) {
+    OmafAdaptationSet* as = it.second;
+    if (!as) continue;
+    uint32_t qualityRanking = as->GetRepresentationQualityRanking();
+    // tile position of cube map is the one in its face, UpdateStreamInfo
+    // only maps the highest quality tiles into their faces
+    TileDef* tileInfo = as->GetTileInfo();
+    if (isCubeMap && tileInfo && qualityRanking == HIGHEST_QUALITY_RANKING) {
+      mTileIndex.Add(qualityRanking, tileInfo->faceId, tileInfo->x, tileInfo->y, as);
+      continue;
+    }
+    OmafSrd* srd = as->GetSRD();
+    if (srd) {
+      mTileIndex.Add(qualityRanking, 0, srd->get_X(), srd->get_Y(), as);
+    }
+  }
+  OMAF_LOG(LOG_INFO, "Tile index of stream %d is built with %lu tiles\n", mStreamID, mTileIndex.Size());
+}
+
 void OmafMediaStream::SetupExtratorDependency() {
   std::lock_guard<std::mutex> lock(mExtractorsMutex);
   for (auto extrator_it = mExtractors.begin(); extrator_it != mExtractors.end(); extrator_it++) {
@@ -705,6 +728,28 @@ int OmafMediaStream::DownloadAssignedSegments(std::map<uint32_t, TracksMap> addi
   return ret;
 }
 
+int OmafMediaStream::CancelObsoleteSegments(const std::map<uint32_t, TracksMap>& obsolete_tracks)
+{
+  if (omaf_reader_mgr_ == nullptr) return ERROR_NULL_PTR;
+
+  for (auto& track : obsolete_tracks) // key: segID - value: first=trackID second=AS
+  {
+    std::vector<uint32_t> trackIDs;
+    {
+      std::lock_guard<std::mutex> lock(mCurrentMutex);
+      auto itSel = m_selectedTileTracks.find(track.first);
+      for (auto& tk : track.second)
+      {
+        if (itSel != m_selectedTileTracks.end()) itSel->second.erase(tk.first);
+        if (tk.second) trackIDs.push_back(static_cast<uint32_t>(tk.second->GetTrackNumber()));
+      }
+    }
+    size_t stopped = omaf_reader_mgr_->StopSegments(track.first, trackIDs);
+    OMAF_LOG(LOG_INFO, "Cancel %zu obsolete segments of seg id %d\n", stopped, track.first);
+  }
+  return ERROR_NONE;
+}
+
 int OmafMediaStream::SeekTo(int seg_num) {
   int ret = ERROR_NONE;
   std::lock_guard<std::mutex> lock(mMutex);
@@ -1366,7 +1411,7 @@ int32_t OmafMediaStream::TilesStitching() {
         break;
       }
     }
-    //2.2.2 Once outdated, clear selectedPackets and remove from segment_parsed_list_
+    //2.2.2 Once outdated, clear selectedPackets and remove from the parsed segment nodes
     if (hasPktOutdated) {
       std::list<MediaPacket *> allPackets;
       for (auto it1 = selectedPackets.begin(); it1 != selectedPackets.end();) {
@@ -1627,6 +1672,8 @@ int OmafMediaStream::CreateCatchupThreadPool()
     stitchThread->catchupStitch = new OmafTilesStitch();
     if (!stitchThread->catchupStitch) return ERROR_NULL_PTR;
     stitchThread->catchupStitch->SetMaxStitchResolution(2560, 2560);
+    // catch-up stitching already runs on several threads
+    stitchThread->catchupStitch->SetMaxMergeWorkers(0);
     stitchThread->pts = -1;
     stitchThread->id = 0;
     m_threadInput->thread = stitchThread;
@@ -43,6 +43,7 @@
 #include "OmafAdaptationSet.h"
 #include "OmafExtractor.h"
 #include "OmafReader.h"
+#include "OmafTileIndex.h"
 #include "OmafTilesStitch.h"
 #include <mutex>
 
@@ -175,6 +176,12 @@ class OmafMediaStream {
     return mMediaAdaptationSet;
   };
 
+  //!
+  //! \brief  get the index from tile position to tile track adaptation set,
+  //!         it is built when the stream is initialized and not changed later
+  //!
+  const OmafTileIndex& GetTileIndex() { return mTileIndex; };
+
   //!
   //! \brief  Update selected extractor after viewport changed
   //!
@@ -284,6 +291,18 @@ class OmafMediaStream {
       m_stitch->SetMaxStitchResolution(width, height);
   };
 
+  //!
+  //! \brief  Get the time spent on tiles stitching of one frame in
+  //!         microseconds, both are 0 if tiles are not stitched
+  //!
+  void GetStitchTime(uint64_t &avgTimeUs, uint64_t &lastTimeUs)
+  {
+    avgTimeUs = 0;
+    lastTimeUs = 0;
+    if (m_stitch)
+      m_stitch->GetStitchTime(avgTimeUs, lastTimeUs);
+  };
+
   void SetSegmentNumber( uint32_t seg_num ) { m_activeSegmentNum = seg_num; } ;
 
   void SetEnableCatchUp(bool enableCatchUp) { m_enableCatchup = enableCatchUp; };
@@ -305,6 +324,11 @@ class OmafMediaStream {
   //! \brief  Download assigned additional segments
   //!
   int DownloadAssignedSegments(std::map<uint32_t, TracksMap> additional_tracks, uint64_t currentTimeLine, bool enableCMAF);
+  //!
+  //! \brief  Cancel the downloading of obsolete tile tracks segments, and drop
+  //!         them from the tiles selection of those segments
+  //!
+  int CancelObsoleteSegments(const std::map<uint32_t, TracksMap>& obsolete_tracks);
 
   void Close();
 
@@ -329,6 +353,11 @@ class OmafMediaStream {
   //!
   void SetupExtratorDependency();
 
+  //!
+  //! \brief  Build the index from tile position to tile track adaptation set
+  //!
+  void BuildTileIndex();
+
   int32_t StartTilesStitching();
 
   //!
@@ -366,6 +395,8 @@ private:
  private:
   //<! Adaptation Set list for tiles
   std::map<int, OmafAdaptationSet*> mMediaAdaptationSet;
+  //<! index of tile tracks by quality ranking, face and position
+  OmafTileIndex mTileIndex;
   //<! Adaptation Set list for extractor
   std::map<int, OmafExtractor*> mExtractors;
   //<! the current extractors to be dealt with
@@ -350,6 +350,102 @@ public:
     //!
     virtual int32_t getTrackSampleOffset(uint32_t trackId, uint32_t sampleId, uint64_t& sampleOffset, uint32_t& sampleLength) = 0;
 
+    //!
+    //! \brief  Get read-only views of the sample data for the
+    //!         specified sample in the specified normal track,
+    //!         referencing the downloaded segment memory directly
+    //!
+    //! \param  [in]  trackId
+    //!         index of specific normal track
+    //! \param  [in]  sampleId
+    //!         index of specified sample
+    //! \param  [out] spans
+    //!         views covering the sample data, valid while the
+    //!         segment holding the sample is alive
+    //! \param  [out] lengthPrefixed
+    //!         whether NAL units still carry length prefixes
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else the sample has to be
+    //!         read by getTrackSampleData
+    //!
+    virtual int32_t getTrackSampleSpans(uint32_t trackId, uint32_t sampleId, std::vector<VCD::MP4::StreamSpan>& spans, bool& lengthPrefixed) = 0;
+
+    //!
+    //! \brief  Resolve the lookups of the segment holding the specified
+    //!         sample once, so that its samples can be read through the
+    //!         cursor overloads below without repeating them per sample
+    //!
+    //! \param  [in]  trackId
+    //!         index of specific track
+    //! \param  [in]  sampleId
+    //!         index of any sample in the segment
+    //! \param  [out] cursor
+    //!         resolved cursor, valid until the segment is invalidated
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    virtual int32_t getTrackSampleCursor(uint32_t trackId, uint32_t sampleId, VCD::MP4::SampleCursor& cursor) = 0;
+
+    //!
+    //! \brief  Same as getTrackSampleOffset, through a resolved cursor
+    //!
+    virtual int32_t getTrackSampleOffset(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId, uint64_t& sampleOffset, uint32_t& sampleLength) = 0;
+
+    //!
+    //! \brief  Same as getTrackSampleSpans, through a resolved cursor
+    //!
+    virtual int32_t getTrackSampleSpans(const VCD::MP4::SampleCursor& cursor, uint32_t sampleId, std::vector<VCD::MP4::StreamSpan>& spans, bool& lengthPrefixed) = 0;
+
+    //!
+    //! \brief  Same as getTrackSampleData, through a resolved cursor
+    //!
+    virtual int32_t getTrackSampleData(const VCD::MP4::SampleCursor& cursor,
+                                       uint32_t sampleId,
+                                       char* memoryBuffer,
+                                       uint32_t& memoryBufferSize,
+                                       bool videoByteStreamHeaders = true) = 0;
+
+    //!
+    //! \brief  Same as getExtractorTrackSampleData, through a resolved cursor
+    //!
+    virtual int32_t getExtractorTrackSampleData(const VCD::MP4::SampleCursor& cursor,
+                                                uint32_t sampleId,
+                                                char* memoryBuffer,
+                                                uint32_t& memoryBufferSize,
+                                                bool videoByteStreamHeaders = true) = 0;
+
+    //!
+    //! \brief  Read consecutive samples of one segment into caller
+    //!         provided buffers in one pass
+    //!
+    //! \param  [in]  cursor
+    //!         cursor of the segment holding the samples
+    //! \param  [in]  sampleId
+    //!         index of the first sample
+    //! \param  [in]  sampleCount
+    //!         number of samples to read
+    //! \param  [in]  memoryBuffers
+    //!         one buffer per sample
+    //! \param  [in,out] memoryBufferSizes
+    //!         capacity of each buffer, updated to the sample sizes, or
+    //!         to the needed sizes if OMAF_MEMORY_TOO_SMALL_BUFFER
+    //! \param  [in]  videoByteStreamHeaders
+    //!         whether to insert NAL unit start codes into
+    //!         sample data
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason; extractor
+    //!         samples are not supported and have to be read one by one
+    //!
+    virtual int32_t getTrackSamplesData(const VCD::MP4::SampleCursor& cursor,
+                                        uint32_t sampleId,
+                                        uint32_t sampleCount,
+                                        char* const* memoryBuffers,
+                                        uint32_t* memoryBufferSizes,
+                                        bool videoByteStreamHeaders = true) = 0;
+
     //!
     //! \brief  Get media codec related specific information,
     //!         like SPS, PPS and so on, for specified sample in
@@ -714,6 +810,28 @@ public:
                                   uint32_t initSegmentId,
                                   uint32_t segmentId,
                                   uint64_t earliestPTSinTS = UINT64_MAX)  = 0;
+
+    //!
+    //! \brief  Parse the movie fragment header of specified segment
+    //!         whose media data is still being downloaded
+    //!
+    //! \param  [in]  streamInterface
+    //!         pointer to specified segment handler
+    //! \param  [in]  initSegmentId
+    //!         index of specified initial segment
+    //! \param  [in]  segmentId
+    //!         index of specified segment
+    //! \param  [in]  earliestPTSinTS
+    //!         the earliest presentation time in timescale for
+    //!         the specified sample
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if the sample tables are available, else failed reason
+    //!
+    virtual int32_t parseSegmentHeader( OmafSegment* streamInterface,
+                                        uint32_t initSegmentId,
+                                        uint32_t segmentId,
+                                        uint64_t earliestPTSinTS = UINT64_MAX)  = 0;
     //!
     //! \brief  get segment header size
     //!
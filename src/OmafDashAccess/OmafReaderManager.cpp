@@ -155,7 +155,9 @@ class OmafSegmentNode : public VCD::NonCopyable {
  public:
   int start(void) noexcept;
   int parse(void) noexcept;
+  int parse(std::shared_ptr<OmafReader> reader) noexcept;
   int stop(void) noexcept;
+  int abandon(std::shared_ptr<OmafReader> reader) noexcept;
 
   // int getPacket(std::unique_ptr<MediaPacket> &pPacket, bool needParams) noexcept;
   int getPacket(MediaPacket *&pPacket, bool requireParams) noexcept;
@@ -240,6 +242,14 @@ class OmafSegmentNode : public VCD::NonCopyable {
   bool isCatchup() const noexcept { return bCatchup_; }
   OmafDashMode GetMode() const noexcept { return mode_; }
   bool isReady() const noexcept;
+  // a progressive node is published after its first parse and caches the rest of
+  // its samples in later parses on the same reader, while its chunk downloads
+  bool isComplete() const noexcept { return segment_.get() == nullptr || !segment_->IsProgressive() || bcached_all_; }
+  bool isResuming() const noexcept { return header_parsed_; }
+  bool isPublished() const noexcept { return bpublished_; }
+  void setPublished() noexcept { bpublished_ = true; }
+  int32_t getParseWorker() const noexcept { return parse_worker_; }
+  void setParseWorker(int32_t worker_idx) noexcept { parse_worker_ = worker_idx; }
   size_t GetSamplesNum() { return samples_num_; };
   uint32_t GetChunkId() { return chunk_id_; };
 
@@ -251,9 +261,13 @@ class OmafSegmentNode : public VCD::NonCopyable {
   bool operator==(OmafSegment::Ptr segment) { return this->segment_ == segment; }
 
  private:
+  int parseProgressive(std::shared_ptr<OmafReader> reader) noexcept;
   int parseSegmentStream(std::shared_ptr<OmafReader> reader) noexcept;
   int removeSegmentStream(std::shared_ptr<OmafReader> reader) noexcept;
   int cachePackets(std::shared_ptr<OmafReader> reader) noexcept;
+  int readPacketsInBulk(std::shared_ptr<OmafReader> reader, const VCD::MP4::SampleCursor &cursor, size_t sample_begin,
+                        size_t sample_end, size_t reserved_size, std::vector<std::unique_ptr<MediaPacket>> &packets,
+                        std::vector<uint32_t> &packet_sizes) noexcept;
   std::shared_ptr<TrackInformation> findTrackInformation(std::shared_ptr<OmafReader> reader) noexcept;
   bool findSampleIndexRange(std::shared_ptr<TrackInformation>, size_t &begin, size_t &end) noexcept;
   OmafPacketParams::Ptr getPacketParams() {
@@ -298,6 +312,14 @@ class OmafSegmentNode : public VCD::NonCopyable {
     }
   }
 
+  MediaPacketPool::Ptr getPacketPool() {
+    auto reader_mgr = omaf_reader_mgr_.lock();
+    if (reader_mgr) {
+      return reader_mgr->getPacketPool(segment_->GetTrackId());
+    }
+    return nullptr;
+  }
+
  private:
   std::weak_ptr<OmafReaderManager> omaf_reader_mgr_;
 
@@ -333,12 +355,31 @@ class OmafSegmentNode : public VCD::NonCopyable {
   size_t samples_num_ = 0;
 
   uint32_t chunk_id_ = 0;
+
+  // progressive parsing state
+  bool header_parsed_ = false;           // the sample table is in the reader of parse_worker_
+  bool bpublished_ = false;              // already added to the parsed list
+  int32_t parse_worker_ = -1;
+  size_t next_sample_ = 0;               // the first sample not cached yet
+  int64_t parsed_size_ = 0;              // bytes present at the last parse
+  std::atomic_bool bcached_all_{false};  // all samples of the segment are cached
 };
 
 uint32_t buildDashTrackId(uint32_t id) noexcept { return id & static_cast<uint32_t>(0xffff); }
 
 uint32_t buildReaderTrackId(uint32_t trackId, uint32_t initSegId) noexcept { return (initSegId << 16) | trackId; }
 
+OmafSegmentNodeTimedSet &OmafReaderManager::getNodeSet(OmafSegmentNodeTimeline &node_sets, int64_t timeline_point) {
+  auto it = node_sets.find(timeline_point);
+  if (it == node_sets.end()) {
+    OmafSegmentNodeTimedSet nodeset;
+    nodeset.timeline_point_ = timeline_point;
+    nodeset.create_time_ = std::chrono::steady_clock::now();
+    it = node_sets.emplace(timeline_point, std::move(nodeset)).first;
+  }
+  return it->second;
+}
+
 OMAF_STATUS OmafReaderManager::Initialize(OmafMediaSource *pSource) noexcept {
   try {
     if (pSource == nullptr) {
@@ -348,13 +389,31 @@ OMAF_STATUS OmafReaderManager::Initialize(OmafMediaSource *pSource) noexcept {
 
     media_source_ = pSource;
 
-    reader_ = std::make_shared<OmafMP4VRReader>();
-    if (reader_.get() == nullptr) {
-      OMAF_LOG(LOG_ERROR, "Failed to create the omaf mp4 vr reader!\n");
-      return ERROR_INVALID;
+    // each parse worker owns one reader, since the mp4 reader is not thread safe
+    size_t worker_num = work_params_.parse_worker_num_;
+    size_t hw_concurrency = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    if (worker_num == 0) {
+      // half of the hardware threads, the other half downloads, decodes and renders,
+      // and every worker reader keeps its own parsed copy of all init segments
+      worker_num = std::min<size_t>(std::max<size_t>(hw_concurrency / 2, 1), MAX_AUTO_PARSE_WORKERS);
+    }
+    worker_num = std::min(worker_num, hw_concurrency);
+    for (size_t i = 0; i < worker_num; i++) {
+      std::unique_ptr<struct _parseWorker> worker(new struct _parseWorker);
+      worker->reader_ = std::make_shared<OmafMP4VRReader>();
+      if (worker->reader_.get() == nullptr) {
+        OMAF_LOG(LOG_ERROR, "Failed to create the omaf mp4 vr reader!\n");
+        return ERROR_INVALID;
+      }
+      parse_workers_.push_back(std::move(worker));
     }
+    reader_ = parse_workers_[0]->reader_;
+
     breader_working_ = true;
-    segment_reader_worker_ = std::thread(&OmafReaderManager::threadRunner, this);
+    for (size_t i = 0; i < parse_workers_.size(); i++) {
+      parse_workers_[i]->thread_ = std::thread(&OmafReaderManager::threadRunner, this, i);
+    }
+    OMAF_LOG(LOG_INFO, "Start %lu segment parse workers\n", parse_workers_.size());
 
     return ERROR_NONE;
 
@@ -371,23 +430,26 @@ OMAF_STATUS OmafReaderManager::Close() noexcept {
 
     {
       std::lock_guard<std::mutex> lock(segment_opening_mutex_);
-      segment_opening_list_.clear();
+      segment_opening_sets_.clear();
     }
 
     {
       std::lock_guard<std::mutex> lock(segment_opened_mutex_);
-      segment_opened_list_.clear();
+      segment_opened_sets_.clear();
       segment_opened_cv_.notify_all();
     }
 
     {
       std::lock_guard<std::mutex> lock(segment_parsed_mutex_);
-      segment_parsed_list_.clear();
+      segment_parsed_tracks_.clear();
+      parsed_evict_point_ = -1;
     }
 
-    if (segment_reader_worker_.joinable()) {
-      breader_working_ = false;
-      segment_reader_worker_.join();
+    for (auto &worker : parse_workers_) {
+      if (worker->thread_.joinable()) {
+        breader_working_ = false;
+        worker->thread_.join();
+      }
     }
 
     return ERROR_NONE;
@@ -473,23 +535,7 @@ OMAF_STATUS OmafReaderManager::OpenSegment(std::shared_ptr<OmafSegment> pSeg, bo
                                                                       std::move(pSeg), depends_size, isExtracotr, isCatchup);
     {
       std::unique_lock<std::mutex> lock(segment_opening_mutex_);
-
-      bool newTimeslide = true;
-      for (auto &nodeset : segment_opening_list_) {
-        if (nodeset.timeline_point_ == new_node->getTimelinePoint()) {
-          nodeset.segment_nodes_.push_back(new_node);
-          newTimeslide = false;
-          break;
-        }
-      }  // end for segment_opening_list_
-
-      if (newTimeslide) {
-        OmafSegmentNodeTimedSet nodeset;
-        nodeset.timeline_point_ = new_node->getTimelinePoint();
-        nodeset.create_time_ = std::chrono::steady_clock::now();
-        nodeset.segment_nodes_.push_back(new_node);
-        segment_opening_list_.emplace_back(nodeset);
-      }
+      getNodeSet(segment_opening_sets_, new_node->getTimelinePoint()).segment_nodes_.push_back(new_node);
     }
 
     OMAF_STATUS ret = new_node->start();
@@ -504,6 +550,38 @@ OMAF_STATUS OmafReaderManager::OpenSegment(std::shared_ptr<OmafSegment> pSeg, bo
   }
 }
 
+size_t OmafReaderManager::StopSegments(int64_t timeline_point, const std::vector<uint32_t> &track_ids) noexcept {
+  try {
+    std::list<OmafSegmentNode::Ptr> stopped_nodes;
+    {
+      // remove from the opening list first, so the stopped segment won't be parsed
+      std::lock_guard<std::mutex> lock(segment_opening_mutex_);
+      auto nodeset_it = segment_opening_sets_.find(timeline_point);
+      if (nodeset_it == segment_opening_sets_.end()) return 0;
+      auto &nodes = nodeset_it->second.segment_nodes_;
+      for (auto it = nodes.begin(); it != nodes.end();) {
+        const auto &node = *it;
+        if (!node->isExtractor() && !node->isCatchup() &&
+            std::find(track_ids.begin(), track_ids.end(), node->getTrackId()) != track_ids.end()) {
+          stopped_nodes.push_back(std::move(*it));
+          it = nodes.erase(it);
+        } else {
+          it++;
+        }
+      }
+    }
+
+    for (auto &node : stopped_nodes) {
+      OMAF_LOG(LOG_INFO, "Stop the obsolete segment node %s\n", node->to_string().c_str());
+      node->stop();
+    }
+    return stopped_nodes.size();
+  } catch (const std::exception &ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when stop segments of timeline %lld, ex: %s\n", timeline_point, ex.what());
+    return 0;
+  }
+}
+
 OMAF_STATUS OmafReaderManager::OpenLocalSegment(std::shared_ptr<OmafSegment> segment, bool isExtractor) noexcept {
   try {
     size_t depends_size = 0;
@@ -516,23 +594,7 @@ OMAF_STATUS OmafReaderManager::OpenLocalSegment(std::shared_ptr<OmafSegment> seg
                                                                       segment, depends_size, isExtractor);
     {
       std::unique_lock<std::mutex> lock(segment_opening_mutex_);
-
-      bool newTimeslide = true;
-      for (auto &nodeset : segment_opening_list_) {
-        if (nodeset.timeline_point_ == new_node->getTimelinePoint()) {
-          nodeset.segment_nodes_.push_back(new_node);
-          newTimeslide = false;
-          break;
-        }
-      }  // end for segment_opening_list_
-
-      if (newTimeslide) {
-        OmafSegmentNodeTimedSet nodeset;
-        nodeset.timeline_point_ = new_node->getTimelinePoint();
-        nodeset.create_time_ = std::chrono::steady_clock::now();
-        nodeset.segment_nodes_.push_back(new_node);
-        segment_opening_list_.emplace_back(nodeset);
-      }
+      getNodeSet(segment_opening_sets_, new_node->getTimelinePoint()).segment_nodes_.push_back(new_node);
     }
     segment->SetState(OmafSegment::State::OPEN_SUCCES);
     this->normalSegmentStateChange(std::move(segment), OmafSegment::State::OPEN_SUCCES);
@@ -552,34 +614,35 @@ OMAF_STATUS OmafReaderManager::GetNextPacket(uint32_t trackID, MediaPacket *&pPa
     {
       std::unique_lock<std::mutex> lock(segment_parsed_mutex_);
 
-      // 1. read the required packet
-      for (auto &nodeset : segment_parsed_list_) {
-        std::list<OmafSegmentNode::Ptr>::iterator it = nodeset.segment_nodes_.begin();
-        while (it != nodeset.segment_nodes_.end()) {
-          auto &node = *it;
-          //OMAF_LOG(LOG_INFO, "Require trackid=%u, node trackid=%u\n", trackID, node->getTrackId());
-          if (node->getTrackId() == trackID) {
-            ret = node->getPacket(pPacket, requireParams);
-            if (ret == ERROR_NONE) {
-              bpacket_readed = true;
-            }
-            if (!node->isCatchup()) {
-              timeline_point_ = node->getTimelinePoint();
-            }
-            //OMAF_LOG(LOG_INFO, "timeline_point_ is %ld in GetNextPacket, bpacket_readed %d\n", timeline_point_, bpacket_readed);
-            if (0 == node->packetQueueSize()) {
-              //OMAF_LOG(LOG_INFO, "Node count=%d. %s\n", node.use_count(), node->to_string().c_str());
-              it = nodeset.segment_nodes_.erase(it);
-            }
-
-            break;
+      // 1. read the required packet from the oldest parsed node of the track
+      auto track_it = segment_parsed_tracks_.find(trackID);
+      if (track_it != segment_parsed_tracks_.end()) {
+        OmafSegmentNodeTrackSlot &slot = track_it->second;
+        auto it = slot.begin();
+        while (it != slot.end()) {
+          std::list<OmafSegmentNode::Ptr> &nodes = it->second;
+          auto &node = nodes.front();
+          // read before the queue size, a progressive node pushes its last packets before it completes
+          const bool bcomplete = node->isComplete();
+          ret = node->getPacket(pPacket, requireParams);
+          if (ret == ERROR_NONE) {
+            bpacket_readed = true;
           }
+          if (!node->isCatchup()) {
+            timeline_point_ = node->getTimelinePoint();
+          }
+          //OMAF_LOG(LOG_INFO, "timeline_point_ is %ld in GetNextPacket, bpacket_readed %d\n", timeline_point_, bpacket_readed);
+          if (0 == node->packetQueueSize()) {
+            // the rest of a progressive chunk is still downloading, keep the packet order
+            if (!bcomplete) break;
+            //OMAF_LOG(LOG_INFO, "Node count=%d. %s\n", node.use_count(), node->to_string().c_str());
+            nodes.pop_front();
+          }
+          it = nodes.empty() ? slot.erase(it) : std::next(it);
 
-          it++;
-        }
-        if (bpacket_readed)
+          if (bpacket_readed)
             break;
-
+        }
       }
     }
     if (!bpacket_readed) {
@@ -600,11 +663,7 @@ OMAF_STATUS OmafReaderManager::GetNextPacket(uint32_t trackID, MediaPacket *&pPa
     if (timeline_point_ != -1) {
       OMAF_LOG(LOG_INFO, "To clear the timeline point < %ld\n", timeline_point_ - 1);
       clearOlderSegmentSet(timeline_point_ - 1);
-      std::lock_guard<std::mutex> lock(segment_parsed_mutex_);
-      std::list<OmafSegmentNodeTimedSet>::iterator it = segment_parsed_list_.begin();
-      while (it != segment_parsed_list_.end() && it->timeline_point_ < timeline_point_ - 1) {
-        it = segment_parsed_list_.erase(it);  // 'it' will move to next when calling erase
-      }
+      clearOlderParsedNodes(timeline_point_ - 1);
     }
     return ret;
   } catch (const std::exception &ex) {
@@ -621,15 +680,17 @@ OMAF_STATUS OmafReaderManager::GetNextPacketWithPTS(uint32_t trackID, uint64_t p
     {
       std::unique_lock<std::mutex> lock(segment_parsed_mutex_);
 
-      // 1. read the required packet
-      for (auto &nodeset : segment_parsed_list_) {//loop on different timeline
-        uint32_t sample_size = GetSamplesNumPerSegmentForTimeLine(1);
-        if (sample_size != 0 && nodeset.timeline_point_ == (int64_t)(pts / sample_size + 1)) {
-        std::list<OmafSegmentNode::Ptr>::iterator it = nodeset.segment_nodes_.begin();
-        while (it != nodeset.segment_nodes_.end()) { //loop on different node (track)
-          auto &node = *it;
-          // OMAF_LOG(LOG_INFO, "Require trackid=%u, node trackid=%u\n", trackID, node->getTrackId());
-          if (node->getTrackId() == trackID) {
+      // 1. read the required packet from the track's nodes of the pts timeline
+      uint32_t sample_size = GetSamplesNumPerSegmentForTimeLine(1);
+      auto track_it = segment_parsed_tracks_.find(trackID);
+      if (sample_size != 0 && track_it != segment_parsed_tracks_.end()) {
+        OmafSegmentNodeTrackSlot &slot = track_it->second;
+        auto slot_it = slot.find(static_cast<int64_t>(pts / sample_size + 1));
+        if (slot_it != slot.end()) {
+          std::list<OmafSegmentNode::Ptr> &nodes = slot_it->second;
+          std::list<OmafSegmentNode::Ptr>::iterator it = nodes.begin();
+          while (it != nodes.end()) { //loop on the nodes (chunks/catch up) of the track
+            auto &node = *it;
             // OMAF_LOG(LOG_INFO, "PACKET Get packet with pts %lld, track id %d\n", node->getPTS(), trackID);
             ret = node->getPacketWithPTS(pPacket, requireParams, pts);
             if (ret == ERROR_NONE) {
@@ -638,30 +699,28 @@ OMAF_STATUS OmafReaderManager::GetNextPacketWithPTS(uint32_t trackID, uint64_t p
               if (!node->isCatchup()) {
                 timeline_point_ = node->getTimelinePoint();
               }
-              if (0 == node->packetQueueSize()) {
+              if (node->isComplete() && 0 == node->packetQueueSize()) {
                 OMAF_LOG(LOG_INFO, "Erase Parsed Node count=%d. %s\n", node.use_count(), node->to_string().c_str());
-                it = nodeset.segment_nodes_.erase(it);
+                it = nodes.erase(it);
               }
               break;
             }
             else if (ret == ERROR_NULL_PACKET) {// in catch up mode, download start chunk id may not equal catchup stitch start chunk id
               // LOG(INFO) << "PACKET Get null packet " << endl;
-              if (0 == node->packetQueueSize()) {
+              if (node->isComplete() && 0 == node->packetQueueSize()) {
                 OMAF_LOG(LOG_INFO, "Erase Parsed Node count=%d. %s\n", node.use_count(), node->to_string().c_str());
-                it = nodeset.segment_nodes_.erase(it);
+                it = nodes.erase(it);
               }
               else it++;
               continue;
             }
+            it++;
+          }
+          if (nodes.empty()) {
+            slot.erase(slot_it);
           }
-          it++;
-        }
-        if (bpacket_readed)
-        {
-          break;
         }
       }
-      }
     }
     if (!bpacket_readed) {
       // FIXME, this may a bug for using the timeline point as segment number
@@ -681,11 +740,7 @@ OMAF_STATUS OmafReaderManager::GetNextPacketWithPTS(uint32_t trackID, uint64_t p
     if (timeline_point_ != -1) {
       OMAF_LOG(LOG_INFO, "To clear the timeline point < %ld\n", timeline_point_ - 1);
       clearOlderSegmentSet(timeline_point_ - 1);
-      std::lock_guard<std::mutex> lock(segment_parsed_mutex_);
-      std::list<OmafSegmentNodeTimedSet>::iterator it = segment_parsed_list_.begin();
-      while (it != segment_parsed_list_.end() && it->timeline_point_ < timeline_point_ - 1) {
-        it = segment_parsed_list_.erase(it);  // 'it' will move to next when calling erase
-      }
+      clearOlderParsedNodes(timeline_point_ - 1);
     }
     return ret;
   } catch (const std::exception &ex) {
@@ -782,7 +837,7 @@ OMAF_STATUS OmafReaderManager::GetNextPacketArray(vector<uint32_t> trackIDs, lis
   return ERROR_NONE;
 }
 
-inline bool OmafReaderManager::isEmpty(std::mutex &mutex, const std::list<OmafSegmentNodeTimedSet> &nodes) noexcept {
+inline bool OmafReaderManager::isEmpty(std::mutex &mutex, const OmafSegmentNodeTimeline &nodes) noexcept {
   try {
     std::lock_guard<std::mutex> lock(mutex);
     if (nodes.empty()) {
@@ -792,7 +847,7 @@ inline bool OmafReaderManager::isEmpty(std::mutex &mutex, const std::list<OmafSe
       return false;
     }
 
-    const OmafSegmentNodeTimedSet &node_set = nodes.front();
+    const OmafSegmentNodeTimedSet &node_set = nodes.begin()->second;
     if (node_set.segment_nodes_.empty()) {
       return true;
     }
@@ -805,6 +860,21 @@ inline bool OmafReaderManager::isEmpty(std::mutex &mutex, const std::list<OmafSe
   }
 }
 
+bool OmafReaderManager::isParsedEmpty() noexcept {
+  try {
+    std::lock_guard<std::mutex> lock(segment_parsed_mutex_);
+    for (auto &track : segment_parsed_tracks_) {
+      if (!track.second.empty()) {
+        return false;
+      }
+    }
+    return true;
+  } catch (const std::exception &ex) {
+    OMAF_LOG(LOG_ERROR, "Failed to check the empty, ex: %s\n", ex.what());
+    return false;
+  }
+}
+
 bool OmafReaderManager::checkEOS(int64_t segment_num) noexcept {
   try {
     if (media_source_ == nullptr) {
@@ -838,17 +908,17 @@ bool OmafReaderManager::checkEOS(int64_t segment_num) noexcept {
       }
     }
     if (eos) {
-      if (!isEmpty(segment_opening_mutex_, segment_opening_list_)) {
+      if (!isEmpty(segment_opening_mutex_, segment_opening_sets_)) {
         OMAF_LOG(LOG_WARNING, "segment opening list is not empty!\n");
       }
     }
     if (eos) {
-      if (!isEmpty(segment_opened_mutex_, segment_opened_list_)) {
+      if (!isEmpty(segment_opened_mutex_, segment_opened_sets_)) {
         OMAF_LOG(LOG_WARNING, "segment opened list is not empty!\n");
       }
     }
     if (eos) {
-      if (!isEmpty(segment_parsed_mutex_, segment_parsed_list_)) {
+      if (!isParsedEmpty()) {
         OMAF_LOG(LOG_WARNING, "segment parsed list is not empty!\n");
       }
     }
@@ -865,13 +935,10 @@ bool OmafReaderManager::checkEOS(int64_t segment_num) noexcept {
 OMAF_STATUS OmafReaderManager::GetPacketQueueSize(uint32_t trackID, size_t &size) noexcept {
   try {
     std::unique_lock<std::mutex> lock(segment_parsed_mutex_);
-    for (auto &nodeset : segment_parsed_list_) {
-      for (auto &node : nodeset.segment_nodes_) {
-        if (node->getTrackId() == trackID) {
-          size = node->packetQueueSize();
-          return ERROR_NONE;
-        }
-      }
+    auto track_it = segment_parsed_tracks_.find(trackID);
+    if (track_it != segment_parsed_tracks_.end() && !track_it->second.empty()) {
+      size = track_it->second.begin()->second.front()->packetQueueSize();
+      return ERROR_NONE;
     }
 
     return ERROR_INVALID;
@@ -885,9 +952,13 @@ uint64_t OmafReaderManager::GetOldestPacketPTSForTrack(int trackId) {
     uint64_t oldestPTS = 0;
     bool findPTS = false;
     std::unique_lock<std::mutex> lock(segment_parsed_mutex_);
-    for (auto &nodeset : segment_parsed_list_) {
-      for (auto &node : nodeset.segment_nodes_) {
-        if (node->getTrackId() == static_cast<uint32_t>(trackId) && !node->isCatchup()) {
+    auto track_it = segment_parsed_tracks_.find(static_cast<uint32_t>(trackId));
+    if (track_it == segment_parsed_tracks_.end()) {
+      return oldestPTS;
+    }
+    for (auto &nodes : track_it->second) {
+      for (auto &node : nodes.second) {
+        if (!node->isCatchup()) {
           //return node->getPTS();
           if (!findPTS)
           {
@@ -914,9 +985,13 @@ uint64_t OmafReaderManager::GetOldestPacketPTSForTrack(int trackId) {
 void OmafReaderManager::RemoveOutdatedPacketForTrack(int trackId, uint64_t currPTS) {
   try {
     std::unique_lock<std::mutex> lock(segment_parsed_mutex_);
-    for (auto &nodeset : segment_parsed_list_) {
-      for (auto &node : nodeset.segment_nodes_) {
-        if (node->getTrackId() == static_cast<uint32_t>(trackId) && !node->isCatchup()) {
+    auto track_it = segment_parsed_tracks_.find(static_cast<uint32_t>(trackId));
+    if (track_it == segment_parsed_tracks_.end()) {
+      return;
+    }
+    for (auto &nodes : track_it->second) {
+      for (auto &node : nodes.second) {
+        if (!node->isCatchup()) {
           node->clearPacketByPTS(currPTS);
         }
       }
@@ -929,15 +1004,21 @@ void OmafReaderManager::RemoveOutdatedPacketForTrack(int trackId, uint64_t currP
 void OmafReaderManager::RemoveOutdatedCatchupPacketForTrack(int trackId, uint64_t currPTS) {
   try {
     std::unique_lock<std::mutex> lock(segment_parsed_mutex_);
-    for (auto &nodeset : segment_parsed_list_) {//for timeline
-      uint64_t sample_num = GetSamplesNumPerSegmentForTimeLine(1);
-      if (sample_num == 0) return;
-      int64_t currtl = currPTS / sample_num + 1;
-      if (nodeset.timeline_point_ != currtl) continue;//only delete the current timeline catchup packets
-      for (auto &node : nodeset.segment_nodes_) {
-        if (node->getTrackId() == static_cast<uint32_t>(trackId) && node->isCatchup()) {
-          node->clearPacketByPTS(currPTS);
-        }
+    auto track_it = segment_parsed_tracks_.find(static_cast<uint32_t>(trackId));
+    if (track_it == segment_parsed_tracks_.end()) {
+      return;
+    }
+    uint64_t sample_num = GetSamplesNumPerSegmentForTimeLine(1);
+    if (sample_num == 0) return;
+    int64_t currtl = currPTS / sample_num + 1;
+    //only delete the current timeline catchup packets
+    auto slot_it = track_it->second.find(currtl);
+    if (slot_it == track_it->second.end()) {
+      return;
+    }
+    for (auto &node : slot_it->second) {
+      if (node->isCatchup()) {
+        node->clearPacketByPTS(currPTS);
       }
     }
   } catch (const std::exception &ex) {
@@ -954,11 +1035,18 @@ void OmafReaderManager::initSegmentStateChange(std::shared_ptr<OmafSegment> pIni
       return;
     }
 
-    // 1. parse the segment
-    OMAF_STATUS ret = reader_->parseInitializationSegment(pInitSeg.get(), pInitSeg->GetInitSegID());
-    if (ret != ERROR_NONE) {
-      OMAF_LOG(LOG_ERROR, "parse initialization segment failed! code= %d\n", ret);
-      return;
+    // 1. parse the segment into the reader of every parse worker
+    for (auto &worker : parse_workers_) {
+      std::lock_guard<std::mutex> lock(worker->reader_mutex_);
+      if (!pInitSeg->SeekAbsoluteOffset(0)) {
+        OMAF_LOG(LOG_ERROR, "Failed to rewind the init segment %u\n", pInitSeg->GetInitSegID());
+        return;
+      }
+      OMAF_STATUS ret = worker->reader_->parseInitializationSegment(pInitSeg.get(), pInitSeg->GetInitSegID());
+      if (ret != ERROR_NONE) {
+        OMAF_LOG(LOG_ERROR, "parse initialization segment failed! code= %d\n", ret);
+        return;
+      }
     }
 
     initSeg_ready_count_++;
@@ -1091,18 +1179,18 @@ void OmafReaderManager::normalSegmentStateChange(std::shared_ptr<OmafSegment> se
     // 1. remove from the opening list
     {
       std::lock_guard<std::mutex> lock(segment_opening_mutex_);
-      for (auto &nodeset : segment_opening_list_) {
-        if (nodeset.timeline_point_ == segment->GetTimelinePoint()) {
-          std::list<OmafSegmentNode::Ptr>::iterator it = nodeset.segment_nodes_.begin();
-          while (it != nodeset.segment_nodes_.end()) {
-            auto &node = (*(*it).get());
-            if (node == segment) {
-              opened_dash_node = std::move(*it);
-              it = nodeset.segment_nodes_.erase(it);
-              break;
-            }
-            it++;
+      auto nodeset_it = segment_opening_sets_.find(segment->GetTimelinePoint());
+      if (nodeset_it != segment_opening_sets_.end()) {
+        auto &nodeset = nodeset_it->second;
+        std::list<OmafSegmentNode::Ptr>::iterator it = nodeset.segment_nodes_.begin();
+        while (it != nodeset.segment_nodes_.end()) {
+          auto &node = (*(*it).get());
+          if (node == segment) {
+            opened_dash_node = std::move(*it);
+            it = nodeset.segment_nodes_.erase(it);
+            break;
           }
+          it++;
         }
       }
     }
@@ -1127,22 +1215,31 @@ void OmafReaderManager::normalChunkStateChange(std::shared_ptr<OmafSegment> segm
       OMAF_LOG(LOG_ERROR, "Empty segment!\n");
       return;
     }
+    // 0.1 more bytes of a progressive chunk arrived, wake up the parser
+    if (state == OmafSegment::State::OPEN) {
+      std::lock_guard<std::mutex> lock(segment_opened_mutex_);
+      segment_opened_cv_.notify_all();
+      return;
+    }
     size_t depends_size = 0;
     auto d_it = initSegId_depends_map_.find(segment->GetInitSegID());
     if (d_it != initSegId_depends_map_.end()) {
       depends_size = d_it->second.size();
     }
-    // 1. get chunk stream block in input segment
-    std::unique_ptr<StreamBlock> chunk_block = segment->PopOneStreamBlock();
-    // LOG(INFO) << "State change chunk stream size " << chunk_block->size() << "track is " << segment->GetTrackId() << "segment is " << segment->GetSegID() << endl;
+    // 1. get chunk stream block in input segment, or the chunk handed out before it completes
+    OmafSegment::Ptr opened_segment = segment->PopProgressiveChunk();
+    if (opened_segment.get() == nullptr) {
+      std::unique_ptr<StreamBlock> chunk_block = segment->PopOneStreamBlock();
+      // LOG(INFO) << "State change chunk stream size " << chunk_block->size() << "track is " << segment->GetTrackId() << "segment is " << segment->GetSegID() << endl;
 
-    if (chunk_block == nullptr) {
-      OMAF_LOG(LOG_INFO, "Segment %d, track id %d has not chunk yet!\n", segment->GetSegID(), segment->GetTrackId());
-      return;
-    }
+      if (chunk_block == nullptr) {
+        OMAF_LOG(LOG_INFO, "Segment %d, track id %d has not chunk yet!\n", segment->GetSegID(), segment->GetTrackId());
+        return;
+      }
 
-    // 2. create a new opened node according to given chunk stream block
-    OmafSegment::Ptr opened_segment = std::make_shared<OmafSegment>(segment, std::move(chunk_block));
+      // 2. create a new opened node according to given chunk stream block
+      opened_segment = std::make_shared<OmafSegment>(segment, std::move(chunk_block));
+    }
     OmafDashMode work_mode = work_params_.mode_;
     if (segment->IsCatchup()) work_mode = OmafDashMode::LATER_BINDING;
 
@@ -1189,111 +1286,84 @@ void OmafReaderManager::AddOpenedNode(std::shared_ptr<OmafSegment> segment, std:
   // 2. append to the dash opened list
   {
     std::lock_guard<std::mutex> lock(segment_opened_mutex_);
-    bool new_timeline_point = true;
-    if (opened_dash_node->GetMode() == OmafDashMode::EXTRACTOR) {
-      // this is a dash node built from extractor
-      // build depends based on extractor
-      if (opened_dash_node->isExtractor()) {
-        for (auto &nodeset : segment_opened_list_) {
-          if (nodeset.timeline_point_ == opened_dash_node->getTimelinePoint()) {
-            new_timeline_point = false;
-            std::list<OmafSegmentNode::Ptr>::iterator it = nodeset.segment_nodes_.begin();
-
-            // put all depends node into depend
-            const auto &depends = initSegId_depends_map_[opened_dash_node->getInitSegId()];
-
-            while (it != nodeset.segment_nodes_.end()) {
-              // check whether this dash node is belong the target dash's depends
-              if ((*it)->GetChunkId() != opened_dash_node->GetChunkId()) {
-                it++;
-                continue;
+    auto nodeset_it = segment_opened_sets_.find(opened_dash_node->getTimelinePoint());
+    if (nodeset_it != segment_opened_sets_.end()) {
+      auto &nodeset = nodeset_it->second;
+      if (opened_dash_node->GetMode() == OmafDashMode::EXTRACTOR) {
+        // this is a dash node built from extractor
+        // build depends based on extractor
+        if (opened_dash_node->isExtractor()) {
+          std::list<OmafSegmentNode::Ptr>::iterator it = nodeset.segment_nodes_.begin();
+
+          // put all depends node into depend
+          const auto &depends = initSegId_depends_map_[opened_dash_node->getInitSegId()];
+
+          while (it != nodeset.segment_nodes_.end()) {
+            // check whether this dash node is belong the target dash's depends
+            if ((*it)->GetChunkId() != opened_dash_node->GetChunkId()) {
+              it++;
+              continue;
+            }
+            auto initSeg_id = (*it)->getInitSegId();
+            auto is_in_depend = false;
+            for (auto id : depends) {
+              if (id == initSeg_id) {
+                is_in_depend = true;
+                break;
               }
-              auto initSeg_id = (*it)->getInitSegId();
-              auto is_in_depend = false;
+            }  // end for id
+
+            if (is_in_depend) {
+              // remove from the list and push to depends
+              opened_dash_node->pushDepends(std::move(*it));
+              // it will move to next when calling erase
+              it = nodeset.segment_nodes_.erase(it);
+            } else {
+              it++;
+            }
+          }  // end while
+
+          nodeset.segment_nodes_.push_back(std::move(opened_dash_node));
+        } else {
+          // this is a dash node built from the general segment
+          // while loop all node in the dash nodes,
+          // the opend_dash_node maybe added to more than one dash node who built from extractor
+          // the detail structure depend on the media stream's extractor logic
+          // FIXME, if one segment belong to different extractor at the same time, the logix has bug now.
+          // it should update the logic of parse in the dash_node
+          //
+          bool bfind_extractor = false;
+          for (auto &node : nodeset.segment_nodes_) {
+            if (opened_dash_node.get() == nullptr) break;
+            // this is a extractor
+            if (node->isExtractor() && node->GetChunkId() == opened_dash_node->GetChunkId()) {
+              const auto &depends = initSegId_depends_map_[node->getInitSegId()];
               for (auto id : depends) {
-                if (id == initSeg_id) {
-                  is_in_depend = true;
+                // this dash node is in depends of the node
+                if (id == opened_dash_node->getInitSegId()) {
+                  bfind_extractor = true;
+                  node->pushDepends(std::move(opened_dash_node));
                   break;
                 }
-              }  // end for id
-
-              if (is_in_depend) {
-                // remove from the list and push to depends
-                opened_dash_node->pushDepends(std::move(*it));
-                // it will move to next when calling erase
-                it = nodeset.segment_nodes_.erase(it);
-              } else {
-                it++;
-              }
-            }  // end while
-
-            nodeset.segment_nodes_.push_back(std::move(opened_dash_node));
-            break;
-          }  // end for if same timeslide
-        }    // end for dash_opened_list loop
-      } else {
-        // this is a dash node built from the general segment
-        for (auto &nodeset : segment_opened_list_) {
-          if (nodeset.timeline_point_ == opened_dash_node->getTimelinePoint()) {
-            new_timeline_point = false;
-            // while loop all node in the dash nodes,
-            // the opend_dash_node maybe added to more than one dash node who built from extractor
-            // the detail structure depend on the media stream's extractor logic
-            // FIXME, if one segment belong to different extractor at the same time, the logix has bug now.
-            // it should update the logic of parse in the dash_node
-            //
-            bool bfind_extractor = false;
-            for (auto &node : nodeset.segment_nodes_) {
-              if (opened_dash_node.get() == nullptr) break;
-              // this is a extractor
-              if (node->isExtractor() && node->GetChunkId() == opened_dash_node->GetChunkId()) {
-                const auto &depends = initSegId_depends_map_[node->getInitSegId()];
-                for (auto id : depends) {
-                  // this dash node is in depends of the node
-                  if (id == opened_dash_node->getInitSegId()) {
-                    bfind_extractor = true;
-                    node->pushDepends(std::move(opened_dash_node));
-                    break;
-                  }
-                }  // end for auto id
-              }
-            }  // end for auto node
-            if (!bfind_extractor) {
-              nodeset.segment_nodes_.push_back(std::move(opened_dash_node));
+              }  // end for auto id
             }
-            break;
+          }  // end for auto node
+          if (!bfind_extractor) {
+            nodeset.segment_nodes_.push_back(std::move(opened_dash_node));
           }
-        }  // end for nodeset
-      }
-    } else {
-      // not extractor mode
-      for (auto &nodeset : segment_opened_list_) {
-        if (nodeset.timeline_point_ == opened_dash_node->getTimelinePoint()) {
-          // LOG(INFO) << "Push back opened node to list " << opened_dash_node->to_string().c_str() << endl;
-          nodeset.segment_nodes_.push_back(std::move(opened_dash_node));
-          new_timeline_point = false;
-          break;
-        }
-      }
-    }
-
-    if (new_timeline_point) {
-      bool to_append = true;
-      if (!segment_opened_list_.empty()) {
-        auto &tail_nodeset = segment_opened_list_.back();
-        // the nodeset queue's timeline should increase one by one
-        if (opened_dash_node->getTimelinePoint() <= tail_nodeset.timeline_point_) {
-          OMAF_LOG(LOG_WARNING, "Try to insert the timeline: %lld, which <= %lld\n", opened_dash_node->getTimelinePoint(), tail_nodeset.timeline_point_);
-          to_append = false;
         }
-      }
-      if (to_append) {
-        OmafSegmentNodeTimedSet nodeset;
-        nodeset.timeline_point_ = opened_dash_node->getTimelinePoint();
-        nodeset.create_time_ = std::chrono::steady_clock::now();
+      } else {
+        // not extractor mode
         // LOG(INFO) << "Push back opened node to list " << opened_dash_node->to_string().c_str() << endl;
         nodeset.segment_nodes_.push_back(std::move(opened_dash_node));
-        segment_opened_list_.emplace_back(nodeset);
+      }
+    } else {
+      // the nodeset queue's timeline should increase one by one
+      if (!segment_opened_sets_.empty() && opened_dash_node->getTimelinePoint() <= segment_opened_sets_.rbegin()->first) {
+        OMAF_LOG(LOG_WARNING, "Try to insert the timeline: %lld, which <= %lld\n", opened_dash_node->getTimelinePoint(), segment_opened_sets_.rbegin()->first);
+      } else {
+        // LOG(INFO) << "Push back opened node to list " << opened_dash_node->to_string().c_str() << endl;
+        getNodeSet(segment_opened_sets_, opened_dash_node->getTimelinePoint()).segment_nodes_.push_back(std::move(opened_dash_node));
       }
     }
     // TODO, refine the logic,
@@ -1302,18 +1372,18 @@ void OmafReaderManager::AddOpenedNode(std::shared_ptr<OmafSegment> segment, std:
   }  // end of append to the dash opened list
 }
 
-void OmafReaderManager::threadRunner() noexcept {
+void OmafReaderManager::threadRunner(size_t worker_idx) noexcept {
   try {
     //OMAF_LOG(LOG_INFO, "Start the reader runner!\n");
-
     while (breader_working_) {
       // 1. find the ready segment/dash_node opend list
       OmafSegmentNode::Ptr ready_dash_node = findReadySegmentNode();
 
       // 1.1 no ready dash node, then wait
       if (ready_dash_node.get() == nullptr) {
+        // the node may get ready between the search and the wait, so check it again under the lock
         std::unique_lock<std::mutex> lock(segment_opened_mutex_);
-        segment_opened_cv_.wait(lock);
+        segment_opened_cv_.wait(lock, [this]() { return !breader_working_ || hasReadySegmentNode(); });
         continue;
       }
 
@@ -1326,7 +1396,16 @@ void OmafReaderManager::threadRunner() noexcept {
       tracepoint(mthq_tp_provider, T4_parse_start_time, timeline_point);
 #endif
 #endif
-      OMAF_STATUS ret = ready_dash_node->parse();
+      OMAF_STATUS ret = ERROR_NONE;
+      {
+        // a progressive node resumes on the reader holding its sample table
+        const int32_t reader_idx = ready_dash_node->isResuming() ? ready_dash_node->getParseWorker()
+                                                                 : static_cast<int32_t>(worker_idx);
+        struct _parseWorker &reader_worker = *parse_workers_[reader_idx];
+        std::lock_guard<std::mutex> lock(reader_worker.reader_mutex_);
+        ret = ready_dash_node->parse(reader_worker.reader_);
+        ready_dash_node->setParseWorker(reader_idx);
+      }
       // if (ready_dash_node->isCatchup()) OMAF_LOG(LOG_INFO, "Catch up node parsed! timeline is %lld, track id %d\n", timeline_point, ready_dash_node->getTrackId());
 
       if (ready_dash_node->getMediaType() == MediaType_Video)
@@ -1342,36 +1421,43 @@ void OmafReaderManager::threadRunner() noexcept {
       //samples_num_per_seg_ = ready_dash_node->GetSamplesNum();
 
       // 3. move the parsed segment/dash_node to parsed list
-      if (ret == ERROR_NONE) {
+      const uint32_t initSeg_id = ready_dash_node->getInitSegId();
+      const bool bcomplete = ready_dash_node->isComplete();
+      if (ret == ERROR_NONE && ready_dash_node->isPublished()) {
+        // the progressive node is in the parsed list already
+      } else if (ret == ERROR_NONE) {
         //OMAF_LOG(LOG_INFO, "Success to parsed dash segment! timeline=%lld\n", timeline_point);
 #ifndef _ANDROID_NDK_OPTION_
 #ifdef _USE_TRACE_
       tracepoint(mthq_tp_provider, T5_parse_end_time, timeline_point);
 #endif
 #endif
-        std::unique_lock<std::mutex> lock(segment_parsed_mutex_);
-        bool new_timeline_point = true;
-        for (auto &nodeset : segment_parsed_list_) {
-          if (nodeset.timeline_point_ == timeline_point) {
-            // if (ready_dash_node->isCatchup())
-            // LOG(INFO) << "Push parsed node PTS " << nodeset.timeline_point_ << " with track id " << ready_dash_node->getTrackId() << "with chunk id " << ready_dash_node->GetChunkId() << " into parsed list" << endl;
-            nodeset.segment_nodes_.push_back(std::move(ready_dash_node));
-            new_timeline_point = false;
-            break;
-          }
-        }
-        if (new_timeline_point) {
-          OmafSegmentNodeTimedSet nodeset;
-          nodeset.timeline_point_ = timeline_point;
-          nodeset.create_time_ = std::chrono::steady_clock::now();
-          // if (ready_dash_node->isCatchup())
-          // LOG(INFO) << "Push parsed node PTS " << nodeset.timeline_point_ << " with track id " << ready_dash_node->getTrackId() << "with chunk id " << ready_dash_node->GetChunkId() << " into parsed list" << endl;
-          nodeset.segment_nodes_.push_back(std::move(ready_dash_node));
-          segment_parsed_list_.emplace_back(nodeset);
-        }
-        segment_parsed_cv_.notify_all();
+        ready_dash_node->setPublished();
+        addParsedNode(ready_dash_node);
       } else {
-        OMAF_LOG(LOG_ERROR, "Failed to parse %s\n", ready_dash_node->to_string().c_str());
+        OMAF_LOG(LOG_ERROR, "Failed to parse %s, timeline=%ld\n", ready_dash_node->to_string().c_str(), timeline_point);
+      }
+
+      // 3.1 the next segment of the same track can be parsed now,
+      // unless the rest of a progressive chunk is still downloading
+      bool bdropped = false;
+      {
+        std::lock_guard<std::mutex> lock(segment_opened_mutex_);
+        auto nodeset_it = segment_opened_sets_.find(timeline_point);
+        if (ret == ERROR_NONE && !bcomplete && nodeset_it != segment_opened_sets_.end()) {
+          nodeset_it->second.segment_nodes_.push_front(std::move(ready_dash_node));
+        } else {
+          bdropped = (ret == ERROR_NONE && !bcomplete);
+          parsing_initSeg_ids_.erase(initSeg_id);
+        }
+        segment_opened_cv_.notify_all();
+      }
+
+      // 3.2 the timeline was cleared while the progressive node was parsed
+      if (bdropped) {
+        struct _parseWorker &reader_worker = *parse_workers_[ready_dash_node->getParseWorker()];
+        std::lock_guard<std::mutex> lock(reader_worker.reader_mutex_);
+        ready_dash_node->abandon(reader_worker.reader_);
       }
 
       // 4. clear dash set whose timeline point older than current ready segment/dash_node
@@ -1386,33 +1472,44 @@ void OmafReaderManager::threadRunner() noexcept {
   OMAF_LOG(LOG_INFO, "Exit from the reader runner!\n");
 }
 
+void OmafReaderManager::addParsedNode(OmafSegmentNode::Ptr parsed_dash_node) noexcept {
+  try {
+    const int64_t timeline_point = parsed_dash_node->getTimelinePoint();
+    std::unique_lock<std::mutex> lock(segment_parsed_mutex_);
+    if (timeline_point < parsed_evict_point_) {
+      OMAF_LOG(LOG_INFO, "Drop the parsed node older than timeline %ld, %s\n", parsed_evict_point_, parsed_dash_node->to_string().c_str());
+      return;
+    }
+    // the track slot is keyed by timeline point, so it keeps the order when workers finish out of order
+    // if (parsed_dash_node->isCatchup())
+    // LOG(INFO) << "Push parsed node PTS " << timeline_point << " with track id " << parsed_dash_node->getTrackId() << "with chunk id " << parsed_dash_node->GetChunkId() << " into parsed list" << endl;
+    segment_parsed_tracks_[parsed_dash_node->getTrackId()][timeline_point].push_back(std::move(parsed_dash_node));
+    segment_parsed_cv_.notify_all();
+  } catch (const std::exception &ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when add the parsed dash node, ex: %s\n", ex.what());
+  }
+}
+
 OmafSegmentNode::Ptr OmafReaderManager::findReadySegmentNode() noexcept {
   try {
     OmafSegmentNode::Ptr ready_dash_node;
     std::unique_lock<std::mutex> lock(segment_opened_mutex_);
-    for (auto &nodeset : segment_opened_list_) {
+    for (auto &nodeset_it : segment_opened_sets_) {
+      auto &nodeset = nodeset_it.second;
       //OMAF_LOG(LOG_INFO, "To find the ready node set timeline=%lld\n", nodeset.timeline_point_);
 
       // 1.1.1 try to find the ready node
       std::list<OmafSegmentNode::Ptr>::iterator it = nodeset.segment_nodes_.begin();
       while (it != nodeset.segment_nodes_.end()) {
         auto &node = *it;
-        if (node->isReady()) {
-          if (node->GetMode() == OmafDashMode::EXTRACTOR) {
-            if (node->isExtractor()) {
-              ready_dash_node = std::move(node);
-            }
-            else if (node->getMediaType() == MediaType_Audio) {
-              ready_dash_node = std::move(node);
-              OMAF_LOG(LOG_INFO, "Found one ready audio track segment node!\n");
-            }
-          } else {
-            ready_dash_node = std::move(node);
-          }
-
-          if (ready_dash_node.get() != nullptr) {
-            break;
+        // segments of one track must be parsed in order, skip the track being parsed by another worker,
+        // a partially parsed progressive node keeps its track until it completes
+        if (isParsableNode(node)) {
+          if (node->GetMode() == OmafDashMode::EXTRACTOR && !node->isExtractor()) {
+            OMAF_LOG(LOG_INFO, "Found one ready audio track segment node!\n");
           }
+          ready_dash_node = std::move(node);
+          break;
         }
         it++;
       }  // end while
@@ -1420,6 +1517,7 @@ OmafSegmentNode::Ptr OmafReaderManager::findReadySegmentNode() noexcept {
       // 1.1.2 find the ready node, exit and return
       if (ready_dash_node.get() != nullptr) {
         it = nodeset.segment_nodes_.erase(it);
+        parsing_initSeg_ids_.insert(ready_dash_node->getInitSegId());
         OMAF_LOG(LOG_INFO, "Get ready segment node with timeline %ld\n", nodeset.timeline_point_);
         break;
       }
@@ -1427,17 +1525,8 @@ OmafSegmentNode::Ptr OmafReaderManager::findReadySegmentNode() noexcept {
         OMAF_LOG(LOG_INFO, "No ready segment node for timeline %ld\n", nodeset.timeline_point_);
       }
 
-      // 1.2.1 no ready node found, then check whether timeout
-      bool btimeout = true;
-      for (auto node : nodeset.segment_nodes_) {
-        if (!node->checkTimeout(work_params_.segment_timeout_ms_)) {
-          btimeout = false;
-          break;
-        }
-      }
-
-      // 1.2.2 some node not timeout, still wait
-      if (!btimeout) {
+      // 1.2 no ready node found, some node not timeout, still wait
+      if (!isNodeSetTimeout(nodeset)) {
         // do nothing, wait the data ready
         break;
       }
@@ -1453,38 +1542,107 @@ OmafSegmentNode::Ptr OmafReaderManager::findReadySegmentNode() noexcept {
   }
 }
 
+bool OmafReaderManager::isParsableNode(const OmafSegmentNode::Ptr &node) noexcept {
+  // segments of one track must be parsed in order, skip the track being parsed by another worker,
+  // a partially parsed progressive node keeps its track until it completes
+  if (!node->isReady() ||
+      (!node->isResuming() && parsing_initSeg_ids_.find(node->getInitSegId()) != parsing_initSeg_ids_.end())) {
+    return false;
+  }
+  // extractor mode only parses the extractor track and the audio track
+  return node->GetMode() != OmafDashMode::EXTRACTOR || node->isExtractor() ||
+         node->getMediaType() == MediaType_Audio;
+}
+
+bool OmafReaderManager::isNodeSetTimeout(const OmafSegmentNodeTimedSet &nodeset) noexcept {
+  for (auto &node : nodeset.segment_nodes_) {
+    if (!node->checkTimeout(work_params_.segment_timeout_ms_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool OmafReaderManager::hasReadySegmentNode() noexcept {
+  // the same walk as findReadySegmentNode without taking the node
+  for (auto &nodeset_it : segment_opened_sets_) {
+    auto &nodeset = nodeset_it.second;
+    for (auto &node : nodeset.segment_nodes_) {
+      if (isParsableNode(node)) {
+        return true;
+      }
+    }
+    if (!isNodeSetTimeout(nodeset)) {
+      return false;
+    }
+  }
+  return false;
+}
+
 void OmafReaderManager::clearOlderSegmentSet(int64_t timeline_point) noexcept {
   try {
     {
       // 1. clear the opening list to save the network bandwith
       std::lock_guard<std::mutex> lock(segment_opening_mutex_);
-      std::list<OmafSegmentNodeTimedSet>::iterator it = segment_opening_list_.begin();
-      while ((it != segment_opening_list_.end()) && (it->timeline_point_ < timeline_point)) {
-        OMAF_LOG(LOG_INFO, "Removing older dash opening list, timeline=%lld\n", it->timeline_point_);
-        std::list<OmafSegmentNode::Ptr>::iterator iter = it->segment_nodes_.begin();
-        while (iter != it->segment_nodes_.end()) {
-          (*iter)->stop();
-          // OMAF_LOG(LOG_INFO, "Erase opening node %s", (*iter)->to_string().c_str());
-          iter = it->segment_nodes_.erase(iter);
+      auto end = segment_opening_sets_.lower_bound(timeline_point);
+      for (auto it = segment_opening_sets_.begin(); it != end; it++) {
+        OMAF_LOG(LOG_INFO, "Removing older dash opening list, timeline=%lld\n", it->first);
+        for (auto &node : it->second.segment_nodes_) {
+          node->stop();
+          // OMAF_LOG(LOG_INFO, "Erase opening node %s", node->to_string().c_str());
         }
-        it = segment_opening_list_.erase(it);
       }
+      segment_opening_sets_.erase(segment_opening_sets_.begin(), end);
     }
 
+    std::list<OmafSegmentNode::Ptr> resuming_nodes;
     {
       // 2. clear the opened dash node list
       std::lock_guard<std::mutex> lock(segment_opened_mutex_);
-      std::list<OmafSegmentNodeTimedSet>::iterator it = segment_opened_list_.begin();
-      while ((it != segment_opened_list_.end()) && (it->timeline_point_ < timeline_point)) {
-        OMAF_LOG(LOG_INFO, "Removing older dash opened list, timeline=%lld\n", it->timeline_point_);
-        it = segment_opened_list_.erase(it);
+      auto end = segment_opened_sets_.lower_bound(timeline_point);
+      if (segment_opened_sets_.begin() != end) {
+        OMAF_LOG(LOG_INFO, "Removing older dash opened list, timeline < %lld\n", timeline_point);
+        for (auto it = segment_opened_sets_.begin(); it != end; it++) {
+          for (auto &node : it->second.segment_nodes_) {
+            if (node->isResuming()) {
+              parsing_initSeg_ids_.erase(node->getInitSegId());
+              resuming_nodes.push_back(node);
+            }
+          }
+        }
+        segment_opened_sets_.erase(segment_opened_sets_.begin(), end);
+        segment_opened_cv_.notify_all();
       }
     }
+
+    // 3. release the partially parsed progressive chunks from their readers
+    for (auto &node : resuming_nodes) {
+      struct _parseWorker &worker = *parse_workers_[node->getParseWorker()];
+      std::lock_guard<std::mutex> lock(worker.reader_mutex_);
+      node->abandon(worker.reader_);
+    }
   } catch (const std::exception &ex) {
     OMAF_LOG(LOG_ERROR, "Exception when clear the older dash set, whose timeline is older than %lld, ex: %s\n", timeline_point, ex.what());
   }
 }
 
+void OmafReaderManager::clearOlderParsedNodes(int64_t timeline_point) noexcept {
+  try {
+    std::lock_guard<std::mutex> lock(segment_parsed_mutex_);
+    // the evict point only moves forward, nodes older than it are gone already
+    if (timeline_point <= parsed_evict_point_) {
+      return;
+    }
+    parsed_evict_point_ = timeline_point;
+    for (auto &track : segment_parsed_tracks_) {
+      OmafSegmentNodeTrackSlot &slot = track.second;
+      slot.erase(slot.begin(), slot.lower_bound(timeline_point));
+    }
+  } catch (const std::exception &ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when clear the older parsed nodes, whose timeline is older than %lld, ex: %s\n", timeline_point, ex.what());
+  }
+}
+
 // FIXME, dims and vps/sps/pps may not in the same sample
 int OmafPacketParams::init(std::shared_ptr<OmafReader> reader, uint32_t reader_trackId, uint32_t sampleId) noexcept {
   try {
@@ -1664,18 +1822,24 @@ void OmafAudioPacketParams::writeADTSHdr(uint32_t frameSize)
   OMAF_LOG(LOG_INFO, "ADTS header size %ld bytes\n", params_.size());
 }
 
-int OmafSegmentNode::parse() noexcept {
+int OmafSegmentNode::parse() noexcept { return parse(reader_.lock()); }
+
+int OmafSegmentNode::parse(std::shared_ptr<OmafReader> reader) noexcept {
   try {
     clock_t lBefore = clock();
     clock_t lBefore2 = lBefore;
     double dResult;
 
-    auto reader = reader_.lock();
     if (reader.get() == nullptr) {
       OMAF_LOG(LOG_ERROR, "The omaf reader is empty!\n");
       return ERROR_NULL_PTR;
     }
 
+    // a chunk handed out while downloading is parsed in several passes
+    if (segment_->IsProgressive()) {
+      return parseProgressive(reader);
+    }
+
     OMAF_STATUS ret = ERROR_NONE;
     // 1.1 calling depends to parse the segment
     for (auto &node : depends_) {
@@ -1732,6 +1896,62 @@ int OmafSegmentNode::parse() noexcept {
   }
 }
 
+int OmafSegmentNode::parseProgressive(std::shared_ptr<OmafReader> reader) noexcept {
+  try {
+    OMAF_STATUS ret = ERROR_NONE;
+    // 1. the download ended before the chunk completed, keep the packets cached so far
+    if (segment_->GetState() != OmafSegment::State::OPEN_SUCCES) {
+      OMAF_LOG(LOG_WARNING, "Stop parsing the incomplete %s\n", this->to_string().c_str());
+      abandon(reader);
+      return ERROR_NONE;
+    }
+
+    // 2. the moof is complete, so the sample table is read while the mdat still arrives
+    if (!header_parsed_) {
+      ret = reader->parseSegmentHeader(segment_.get(), segment_->GetInitSegID(), segment_->GetSegID());
+      if (ERROR_NONE != ret) {
+        OMAF_LOG(LOG_ERROR, "Failed to parse the header of %s. Error code=%d\n", this->to_string().c_str(), ret);
+        bcached_all_ = true;
+        return ret;
+      }
+      header_parsed_ = true;
+    }
+
+    // 3. cache the packets whose sample bytes are present
+    parsed_size_ = segment_->GetAvailableSize();
+    ret = cachePackets(reader);
+    if (ERROR_NONE != ret) {
+      OMAF_LOG(LOG_ERROR, "Failed to read packet from %s. Error code=%d\n", this->to_string().c_str(), ret);
+      abandon(reader);
+      return ERROR_INVALID;
+    }
+
+    // 4. remove self segment from reader once all samples are cached
+    if (bcached_all_) {
+      header_parsed_ = false;
+      ret = removeSegmentStream(reader);
+      if (ERROR_NONE != ret) {
+        OMAF_LOG(LOG_ERROR, "Failed to remove segment from reader %s. Error code=%d\n", this->to_string().c_str(), ret);
+        return ERROR_INVALID;
+      }
+    }
+    return ERROR_NONE;
+  } catch (const std::exception &ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when parse the progressive segment! ex: %s\n", ex.what());
+    return ERROR_INVALID;
+  }
+}
+
+int OmafSegmentNode::abandon(std::shared_ptr<OmafReader> reader) noexcept {
+  OMAF_STATUS ret = ERROR_NONE;
+  if (header_parsed_ && reader.get() != nullptr) {
+    ret = removeSegmentStream(reader);
+  }
+  header_parsed_ = false;
+  bcached_all_ = true;
+  return ret;
+}
+
 int OmafSegmentNode::start(void) noexcept {
   try {
     OMAF_STATUS ret = ERROR_NONE;
@@ -1895,6 +2115,52 @@ int OmafSegmentNode::getPacketWithPTS(MediaPacket *&pPacket, bool requireParams,
   }
 }
 
+int OmafSegmentNode::readPacketsInBulk(std::shared_ptr<OmafReader> reader, const VCD::MP4::SampleCursor &cursor,
+                                       size_t sample_begin, size_t sample_end, size_t reserved_size,
+                                       std::vector<std::unique_ptr<MediaPacket>> &packets,
+                                       std::vector<uint32_t> &packet_sizes) noexcept {
+  try {
+    packets.clear();
+    packet_sizes.clear();
+    if (sample_begin >= sample_end) return ERROR_NONE;
+
+    // the samples are referenced in place when the segment is held in memory
+    std::vector<VCD::MP4::StreamSpan> sample_spans;
+    bool length_prefixed = false;
+    if (reader->getTrackSampleSpans(cursor, sample_begin, sample_spans, length_prefixed) == ERROR_NONE) {
+      return ERROR_NONE;
+    }
+
+    auto packet_pool = getPacketPool();
+    const size_t sample_count = sample_end - sample_begin;
+    std::vector<char *> buffers(sample_count, nullptr);
+    packets.reserve(sample_count);
+    packet_sizes.resize(sample_count, 0);
+    for (size_t i = 0; i < sample_count; i++) {
+      uint64_t sample_offset = 0;
+      uint32_t sample_size = 0;
+      int ret = reader->getTrackSampleOffset(cursor, sample_begin + i, sample_offset, sample_size);
+      if (ret != ERROR_NONE) return ret;
+
+      std::unique_ptr<MediaPacket> packet(new MediaPacket());
+      if (packet->AllocatePacket(packet_pool, sample_size + reserved_size) < 0) {
+        OMAF_LOG(LOG_ERROR, "Failed to allocate the packet buffer with size %u!\n", sample_size);
+        return ERROR_NULL_PTR;
+      }
+      buffers[i] = static_cast<char *>(packet->Payload());
+      packet_sizes[i] = static_cast<uint32_t>(packet->AllocatedSize());
+      packets.push_back(std::move(packet));
+    }
+
+    // one pass over the segment, packet_sizes are updated to the real sample sizes
+    return reader->getTrackSamplesData(cursor, static_cast<uint32_t>(sample_begin), static_cast<uint32_t>(sample_count),
+                                       buffers.data(), packet_sizes.data());
+  } catch (const std::exception &ex) {
+    OMAF_LOG(LOG_ERROR, "Failed to read the samples in bulk, ex: %s\n", ex.what());
+    return ERROR_INVALID;
+  }
+}
+
 int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
   try {
     OMAF_STATUS ret = ERROR_NONE;
@@ -1957,14 +2223,15 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
       }
 
       auto packet_params = (bExtractor_ == true) ? getPacketParamsForExtractors() : getPacketParams();
-      for (size_t sample = sample_begin; sample < sample_end; sample++) {
-        uint32_t reader_track_id = buildReaderTrackId(segment_->GetTrackId(), segment_->GetInitSegID());
-
+      auto packet_pool = getPacketPool();
+      uint32_t last_packet_size = 0;
+      uint32_t reader_track_id = buildReaderTrackId(segment_->GetTrackId(), segment_->GetInitSegID());
+      if (sample_begin < sample_end) {
         if (packet_params.get() == nullptr) {
           packet_params = std::make_shared<OmafPacketParams>();
         }
         if (!packet_params->binit_) {
-          ret = packet_params->init(reader, reader_track_id, sample);
+          ret = packet_params->init(reader, reader_track_id, sample_begin);
           if (ret != ERROR_NONE) {
             OMAF_LOG(LOG_ERROR, "Failed to read the packet params include width/height/vps/sps/pps!\n");
             return ret;
@@ -1978,24 +2245,103 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
             this->setPacketParams(packet_params);
           }
         }
+      }
 
-        // cache packets
-        // std::shared_ptr<MediaPacket> packet = make_unique_vcd<MediaPacket>;
-        MediaPacket *packet = new MediaPacket();
-        if (packet == nullptr) {
-          OMAF_LOG(LOG_ERROR, "Failed to create the packet!\n");
-          return ERROR_INVALID;
+      // resolve the segment and track lookups once for all samples of the node
+      VCD::MP4::SampleCursor cursor;
+      if (sample_begin < sample_end &&
+          reader->getTrackSampleCursor(reader_track_id, static_cast<uint32_t>(sample_begin), cursor) != ERROR_NONE) {
+        cursor = VCD::MP4::SampleCursor();
+      }
+
+      // samples which can not be referenced in memory are read in one pass
+      std::vector<std::unique_ptr<MediaPacket>> bulk_packets;
+      std::vector<uint32_t> bulk_sizes;
+      if (mode_ != OmafDashMode::EXTRACTOR && cursor.IsValid() && !segment_->IsProgressive() &&
+          readPacketsInBulk(reader, cursor, sample_begin, sample_end, packet_params->params_.size(), bulk_packets,
+                            bulk_sizes) != ERROR_NONE) {
+        OMAF_LOG(LOG_WARNING, "Failed to read the samples of %s in bulk, read them one by one!\n",
+                 this->to_string().c_str());
+        bulk_packets.clear();
+        bulk_sizes.clear();
+      }
+
+      for (size_t sample = std::max(sample_begin, next_sample_); sample < sample_end; sample++) {
+        const bool by_cursor = cursor.Contains(static_cast<uint32_t>(sample));
+        MediaPacket *packet = nullptr;
+        uint32_t packet_size = 0;
+
+        // 0. a progressive chunk releases the sample once its bytes are present
+        if (segment_->IsProgressive()) {
+          uint64_t sample_offset = 0;
+          uint32_t sample_size = 0;
+          ret = by_cursor ? reader->getTrackSampleOffset(cursor, sample, sample_offset, sample_size)
+                          : reader->getTrackSampleOffset(reader_track_id, sample, sample_offset, sample_size);
+          if (ret == ERROR_NONE && sample_offset + sample_size > static_cast<uint64_t>(segment_->GetAvailableSize())) {
+            next_sample_ = sample;
+            return ERROR_NONE;
+          }
         }
-        uint32_t packet_size = ((packet_params->width_ * packet_params->height_ * 3) >> 1) >> 1;
-        // FIXME, we need refine the packet buffer. we may include the vps/pps/sps here
-        packet->ReAllocatePacket(packet_size);
 
-        if (mode_ == OmafDashMode::EXTRACTOR) {
-          ret = reader->getExtractorTrackSampleData(reader_track_id, sample, static_cast<char *>(packet->Payload()),
-                                                    packet_size);
+        if (!bulk_packets.empty()) {
+          // the sample has already been read into its packet
+          packet = bulk_packets[sample - sample_begin].release();
+          packet_size = bulk_sizes[sample - sample_begin];
+          ret = ERROR_NONE;
         } else {
-          ret = reader->getTrackSampleData(reader_track_id, sample, static_cast<char *>(packet->Payload()), packet_size);
+          // cache packets
+          // std::shared_ptr<MediaPacket> packet = make_unique_vcd<MediaPacket>;
+          packet = new MediaPacket();
+          if (packet == nullptr) {
+            OMAF_LOG(LOG_ERROR, "Failed to create the packet!\n");
+            return ERROR_INVALID;
+          }
+          // 1. the sample size comes from the sample table, while the size of the
+          // resolved extractor sample is only known after reading, so take the last one as hint
+          uint64_t sample_offset = 0;
+          ret = by_cursor ? reader->getTrackSampleOffset(cursor, sample, sample_offset, packet_size)
+                          : reader->getTrackSampleOffset(reader_track_id, sample, sample_offset, packet_size);
+          if (ret != ERROR_NONE || packet_size == 0) {
+            packet_size = ((packet_params->width_ * packet_params->height_ * 3) >> 1) >> 1;
+          }
+          if (mode_ == OmafDashMode::EXTRACTOR) {
+            packet_size = std::max(packet_size, last_packet_size);
+          }
+
+          // 2. reference the sample in the downloaded segment when it is held in memory,
+          // the packet keeps the segment alive and only copies the data when it is consumed
+          std::vector<VCD::MP4::StreamSpan> sample_spans;
+          bool length_prefixed = false;
+          if (mode_ != OmafDashMode::EXTRACTOR &&
+              (by_cursor ? reader->getTrackSampleSpans(cursor, sample, sample_spans, length_prefixed)
+                         : reader->getTrackSampleSpans(reader_track_id, sample, sample_spans, length_prefixed)) ==
+                  ERROR_NONE) {
+            packet_size = static_cast<uint32_t>(
+                packet->SetPayloadSpans(packet_pool, std::move(sample_spans), segment_, length_prefixed));
+            ret = ERROR_NONE;
+          } else {
+            // 3. else read the sample into the pooled buffer, which leaves room for vps/sps/pps
+            for (int tries = 0; tries < 2; tries++) {
+              if (packet->AllocatePacket(packet_pool, packet_size + packet_params->params_.size()) < 0) {
+                OMAF_LOG(LOG_ERROR, "Failed to allocate the packet buffer with size %u!\n", packet_size);
+                SAFE_DELETE(packet);
+                return ERROR_NULL_PTR;
+              }
+              packet_size = static_cast<uint32_t>(packet->AllocatedSize());
+              char *payload = static_cast<char *>(packet->Payload());
+              if (mode_ == OmafDashMode::EXTRACTOR) {
+                ret = by_cursor ? reader->getExtractorTrackSampleData(cursor, sample, payload, packet_size)
+                                : reader->getExtractorTrackSampleData(reader_track_id, sample, payload, packet_size);
+              } else {
+                ret = by_cursor ? reader->getTrackSampleData(cursor, sample, payload, packet_size)
+                                : reader->getTrackSampleData(reader_track_id, sample, payload, packet_size);
+              }
+              // packet_size has been updated to the required size
+              if (ret != OMAF_MEMORY_TOO_SMALL_BUFFER) break;
+            }
+          }
         }
+        last_packet_size = packet_size;
         if (ret != ERROR_NONE) {
           OMAF_LOG(LOG_ERROR, "Failed to read sample data from reader, code= %d\n", ret);
           SAFE_DELETE(packet);
@@ -2014,11 +2360,12 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
 
         packet->SetPRFT(pPrft);
 
+        auto reader_mgr = omaf_reader_mgr_.lock();
         if (reader->GetVideoSegSampleSize() == 0) {
-          reader->SetVideoSegSampleSize(track_info->sampleProperties.size);
+          uint32_t sample_size = track_info->sampleProperties.size;
+          reader->SetVideoSegSampleSize(reader_mgr ? reader_mgr->getSegSampleSize(MediaType_Video, sample_size) : sample_size);
         }
 
-        auto reader_mgr = omaf_reader_mgr_.lock();
         if (reader_mgr) {
           if (segment_->GetSegID() == 1 && reader_mgr->GetStartOffsetPts() == -1) {// set start offset pts when segment id is 1
             reader_mgr->SetStartOffsetPts(chunk_id_ * track_info->sampleProperties.size);
@@ -2130,9 +2477,20 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
     }
     else if (segment_->GetMediaType() == MediaType_Audio) {
       auto packet_params = getPacketParamsForAudio();
-      for (size_t sample = sample_begin; sample < sample_end; sample++) {
+      auto packet_pool = getPacketPool();
+      for (size_t sample = std::max(sample_begin, next_sample_); sample < sample_end; sample++) {
         uint32_t reader_track_id = buildReaderTrackId(segment_->GetTrackId(), segment_->GetInitSegID());
 
+        if (segment_->IsProgressive()) {
+          uint64_t sample_offset = 0;
+          uint32_t sample_size = 0;
+          ret = reader->getTrackSampleOffset(reader_track_id, sample, sample_offset, sample_size);
+          if (ret == ERROR_NONE && sample_offset + sample_size > static_cast<uint64_t>(segment_->GetAvailableSize())) {
+            next_sample_ = sample;
+            return ERROR_NONE;
+          }
+        }
+
         if (packet_params.get() == nullptr) {
           packet_params = std::make_shared<OmafAudioPacketParams>();
         }
@@ -2155,7 +2513,11 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
         uint32_t chlNum = segment_->GetAudioChlNum();
         uint32_t packet_size = 1024 * chlNum;
 
-        packet->ReAllocatePacket(packet_size);
+        if (packet->AllocatePacket(packet_pool, packet_size) < 0) {
+          OMAF_LOG(LOG_ERROR, "Failed to allocate the packet buffer with size %u!\n", packet_size);
+          SAFE_DELETE(packet);
+          return ERROR_NULL_PTR;
+        }
 
         ret = reader->getTrackSampleData(reader_track_id, sample, static_cast<char *>(packet->Payload()), packet_size);
 
@@ -2166,7 +2528,9 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
         }
 
         if (reader->GetAudioSegSampleSize() == 0) {
-          reader->SetAudioSegSampleSize(track_info->sampleProperties.size);
+          auto reader_mgr = omaf_reader_mgr_.lock();
+          uint32_t sample_size = track_info->sampleProperties.size;
+          reader->SetAudioSegSampleSize(reader_mgr ? reader_mgr->getSegSampleSize(MediaType_Audio, sample_size) : sample_size);
         }
         packet->SetPTS(reader->GetAudioSegSampleSize() * (segment_->GetSegID() - 1) + sample_begin + sample);
         if ((sample + 1) == sample_end)
@@ -2190,6 +2554,7 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
       }
     }
 
+    bcached_all_ = true;
     return ERROR_NONE;
   } catch (const std::exception &ex) {
     OMAF_LOG(LOG_ERROR, "Exception when read packets! ex: %s\n", ex.what());
@@ -2258,6 +2623,11 @@ bool OmafSegmentNode::isReady() const noexcept {
       return false;
     }
 
+    // resume a progressive node when more bytes arrived, or to release it when the download ended
+    if (header_parsed_) {
+      return segment_->GetState() != OmafSegment::State::OPEN_SUCCES || segment_->GetAvailableSize() > parsed_size_;
+    }
+
     if (segment_->GetState() != OmafSegment::State::OPEN_SUCCES) {
       OMAF_LOG(LOG_WARNING, "The segment is not in open success. state=%d\n", static_cast<int>(segment_->GetState()));
       return false;
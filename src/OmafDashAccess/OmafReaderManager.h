@@ -37,6 +37,7 @@
 #define OMAFMP4READERMGR_H
 
 #include "MediaPacket.h"
+#include "MediaPacketPool.h"
 #include "general.h"
 
 #include "OmafMediaSource.h"
@@ -45,10 +46,14 @@
 #include <atomic>
 #include <chrono>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <set>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 VCD_OMAF_BEGIN
 
@@ -65,6 +70,10 @@ struct _omafSegmentNodeTimedSet {
 };
 
 using OmafSegmentNodeTimedSet = struct _omafSegmentNodeTimedSet;
+// node sets indexed by timeline point, ordered for in-order parsing and range eviction
+using OmafSegmentNodeTimeline = std::map<int64_t, OmafSegmentNodeTimedSet>;
+// parsed nodes of one track indexed by timeline point
+using OmafSegmentNodeTrackSlot = std::map<int64_t, std::list<std::shared_ptr<OmafSegmentNode>>>;
 
 class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_this<OmafReaderManager> {
   friend OmafSegmentNode;
@@ -76,6 +85,8 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
     size_t duration_ = 0;
     int32_t segment_timeout_ms_ = 3000;  // ms
     ProjectionFormat proj_fmt_  = ProjectionFormat::PF_ERP;
+    uint32_t parse_worker_num_ = 0;  // 0 is derived from the hardware concurrency, capped by it
+    bool progressive_parse_ = false;  // parse cmaf chunks while their mdat downloads
   };
 
   using OmafReaderParams = struct _params;
@@ -107,6 +118,11 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   OMAF_STATUS OpenSegment(std::shared_ptr<OmafSegment> pSeg, bool isExtractor = false, bool isCatchup = false) noexcept;
   OMAF_STATUS OpenLocalSegment(std::shared_ptr<OmafSegment> pSeg, bool isExtractor = false) noexcept;
 
+  //!  \brief stop the downloading segments of the tracks at the timeline point,
+  //!         return the number of stopped segments
+  //!
+  size_t StopSegments(int64_t timeline_point, const std::vector<uint32_t> &track_ids) noexcept;
+
   //!  \brief Get Next packet from packet queue. each track has a packet queue
   //!
   OMAF_STATUS GetNextPacket(uint32_t trackID, MediaPacket *&pPacket, bool requireParams) noexcept;
@@ -132,6 +148,8 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   void SetStartOffsetPts(int64_t pts) { offset_pts_ = pts; };
 
   DashStreamType GetStreamType() { return work_params_.stream_type_; };
+  // extractor segments depend on their tile tracks being complete
+  bool IsProgressiveParse() { return work_params_.progressive_parse_ && work_params_.mode_ != OmafDashMode::EXTRACTOR; };
 
   uint64_t GetOldestPacketPTSForTrack(int trackId);
   void RemoveOutdatedPacketForTrack(int trackId, uint64_t currPTS);
@@ -178,11 +196,19 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   }
 
  private:
-  void threadRunner() noexcept;
+  void threadRunner(size_t worker_idx) noexcept;
   std::shared_ptr<OmafSegmentNode> findReadySegmentNode() noexcept;
+  // below three need segment_opened_mutex_ held
+  bool isParsableNode(const std::shared_ptr<OmafSegmentNode> &node) noexcept;
+  bool isNodeSetTimeout(const OmafSegmentNodeTimedSet &nodeset) noexcept;
+  bool hasReadySegmentNode() noexcept;
+  void addParsedNode(std::shared_ptr<OmafSegmentNode> parsed_dash_node) noexcept;
   void clearOlderSegmentSet(int64_t timeline_point) noexcept;
+  void clearOlderParsedNodes(int64_t timeline_point) noexcept;
   bool checkEOS(int64_t segment_num) noexcept;
-  bool isEmpty(std::mutex &mutex, const std::list<OmafSegmentNodeTimedSet> &nodes) noexcept;
+  bool isEmpty(std::mutex &mutex, const OmafSegmentNodeTimeline &nodes) noexcept;
+  bool isParsedEmpty() noexcept;
+  static OmafSegmentNodeTimedSet &getNodeSet(OmafSegmentNodeTimeline &node_sets, int64_t timeline_point);
 
  private:
   inline int initSegParsedCount(void) noexcept { return initSeg_ready_count_.load(); }
@@ -195,24 +221,53 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   void normalChunkStateChange(std::shared_ptr<OmafSegment>, OmafSegment::State) noexcept;
   void AddOpenedNode(std::shared_ptr<OmafSegment>, std::shared_ptr<OmafSegmentNode> opened_dash_node) noexcept;
 
+  //!  \brief the sample number of one whole segment for the media type,
+  //!         the first parsed segment decides it for all parse workers
+  uint32_t getSegSampleSize(MediaType type, uint32_t sample_size) noexcept {
+    std::atomic<uint32_t> &seg_sample_size = (type == MediaType_Audio) ? audio_seg_sample_size_ : video_seg_sample_size_;
+    uint32_t expected = 0;
+    seg_sample_size.compare_exchange_strong(expected, sample_size);
+    return seg_sample_size.load();
+  }
+
+  //!  \brief the payload buffer pool of the track, samples of one track have similar sizes
+  MediaPacketPool::Ptr getPacketPool(uint32_t trackId) noexcept {
+    try {
+      std::lock_guard<std::mutex> lock(packet_pools_mutex_);
+      MediaPacketPool::Ptr &pool = packet_pools_[trackId];
+      if (pool.get() == nullptr) {
+        pool = std::make_shared<MediaPacketPool>();
+      }
+      return pool;
+    } catch (const std::exception &ex) {
+      return nullptr;
+    }
+  }
+
   std::shared_ptr<OmafPacketParams> getPacketParams(uint32_t qualityRanking) noexcept {
+    std::lock_guard<std::mutex> lock(packet_params_mutex_);
     return omaf_packet_params_[qualityRanking];
   }
   void setPacketParams(uint32_t qualityRanking, std::shared_ptr<OmafPacketParams> params) {
+    std::lock_guard<std::mutex> lock(packet_params_mutex_);
     omaf_packet_params_[qualityRanking] = std::move(params);
   }
 
   std::shared_ptr<OmafPacketParams> getPacketParamsForExtractors(uint32_t extractorTrackIdx) noexcept {
+    std::lock_guard<std::mutex> lock(packet_params_mutex_);
     return packet_params_for_extractors_[extractorTrackIdx];
   }
   void setPacketParamsForExtractors(uint32_t extractorTrackIdx, std::shared_ptr<OmafPacketParams> params) {
+    std::lock_guard<std::mutex> lock(packet_params_mutex_);
     packet_params_for_extractors_[extractorTrackIdx] = std::move(params);
   }
 
   std::shared_ptr<OmafAudioPacketParams> getPacketParamsForAudio(uint32_t audioTrackIdx) noexcept {
+    std::lock_guard<std::mutex> lock(packet_params_mutex_);
     return packet_params_for_audio_[audioTrackIdx];
   }
   void setPacketParamsForAudio(uint32_t audioTrackIdx, std::shared_ptr<OmafAudioPacketParams> params) {
+    std::lock_guard<std::mutex> lock(packet_params_mutex_);
     packet_params_for_audio_[audioTrackIdx] = std::move(params);
   }
 
@@ -221,9 +276,19 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
 
   OmafReaderParams work_params_;
   int64_t timeline_point_ = -1;
-  // omaf reader
-  std::thread segment_reader_worker_;
-  bool breader_working_ = false;
+  // omaf reader, one parse worker per reader, reader of worker 0 is reader_
+  struct _parseWorker {
+    std::thread thread_;
+    std::mutex reader_mutex_;
+    std::shared_ptr<OmafReader> reader_;
+  };
+  std::vector<std::unique_ptr<struct _parseWorker>> parse_workers_;
+  std::atomic_bool breader_working_{false};
+  // init segment ids being parsed by workers, guarded by segment_opened_mutex_.
+  // segments of one track are parsed in order, so only one in flight per init segment
+  std::set<uint32_t> parsing_initSeg_ids_;
+  std::atomic<uint32_t> video_seg_sample_size_{0};
+  std::atomic<uint32_t> audio_seg_sample_size_{0};
 
   std::mutex segment_samples_mutex_;
   std::map<uint64_t, size_t> samples_num_per_seg_;
@@ -231,21 +296,28 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   std::shared_ptr<OmafReader> reader_;
 
   std::mutex segment_opening_mutex_;
-  std::list<OmafSegmentNodeTimedSet> segment_opening_list_;
+  OmafSegmentNodeTimeline segment_opening_sets_;
   std::mutex segment_opened_mutex_;
   std::condition_variable segment_opened_cv_;
-  std::list<OmafSegmentNodeTimedSet> segment_opened_list_;
+  OmafSegmentNodeTimeline segment_opened_sets_;
   std::mutex segment_parsed_mutex_;
   std::condition_variable segment_parsed_cv_;
-  std::list<OmafSegmentNodeTimedSet> segment_parsed_list_;
+  // parsed nodes per track id, so reading packets of one track is a direct lookup
+  std::unordered_map<uint32_t, OmafSegmentNodeTrackSlot> segment_parsed_tracks_;
+  // parsed nodes older than it have been evicted
+  int64_t parsed_evict_point_ = -1;
 
   OmafMediaSource *media_source_ = nullptr;
+  std::mutex packet_params_mutex_;
   std::map<uint32_t, std::shared_ptr<OmafPacketParams>> omaf_packet_params_;
 
   std::map<uint32_t, std::shared_ptr<OmafPacketParams>> packet_params_for_extractors_;
 
   std::map<uint32_t, std::shared_ptr<OmafAudioPacketParams>> packet_params_for_audio_;
 
+  std::mutex packet_pools_mutex_;
+  std::map<uint32_t, MediaPacketPool::Ptr> packet_pools_;
+
   std::mutex initSeg_mutex_;
 
   //<! ID pair for InitSegID to TrackID;
@@ -260,7 +332,7 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
 
   std::string sBrand_;
 
-  int64_t offset_pts_ = -1;
+  std::atomic<int64_t> offset_pts_{-1};
   uint32_t timeout_for_checkEOS_ = 500;
   uint64_t fetch_pts_ = 0;
   vector<pair<uint32_t, uint32_t>> inactive_tracks_; // first: segment id, second: track id
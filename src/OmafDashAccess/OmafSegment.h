@@ -134,6 +134,8 @@ class OmafSegment : public VCD::MP4::StreamIO, public enable_shared_from_this<Om
 
   offset_t GetStreamSize() override {
     if (!buse_stored_file_) {
+      // a progressive chunk reports its full size while its bytes arrive
+      if (expected_size_ > 0) return expected_size_;
       return dash_stream_.GetStreamSize();
     } else {
       if (!mFileStream.is_open()) {
@@ -146,6 +148,14 @@ class OmafSegment : public VCD::MP4::StreamIO, public enable_shared_from_this<Om
     }
   };
 
+  bool GetStreamSpans(offset_t offset, offset_t size, std::vector<VCD::MP4::StreamSpan>& spans) override {
+    if (!buse_stored_file_) {
+      return dash_stream_.GetStreamSpans(offset, size, spans);
+    }
+    // the data lives in the cache file, no memory to reference
+    return false;
+  };
+
  public:
   //
   // @brief register state change callback
@@ -214,6 +224,43 @@ class OmafSegment : public VCD::MP4::StreamIO, public enable_shared_from_this<Om
 
   virtual std::unique_ptr<StreamBlock> PopOneStreamBlock() noexcept { return nullptr; };
 
+  //
+  // @brief pop the chunk handed out before all of its bytes were downloaded
+  //
+  // @return OmafSegment::Ptr
+  // @brief the progressive chunk, nullptr if there is none
+  virtual OmafSegment::Ptr PopProgressiveChunk() noexcept { return nullptr; };
+
+  //
+  // @brief append downloaded bytes to a progressive chunk
+  //
+  // @param[in] sb
+  // @brief the bytes following the ones already present
+  //
+  // @return void
+  // @brief
+  void AppendStreamBlock(std::unique_ptr<StreamBlock> sb) noexcept { dash_stream_.push_back(std::move(sb)); };
+
+  //
+  // @brief mark the segment as a progressive chunk of the given full size
+  //
+  // @param[in] size
+  // @brief the chunk size from the segment index
+  //
+  // @return void
+  // @brief
+  void SetExpectedSize(int64_t size) noexcept { expected_size_ = size; };
+
+  bool IsProgressive() const noexcept { return expected_size_ > 0; };
+
+  //
+  // @brief get the number of bytes present, which is less than the stream
+  //        size while a progressive chunk is downloading
+  //
+  // @return int64_t
+  // @brief bytes present from the start of the segment
+  int64_t GetAvailableSize() noexcept { return dash_stream_.GetStreamSize(); };
+
   int Stop() noexcept;
   // int Read(uint8_t* data, size_t len);
   // int Peek(uint8_t* data, size_t len);
@@ -292,6 +339,9 @@ class OmafSegment : public VCD::MP4::StreamIO, public enable_shared_from_this<Om
 
   uint32_t chunk_num_ = 1;
 
+  //<! full size of a progressive chunk, 0 when all bytes are present
+  int64_t expected_size_ = 0;
+
  private:
 
   // SegmentElement* mSegElement;  //<! SegmentElement
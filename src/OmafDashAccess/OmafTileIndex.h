@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+//!
+//! \file:   OmafTileIndex.h
+//! \brief:  the spatial index from tile position to tile track adaptation set
+//! \detail: the index is built once for one stream after the MPD is parsed, so
+//!          tracks selectors find the adaptation set of each tile in viewport
+//!          by its quality ranking, face and position without going through
+//!          all adaptation sets of the stream.
+//!
+
+#ifndef OMAFTILEINDEX_H_
+#define OMAFTILEINDEX_H_
+
+#include "../utils/ns_def.h"
+#include "general.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace VCD {
+namespace OMAF {
+
+class OmafAdaptationSet;
+
+class OmafTileIndex {
+ public:
+  OmafTileIndex() = default;
+  virtual ~OmafTileIndex() = default;
+
+  //!
+  //! \brief  Remove all tiles from the index
+  //!
+  void Clear() {
+    tiles_.clear();
+    quality_sets_.clear();
+  }
+
+  //!
+  //! \brief  Add one tile into the index. if there is already one tile at the same
+  //!         position, the first added one is kept for the position
+  //!
+  //! \param  [in] qualityRanking
+  //!         the quality ranking of the tile
+  //! \param  [in] faceId
+  //!         the cube map face of the tile, 0 for other projections
+  //! \param  [in] x
+  //!         the left position of the tile
+  //! \param  [in] y
+  //!         the top position of the tile
+  //! \param  [in] as
+  //!         the adaptation set of the tile track
+  //!
+  void Add(uint32_t qualityRanking, int32_t faceId, int32_t x, int32_t y, OmafAdaptationSet *as) {
+    if (as == nullptr) return;
+    tiles_.emplace(key(qualityRanking, faceId, x, y), as);
+    quality_sets_[qualityRanking].push_back(as);
+  }
+
+  //!
+  //! \brief  Find the adaptation set of the tile at the position
+  //!
+  //! \return
+  //!         the adaptation set, nullptr if there is no such tile
+  //!
+  OmafAdaptationSet *Find(uint32_t qualityRanking, int32_t faceId, int32_t x, int32_t y) const {
+    auto it = tiles_.find(key(qualityRanking, faceId, x, y));
+    return it == tiles_.end() ? nullptr : it->second;
+  }
+
+  //!
+  //! \brief  Get all adaptation sets of the quality ranking, in the order they are added
+  //!
+  const std::vector<OmafAdaptationSet *> &GetAdaptationSets(uint32_t qualityRanking) const {
+    auto it = quality_sets_.find(qualityRanking);
+    return it == quality_sets_.end() ? empty_ : it->second;
+  }
+
+  //!
+  //! \brief  Get the map of <qualityRanking, adaptation sets> of all tiles
+  //!
+  const std::map<uint32_t, std::vector<OmafAdaptationSet *>> &GetAllAdaptationSets() const { return quality_sets_; }
+
+  size_t Size() const { return tiles_.size(); }
+
+ private:
+  // quality ranking, face and position of one tile are packed into one key,
+  // positions are in pixels so 20 bits are enough for each of them
+  static uint64_t key(uint32_t qualityRanking, int32_t faceId, int32_t x, int32_t y) noexcept {
+    return (static_cast<uint64_t>(qualityRanking & 0xFFFF) << 48) | (static_cast<uint64_t>(faceId & 0xFF) << 40) |
+           (static_cast<uint64_t>(x & 0xFFFFF) << 20) | static_cast<uint64_t>(y & 0xFFFFF);
+  }
+
+ private:
+  std::unordered_map<uint64_t, OmafAdaptationSet *> tiles_;
+  std::map<uint32_t, std::vector<OmafAdaptationSet *>> quality_sets_;
+  std::vector<OmafAdaptationSet *> empty_;
+};
+
+}  // namespace OMAF
+}  // namespace VCD
+
+#endif /* OMAFTILEINDEX_H_ */
@@ -123,6 +123,8 @@ int OmafTileTracksSelector::SelectTracks(OmafMediaStream* pStream, bool isTimed)
                         if (m_SelectedTracks.size() <= rowSize * colSize / 2 || m_SelectedTracks.size() < oneTracks.size())
                         {
                             m_SelectedTracks.insert(*iter);
+                            // sorted by ViewportPriority, so the first one is kept
+                            m_selectedTracksPriority.insert(make_pair(iter->first, predictedTracksArray[i].first));
                         }
                         else break;
                     }
@@ -155,6 +157,7 @@ int OmafTileTracksSelector::SelectTracks(OmafMediaStream* pStream, bool isTimed)
                 m_currentTracks.clear();
             }
             m_currentTracks = m_SelectedTracks;
+            m_currentTracksPriority = m_selectedTracksPriority;
         }
         if (isTimed)
         {
@@ -174,6 +177,7 @@ int OmafTileTracksSelector::SelectTracks(OmafMediaStream* pStream, bool isTimed)
             OMAF_LOG(LOG_INFO, "Insert segid %lld tracks into previous map!\n", curr_pts);
         }
         m_SelectedTracks.clear();
+        m_selectedTracksPriority.clear();
     }
 
     return ret;
@@ -187,6 +191,7 @@ int OmafTileTracksSelector::UpdateEnabledTracks(OmafMediaStream* pStream)
     {
         std::lock_guard<std::mutex> lock(mCurrentMutex);
         ret = pStream->UpdateEnabledTileTracks(m_currentTracks);
+        UpdateTracksDownloadPriority();
     }
     else if (streamInfo->stream_type == MediaType_Audio)
     {
@@ -195,6 +200,33 @@ int OmafTileTracksSelector::UpdateEnabledTracks(OmafMediaStream* pStream)
     return ret;
 }
 
+void OmafTileTracksSelector::UpdateTracksDownloadPriority()
+{
+    for (auto it = m_currentTracks.begin(); it != m_currentTracks.end(); it++)
+    {
+        OmafAdaptationSet *adaptationSet = it->second;
+        if (!adaptationSet) continue;
+
+        TaskPriority priority = TaskPriority::NORMAL;
+        // low quality tiles cover the whole sphere as background
+        if ((mProjFmt != ProjectionFormat::PF_PLANAR) &&
+            (adaptationSet->GetRepresentationQualityRanking() != HIGHEST_QUALITY_RANKING))
+        {
+            priority = TaskPriority::LOW;
+        }
+        else
+        {
+            // tracks without prediction are all in current viewport
+            auto itPri = m_currentTracksPriority.find(it->first);
+            if (itPri != m_currentTracksPriority.end() && itPri->second != ViewportPriority::HIGH)
+            {
+                priority = TaskPriority::LOW;
+            }
+        }
+        adaptationSet->SetDownloadPriority(priority);
+    }
+}
+
 bool OmafTileTracksSelector::IsPoseChanged(HeadPose* pose1, HeadPose* pose2)
 {
     // return false if two pose is same
@@ -305,30 +337,38 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
         return selectedTracks;
 
     std::lock_guard<std::mutex> lock(mASMutex);
-    TileDef *tilesInViewport = new TileDef[1024];
-    if (!tilesInViewport)
-        return selectedTracks;
+    if (mTilesInViewport.size() < MAX_TILES_IN_VIEWPORT)
+        mTilesInViewport.resize(MAX_TILES_IN_VIEWPORT);
+    TileDef *tilesInViewport = mTilesInViewport.data();
 
     Param_ViewportOutput paramViewportOutput;
     int32_t selectedTilesNum = I360SCVP_getTilesInViewport(
             tilesInViewport, &paramViewportOutput, m360ViewPortHandle);
 
+    return GetTileTracksByTiles(pStream, pose, tilesInViewport, selectedTilesNum);
+}
+
+TracksMap OmafTileTracksSelector::GetTileTracksByTiles(
+    OmafMediaStream* pStream,
+    HeadPose* pose,
+    TileDef* tilesInViewport,
+    int32_t selectedTilesNum)
+{
+    TracksMap selectedTracks;
+
     // in planar projection format
     if (abs(pose->zoomFactor) < 1e-3 && mProjFmt == ProjectionFormat::PF_PLANAR)
     {
         return selectedTracks;
     }
 
-    if (selectedTilesNum <= 0 || selectedTilesNum > 1024)
+    if (selectedTilesNum <= 0 || selectedTilesNum > MAX_TILES_IN_VIEWPORT)
     {
         OMAF_LOG(LOG_ERROR, "Failed to get tiles information in viewport !\n");
-        DELETE_ARRAY(tilesInViewport);
         return selectedTracks;
     }
 
-    mASMap.clear();
-    mASMap = pStream->GetMediaAdaptationSet();
-    std::map<int, OmafAdaptationSet*>::iterator itAS;
+    const OmafTileIndex &tileIndex = pStream->GetTileIndex();
 
     // insert all tile tracks in viewport into selected tile tracks map
     uint32_t sqrtedSize = (uint32_t)sqrt(selectedTilesNum);
@@ -339,61 +379,19 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
         OMAF_LOG(LOG_INFO,"need additional tile is true! original selected tile num of high quality is %d\n", selectedTilesNum);
         needAddtionalTile = true;
     }
-    if (mProjFmt == ProjectionFormat::PF_ERP)
+    if (mProjFmt == ProjectionFormat::PF_ERP || mProjFmt == ProjectionFormat::PF_CUBEMAP)
     {
         for (int32_t index = 0; index < selectedTilesNum; index++)
         {
             int32_t left = tilesInViewport[index].x;
             int32_t top  = tilesInViewport[index].y;
+            int32_t faceId = (mProjFmt == ProjectionFormat::PF_CUBEMAP) ? tilesInViewport[index].faceId : 0;
 
-            for (itAS = mASMap.begin(); itAS != mASMap.end(); itAS++)
-            {
-                OmafAdaptationSet *adaptationSet = itAS->second;
-                OmafSrd *srd = adaptationSet->GetSRD();
-                int32_t tileLeft = srd->get_X();
-                int32_t tileTop  = srd->get_Y();
-                uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-
-                if ((qualityRanking == HIGHEST_QUALITY_RANKING) && (tileLeft == left) && (tileTop == top))
-                {
-                    int trackID = adaptationSet->GetID();
-                    selectedTracks.insert(make_pair(trackID, adaptationSet));
-                    break;
-                }
-            }
-        }
-    }
-    else if (mProjFmt == ProjectionFormat::PF_CUBEMAP)
-    {
-        for (int32_t index = 0; index < selectedTilesNum; index++)
-        {
-            int32_t left = tilesInViewport[index].x;
-            int32_t top  = tilesInViewport[index].y;
-            int32_t faceId = tilesInViewport[index].faceId;
-            for (itAS = mASMap.begin(); itAS != mASMap.end(); itAS++)
+            OmafAdaptationSet *adaptationSet = tileIndex.Find(HIGHEST_QUALITY_RANKING, faceId, left, top);
+            if (adaptationSet)
             {
-                OmafAdaptationSet *adaptationSet = itAS->second;
-                uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-
-                if (qualityRanking == HIGHEST_QUALITY_RANKING)
-                {
-                    TileDef *tileInfo = adaptationSet->GetTileInfo();
-                    if (!tileInfo)
-                    {
-                        OMAF_LOG(LOG_ERROR, "NULL tile information for Cubemap !\n");
-                        DELETE_ARRAY(tilesInViewport);
-                        return selectedTracks;
-                    }
-                    int32_t tileLeft = tileInfo->x;
-                    int32_t tileTop  = tileInfo->y;
-                    int32_t tileFaceId = tileInfo->faceId;
-                    if ((tileLeft == left) && (tileTop == top) && (tileFaceId == faceId))
-                    {
-                        int trackID = adaptationSet->GetID();
-                        selectedTracks.insert(make_pair(trackID, adaptationSet));
-                        break;
-                    }
-                }
+                int trackID = adaptationSet->GetID();
+                selectedTracks.insert(make_pair(trackID, adaptationSet));
             }
         }
     }
@@ -410,39 +408,27 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
             if (itStrQua == mTwoDStreamQualityMap.end())
             {
                 OMAF_LOG(LOG_ERROR, "Can't find corresponding quality ranking for stream index %d !\n", strId);
-                DELETE_ARRAY(tilesInViewport);
                 return selectedTracks;
             }
 
             corresQualityRanking = itStrQua->second;
             OMAF_LOG(LOG_INFO, "Selected tile from stream %d with quality ranking %d\n", strId, corresQualityRanking);
 
-            for (itAS = mASMap.begin(); itAS != mASMap.end(); itAS++)
+            OmafAdaptationSet *adaptationSet = tileIndex.Find(corresQualityRanking, 0, left, top);
+            if (adaptationSet)
             {
-                OmafAdaptationSet *adaptationSet = itAS->second;
-                OmafSrd *srd = adaptationSet->GetSRD();
-                int32_t tileLeft = srd->get_X();
-                int32_t tileTop  = srd->get_Y();
-                uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-
-                if ((qualityRanking == (uint32_t)(corresQualityRanking)) && (tileLeft == left) && (tileTop == top))
-                {
-                    int trackID = adaptationSet->GetID();
-                    OMAF_LOG(LOG_INFO, "Selected track %d\n", trackID);
-                    selectedTracks.insert(make_pair(trackID, adaptationSet));
-                    break;
-                }
+                int trackID = adaptationSet->GetID();
+                OMAF_LOG(LOG_INFO, "Selected track %d\n", trackID);
+                selectedTracks.insert(make_pair(trackID, adaptationSet));
             }
         }
 
         if (needAddtionalTile)
         {
-            for (itAS = mASMap.begin(); itAS != mASMap.end(); itAS++)
+            for (OmafAdaptationSet *adaptationSet : tileIndex.GetAdaptationSets(corresQualityRanking))
             {
-                OmafAdaptationSet *adaptationSet = itAS->second;
-                uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
                 int trackID = adaptationSet->GetID();
-                if (selectedTracks.find(trackID) == selectedTracks.end() && qualityRanking == corresQualityRanking)
+                if (selectedTracks.find(trackID) == selectedTracks.end())
                 {
                     selectedTracks.insert(make_pair(trackID, adaptationSet));
                     break;
@@ -453,12 +439,10 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
 
     if (needAddtionalTile && (mProjFmt != ProjectionFormat::PF_PLANAR))
     {
-        for (itAS = mASMap.begin(); itAS != mASMap.end(); itAS++)
+        for (OmafAdaptationSet *adaptationSet : tileIndex.GetAdaptationSets(HIGHEST_QUALITY_RANKING))
         {
-            OmafAdaptationSet *adaptationSet = itAS->second;
-            uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
             int trackID = adaptationSet->GetID();
-            if (selectedTracks.find(trackID) == selectedTracks.end() && qualityRanking == HIGHEST_QUALITY_RANKING)
+            if (selectedTracks.find(trackID) == selectedTracks.end())
             {
                 selectedTracks.insert(make_pair(trackID, adaptationSet));
                 break;
@@ -468,11 +452,10 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
     // insert all tile tracks from low qulity video into selected tile tracks map when projection type is not PF_PLANAR
     if (mProjFmt != ProjectionFormat::PF_PLANAR)
     {
-        for (itAS = mASMap.begin(); itAS != mASMap.end(); itAS++)
+        const std::map<uint32_t, std::vector<OmafAdaptationSet*>> &qualitySets = tileIndex.GetAllAdaptationSets();
+        for (auto itQua = qualitySets.upper_bound(HIGHEST_QUALITY_RANKING); itQua != qualitySets.end(); itQua++)
         {
-            OmafAdaptationSet *adaptationSet = itAS->second;
-            uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-            if (qualityRanking > HIGHEST_QUALITY_RANKING)
+            for (OmafAdaptationSet *adaptationSet : itQua->second)
             {
                 int trackID = adaptationSet->GetID();
                 selectedTracks.insert(make_pair(trackID, adaptationSet));
@@ -480,8 +463,6 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
         }
     }
 
-    DELETE_ARRAY(tilesInViewport);
-
     return selectedTracks;
 }
 
@@ -566,15 +547,40 @@ std::vector<std::pair<ViewportPriority, TracksMap>> OmafTileTracksSelector::GetT
         OMAF_LOG(LOG_INFO, "pred_angle.PTS %ld \n", pred_angle.first);
         predictPose[i].yaw = pred_angle.second->yaw;
         predictPose[i].pitch = pred_angle.second->pitch;
+        i++;
+    }
 
-        OMAF_LOG(LOG_INFO, "Start to select tile tracks!\n");
+    OMAF_LOG(LOG_INFO, "Start to select tile tracks!\n");
 #ifndef _ANDROID_NDK_OPTION_
 #ifdef _USE_TRACE_
-        // trace
-        tracepoint(mthq_tp_provider, T1_select_tracks, "tiletracks");
+    // trace
+    tracepoint(mthq_tp_provider, T1_select_tracks, "tiletracks");
 #endif
 #endif
-        TracksMap selectedTracks = SelectTileTracks(pStream, &predictPose[i]);
+    // the tiles of all the predicted poses are selected in one call
+    std::lock_guard<std::mutex> lock(mASMutex);
+    if (mTilesInViewport.size() < poseCandicateNum * MAX_TILES_IN_VIEWPORT)
+        mTilesInViewport.resize(poseCandicateNum * MAX_TILES_IN_VIEWPORT);
+    std::vector<int32_t> selectedTilesNums(poseCandicateNum, 0);
+    int ret = I360SCVP_getTilesInViewportBatch(predictPose, poseCandicateNum, mTilesInViewport.data(),
+            MAX_TILES_IN_VIEWPORT, selectedTilesNums.data(), NULL, NULL, m360ViewPortHandle);
+    if (ret < 0)
+    {
+        OMAF_LOG(LOG_ERROR, "Failed to get tiles in viewport of predicted poses !\n");
+        SAFE_DELARRAY(predictPose);
+        return predictedTracks;
+    }
+    // a failed pose has no tiles, so it gets no tracks and is skipped below
+    if (ret > 0)
+    {
+        OMAF_LOG(LOG_WARNING, "Failed to get tiles in viewport of %d predicted poses !\n", ret);
+    }
+
+    i = 0;
+    for (auto pred_angle : predict_angles)
+    {
+        TracksMap selectedTracks = GetTileTracksByTiles(pStream, &predictPose[i],
+                mTilesInViewport.data() + i * MAX_TILES_IN_VIEWPORT, selectedTilesNums[i]);
         if (selectedTracks.size() && previousPose)
         {
             predictedTracks.push_back(make_pair(pred_angle.second->priority, selectedTracks));
@@ -100,12 +100,25 @@ private:
 
     TracksMap SelectTileTracks(OmafMediaStream* pStream, HeadPose* pose);
 
+    //!
+    //! \brief  Map the tiles selected in the viewport of the pose to tile tracks
+    //!
+    TracksMap GetTileTracksByTiles(OmafMediaStream* pStream, HeadPose* pose, TileDef* tilesInViewport, int32_t selectedTilesNum);
+
     bool IsPoseChanged(HeadPose* pose1, HeadPose* pose2);
 
+    //!
+    //! \brief  Set download priority of current tile tracks, viewport high quality
+    //!         tiles go before predicted-only and low quality background tiles
+    //!
+    void UpdateTracksDownloadPriority();
+
 private:
     TracksMap                 m_currentTracks;
     std::mutex                mExtractorsMutex;
     TracksMap                 m_SelectedTracks;
+    std::map<int, ViewportPriority> m_selectedTracksPriority; //<! viewport priority of m_SelectedTracks from prediction
+    std::map<int, ViewportPriority> m_currentTracksPriority;  //<! viewport priority of m_currentTracks
 };
 
 VCD_OMAF_END;
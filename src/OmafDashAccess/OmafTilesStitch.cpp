@@ -30,6 +30,9 @@
 #include "math.h"
 
 #include "common.h"
+
+#include <chrono>
+
 VCD_OMAF_BEGIN
 
 OmafTilesStitch::OmafTilesStitch() {
@@ -51,9 +54,24 @@ OmafTilesStitch::OmafTilesStitch() {
   m_tmpRegionrwpk = nullptr;
   m_maxStitchWidth = 0;
   m_maxStitchHeight = 0;
+  m_mergeJobNum = 0;
+  m_nextMergeJob = 0;
+  m_unfinishedMergeJobs = 0;
+  m_mergeWorkersQuit = false;
+  uint32_t cores = std::thread::hardware_concurrency();
+  m_maxMergeWorkers = cores > 1 ? std::min(cores - 1, (uint32_t)DEFAULT_MERGE_WORKERS_NUM) : 0;
+  m_lastStitchTimeUs = 0;
+  m_totalStitchTimeUs = 0;
+  m_stitchedFrameNum = 0;
 }
 
 OmafTilesStitch::~OmafTilesStitch() {
+  StopMergeWorkers();
+  for (uint32_t i = 0; i < m_mergeJobs.size(); i++) {
+    SAFE_DELETE(m_mergeJobs[i].mergedPacket);
+  }
+  m_mergeJobs.clear();
+
   if (m_selectedTiles.size()) {
     std::list<MediaPacket *> allPackets;
     std::map<QualityRank, std::map<uint32_t, MediaPacket *>>::iterator it;
@@ -120,6 +138,9 @@ OmafTilesStitch::~OmafTilesStitch() {
     m_updatedTilesMergeArr.clear();
   }
 
+  // sessions of merged layouts are released before the main 360SCVP handle
+  m_layoutCtxs.clear();
+
   SAFE_DELETE(m_360scvpParam);
 
   if (m_360scvpHandle) {
@@ -133,23 +154,6 @@ OmafTilesStitch::~OmafTilesStitch() {
     m_fullResVideoHeader = nullptr;
   }
 
-  if (m_mergedVideoHeaders.size()) {
-    std::map<QualityRank, vector<std::map<uint32_t, uint8_t *>>>::iterator itHrd;
-    for (itHrd = m_mergedVideoHeaders.begin(); itHrd != m_mergedVideoHeaders.end();) {
-      vector<std::map<uint32_t, uint8_t *>> oneHeader = itHrd->second;
-      for (uint32_t i = 0; i < oneHeader.size(); i++) {
-        std::map<uint32_t, uint8_t *>::iterator itParam;
-        for (itParam = oneHeader[i].begin(); itParam != oneHeader[i].end();) {
-          uint8_t *headers = itParam->second;
-          DELETE_ARRAY(headers);
-          oneHeader[i].erase(itParam++);
-        }
-        oneHeader[i].clear();
-      }
-      m_mergedVideoHeaders.erase(itHrd++);
-    }
-    m_mergedVideoHeaders.clear();
-  }
   m_tmpRegionrwpk = nullptr;
   m_sources.clear();
 }
@@ -1223,7 +1227,7 @@ int32_t OmafTilesStitch::GenerateTilesMergeArrangement() {
   return ERROR_NONE;
 }
 
-int32_t OmafTilesStitch::IsArrChanged(QualityRank qualityRanking, vector<TilesMergeArrangement *> layOut, vector<TilesMergeArrangement *> initLayOut, bool *isArrChanged, bool *packetLost, bool *arrangeChanged)
+int32_t OmafTilesStitch::IsArrChanged(QualityRank qualityRanking, const vector<TilesMergeArrangement *> &layOut, const vector<TilesMergeArrangement *> &initLayOut, bool *isArrChanged, bool *packetLost, bool *arrangeChanged)
 {
     if (layOut.empty()) {
         OMAF_LOG(LOG_ERROR, " Invalid tile merge arrangement data!\n");
@@ -1275,163 +1279,152 @@ int32_t OmafTilesStitch::IsArrChanged(QualityRank qualityRanking, vector<TilesMe
 }
 
 int32_t OmafTilesStitch::GenerateMergedVideoHeaders(bool arrangeChanged, QualityRank qualityRanking,
-    vector<TilesMergeArrangement *> layOut,
-    vector<TilesMergeArrangement *> initLayOut,
-    std::map<uint32_t, MediaPacket *> packets) {
-    int32_t ret = ERROR_NONE;
+    const vector<TilesMergeArrangement *> &layOut,
+    const vector<TilesMergeArrangement *> &initLayOut,
+    const std::map<uint32_t, MediaPacket *> &packets) {
     if (layOut.empty()) {
         OMAF_LOG(LOG_ERROR, "INVALID tile merge arrangement data!\n");
         return OMAF_ERROR_NULL_PTR;
     }
-    // 1. clear all headers
-    std::map<QualityRank, vector<std::map<uint32_t, uint8_t *>>>::iterator itMergeHrd;
-    for (itMergeHrd = m_mergedVideoHeaders.begin(); itMergeHrd != m_mergedVideoHeaders.end(); ) {
-      QualityRank oneQualityRanking = itMergeHrd->first;
-      vector<std::map<uint32_t, uint8_t *>> oneVideoHeaderArr = m_mergedVideoHeaders[oneQualityRanking];
-      for (uint32_t i = 0; i < oneVideoHeaderArr.size(); i++) {
-        std::map<uint32_t, uint8_t *>::iterator itHdr = oneVideoHeaderArr[i].begin();
-        if (itHdr == oneVideoHeaderArr[i].end())
-        {
-            OMAF_LOG(LOG_ERROR, "Video header map is empty!\n");
-            return OMAF_ERROR_INVALID_DATA;
-        }
-        uint8_t *headers = itHdr->second;
-        DELETE_ARRAY(headers);
-        oneVideoHeaderArr[i].clear();
+    // 1. get original VPS/SPS/PPS which merged headers are generated from
+    uint8_t *srcHeaders = nullptr;
+    uint32_t vpsLen = 0;
+    uint32_t spsLen = 0;
+    uint32_t ppsLen = 0;
+    if (qualityRanking == HIGHEST_QUALITY_RANKING) {
+      if (!m_fullResVideoHeader) {
+        OMAF_LOG(LOG_ERROR, "nullptr original video headers data !\n");
+        return OMAF_ERROR_NULL_PTR;
       }
-      oneVideoHeaderArr.clear();
-      m_mergedVideoHeaders.erase(itMergeHrd++);
-    }
-    // 2. generate new headers.
-    if ((qualityRanking == HIGHEST_QUALITY_RANKING) && (0 == m_mergedVideoHeaders[qualityRanking].size())) {
-      if (qualityRanking == HIGHEST_QUALITY_RANKING) {
-        if (!m_fullResVideoHeader) {
-          OMAF_LOG(LOG_ERROR, "nullptr original video headers data !\n");
-          return OMAF_ERROR_NULL_PTR;
-        }
-        vector<std::map<uint32_t, uint8_t*>> videoHeaders;
-        for (uint32_t i = 0; i < layOut.size(); i++) {
-          uint32_t headersSize = 0;
-          uint8_t *headers = new uint8_t[1024];
-          if (!headers) return OMAF_ERROR_NULL_PTR;
-
-          memset(headers, 0, 1024);
-          memcpy_s(headers, 1024, m_fullResVideoHeader, m_fullResVPSSize);
-          headersSize += m_fullResVPSSize;
-
-          uint8_t *tmp = headers + m_fullResVPSSize;
-          m_360scvpParam->pInputBitstream = m_fullResVideoHeader + m_fullResVPSSize;
-          m_360scvpParam->inputBitstreamLen = m_fullResSPSSize;
-          m_360scvpParam->destWidth = (arrangeChanged || initLayOut.size() < i + 1 ? layOut[i]->mergedWidth : initLayOut[i]->mergedWidth);
-          m_360scvpParam->destHeight = (arrangeChanged || initLayOut.size() < i + 1 ? layOut[i]->mergedHeight : initLayOut[i]->mergedHeight);
-          m_360scvpParam->pOutputBitstream = tmp;
-          ret = I360SCVP_GenerateSPS(m_360scvpParam, m_360scvpHandle);
-          if (ret) {
-            DELETE_ARRAY(headers);
-            return OMAF_ERROR_SCVP_OPERATION_FAILED;
-          }
-
-          headersSize += m_360scvpParam->outputBitstreamLen;
-          tmp += m_360scvpParam->outputBitstreamLen;
-          m_360scvpParam->pInputBitstream = m_fullResVideoHeader + m_fullResVPSSize + m_fullResSPSSize;
-          m_360scvpParam->inputBitstreamLen = m_fullResPPSSize;
-          m_360scvpParam->pOutputBitstream = tmp;
-          if (arrangeChanged) {
-            ret = I360SCVP_GeneratePPS(m_360scvpParam, &(layOut[i]->tilesLayout), m_360scvpHandle);
-          } else {
-            ret = I360SCVP_GeneratePPS(m_360scvpParam, &(initLayOut[i]->tilesLayout), m_360scvpHandle);
-          }
-
-          if (ret) {
-            DELETE_ARRAY(headers);
-            return OMAF_ERROR_SCVP_OPERATION_FAILED;
-          }
-
-          headersSize += m_360scvpParam->outputBitstreamLen;
-
-          std::map<uint32_t, uint8_t *> oneVideoHeader;
-          oneVideoHeader.insert(std::make_pair(headersSize, headers));
-          videoHeaders.push_back(oneVideoHeader);
-        }
-        m_mergedVideoHeaders[qualityRanking] = std::move(videoHeaders);
+      srcHeaders = m_fullResVideoHeader;
+      vpsLen = m_fullResVPSSize;
+      spsLen = m_fullResSPSSize;
+      ppsLen = m_fullResPPSSize;
+    } else {
+      std::map<uint32_t, MediaPacket *>::const_iterator itPacket = packets.begin();
+      if (itPacket == packets.end())
+      {
+          OMAF_LOG(LOG_ERROR, "Packets map is empty!\n");
+          return OMAF_ERROR_INVALID_DATA;
       }
+      MediaPacket *onePacket = itPacket->second;
+      if (!(onePacket->GetHasVideoHeader())) {
+          OMAF_LOG(LOG_ERROR, "There should be video headers here !\n");
+          return OMAF_ERROR_INVALID_DATA;
+      }
+      srcHeaders = (uint8_t *)(onePacket->Payload());
+      vpsLen = onePacket->GetVPSLen();
+      spsLen = onePacket->GetSPSLen();
+      ppsLen = onePacket->GetPPSLen();
     }
-
-    if ((qualityRanking > HIGHEST_QUALITY_RANKING) && (0 == m_mergedVideoHeaders[qualityRanking].size())) {
-      if (qualityRanking > HIGHEST_QUALITY_RANKING) {
-        std::map<uint32_t, MediaPacket *>::iterator itPacket;
-        itPacket = packets.begin();
-        if (itPacket == packets.end())
-        {
-            OMAF_LOG(LOG_ERROR, "Packets map is empty!\n");
-            return OMAF_ERROR_INVALID_DATA;
-        }
-        MediaPacket *onePacket = itPacket->second;
-        if (!(onePacket->GetHasVideoHeader())) {
-            OMAF_LOG(LOG_ERROR, "There should be video headers here !\n");
-            return OMAF_ERROR_INVALID_DATA;
+    if (!srcHeaders) {
+      return OMAF_ERROR_NULL_PTR;
+    }
+    uint32_t srcHeadersLen = vpsLen + spsLen + ppsLen;
+
+    // 2. generate new headers only for the layouts whose merged resolution,
+    //    tiles layout or original headers have been changed
+    vector<std::unique_ptr<MergeLayoutContext>> &layoutCtxs = m_layoutCtxs[qualityRanking];
+    layoutCtxs.resize(layOut.size());
+    for (uint32_t i = 0; i < layOut.size(); i++) {
+      bool useInitLayOut = (qualityRanking == HIGHEST_QUALITY_RANKING) && !arrangeChanged && (initLayOut.size() >= i + 1);
+      TilesMergeArrangement *arrange = useInitLayOut ? initLayOut[i] : layOut[i];
+      if (!arrange) return OMAF_ERROR_NULL_PTR;
+
+      if (!layoutCtxs[i]) {
+        layoutCtxs[i].reset(new MergeLayoutContext);
+        if (!layoutCtxs[i]) return OMAF_ERROR_NULL_PTR;
+      }
+      MergeLayoutContext *ctx = layoutCtxs[i].get();
+      if (!ctx->handle) {
+        // each layout has its own 360SCVP session, so that layouts can be merged in parallel
+        ctx->param.usedType = E_PARSER_ONENAL;
+        ctx->param.logFunction = (void*)logCallBack;
+        ctx->handle = I360SCVP_NewSession(m_360scvpHandle);
+        if (!ctx->handle) {
+          ctx->param.pInputBitstream = m_fullResVideoHeader;
+          ctx->param.inputBitstreamLen = m_fullResVPSSize + m_fullResSPSSize + m_fullResPPSSize;
+          ctx->handle = I360SCVP_Init(&(ctx->param));
         }
-        //get original VPS/SPS/PPS
-        uint32_t hrdSize = onePacket->GetVideoHeaderSize();
-        uint8_t *headersData = new uint8_t[hrdSize];
-        if (!headersData) {
+        if (!ctx->handle) {
+          OMAF_LOG(LOG_ERROR, "Failed to create 360SCVP session for merged layout %u !\n", i);
           return OMAF_ERROR_NULL_PTR;
         }
-        memcpy_s(headersData, hrdSize, onePacket->Payload(), hrdSize);
-        vector<std::map<uint32_t, uint8_t*>> videoHeaders;
-        for (uint32_t i = 0; i < layOut.size(); i++) {
-        //generate new VPS/SPS/PPS for merged video
-          uint32_t headersSize = 0;
-          uint8_t *headers = new uint8_t[1024];
-          if (!headers)
-          {
-              DELETE_ARRAY(headersData);
-              return OMAF_ERROR_NULL_PTR;
-          }
-          memset(headers, 0, 1024);
-          uint32_t vpsLen = onePacket->GetVPSLen();
-          uint32_t spsLen = onePacket->GetSPSLen();
-          uint32_t ppsLen = onePacket->GetPPSLen();
-          memcpy_s(headers, vpsLen, headersData, vpsLen);
-          headersSize += vpsLen;
-
-          uint8_t *tmp = headers + vpsLen;
-          m_360scvpParam->pInputBitstream = headersData + vpsLen;
-          m_360scvpParam->inputBitstreamLen = spsLen;
-          m_360scvpParam->destWidth = layOut[i]->mergedWidth;
-          m_360scvpParam->destHeight = layOut[i]->mergedHeight;
-          m_360scvpParam->pOutputBitstream = tmp;
-          ret = I360SCVP_GenerateSPS(m_360scvpParam, m_360scvpHandle);
-          if (ret) {
-            DELETE_ARRAY(headersData);
-            DELETE_ARRAY(headers);
-            return OMAF_ERROR_SCVP_OPERATION_FAILED;
-          }
-
-          headersSize += m_360scvpParam->outputBitstreamLen;
-          tmp += m_360scvpParam->outputBitstreamLen;
-          m_360scvpParam->pInputBitstream = headersData + vpsLen + spsLen;
-          m_360scvpParam->inputBitstreamLen = ppsLen;
-          m_360scvpParam->pOutputBitstream = tmp;
-
-          ret = I360SCVP_GeneratePPS(m_360scvpParam, &(layOut[i]->tilesLayout), m_360scvpHandle);
-          if (ret) {
-            DELETE_ARRAY(headersData);
-            DELETE_ARRAY(headers);
-            return OMAF_ERROR_SCVP_OPERATION_FAILED;
-          }
+      }
 
-          headersSize += m_360scvpParam->outputBitstreamLen;
+      const TileArrangement &tilesLayout = arrange->tilesLayout;
+      std::vector<uint32_t> &key = ctx->headersKey;
+      bool sameKey = !ctx->headers.empty() &&
+                     (key.size() == (size_t)(4 + tilesLayout.tileRowsNum + tilesLayout.tileColsNum)) &&
+                     (key[0] == arrange->mergedWidth) && (key[1] == arrange->mergedHeight) &&
+                     (key[2] == tilesLayout.tileRowsNum) && (key[3] == tilesLayout.tileColsNum);
+      for (uint8_t idx = 0; sameKey && idx < tilesLayout.tileRowsNum; idx++)
+        sameKey = (key[4 + idx] == tilesLayout.tileRowHeight[idx]);
+      for (uint8_t idx = 0; sameKey && idx < tilesLayout.tileColsNum; idx++)
+        sameKey = (key[4 + tilesLayout.tileRowsNum + idx] == tilesLayout.tileColWidth[idx]);
+      if (sameKey && (ctx->srcHeaders.size() == srcHeadersLen) &&
+          (0 == memcmp(ctx->srcHeaders.data(), srcHeaders, srcHeadersLen))) {
+        continue;
+      }
 
-          std::map<uint32_t, uint8_t *> oneVideoHeader;
-          oneVideoHeader.insert(std::make_pair(headersSize, headers));
-          videoHeaders.push_back(oneVideoHeader);
-        }
-        m_mergedVideoHeaders[qualityRanking] = std::move(videoHeaders);
-        DELETE_ARRAY(headersData);
+      // 360SCVP writes the SPS/PPS without an output bound, so the buffer takes the
+      // original headers twice plus the explicit tile sizes of the PPS, and at least
+      // the buffer size it has always been given
+      size_t headersCapacity = vpsLen + 2 * (spsLen + ppsLen) +
+                               MERGED_TILESIZE_BYTES * (tilesLayout.tileRowsNum + tilesLayout.tileColsNum);
+      ctx->headers.assign(std::max<size_t>(headersCapacity, MERGED_HEADERS_MIN), 0);
+      ctx->srcHeaders.clear();
+      uint8_t *headers = ctx->headers.data();
+      uint32_t headersSize = 0;
+      memcpy_s(headers, vpsLen, srcHeaders, vpsLen);
+      headersSize += vpsLen;
+
+      ctx->param.pInputBitstream = srcHeaders + vpsLen;
+      ctx->param.inputBitstreamLen = spsLen;
+      ctx->param.destWidth = arrange->mergedWidth;
+      ctx->param.destHeight = arrange->mergedHeight;
+      ctx->param.pOutputBitstream = headers + headersSize;
+      if (I360SCVP_GenerateSPS(&(ctx->param), ctx->handle)) {
+        ctx->headers.clear();
+        return OMAF_ERROR_SCVP_OPERATION_FAILED;
+      }
+      if (ctx->param.outputBitstreamLen > ctx->headers.size() - headersSize) {
+        OMAF_LOG(LOG_ERROR, "Generated SPS of %u bytes is over the headers buffer !\n", ctx->param.outputBitstreamLen);
+        ctx->headers.clear();
+        return OMAF_ERROR_SCVP_OPERATION_FAILED;
+      }
+      headersSize += ctx->param.outputBitstreamLen;
+
+      ctx->param.pInputBitstream = srcHeaders + vpsLen + spsLen;
+      ctx->param.inputBitstreamLen = ppsLen;
+      ctx->param.pOutputBitstream = headers + headersSize;
+      if (I360SCVP_GeneratePPS(&(ctx->param), &(arrange->tilesLayout), ctx->handle)) {
+        ctx->headers.clear();
+        return OMAF_ERROR_SCVP_OPERATION_FAILED;
+      }
+      if (ctx->param.outputBitstreamLen > ctx->headers.size() - headersSize) {
+        OMAF_LOG(LOG_ERROR, "Generated PPS of %u bytes is over the headers buffer !\n", ctx->param.outputBitstreamLen);
+        ctx->headers.clear();
+        return OMAF_ERROR_SCVP_OPERATION_FAILED;
       }
+      headersSize += ctx->param.outputBitstreamLen;
+      ctx->headers.resize(headersSize);
+      ctx->srcHeaders.assign(srcHeaders, srcHeaders + srcHeadersLen);
+
+      key.resize(4 + tilesLayout.tileRowsNum + tilesLayout.tileColsNum);
+      key[0] = arrange->mergedWidth;
+      key[1] = arrange->mergedHeight;
+      key[2] = tilesLayout.tileRowsNum;
+      key[3] = tilesLayout.tileColsNum;
+      for (uint8_t idx = 0; idx < tilesLayout.tileRowsNum; idx++)
+        key[4 + idx] = tilesLayout.tileRowHeight[idx];
+      for (uint8_t idx = 0; idx < tilesLayout.tileColsNum; idx++)
+        key[4 + tilesLayout.tileRowsNum + idx] = tilesLayout.tileColWidth[idx];
+
+      OMAF_LOG(LOG_INFO, "Generate merged video headers for quality ranking %d layout %u, width %u, height %u\n",
+               qualityRanking, i, arrange->mergedWidth, arrange->mergedHeight);
     }
-    return ret;
+    return ERROR_NONE;
 }
 
 vector<std::unique_ptr<RegionWisePacking>> OmafTilesStitch::GenerateMergedRWPK(QualityRank qualityRanking, bool packetLost, bool arrangeChanged) {
@@ -1447,271 +1440,185 @@ vector<std::unique_ptr<RegionWisePacking>> OmafTilesStitch::GenerateMergedRWPK(Q
     return rwpk;
 }
 
-int32_t OmafTilesStitch::UpdateMergedVideoHeadersForLowQualityRank(bool isEmptyHeader,
-    std::map<uint32_t, MediaPacket *> packets, QualityRank qualityRanking,
-    TilesMergeArrangement *layOut) {
-    int32_t ret = ERROR_NONE;
-    std::map<uint32_t, MediaPacket *>::iterator itPacket;
-    if (isEmptyHeader) {
-        itPacket = packets.begin();
-        if (itPacket == packets.end())
+int32_t OmafTilesStitch::GetLayoutPackets(const std::map<uint32_t, MediaPacket *> &packets, uint32_t index,
+                                          const vector<uint32_t> &needPacketSize, uint64_t layoutNum,
+                                          std::vector<MediaPacket *> &tilePackets) {
+    tilePackets.clear();
+    if (index >= layoutNum || needPacketSize.size() < layoutNum) {
+        OMAF_LOG(LOG_ERROR, "Invalid layout index %u for tiles stitching !\n", index);
+        return OMAF_ERROR_INVALID_DATA;
+    }
+    // tiles are repeated from the first one if there are not enough selected tiles for all layouts
+    bool repeatTiles = needPacketSize[layoutNum - 1] > packets.size();
+    uint32_t startIdx = index == 0 ? 0 : needPacketSize[index - 1];
+    std::map<uint32_t, MediaPacket *>::const_iterator itPacket = packets.begin();
+    if (startIdx < packets.size())
+      std::advance(itPacket, startIdx);
+    else
+      itPacket = packets.end();
+    if (itPacket == packets.end())
+    {
+        if (repeatTiles)
         {
-            OMAF_LOG(LOG_ERROR, "Packets map is empty!\n");
-            return OMAF_ERROR_INVALID_DATA;
-        }
-        MediaPacket *onePacket = itPacket->second;
-        if (!(onePacket->GetHasVideoHeader())) {
-            OMAF_LOG(LOG_ERROR, "There should be video headers here !\n");
-            return OMAF_ERROR_INVALID_DATA;
-        }
-        //get original VPS/SPS/PPS
-        uint32_t hrdSize = onePacket->GetVideoHeaderSize();
-        uint8_t *headersData = new uint8_t[hrdSize];
-        if (!headersData) {
-          return OMAF_ERROR_NULL_PTR;
+            itPacket = packets.begin();
         }
-        memcpy_s(headersData, hrdSize, onePacket->Payload(), hrdSize);
-
-        //generate new VPS/SPS/PPS for merged video
-        uint32_t headersSize = 0;
-        uint8_t *headers = new uint8_t[1024];
-        if (!headers)
+        else
         {
-            DELETE_ARRAY(headersData);
-            return OMAF_ERROR_NULL_PTR;
-        }
-        memset(headers, 0, 1024);
-        uint32_t vpsLen = onePacket->GetVPSLen();
-        uint32_t spsLen = onePacket->GetSPSLen();
-        uint32_t ppsLen = onePacket->GetPPSLen();
-        memcpy_s(headers, vpsLen, headersData, vpsLen);
-        headersSize += vpsLen;
-
-        uint8_t *tmp = headers + vpsLen;
-        m_360scvpParam->pInputBitstream = headersData + vpsLen;
-        m_360scvpParam->inputBitstreamLen = spsLen;
-        m_360scvpParam->destWidth = layOut->mergedWidth;
-        m_360scvpParam->destHeight = layOut->mergedHeight;
-        m_360scvpParam->pOutputBitstream = tmp;
-        ret = I360SCVP_GenerateSPS(m_360scvpParam, m_360scvpHandle);
-        if (ret) {
-          DELETE_ARRAY(headersData);
-          DELETE_ARRAY(headers);
-          return OMAF_ERROR_SCVP_OPERATION_FAILED;
-        }
-
-        headersSize += m_360scvpParam->outputBitstreamLen;
-        tmp += m_360scvpParam->outputBitstreamLen;
-        m_360scvpParam->pInputBitstream = headersData + vpsLen + spsLen;
-        m_360scvpParam->inputBitstreamLen = ppsLen;
-        m_360scvpParam->pOutputBitstream = tmp;
-
-        ret = I360SCVP_GeneratePPS(m_360scvpParam, &(layOut->tilesLayout), m_360scvpHandle);
-        if (ret) {
-          DELETE_ARRAY(headersData);
-          DELETE_ARRAY(headers);
-          return OMAF_ERROR_SCVP_OPERATION_FAILED;
+            OMAF_LOG(LOG_ERROR, "ERROR in selected media packets for tiles stitching !\n");
+            return OMAF_ERROR_INVALID_DATA;
         }
+    }
 
-        headersSize += m_360scvpParam->outputBitstreamLen;
-
-        std::map<uint32_t, uint8_t *> oneVideoHeader;
-        oneVideoHeader.insert(std::make_pair(headersSize, headers));
-        m_mergedVideoHeaders[qualityRanking].push_back(std::move(oneVideoHeader));
-        DELETE_ARRAY(headersData);
+    uint32_t packetSize = needPacketSize[index] - startIdx;
+    tilePackets.reserve(packetSize);
+    for (uint32_t cnt = 0; cnt < packetSize; cnt++, itPacket++) {
+      if (itPacket == packets.end() && repeatTiles)
+      {
+          itPacket = packets.begin();
+      }
+      if (itPacket == packets.end())
+      {
+          OMAF_LOG(LOG_ERROR, "There is mismatch in needed packets size and actually selected media packets !\n");
+          return OMAF_ERROR_INVALID_DATA;
+      }
+      if (!(itPacket->second))
+      {
+          OMAF_LOG(LOG_ERROR, "Selected media packet is NULL !\n");
+          return OMAF_ERROR_NULL_PTR;
+      }
+      tilePackets.push_back(itPacket->second);
     }
-    return ret;
+    return ERROR_NONE;
 }
 
-int32_t OmafTilesStitch::InitMergedDataAndRealSize(QualityRank qualityRanking, std::map<uint32_t, MediaPacket *> packets,
-    char* mergedData, uint64_t* realSize, uint32_t index,
-    TilesMergeArrangement *tilesArr) {
-    if (packets.empty()) {
-        OMAF_LOG(LOG_ERROR, "packets is empty!\n");
-        return OMAF_ERROR_INVALID_DATA;
-    }
-    if (mergedData == NULL || realSize == NULL) {
+int32_t OmafTilesStitch::InitMergedDataAndRealSize(MergeLayoutContext *ctx, char* mergedData, uint64_t capacity, uint64_t* realSize) {
+    if (!ctx || mergedData == NULL || realSize == NULL) {
         OMAF_LOG(LOG_ERROR, "merged data or real size is null ptr!\n");
         return OMAF_ERROR_NULL_PTR;
     }
     if (m_needHeaders) {
-      vector<std::map<uint32_t, uint8_t *>> videoHeaders = m_mergedVideoHeaders[qualityRanking];
-      bool isEmptyHeaders = (videoHeaders.empty() ? true : videoHeaders[index].empty());
-      if (qualityRanking != HIGHEST_QUALITY_RANKING) {
-        if (ERROR_NONE != UpdateMergedVideoHeadersForLowQualityRank(isEmptyHeaders, packets, qualityRanking, tilesArr)) {
-            OMAF_LOG(LOG_ERROR, "Update merged video headers for low quality ranking failed!\n");
-            return OMAF_ERROR_OPERATION;
-        }
-      }
-      if (m_mergedVideoHeaders[qualityRanking].empty()) {
-        OMAF_LOG(LOG_ERROR, "Video headers for Quality %d is empty!\n", qualityRanking);
+      if (ctx->headers.empty()) {
+        OMAF_LOG(LOG_ERROR, "Merged video headers are empty!\n");
         return OMAF_ERROR_INVALID_DATA;
       }
-      if (m_mergedVideoHeaders[qualityRanking][index].empty()) {
-        OMAF_LOG(LOG_ERROR, "Failed to generate merged video headers for quality ranking %d split %d\n", qualityRanking, index);
+      uint64_t headersLen = ctx->headers.size();
+      if (*realSize + headersLen > capacity) {
+        OMAF_LOG(LOG_ERROR, "Merged packet buffer is too small for video headers!\n");
         return OMAF_ERROR_INVALID_DATA;
       }
-      std::map<uint32_t, uint8_t *> oneVideoHeader = (m_mergedVideoHeaders[qualityRanking][index]);
-      std::map<uint32_t, uint8_t *>::iterator itHdr = oneVideoHeader.begin();
-      if (itHdr == oneVideoHeader.end())
-      {
-          OMAF_LOG(LOG_ERROR, "Video header map is empty!\n");
-          return OMAF_ERROR_INVALID_DATA;
-      }
-      uint8_t *headers = itHdr->second;
-      uint32_t headersLen = itHdr->first;
-      if (!headers) {
-        return OMAF_ERROR_NULL_PTR;
-      }
-      memcpy_s(mergedData, headersLen, headers, headersLen);
+      memcpy_s(mergedData + *realSize, headersLen, ctx->headers.data(), headersLen);
       *realSize += headersLen;
     }
     return ERROR_NONE;
 }
 
 int32_t OmafTilesStitch::UpdateMergedDataAndRealSize(
-    QualityRank qualityRanking, std::map<uint32_t, MediaPacket *> packets,
+    QualityRank qualityRanking, const std::vector<MediaPacket *> &tilePackets, MergeLayoutContext *ctx,
     uint8_t tileColsNum, bool arrangeChanged, uint32_t width, uint32_t height,
-    uint32_t initWidth, uint32_t initHeight, char *mergedData, uint64_t *realSize,
-    uint32_t index, vector<uint32_t> needPacketSize, uint64_t layoutNum) {
+    uint32_t initWidth, uint32_t initHeight, char *mergedData, uint64_t capacity, uint64_t *realSize) {
 
-    uint32_t tilesIdx = 0;
-    int32_t tileWidth = 0;
-    int32_t tileHeight = 0;
     if (tileColsNum == 0) {
         OMAF_LOG(LOG_ERROR, "tile column number cannot be zero!\n");
         return OMAF_ERROR_INVALID_DATA;
     }
-    if (mergedData == NULL || realSize == NULL) {
+    if (!ctx || mergedData == NULL || realSize == NULL) {
         OMAF_LOG(LOG_ERROR, "merged data or realSize is null ptr!\n");
         return OMAF_ERROR_NULL_PTR;
     }
-    // calculate real size for merged packets
-    std::map<uint32_t, MediaPacket *>::iterator itPacket = packets.begin();
-    if (index > 0)
-      std::advance(itPacket, needPacketSize[index - 1]);
-    if (itPacket == packets.end())
+    if (tilePackets.empty()) {
+        OMAF_LOG(LOG_ERROR, "There is no selected media packet for tiles stitching !\n");
+        return OMAF_ERROR_INVALID_DATA;
+    }
+    std::map<uint32_t, SourceInfo>::iterator itSrc;
+    itSrc = m_sources.find(qualityRanking);
+    if (itSrc == m_sources.end())
     {
-        if (needPacketSize[layoutNum-1] > packets.size())
-        {
-            itPacket = packets.begin();
-        }
-        else
-        {
-            OMAF_LOG(LOG_ERROR, "ERROR in selected media packets for tiles stitching !\n");
-            return OMAF_ERROR_INVALID_DATA;
+      OMAF_LOG(LOG_ERROR, "Can't find source information corresponding to quality ranking %d\n", qualityRanking);
+      return OMAF_ERROR_INVALID_DATA;
+    }
+    const SourceInfo &srcInfo = itSrc->second;
+    bool newSliceHdr = (width != (uint32_t)(srcInfo.width)) || (height != (uint32_t)(srcInfo.height));
+    if (newSliceHdr) {
+      // CTU address of each tile only depends on the tiles merge arrangement
+      SRDInfo srd = tilePackets[0]->GetSRDInfo();
+      int32_t tileWidth = srd.width;
+      int32_t tileHeight = srd.height;
+      if ((ctx->ctuTileCols != tileColsNum) || (ctx->ctuTileWidth != (uint32_t)tileWidth) ||
+          (ctx->ctuTileHeight != (uint32_t)tileHeight) || (ctx->ctuOffsets.size() != tilePackets.size())) {
+        ctx->ctuOffsets.resize(tilePackets.size());
+        for (uint32_t tilesIdx = 0; tilesIdx < tilePackets.size(); tilesIdx++) {
+          uint8_t colIdx = tilesIdx % tileColsNum;
+          uint8_t rowIdx = tilesIdx / tileColsNum;
+          ctx->ctuOffsets[tilesIdx] =
+              rowIdx * (tileHeight / LCU_SIZE) * ((tileWidth / LCU_SIZE) * tileColsNum) + colIdx * (tileWidth / LCU_SIZE);
         }
+        ctx->ctuTileCols = tileColsNum;
+        ctx->ctuTileWidth = tileWidth;
+        ctx->ctuTileHeight = tileHeight;
+        OMAF_LOG(LOG_INFO, "Original source width %d, height %d, merged source width %u, height %u\n",
+                 srcInfo.width, srcInfo.height, width, height);
+      }
+      ctx->param.destWidth = (arrangeChanged ? width : initWidth);
+      ctx->param.destHeight = (arrangeChanged ? height : initHeight);
     }
 
-    uint32_t packetSize = index == 0 ? needPacketSize[index] : needPacketSize[index] - needPacketSize[index - 1];
-    uint32_t cnt = 0;
-    for (; ; itPacket++) {
-      if (itPacket == packets.end())
-      {
-          if (needPacketSize[layoutNum-1] > packets.size())
-              itPacket = packets.begin();
+    for (uint32_t tilesIdx = 0; tilesIdx < tilePackets.size(); tilesIdx++) {
+      MediaPacket *onePacket = tilePackets[tilesIdx];
+      // the sample referenced in place is read straight into the merged data
+      if (onePacket->HasPayloadSpans()) {
+        int32_t ret = MergeTileSpans(onePacket, ctx, tilesIdx, newSliceHdr, mergedData, capacity, realSize);
+        if (ret != ERROR_NONE) return ret;
+        continue;
       }
-      cnt++;
-      if (cnt > packetSize) break;
-      if (itPacket == packets.end())
+      char *data = onePacket->Payload();
+      int32_t dataSize = onePacket->Size();
+      if (!data || !dataSize)
       {
-          OMAF_LOG(LOG_ERROR, "There is mismatch in needed packets size and actually selected media packets !\n");
+          OMAF_LOG(LOG_ERROR, "Invalid data in selected media packet !\n");
           return OMAF_ERROR_INVALID_DATA;
       }
-      MediaPacket *onePacket = NULL;
-      onePacket = itPacket->second;
-      if (!onePacket)
-      {
-          OMAF_LOG(LOG_ERROR, "Selected media packet is NULL !\n");
-          return OMAF_ERROR_NULL_PTR;
+
+      if (onePacket->GetHasVideoHeader()) {
+        uint32_t hrdSize = newSliceHdr ? (onePacket->GetVPSLen() + onePacket->GetSPSLen() + onePacket->GetPPSLen())
+                                       : onePacket->GetVideoHeaderSize();
+        data += hrdSize;
+        dataSize -= hrdSize;
       }
-      //if (qualityRanking == HIGHEST_QUALITY_RANKING) {
-      std::map<uint32_t, SourceInfo>::iterator itSrc;
-      itSrc = m_sources.find(qualityRanking);
-      if (itSrc == m_sources.end())
+      if (!data || dataSize <= 0)
       {
-        OMAF_LOG(LOG_ERROR, "Can't find source information corresponding to quality ranking %d\n", qualityRanking);
-        return OMAF_ERROR_INVALID_DATA;
+          OMAF_LOG(LOG_ERROR, "After video headers (VPS/SPS/PPS) are moved, invalid data in selected media packet !\n");
+          return OMAF_ERROR_INVALID_DATA;
+      }
+      if (*realSize + dataSize + MERGED_SLICEHDR_MARGIN > capacity) {
+          OMAF_LOG(LOG_ERROR, "Merged packet buffer is too small for tile %u !\n", tilesIdx);
+          return OMAF_ERROR_INVALID_DATA;
       }
-      SourceInfo srcInfo = itSrc->second;
-
-      OMAF_LOG(LOG_INFO, "Original source width %d, height %d\n", srcInfo.width, srcInfo.height);
-      OMAF_LOG(LOG_INFO, "Merged source width %d, height %d\n", width, height);
-      if ((width != (uint32_t)(srcInfo.width)) || (height != (uint32_t)(srcInfo.height))) {
-        SRDInfo srd = onePacket->GetSRDInfo();
-        if (!tileWidth || !tileHeight) {
-          tileWidth = srd.width;
-          tileHeight = srd.height;
-        }
-
-        uint8_t colIdx = tilesIdx % tileColsNum;
-        uint8_t rowIdx = tilesIdx / tileColsNum;
-        uint16_t ctuIdx =
-            rowIdx * (tileHeight / LCU_SIZE) * ((tileWidth / LCU_SIZE) * tileColsNum) + colIdx * (tileWidth / LCU_SIZE);
-        // LOG(INFO)<< "SRD: " << srd.top << " and  "<<srd.left<<endl;
-        // LOG(INFO)<<"New ctuIdx  "<<ctuIdx<<endl;
-        char *data = onePacket->Payload();
-        int32_t dataSize = onePacket->Size();
-        if (!data || !dataSize)
-        {
-            OMAF_LOG(LOG_ERROR, "Invalid data in selected media packet !\n");
-            return OMAF_ERROR_INVALID_DATA;
-        }
 
-        if (onePacket->GetHasVideoHeader()) {
-          data += (onePacket->GetVPSLen() + onePacket->GetSPSLen() + onePacket->GetPPSLen());
-          dataSize -= (onePacket->GetVPSLen() + onePacket->GetSPSLen() + onePacket->GetPPSLen());
-        }
-        if (!data || !dataSize)
-        {
-            OMAF_LOG(LOG_ERROR, "After video headers (VPS/SPS/PPS) are moved, invalid data in selected media packet !\n");
-            return OMAF_ERROR_INVALID_DATA;
+      if (newSliceHdr) {
+        Nalu nalu;
+        memset(&nalu, 0, sizeof(Nalu));
+        nalu.data = (uint8_t *)data;
+        nalu.dataSize = dataSize;
+        I360SCVP_ParseNAL(&nalu, ctx->handle);
+
+        nalu.sliceHeaderLen = nalu.sliceHeaderLen - HEVC_NALUHEADER_LEN;
+        int32_t sliceDataOffset = HEVC_STARTCODES_LEN + HEVC_NALUHEADER_LEN + nalu.sliceHeaderLen;
+        if (sliceDataOffset > nalu.dataSize) {
+          OMAF_LOG(LOG_ERROR, "Invalid slice header in selected media packet !\n");
+          return OMAF_ERROR_INVALID_DATA;
         }
 
-        Nalu *nalu = new Nalu;
-        if (!nalu) {
-          return OMAF_ERROR_NULL_PTR;
+        ctx->param.pInputBitstream = (uint8_t *)data;
+        ctx->param.inputBitstreamLen = dataSize;
+        ctx->param.pOutputBitstream = (uint8_t *)mergedData + *realSize;
+        if (I360SCVP_GenerateSliceHdr(&(ctx->param), ctx->ctuOffsets[tilesIdx], ctx->handle)) {
+          return OMAF_ERROR_SCVP_OPERATION_FAILED;
         }
-
-        nalu->data = (uint8_t *)data;
-        nalu->dataSize = dataSize;
-        I360SCVP_ParseNAL(nalu, m_360scvpHandle);
-
-        nalu->sliceHeaderLen = nalu->sliceHeaderLen - HEVC_NALUHEADER_LEN;
-
-        m_360scvpParam->destWidth = (arrangeChanged ? width : initWidth);
-        m_360scvpParam->destHeight = (arrangeChanged ? height : initHeight);
-        m_360scvpParam->pInputBitstream = (uint8_t *)data;
-        m_360scvpParam->inputBitstreamLen = dataSize;
-        m_360scvpParam->pOutputBitstream = (uint8_t *)mergedData + *realSize;
-        I360SCVP_GenerateSliceHdr(m_360scvpParam, ctuIdx, m_360scvpHandle);
-        *realSize += m_360scvpParam->outputBitstreamLen;
-        memcpy_s(mergedData + *realSize,
-                 (size_t(nalu->dataSize) - (HEVC_STARTCODES_LEN + HEVC_NALUHEADER_LEN + nalu->sliceHeaderLen)),
-                 (nalu->data + HEVC_STARTCODES_LEN + HEVC_NALUHEADER_LEN + nalu->sliceHeaderLen),
-                 (size_t(nalu->dataSize) - (HEVC_STARTCODES_LEN + HEVC_NALUHEADER_LEN + nalu->sliceHeaderLen)));
-
-        *realSize += nalu->dataSize - (HEVC_STARTCODES_LEN + HEVC_NALUHEADER_LEN + nalu->sliceHeaderLen);
-        SAFE_DELETE(nalu);
-        tilesIdx++;
+        *realSize += ctx->param.outputBitstreamLen;
+        size_t sliceDataSize = size_t(nalu.dataSize - sliceDataOffset);
+        memcpy_s(mergedData + *realSize, sliceDataSize, (nalu.data + sliceDataOffset), sliceDataSize);
+        *realSize += sliceDataSize;
       } else {
-        char *data = onePacket->Payload();
-        int32_t dataSize = onePacket->Size();
-        if (!data || !dataSize)
-        {
-            OMAF_LOG(LOG_ERROR, "Invalid data in selected media packet !\n");
-            return OMAF_ERROR_INVALID_DATA;
-        }
-
-        if (onePacket->GetHasVideoHeader()) {
-          data += onePacket->GetVideoHeaderSize();
-          dataSize -= onePacket->GetVideoHeaderSize();
-        }
-        if (!data || !dataSize)
-        {
-            OMAF_LOG(LOG_ERROR, "After video headers (VPS/SPS/PPS) are moved, invalid data in selected media packet !\n");
-            return OMAF_ERROR_INVALID_DATA;
-        }
         memcpy_s(mergedData + *realSize, dataSize, data, dataSize);
         *realSize += dataSize;
       }
@@ -1719,6 +1626,70 @@ int32_t OmafTilesStitch::UpdateMergedDataAndRealSize(
     return ERROR_NONE;
 }
 
+int32_t OmafTilesStitch::MergeTileSpans(MediaPacket *onePacket, MergeLayoutContext *ctx, uint32_t tilesIdx,
+                                        bool newSliceHdr, char *mergedData, uint64_t capacity, uint64_t *realSize) {
+    // video headers are inserted by copying the sample into the packet, so there are none here
+    size_t dataSize = onePacket->Size();
+    if (!dataSize || onePacket->GetHasVideoHeader()) {
+        OMAF_LOG(LOG_ERROR, "Invalid data in selected media packet !\n");
+        return OMAF_ERROR_INVALID_DATA;
+    }
+    if (*realSize + dataSize + MERGED_SLICEHDR_MARGIN > capacity) {
+        OMAF_LOG(LOG_ERROR, "Merged packet buffer is too small for tile %u !\n", tilesIdx);
+        return OMAF_ERROR_INVALID_DATA;
+    }
+
+    if (!newSliceHdr) {
+      *realSize += onePacket->CopyPayload(0, dataSize, mergedData + *realSize);
+      return ERROR_NONE;
+    }
+
+    // only the slice header has to be in one piece to be rewritten, the rest of
+    // the sample is then copied behind the new slice header like the copy path does.
+    // The slice header is parsed within the first NAL unit only
+    size_t nalSize = onePacket->FirstNalSize();
+    if (nalSize <= HEVC_STARTCODES_LEN + HEVC_NALUHEADER_LEN || nalSize > dataSize) {
+      OMAF_LOG(LOG_ERROR, "Invalid first NAL unit size %zu in tile %u !\n", nalSize, tilesIdx);
+      return OMAF_ERROR_INVALID_DATA;
+    }
+    size_t headSize = std::min<size_t>(nalSize, MERGED_SLICEHDR_HEAD);
+    int32_t sliceDataOffset = 0;
+    while (true) {
+      ctx->sliceHead.resize(headSize);
+      if (onePacket->CopyPayload(0, headSize, (char *)ctx->sliceHead.data()) != headSize) {
+        OMAF_LOG(LOG_ERROR, "Failed to read the slice header of tile %u !\n", tilesIdx);
+        return OMAF_ERROR_INVALID_DATA;
+      }
+      Nalu nalu;
+      memset(&nalu, 0, sizeof(Nalu));
+      nalu.data = ctx->sliceHead.data();
+      nalu.dataSize = headSize;
+      I360SCVP_ParseNAL(&nalu, ctx->handle);
+
+      nalu.sliceHeaderLen = nalu.sliceHeaderLen - HEVC_NALUHEADER_LEN;
+      sliceDataOffset = HEVC_STARTCODES_LEN + HEVC_NALUHEADER_LEN + nalu.sliceHeaderLen;
+      // parse the whole NAL unit if the slice header does not fit in the head
+      if ((size_t)sliceDataOffset < headSize || headSize == nalSize) break;
+      headSize = nalSize;
+    }
+    if (sliceDataOffset > (int32_t)nalSize) {
+      OMAF_LOG(LOG_ERROR, "Invalid slice header in selected media packet !\n");
+      return OMAF_ERROR_INVALID_DATA;
+    }
+
+    ctx->param.pInputBitstream = ctx->sliceHead.data();
+    ctx->param.inputBitstreamLen = headSize;
+    ctx->param.pOutputBitstream = (uint8_t *)mergedData + *realSize;
+    if (I360SCVP_GenerateSliceHdr(&(ctx->param), ctx->ctuOffsets[tilesIdx], ctx->handle)) {
+      return OMAF_ERROR_SCVP_OPERATION_FAILED;
+    }
+    *realSize += ctx->param.outputBitstreamLen;
+    // the slice data and any NAL unit after it in the sample
+    size_t sliceDataSize = dataSize - size_t(sliceDataOffset);
+    *realSize += onePacket->CopyPayload(size_t(sliceDataOffset), sliceDataSize, mergedData + *realSize);
+    return ERROR_NONE;
+}
+
 int32_t OmafTilesStitch::UpdateInitTilesMergeArr() {
 
     for (auto it = m_initTilesMergeArr.begin(); it != m_initTilesMergeArr.end();) {
@@ -1776,104 +1747,219 @@ int32_t OmafTilesStitch::UpdateInitTilesMergeArr() {
     return ERROR_NONE;
 }
 
+void OmafTilesStitch::MergeLayout(MergeJob &job) {
+  char *mergedData = job.mergedPacket->Payload();
+  uint64_t capacity = job.mergedPacket->AllocatedSize();
+  job.realSize = 0;
+  job.ret = InitMergedDataAndRealSize(job.ctx, mergedData, capacity, &(job.realSize));
+  if (ERROR_NONE != job.ret) {
+    OMAF_LOG(LOG_ERROR, "Failed to calculated mergedData and realSize!\n");
+    return;
+  }
+
+  job.ret = UpdateMergedDataAndRealSize(job.qualityRanking, job.tilePackets, job.ctx, job.tileColsNum,
+                                        job.arrangeChanged, job.width, job.height, job.initWidth,
+                                        job.initHeight, mergedData, capacity, &(job.realSize));
+  if (ERROR_NONE != job.ret) {
+    OMAF_LOG(LOG_ERROR, "Failed to update mergedData and realSize!\n");
+  }
+}
+
+void OmafTilesStitch::RunMergeJobs() {
+  uint32_t jobNum = m_mergeJobs.size();
+  if (0 == jobNum) return;
+
+  uint32_t workerNum = std::min(m_maxMergeWorkers, jobNum - 1);
+  if (0 == workerNum) {
+    for (uint32_t i = 0; i < jobNum; i++) {
+      MergeLayout(m_mergeJobs[i]);
+    }
+    return;
+  }
+
+  // merge workers are created when needed and kept for later frames
+  while (m_mergeWorkers.size() < workerNum) {
+    try {
+      m_mergeWorkers.push_back(std::thread(&OmafTilesStitch::MergeWorkerLoop, this));
+    } catch (const std::exception &ex) {
+      OMAF_LOG(LOG_WARNING, "Failed to create tiles merge worker, exception: %s\n", ex.what());
+      break;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(m_mergeMutex);
+  m_mergeJobNum = jobNum;
+  m_nextMergeJob = 0;
+  m_unfinishedMergeJobs = jobNum;
+  m_mergeCv.notify_all();
+
+  // stitching thread merges layouts as well
+  while (m_nextMergeJob < m_mergeJobNum) {
+    uint32_t jobIdx = m_nextMergeJob++;
+    lock.unlock();
+    MergeLayout(m_mergeJobs[jobIdx]);
+    lock.lock();
+    m_unfinishedMergeJobs--;
+  }
+  m_mergeDoneCv.wait(lock, [this] { return 0 == m_unfinishedMergeJobs; });
+}
+
+void OmafTilesStitch::MergeWorkerLoop() {
+  std::unique_lock<std::mutex> lock(m_mergeMutex);
+  while (true) {
+    m_mergeCv.wait(lock, [this] { return m_mergeWorkersQuit || (m_nextMergeJob < m_mergeJobNum); });
+    if (m_mergeWorkersQuit) break;
+
+    uint32_t jobIdx = m_nextMergeJob++;
+    lock.unlock();
+    MergeLayout(m_mergeJobs[jobIdx]);
+    lock.lock();
+    if (0 == --m_unfinishedMergeJobs) {
+      m_mergeDoneCv.notify_all();
+    }
+  }
+}
+
+void OmafTilesStitch::StopMergeWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(m_mergeMutex);
+    m_mergeWorkersQuit = true;
+  }
+  m_mergeCv.notify_all();
+  for (auto &worker : m_mergeWorkers) {
+    if (worker.joinable()) worker.join();
+  }
+  m_mergeWorkers.clear();
+}
+
 int32_t OmafTilesStitch::GenerateOutputMergedPackets() {
   if (m_outMergedStream.size()) {
     m_outMergedStream.clear();
   }
+  std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
   // 1. generate m_updatedTilesMergeArr
   int32_t ret = GenerateTilesMergeArrangement();  // GenerateTilesMergeArrAndRwpk();
   if (ret) return ret;
 
-  if (0 == m_mergedVideoHeaders.size()) {
+  if (0 == m_layoutCtxs.size()) {
     if (m_updatedTilesMergeArr.size()) {
       OMAF_LOG(LOG_ERROR, "Incorrect operation in initialization stage !\n");
       return OMAF_ERROR_OPERATION;
     }
   }
 
-  std::map<QualityRank, vector<TilesMergeArrangement *>> tilesMergeArr;
-  if (0 == m_updatedTilesMergeArr.size()) {
-    tilesMergeArr = m_initTilesMergeArr;
-  } else {
-    tilesMergeArr = m_updatedTilesMergeArr;
-  }
+  const std::map<QualityRank, vector<TilesMergeArrangement *>> &tilesMergeArr =
+      m_updatedTilesMergeArr.empty() ? m_initTilesMergeArr : m_updatedTilesMergeArr;
+
+  // merged packets of the frame are not released until all merge jobs are done
+  uint32_t jobNum = 0;
+  auto releaseJobPackets = [this, &jobNum]() {
+    for (uint32_t i = 0; i < jobNum; i++) {
+      SAFE_DELETE(m_mergeJobs[i].mergedPacket);
+    }
+  };
 
   bool isArrChanged = false;
+  vector<TilesMergeArrangement *> noLayOut;
   // for each quality ranking
-  std::map<QualityRank, vector<TilesMergeArrangement *>>::iterator it;
+  std::map<QualityRank, vector<TilesMergeArrangement *>>::const_iterator it;
   for (it = tilesMergeArr.begin(); it != tilesMergeArr.end(); it++) {
     auto qualityRanking = it->first;
     bool packetLost = false;
     bool arrangeChanged = false;
-    vector<TilesMergeArrangement *> layOut = it->second;
-    if (layOut.empty()) return OMAF_ERROR_NULL_PTR;
-    vector<TilesMergeArrangement *> initLayOut = m_initTilesMergeArr[qualityRanking];
+    const vector<TilesMergeArrangement *> &layOut = it->second;
+    if (layOut.empty()) {
+      releaseJobPackets();
+      return OMAF_ERROR_NULL_PTR;
+    }
+    auto itInitArr = m_initTilesMergeArr.find(qualityRanking);
+    const vector<TilesMergeArrangement *> &initLayOut = (itInitArr == m_initTilesMergeArr.end()) ? noLayOut : itInitArr->second;
 
     // 1. check isArrChanged, packetLost and arrangeChanged flag.
     ret = IsArrChanged(qualityRanking, layOut, initLayOut, &isArrChanged, &packetLost, &arrangeChanged);
     if (ret != ERROR_NONE)
     {
         OMAF_LOG(LOG_ERROR, "error ocurrs in checking arrange changed!\n");
+        releaseJobPackets();
         return OMAF_ERROR_OPERATION;
     }
 
-    std::map<uint32_t, MediaPacket *> packets = m_selectedTiles[qualityRanking];
-    // 2. if arrangeChanged, then generate new merged video headers
+    auto itTiles = m_selectedTiles.find(qualityRanking);
+    if (itTiles == m_selectedTiles.end() || itTiles->second.empty())
+    {
+      OMAF_LOG(LOG_ERROR, "Packet map is empty!\n");
+      releaseJobPackets();
+      return OMAF_ERROR_INVALID_DATA;
+    }
+    const std::map<uint32_t, MediaPacket *> &packets = itTiles->second;
+
+    // 2. generate new merged video headers for the layouts which have been changed
     ret = GenerateMergedVideoHeaders(arrangeChanged, qualityRanking, layOut, initLayOut, packets);
     if (ret != ERROR_NONE)
     {
         OMAF_LOG(LOG_ERROR, "generate merged video headers failed! and error code is %d\n", ret);
+        releaseJobPackets();
         return OMAF_ERROR_OPERATION;
     }
     // 3. generate rwpk structure for ERP/Cubemap
     vector<std::unique_ptr<RegionWisePacking>> rwpk = GenerateMergedRWPK(qualityRanking, packetLost, arrangeChanged);
-    if (rwpk.empty()) {
+    if (rwpk.size() < layOut.size()) {
         OMAF_LOG(LOG_ERROR, "Failed to generate merged rwpk!\n");
+        releaseJobPackets();
         return OMAF_ERROR_GENERATE_RWPK;
     }
-    // 4. init mergedData and realSize with headers
-    std::map<uint32_t, MediaPacket *>::iterator itPacket;
+    // 4. prepare merge job and merged packet for each layout
     std::vector<uint32_t> needAccumPacketSize(layOut.size(), 0);
+    for (uint32_t index = 0; index < layOut.size(); index++) {
+      uint32_t packetSizeForOneLayout = layOut[index]->tilesLayout.tileColsNum * layOut[index]->tilesLayout.tileRowsNum;
+      needAccumPacketSize[index] = index == 0 ? packetSizeForOneLayout : packetSizeForOneLayout + needAccumPacketSize[index - 1];
+    }
+    MediaPacket *firstPacket = packets.begin()->second;
+    vector<std::unique_ptr<MergeLayoutContext>> &layoutCtxs = m_layoutCtxs[qualityRanking];
     for (uint32_t index = 0; index < layOut.size(); index++) {
       uint32_t width = layOut[index]->mergedWidth;
       uint32_t height = layOut[index]->mergedHeight;
       uint32_t initWidth = initLayOut.size() < index + 1 ? 0 : initLayOut[index]->mergedWidth;
       uint32_t initHeight = initLayOut.size() < index + 1 ? 0 : initLayOut[index]->mergedHeight;
-      MediaPacket *mergedPacket = new MediaPacket();
-      uint32_t packetSize = ((width * height * 3) / 2) / 2;
-      mergedPacket->ReAllocatePacket(packetSize);
-      mergedPacket->SetRwpk(std::move(rwpk[index]));
-      char *mergedData = mergedPacket->Payload();
-      uint64_t realSize = 0;
-      if (ERROR_NONE != InitMergedDataAndRealSize(qualityRanking, packets, mergedData, &realSize, index, layOut[index])) {
-          SAFE_DELETE(mergedPacket);
-          OMAF_LOG(LOG_ERROR, "Failed to calculated mergedData and realSize!\n");
-          return OMAF_ERROR_OPERATION;
+
+      if (m_mergeJobs.size() < jobNum + 1) m_mergeJobs.resize(jobNum + 1);
+      MergeJob &job = m_mergeJobs[jobNum];
+      job.qualityRanking = qualityRanking;
+      job.ctx = layoutCtxs[index].get();
+      job.tileColsNum = layOut[index]->tilesLayout.tileColsNum;
+      job.arrangeChanged = arrangeChanged;
+      job.width = width;
+      job.height = height;
+      job.initWidth = initWidth;
+      job.initHeight = initHeight;
+      job.mergedPacket = nullptr;
+      job.realSize = 0;
+      job.ret = ERROR_NONE;
+      if (ERROR_NONE != GetLayoutPackets(packets, index, needAccumPacketSize, layOut.size(), job.tilePackets)) {
+        releaseJobPackets();
+        return OMAF_ERROR_INVALID_DATA;
       }
-      // 5. set params for merged packets
-      TilesMergeArrangement *arrange = nullptr;
-      if (m_updatedTilesMergeArr.empty())
-        arrange = m_initTilesMergeArr[qualityRanking][index];
-      else
-        arrange = m_updatedTilesMergeArr[qualityRanking][index];
 
-      if (!arrange) {
+      // merged packet holds the merged headers and each tile with its regenerated slice header
+      uint64_t packetSize = (m_needHeaders && job.ctx) ? job.ctx->headers.size() : 0;
+      for (MediaPacket *tilePacket : job.tilePackets) {
+        packetSize += tilePacket->Size() + MERGED_SLICEHDR_MARGIN;
+      }
+      if (job.ctx && !(job.ctx->pool)) {
+        job.ctx->pool = std::make_shared<MediaPacketPool>();
+      }
+      MediaPacket *mergedPacket = new MediaPacket();
+      if (!job.ctx || mergedPacket->AllocatePacket(job.ctx->pool, packetSize) < 0) {
+        OMAF_LOG(LOG_ERROR, "Failed to allocate merged packet with size %lu!\n", packetSize);
         SAFE_DELETE(mergedPacket);
+        releaseJobPackets();
         return OMAF_ERROR_NULL_PTR;
       }
+      job.mergedPacket = mergedPacket;
+      jobNum++;
 
-      uint8_t tileColsNum = arrange->tilesLayout.tileColsNum;
-      uint8_t tileRowsNum = arrange->tilesLayout.tileRowsNum;
-      uint32_t packetSizeForOneLayout = tileColsNum * tileRowsNum;
-      needAccumPacketSize[index] = index == 0 ? packetSizeForOneLayout : packetSizeForOneLayout + needAccumPacketSize[index - 1];
-      itPacket = packets.begin();
-      if (itPacket == packets.end())
-      {
-        OMAF_LOG(LOG_ERROR, "Packet map is empty!\n");
-        SAFE_DELETE(mergedPacket);
-        return OMAF_ERROR_INVALID_DATA;
-      }
-      MediaPacket *firstPacket = itPacket->second;
+      // 5. set params for merged packets
+      mergedPacket->SetRwpk(std::move(rwpk[index]));
       mergedPacket->SetVideoID(static_cast<uint32_t>(qualityRanking) - 1);
       mergedPacket->SetCodecType(firstPacket->GetCodecType());
       mergedPacket->SetPTS(firstPacket->GetPTS());
@@ -1899,22 +1985,24 @@ int32_t OmafTilesStitch::GenerateOutputMergedPackets() {
         newPrft->mediaTime = pPrft->mediaTime;
       }
       mergedPacket->SetPRFT(std::move(newPrft));
+    }
+  } // each quality ranking
 
-      if (ERROR_NONE != UpdateMergedDataAndRealSize(
-                            qualityRanking, packets, tileColsNum,
-                            arrangeChanged, width, height, initWidth,
-                            initHeight, mergedData, &realSize, index,
-                            needAccumPacketSize, layOut.size())) {
-          OMAF_LOG(LOG_ERROR, "Failed to update mergedData and realSize!\n");
-          SAFE_DELETE(mergedPacket);
-          return OMAF_ERROR_OPERATION;
-      }
-
-      mergedPacket->SetRealSize(realSize);
+  // 6. merge tiles data of all layouts, layouts are independent of each other
+  m_mergeJobs.resize(jobNum);
+  RunMergeJobs();
 
-      m_outMergedStream.push_back(mergedPacket);
+  for (uint32_t i = 0; i < jobNum; i++) {
+    if (ERROR_NONE != m_mergeJobs[i].ret) {
+      releaseJobPackets();
+      return OMAF_ERROR_OPERATION;
     }
-  } // each quality ranking
+  }
+  for (uint32_t i = 0; i < jobNum; i++) {
+    m_mergeJobs[i].mergedPacket->SetRealSize(m_mergeJobs[i].realSize);
+    m_outMergedStream.push_back(m_mergeJobs[i].mergedPacket);
+    m_mergeJobs[i].mergedPacket = nullptr;
+  }
 
   if (isArrChanged) {
     if (ERROR_NONE != UpdateInitTilesMergeArr()) {
@@ -1923,6 +2011,11 @@ int32_t OmafTilesStitch::GenerateOutputMergedPackets() {
     }
   }
 
+  uint64_t stitchTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+  m_lastStitchTimeUs = stitchTimeUs;
+  m_totalStitchTimeUs += stitchTimeUs;
+  m_stitchedFrameNum++;
+
   return ERROR_NONE;
 }
 
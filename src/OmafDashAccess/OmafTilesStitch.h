@@ -38,15 +38,25 @@
 #define OMAFTILESSTITCH_H
 
 #include "MediaPacket.h"
+#include "MediaPacketPool.h"
 #include "general.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 VCD_OMAF_BEGIN
 
 #define LCU_SIZE 64
 #define HEVC_STARTCODES_LEN 4
 #define HEVC_NALUHEADER_LEN 2
+#define MERGED_SLICEHDR_MARGIN 64  // max bytes one regenerated slice header may grow by
+#define MERGED_SLICEHDR_HEAD 256   // bytes of a referenced tile sample read to parse its slice header
+#define MERGED_HEADERS_MIN 1024    // min buffer size of generated VPS/SPS/PPS, not bounded by 360SCVP
+#define MERGED_TILESIZE_BYTES 4    // max bytes of one explicit tile column width or row height in PPS
+#define DEFAULT_MERGE_WORKERS_NUM 3
 
 // map of <qualityRanking, <trackID, MediaPacket*>>
 typedef std::map<QualityRank, std::map<uint32_t, MediaPacket *>> PacketsMap;
@@ -64,6 +74,56 @@ typedef struct TilesMergeArrangement {
   TileArrangement tilesLayout;
 } TilesMergeArrangement;
 
+//!
+//! \struct: MergeLayoutContext
+//! \brief:  the state kept for merging one tiles layout of one quality
+//!          ranking across frames, so that frames with unchanged layout
+//!          reuse the merged headers, CTU addresses and output buffers
+//!
+struct MergeLayoutContext {
+  MergeLayoutContext() : handle(nullptr), ctuTileWidth(0), ctuTileHeight(0), ctuTileCols(0) {
+    memset(&param, 0, sizeof(param_360SCVP));
+  }
+  ~MergeLayoutContext() {
+    if (handle) {
+      I360SCVP_unInit(handle);
+      handle = nullptr;
+    }
+  }
+
+  param_360SCVP param;  //<! 360SCVP parameter used with handle
+  void *handle;         //<! 360SCVP session holding VPS/SPS/PPS of the layout source
+  std::vector<uint8_t> srcHeaders;   //<! VPS/SPS/PPS of the source the merged headers come from
+  std::vector<uint32_t> headersKey;  //<! merged width/height and tiles layout of the merged headers
+  std::vector<uint8_t> headers;      //<! merged VPS/SPS/PPS, empty if to be generated
+  std::vector<uint16_t> ctuOffsets;  //<! CTU address of each tile in merged picture
+  std::vector<uint8_t> sliceHead;    //<! leading bytes of a referenced tile sample with its slice header
+  uint32_t ctuTileWidth;             //<! tile width the CTU addresses are calculated for
+  uint32_t ctuTileHeight;            //<! tile height the CTU addresses are calculated for
+  uint32_t ctuTileCols;              //<! tile columns the CTU addresses are calculated for
+  MediaPacketPool::Ptr pool;         //<! output buffers of merged packets
+};
+
+//!
+//! \struct: MergeJob
+//! \brief:  tiles data merge of one layout for current frame, which is
+//!          independent of other layouts and can run on any merge worker
+//!
+typedef struct MergeJob {
+  QualityRank qualityRanking;
+  MergeLayoutContext *ctx;
+  std::vector<MediaPacket *> tilePackets;  //<! tile packets merged into the layout, in merge order
+  uint8_t tileColsNum;
+  bool arrangeChanged;
+  uint32_t width;
+  uint32_t height;
+  uint32_t initWidth;
+  uint32_t initHeight;
+  MediaPacket *mergedPacket;
+  uint64_t realSize;
+  int32_t ret;
+} MergeJob;
+
 //!
 //! \class OmafTilesStitch
 //! \brief The class for tiles stitching
@@ -135,6 +195,28 @@ class OmafTilesStitch {
 
   void SetMaxStitchResolution(uint32_t width, uint32_t height) { m_maxStitchWidth = width; m_maxStitchHeight = height; };
 
+  //!
+  //! \brief  Set the max number of worker threads merging layouts in
+  //!         parallel, besides the stitching thread itself
+  //!
+  void SetMaxMergeWorkers(uint32_t workerNum) { m_maxMergeWorkers = workerNum; };
+
+  //!
+  //! \brief  Get the time spent on stitching frames
+  //!
+  //! \param  [out] avgTimeUs
+  //!         average stitching time of one frame in microseconds
+  //! \param  [out] lastTimeUs
+  //!         stitching time of the last frame in microseconds
+  //!
+  //! \return void
+  //!
+  void GetStitchTime(uint64_t &avgTimeUs, uint64_t &lastTimeUs) {
+    uint64_t frameNum = m_stitchedFrameNum.load();
+    avgTimeUs = frameNum ? m_totalStitchTimeUs.load() / frameNum : 0;
+    lastTimeUs = m_lastStitchTimeUs.load();
+  };
+
  private:
   //!
   //! \brief  Parse the VPS/SPS/PPS information
@@ -243,21 +325,52 @@ private:
   OmafTilesStitch& operator=(const OmafTilesStitch& other) { return *this; };
   OmafTilesStitch(const OmafTilesStitch& other) { /* do not create copies */ };
 
-  int32_t IsArrChanged(QualityRank qualityRanking, vector<TilesMergeArrangement *> layOut, vector<TilesMergeArrangement *> initLayOut, bool *isArrChanged, bool *packetLost, bool *arrangeChanged);
+  int32_t IsArrChanged(QualityRank qualityRanking, const vector<TilesMergeArrangement *> &layOut, const vector<TilesMergeArrangement *> &initLayOut, bool *isArrChanged, bool *packetLost, bool *arrangeChanged);
 
-  int32_t GenerateMergedVideoHeaders(bool arrangeChanged, QualityRank qualityRanking, vector<TilesMergeArrangement *> layOut, vector<TilesMergeArrangement *> initLayOut, std::map<uint32_t, MediaPacket *> packets);
+  //!
+  //! \brief  Prepare the merge context of each layout for the quality
+  //!         ranking, and generate merged VPS/SPS/PPS for the layouts
+  //!         whose merged resolution or tiles layout has changed
+  //!
+  int32_t GenerateMergedVideoHeaders(bool arrangeChanged, QualityRank qualityRanking, const vector<TilesMergeArrangement *> &layOut, const vector<TilesMergeArrangement *> &initLayOut, const std::map<uint32_t, MediaPacket *> &packets);
 
   vector<std::unique_ptr<RegionWisePacking>> GenerateMergedRWPK(QualityRank qualityRanking, bool packetLost, bool arrangeChanged);
 
-  int32_t UpdateMergedVideoHeadersForLowQualityRank(bool isEmptyHeaders, std::map<uint32_t, MediaPacket *> packets, QualityRank qualityRanking, TilesMergeArrangement *layOut);
+  //!
+  //! \brief  Get the tile packets to be merged into the layout of index
+  //!
+  int32_t GetLayoutPackets(const std::map<uint32_t, MediaPacket *> &packets, uint32_t index,
+                           const vector<uint32_t> &needPacketSize, uint64_t layoutNum,
+                           std::vector<MediaPacket *> &tilePackets);
 
-  int32_t InitMergedDataAndRealSize(QualityRank qualityRanking, std::map<uint32_t, MediaPacket *> packets, char* mergedData, uint64_t* realSize, uint32_t index, TilesMergeArrangement *tilesArr);
+  int32_t InitMergedDataAndRealSize(MergeLayoutContext *ctx, char* mergedData, uint64_t capacity, uint64_t* realSize);
 
   int32_t UpdateMergedDataAndRealSize(
-      QualityRank qualityRanking, std::map<uint32_t, MediaPacket *> packets,
+      QualityRank qualityRanking, const std::vector<MediaPacket *> &tilePackets, MergeLayoutContext *ctx,
       uint8_t tileColsNum, bool arrangeChanged, uint32_t width, uint32_t height,
-      uint32_t initWidth, uint32_t initHeight, char *mergedData, uint64_t *realSize,
-      uint32_t index, vector<uint32_t> needPacketSize, uint64_t layoutNum);
+      uint32_t initWidth, uint32_t initHeight, char *mergedData, uint64_t capacity, uint64_t *realSize);
+
+  //!
+  //! \brief  Merge the tile packet whose sample is referenced in place, the
+  //!         sample is read into the merged data without copying it into the packet
+  //!
+  int32_t MergeTileSpans(MediaPacket *onePacket, MergeLayoutContext *ctx, uint32_t tilesIdx, bool newSliceHdr,
+                         char *mergedData, uint64_t capacity, uint64_t *realSize);
+
+  //!
+  //! \brief  Run the merge jobs of current frame on the stitching thread
+  //!         and the merge workers, and wait for all of them to finish
+  //!
+  void RunMergeJobs();
+
+  //!
+  //! \brief  Merge the tile packets of one layout into the merged packet
+  //!
+  void MergeLayout(MergeJob &job);
+
+  void MergeWorkerLoop();
+
+  void StopMergeWorkers();
 
   int32_t UpdateInitTilesMergeArr();
 
@@ -290,8 +403,8 @@ private:
   std::map<QualityRank, vector<TilesMergeArrangement *>>
       m_updatedTilesMergeArr;  //<! updated tiles merge arrangement per frame
 
-  std::map<QualityRank, vector<std::map<uint32_t, uint8_t *>>>
-      m_mergedVideoHeaders;  //<! map of <qualityRanking, <mergedVideoHeadersSize, mergedVideoHeadersData*>>
+  std::map<QualityRank, vector<std::unique_ptr<MergeLayoutContext>>>
+      m_layoutCtxs;  //<! map of <qualityRanking, merge context of each layout>
 
   uint32_t m_fullWidth;  //<! the width of original video
 
@@ -316,6 +429,32 @@ private:
   uint32_t m_maxStitchHeight; //<! max merged height for stitching
 
   std::map<uint32_t, SourceInfo> m_sources; //all video source information corresponding to different quality ranking <qualityRanking, SourceInfo>
+
+  std::vector<MergeJob> m_mergeJobs;  //<! merge jobs of current frame, one for each layout
+
+  uint32_t m_mergeJobNum;  //<! number of merge jobs of current frame, guarded by m_mergeMutex
+
+  uint32_t m_nextMergeJob;  //<! index of the next merge job to run, guarded by m_mergeMutex
+
+  uint32_t m_unfinishedMergeJobs;  //<! number of merge jobs not finished, guarded by m_mergeMutex
+
+  bool m_mergeWorkersQuit;  //<! whether merge workers should exit, guarded by m_mergeMutex
+
+  uint32_t m_maxMergeWorkers;  //<! max number of merge workers
+
+  std::vector<std::thread> m_mergeWorkers;  //<! threads merging layouts in parallel
+
+  std::mutex m_mergeMutex;
+
+  std::condition_variable m_mergeCv;  //<! notifies merge workers of new merge jobs
+
+  std::condition_variable m_mergeDoneCv;  //<! notifies stitching thread that all merge jobs finished
+
+  std::atomic<uint64_t> m_lastStitchTimeUs;  //<! stitching time of the last frame
+
+  std::atomic<uint64_t> m_totalStitchTimeUs;  //<! total stitching time of all frames
+
+  std::atomic<uint64_t> m_stitchedFrameNum;  //<! number of stitched frames
 };
 
 VCD_OMAF_END;
@@ -320,7 +320,8 @@ int OmafTracksSelector::InitializePredictPlugins() {
   return ERROR_NONE;
 }
 
-std::map<uint32_t, std::map<int, OmafAdaptationSet*>> OmafTracksSelector::CompareTracksAndGetDifference(OmafMediaStream* pStream, uint64_t *currentTimeLine)
+std::map<uint32_t, std::map<int, OmafAdaptationSet*>> OmafTracksSelector::CompareTracksAndGetDifference(OmafMediaStream* pStream, uint64_t *currentTimeLine,
+                                                                                                       std::map<uint32_t, TracksMap> *obsoleteTracks)
 {
     //first: segID, second: TracksMap
     std::map<uint32_t, std::map<int, OmafAdaptationSet*>> diffTracksMap;
@@ -356,6 +357,24 @@ std::map<uint32_t, std::map<int, OmafAdaptationSet*>> OmafTracksSelector::Compar
         OMAF_LOG(LOG_INFO, "There is no difference between current tracks and former timed-download tracks\n");
         return diffTracksMap;
     }
+    //3.1.1 tracks selected for future segments but out of current selection are obsolete,
+    // low quality tiles still cover them, so it only works for non-planar projection
+    if (obsoleteTracks && mProjFmt != ProjectionFormat::PF_PLANAR)
+    {
+        std::lock_guard<std::mutex> lock(mCurrentMutex);
+        for (auto itPrev = m_prevTimedTracksMap.upper_bound(comTimeLine); itPrev != m_prevTimedTracksMap.end(); itPrev++)
+        {
+            TracksMap removedTracks = GetDifferentTracks(itPrev->second, mCurrSelectedTracksMap);
+            if (removedTracks.empty()) continue;
+            for (auto &tk : removedTracks)
+            {
+                itPrev->second.erase(tk.first);
+            }
+            uint32_t segID = itPrev->first / sampleNumPerSeg + 1;
+            OMAF_LOG(LOG_INFO, "%zu tracks of seg id %u are obsolete\n", removedTracks.size(), segID);
+            obsoleteTracks->insert(make_pair(segID, std::move(removedTracks)));
+        }
+    }
     // for (auto df : diffTracks)
     // {
     //   OMAF_LOG(LOG_INFO, "Diff is %d\n", df.first);
@@ -46,6 +46,7 @@ using namespace VCD::OMAF;
 VCD_OMAF_BEGIN
 
 #define POSE_SIZE 10
+#define MAX_TILES_IN_VIEWPORT 1024
 
 constexpr uint64_t ptsInterval[4] = {0, 8, 15, 23}; // 30 38 45 53
 
@@ -141,8 +142,12 @@ class OmafTracksSelector {
 
   //!
   //! \brief  Compare current tracks and prev tracks and get the different tracks.
+  //!         when obsoleteTracks is set, it also gets the tracks of future segments
+  //!         which are not selected any more, pair<segID, tracks>, and drops them
+  //!         from the previous timed tracks.
   //!
-  std::map<uint32_t, std::map<int, OmafAdaptationSet*>> CompareTracksAndGetDifference(OmafMediaStream* pStream, uint64_t *currentTimeLine);
+  std::map<uint32_t, std::map<int, OmafAdaptationSet*>> CompareTracksAndGetDifference(OmafMediaStream* pStream, uint64_t *currentTimeLine,
+                                                                                     std::map<uint32_t, TracksMap> *obsoleteTracks = nullptr);
 
   //!
   //! \brief  Get the different tracks (tracks1 - tracks2)
@@ -183,6 +188,7 @@ private:
   uint64_t                      mLastCatchupPTS;
   TracksMap                     mCurrSelectedTracksMap;
   std::map<int, OmafAdaptationSet*>  mASMap;
+  std::vector<TileDef>          mTilesInViewport;  //<! tiles in viewport got from 360SCVP library, guarded by mASMutex
 };
 
 VCD_OMAF_END;
@@ -45,6 +45,11 @@ namespace OMAF {
 
 const long DEFAULT_MAX_PARALLEL_TRANSFERS = 50;
 const int32_t DEFAULT_SEGMENT_OPEN_TIMEOUT = 3000;
+// 0: half of the hardware threads, at most MAX_AUTO_PARSE_WORKERS
+const uint32_t DEFAULT_MAX_PARSE_WORKERS = 0;
+const uint32_t MAX_AUTO_PARSE_WORKERS = 8;
+// larger configured numbers are taken as invalid
+const uint32_t MAX_PARSE_WORKERS = 64;
 
 enum class OmafDashMode { EXTRACTOR = 0, LATER_BINDING = 1, MULTI_VIEW = 2 };
 
@@ -153,12 +158,17 @@ class OmafDashParams {
   uint32_t max_response_times_in_seg;
   uint32_t max_catchup_width;
   uint32_t max_catchup_height;
+  // for segment parsing
+  uint32_t max_parse_workers_ = DEFAULT_MAX_PARSE_WORKERS;
+  bool enable_progressive_parse_ = false;
 
   std::string to_string() {
     std::stringstream ss;
     ss << http_proxy_.to_string();
     ss << http_params_.to_string();
     ss << "\tmax parallel transfers: " << max_parallel_transfers_ << ", " << std::endl;
+    ss << "\tmax parse workers: " << max_parse_workers_ << ", " << std::endl;
+    ss << "\tprogressive parse: " << enable_progressive_parse_ << ", " << std::endl;
     ss << stats_params_.to_string();
     ss << syncer_params_.to_string();
     ss << prediector_params_.to_string();
@@ -206,6 +216,7 @@ class DashSegmentSourceParams {
   bool enable_byte_range_ = false;
   DashStreamType stream_type_ = DASH_STREAM_STATIC;
   ChunkInfoType chunk_info_type_ = ChunkInfoType::NO_CHUNKINFO;
+  bool progressive_parse_ = false;  // hand out chunks before their mdat completes
 
   std::string to_string() const noexcept {
     std::stringstream ss;
@@ -217,6 +228,7 @@ class DashSegmentSourceParams {
     ss << ", header_size=" << header_size_;
     ss << ", cloc_size=" << cloc_size_;
     ss << ", enable_byte_range=" << enable_byte_range_;
+    ss << ", progressive_parse=" << progressive_parse_;
     return ss.str();
   }
 };
@@ -9,6 +9,10 @@ g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testOmafReade
 g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testDownloader.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testDownloaderPerf.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testTracksSelector.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testMediaPacketPool.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testStreamSpans.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testStreamBlocks.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testTileIndex.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 
 LD_FLAGS="-I/usr/local/include/ -lcurl -lstdc++ -lOmafDashAccess -llttng-ust -ldl -lpthread -lglog -l360SCVP -lm -L/usr/local/lib"
 g++ -L/usr/local/lib testDownloaderPerf.o testDownloader.o testMediaSource.o testMPDParser.o testOmafReader.o testOmafReaderManager.o testTracksSelector.o libgtest.a -o testLib ${LD_FLAGS}
@@ -19,6 +23,10 @@ g++ -L/usr/local/lib testOmafReaderManager.o libgtest.a -o testOmafReaderManager
 g++ -L/usr/local/lib testDownloader.o libgtest.a -o testDownloader ${LD_FLAGS}
 g++ -L/usr/local/lib testDownloaderPerf.o libgtest.a -o testDownloaderPerf ${LD_FLAGS}
 g++ -L/usr/local/lib testTracksSelector.o libgtest.a -o testTracksSelector ${LD_FLAGS}
+g++ -L/usr/local/lib testMediaPacketPool.o libgtest.a -o testMediaPacketPool ${LD_FLAGS}
+g++ -L/usr/local/lib testStreamSpans.o libgtest.a -o testStreamSpans ${LD_FLAGS}
+g++ -L/usr/local/lib testStreamBlocks.o libgtest.a -o testStreamBlocks ${LD_FLAGS}
+g++ -L/usr/local/lib testTileIndex.o libgtest.a -o testTileIndex ${LD_FLAGS}
 
 ./run.sh
 if [ $? -ne 0 ]; then exit 1; fi
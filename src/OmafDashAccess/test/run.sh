@@ -9,6 +9,18 @@ curl -ukang1:AP2hWmPtk4RkLXUn2SMWfocyUq2 -O "https://ubit-artifactory-sh.intel.c
 ./testTracksSelector
 if [ $? -ne 0 ]; then exit 1; fi
 
+./testMediaPacketPool
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testStreamSpans
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testStreamBlocks
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testTileIndex
+if [ $? -ne 0 ]; then exit 1; fi
+
 ./testOmafReaderManager
 if [ $? -ne 0 ]; then exit 1; fi
 
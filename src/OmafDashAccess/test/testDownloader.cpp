@@ -28,14 +28,90 @@
 #include <string>
 #include <thread>
 #include <memory>
+#include <atomic>
 #include <pwd.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 #include "../OmafDashDownload/OmafDownloader.h"
+#include "../OmafDashDownload/OmafCurlMultiHandler.h"
+
+#include <algorithm>
+#include <vector>
 
 using namespace VCD::OMAF;
 
 namespace {
 
+// local http server which sends the header and the first bytes of one segment, then stalls
+// until it is stopped, so the transfer is always running when it is cancelled
+class StalledHttpServer {
+ public:
+  StalledHttpServer(size_t content_length, size_t sent_length)
+      : content_length_(content_length), sent_length_(sent_length) {}
+
+  ~StalledHttpServer() { stop(); }
+
+  bool start() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) return false;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 || listen(listen_fd_, 4) != 0 ||
+        getsockname(listen_fd_, reinterpret_cast<struct sockaddr *>(&addr), &len) != 0) {
+      return false;
+    }
+    port_ = ntohs(addr.sin_port);
+    worker_ = std::thread(&StalledHttpServer::run, this);
+    return true;
+  }
+
+  void stop() {
+    stopped_ = true;
+    if (listen_fd_ >= 0) {
+      shutdown(listen_fd_, SHUT_RDWR);
+      close(listen_fd_);
+      listen_fd_ = -1;
+    }
+    if (worker_.joinable()) worker_.join();
+  }
+
+  std::string url() const { return "http://127.0.0.1:" + std::to_string(port_) + "/segment.mp4"; }
+
+  bool sent() const { return sent_; }
+
+ private:
+  void run() {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) return;
+    char request[4096];
+    recv(fd, request, sizeof(request), 0);
+    std::string header = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(content_length_) + "\r\n\r\n";
+    std::vector<char> body(sent_length_, 0);
+    send(fd, header.data(), header.size(), MSG_NOSIGNAL);
+    send(fd, body.data(), body.size(), MSG_NOSIGNAL);
+    sent_ = true;
+    while (!stopped_) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    close(fd);
+  }
+
+  size_t content_length_;
+  size_t sent_length_;
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+  std::thread worker_;
+  std::atomic<bool> sent_{false};
+  std::atomic<bool> stopped_{false};
+};
+
 class DownloaderTest : public testing::Test {
  public:
   virtual void SetUp() {
@@ -210,6 +286,53 @@ TEST_F(DownloaderTest, downloadCMAFSuccess_withCloc) {
   }
 }
 
+TEST_F(DownloaderTest, downloadCancel) {
+  const size_t content_length = 1 << 20;
+  const size_t sent_length = 1024;
+  StalledHttpServer server(content_length, sent_length);
+  ASSERT_TRUE(server.start());
+
+  dash_client_->setStatisticsWindows(1000);
+  OMAF_STATUS ret = dash_client_->start();
+  EXPECT_TRUE(ret == ERROR_NONE);
+
+  DashSegmentSourceParams ds;
+  ds.dash_url_ = server.url();
+  ds.timeline_point_ = 1;
+  ds.enable_byte_range_ = false;
+
+  std::atomic<bool> isState{false};
+  std::atomic<OmafDashSegmentClient::State> lastState{OmafDashSegmentClient::State::FAILURE};
+  dash_client_->open(
+      ds, [](std::unique_ptr<VCD::OMAF::StreamBlock> sb) {}, nullptr,
+      [&isState, &lastState](OmafDashSegmentClient::State state) {
+        OMAF_LOG(LOG_INFO, "Receive the state: %d\n", static_cast<int>(state));
+        lastState = state;
+        isState = true;
+      });
+  while (!server.sent()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // let curl take the header, the transfer stalls after the first bytes
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_FALSE(isState);
+
+  ret = dash_client_->remove(ds);
+  EXPECT_TRUE(ret == ERROR_NONE);
+  while (!isState) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  server.stop();
+
+  // the counters behind cancelled_segments_num and cancelled_bytes_saved of the stream info
+  EXPECT_TRUE(lastState == OmafDashSegmentClient::State::STOPPED);
+  auto stats = dash_client_->statistics();
+  ASSERT_TRUE(stats != nullptr);
+  EXPECT_EQ(stats->cancelled_count_, 1u);
+  EXPECT_GE(stats->cancelled_bytes_, content_length - sent_length);
+  EXPECT_LE(stats->cancelled_bytes_, content_length);
+}
+
 TEST_F(DownloaderTest, downloadFailure) {
   OMAF_STATUS ret = dash_client_->start();
   EXPECT_TRUE(ret == ERROR_NONE);
@@ -357,4 +480,33 @@ TEST_F(DownloaderTest, no_proxy_success) {
   }
 }
 
+
+TEST_F(DownloaderTest, taskSchedulingOrder) {
+  auto createTask = [](const std::string &url, int64_t timeline, TaskPriority priority) {
+    DashSegmentSourceParams ds;
+    ds.dash_url_ = url;
+    ds.timeline_point_ = timeline;
+    ds.priority_ = priority;
+    return OmafDownloadTask::createTask(ds, nullptr, nullptr, nullptr);
+  };
+
+  std::vector<OmafDownloadTask::Ptr> tasks;
+  tasks.push_back(createTask("background_3", 3, TaskPriority::LOW));
+  tasks.push_back(createTask("viewport_3", 3, TaskPriority::NORMAL));
+  tasks.push_back(createTask("background_2", 2, TaskPriority::LOW));
+  tasks.push_back(createTask("viewport_2", 2, TaskPriority::NORMAL));
+  tasks.push_back(createTask("catchup_2", 2, TaskPriority::HIGH));
+  tasks.push_back(createTask("viewport_2_next", 2, TaskPriority::NORMAL));
+
+  std::stable_sort(tasks.begin(), tasks.end(), OmafDownloadTask::moreUrgent);
+
+  // urgent first, then deadline, then viewport priority, then arrival order
+  std::vector<std::string> expected = {"catchup_2",  "viewport_2",   "viewport_2_next",
+                                       "background_2", "viewport_3", "background_3"};
+  ASSERT_EQ(tasks.size(), expected.size());
+  for (size_t i = 0; i < tasks.size(); i++) {
+    EXPECT_EQ(tasks[i]->url(), expected[i]);
+  }
+}
+
 }  // namespace
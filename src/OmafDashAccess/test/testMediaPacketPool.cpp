@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testMediaPacketPool.cpp
+//! \brief:  media packet pool unit test and benchmark, the benchmark runs with VR_PERF_BENCH set
+//!
+
+#include "gtest/gtest.h"
+#include "../MediaPacket.h"
+#include "../MediaPacketPool.h"
+#include "../../utils/PerfBench.h"
+
+#include <list>
+#include <random>
+
+VCD_USE_VROMAF;
+
+namespace {
+
+// 8K ERP with 8x8 tiles, the packet size estimated from the picture size
+const uint32_t kTileWidth = 960;
+const uint32_t kTileHeight = 480;
+const uint32_t kEstimatedPacketSize = ((kTileWidth * kTileHeight * 3) >> 1) >> 1;
+const int kTrackNum = 16;
+const int kSegmentNum = 20;
+const int kSamplesPerSegment = 30;
+
+class MediaPacketPoolTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    // compressed tile samples are usually a few KB, with larger key frames
+    std::mt19937 gen(2020);
+    std::uniform_int_distribution<uint32_t> frame_dist(2 * 1024, 24 * 1024);
+    for (int i = 0; i < kSamplesPerSegment; i++) {
+      sample_sizes_.push_back(i == 0 ? 120 * 1024 : frame_dist(gen));
+    }
+    sample_.assign(120 * 1024, 0x5a);
+    params_.assign(96, 0x01);
+  }
+
+  virtual void TearDown() {}
+
+  // cache one sample the way cachePackets does, the legacy way is the one before the pool:
+  // a zero filled buffer of the size estimated from the picture for every sample
+  MediaPacket *CacheSample(MediaPacketPool::Ptr pool, uint32_t sampleSize, bool firstSample) {
+    MediaPacket *packet = new MediaPacket();
+    if (pool) {
+      packet->AllocatePacket(pool, sampleSize + params_.size());
+    } else {
+      packet->ReAllocatePacket(kEstimatedPacketSize);
+    }
+    memcpy(packet->Payload(), sample_.data(), sampleSize);
+    packet->SetRealSize(sampleSize);
+    if (firstSample) {
+      packet->InsertParams(params_);
+    }
+    return packet;
+  }
+
+  // cache one segment of every track, then release them like the stitching does,
+  // liveBytes is the most payload bytes held by the packets and the pools at once
+  void RunSegments(bool usePool, size_t &liveBytes) {
+    std::vector<MediaPacketPool::Ptr> pools;
+    for (int t = 0; t < kTrackNum; t++) {
+      pools.push_back(usePool ? std::make_shared<MediaPacketPool>() : nullptr);
+    }
+    liveBytes = 0;
+    for (int seg = 0; seg < kSegmentNum; seg++) {
+      std::list<MediaPacket *> packets;
+      size_t bytes = 0;
+      for (int t = 0; t < kTrackNum; t++) {
+        for (size_t i = 0; i < sample_sizes_.size(); i++) {
+          MediaPacket *packet = CacheSample(pools[t], sample_sizes_[i], i == 0);
+          bytes += packet->AllocatedSize();
+          packets.push_back(packet);
+        }
+      }
+      for (auto &pool : pools) {
+        if (pool) bytes += pool->CachedBytes();
+      }
+      liveBytes = std::max(liveBytes, bytes);
+      for (auto packet : packets) {
+        delete packet;
+      }
+    }
+  }
+
+  std::vector<uint32_t> sample_sizes_;
+  std::vector<uint8_t> sample_;
+  std::vector<uint8_t> params_;
+};
+
+TEST_F(MediaPacketPoolTest, AcquireAndRelease) {
+  MediaPacketPool pool;
+  size_t capacity = 0;
+  char *buf = pool.Acquire(5000, capacity);
+  EXPECT_TRUE(buf != nullptr);
+  EXPECT_TRUE(capacity >= 5000);
+  EXPECT_TRUE(capacity <= 5000 + 5000 / 4);
+  pool.Release(buf, capacity);
+  EXPECT_EQ(pool.CachedBytes(), capacity);
+
+  // the same size class is reused
+  size_t capacity2 = 0;
+  char *buf2 = pool.Acquire(4500, capacity2);
+  EXPECT_EQ(buf2, buf);
+  EXPECT_EQ(capacity2, capacity);
+  EXPECT_EQ(pool.CachedBytes(), 0u);
+  EXPECT_EQ(pool.AllocatedNum(), 1u);
+  EXPECT_EQ(pool.ReusedNum(), 1u);
+  pool.Release(buf2, capacity2);
+}
+
+TEST_F(MediaPacketPoolTest, CachedBytesLimit) {
+  MediaPacketPool pool(64 * 1024);
+  size_t capacity1 = 0;
+  size_t capacity2 = 0;
+  char *buf1 = pool.Acquire(60 * 1024, capacity1);
+  char *buf2 = pool.Acquire(60 * 1024, capacity2);
+  pool.Release(buf1, capacity1);
+  pool.Release(buf2, capacity2);
+  // only one buffer is kept, the other one is freed
+  EXPECT_EQ(pool.CachedBytes(), capacity1);
+}
+
+TEST_F(MediaPacketPoolTest, PacketReleaseToPool) {
+  MediaPacketPool::Ptr pool = std::make_shared<MediaPacketPool>();
+  MediaPacket *packet = new MediaPacket();
+  EXPECT_EQ(packet->AllocatePacket(pool, 10000), 10000);
+  size_t capacity = packet->AllocatedSize();
+  EXPECT_TRUE(capacity >= 10000);
+
+  // inserting params fits in the spare room, the pooled buffer is kept
+  char *payload = packet->Payload();
+  packet->SetRealSize(9000);
+  std::vector<uint8_t> params(100, 1);
+  packet->InsertParams(params);
+  EXPECT_EQ(packet->Payload(), payload);
+  EXPECT_EQ(packet->GetRealSize(), 9100u);
+
+  delete packet;
+  EXPECT_EQ(pool->CachedBytes(), capacity);
+
+  // moved payload belongs to the caller, nothing goes back to the pool
+  packet = new MediaPacket();
+  packet->AllocatePacket(pool, 10000);
+  char *moved = packet->MovePayload();
+  delete packet;
+  EXPECT_EQ(pool->CachedBytes(), 0u);
+  free(moved);
+}
+
+TEST_F(MediaPacketPoolTest, SameDataAsLegacyPath) {
+  MediaPacketPool::Ptr pool = std::make_shared<MediaPacketPool>();
+  for (size_t i = 0; i < 2; i++) {
+    MediaPacket *legacy = CacheSample(nullptr, sample_sizes_[i], i == 0);
+    MediaPacket *pooled = CacheSample(pool, sample_sizes_[i], i == 0);
+    EXPECT_EQ(pooled->GetRealSize(), legacy->GetRealSize());
+    EXPECT_EQ(memcmp(pooled->Payload(), legacy->Payload(), legacy->GetRealSize()), 0);
+    // the parameter sets fit in the pooled buffer without reallocation
+    EXPECT_TRUE(pooled->AllocatedSize() >= pooled->GetRealSize());
+    EXPECT_TRUE(pooled->AllocatedSize() < legacy->AllocatedSize());
+    delete legacy;
+    delete pooled;
+  }
+}
+
+TEST_F(MediaPacketPoolTest, PoolHoldsLessPayload) {
+  size_t legacyBytes = 0;
+  size_t poolBytes = 0;
+  RunSegments(false, legacyBytes);
+  RunSegments(true, poolBytes);
+  EXPECT_TRUE(poolBytes < legacyBytes);
+}
+
+TEST_F(MediaPacketPoolTest, Benchmark) {
+  if (!VCD::PerfBench::Enabled()) return;
+
+  size_t legacyBytes = 0;
+  size_t poolBytes = 0;
+  double legacyMs = VCD::PerfBench::MeasureMs([&]() { RunSegments(false, legacyBytes); });
+  double poolMs = VCD::PerfBench::MeasureMs([&]() { RunSegments(true, poolBytes); });
+  // payload bytes the packets and pools hold, not the process RSS
+  VCD::PerfBench::PerfReport("MediaPacketPool")
+      .Add("tracks", static_cast<uint64_t>(kTrackNum))
+      .Add("segments", static_cast<uint64_t>(kSegmentNum))
+      .Add("legacy_ms", legacyMs)
+      .Add("pool_ms", poolMs)
+      .Add("legacy_payload_kb", static_cast<uint64_t>(legacyBytes / 1024))
+      .Add("pool_payload_kb", static_cast<uint64_t>(poolBytes / 1024))
+      .Print();
+}
+
+}  // namespace
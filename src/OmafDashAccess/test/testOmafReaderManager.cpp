@@ -31,11 +31,16 @@
 //! Created on July 17, 2019, 6:04 AM
 //!
 
+#include "../CmafSegment.h"
 #include "../OmafDashSource.h"
 #include "../OmafReader.h"
 #include "../OmafReaderManager.h"
 #include "gtest/gtest.h"
 
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
 VCD_USE_VROMAF;
 VCD_USE_VRVIDEO;
 
@@ -311,4 +316,480 @@ TEST_F(OmafReaderManagerTest, ReaderTrackSegments) {
     fpGen = NULL;
   }
 }
+
+// cmaf segment exposing the progressive chunk handling for the tests
+class CmafSegmentProbe : public CmafSegment {
+ public:
+  CmafSegmentProbe(DashSegmentSourceParams params, int segCnt) : CmafSegment(params, segCnt, false) {
+    SetSegmentType(SegmentType_Cmaf);
+  }
+
+  using CmafSegment::HasChunkHeader;
+  using CmafSegment::AbortProgressiveChunk;
+
+  void SetChunkSizes(const std::vector<uint32_t> &sizes) {
+    chunk_num_ = sizes.size();
+    for (uint32_t i = 0; i < sizes.size(); i++) {
+      index_range_[i] = sizes[i];
+    }
+  }
+
+  // the bytes arrive from curl, as the data callback of Open does
+  int32_t Receive(const std::vector<char> &bytes, size_t offset, size_t size) {
+    char *buf = new char[size];
+    memcpy_s(buf, size, bytes.data() + offset, size);
+    dash_stream_.push_back(make_unique_vcd<StreamBlock>(buf, size));
+    return GenerateChunkStream();
+  }
+
+  int64_t GetIndexLength() { return index_length_; }
+  std::string GetUrl() { return ds_params_.dash_url_; }
+  std::weak_ptr<OmafSegment> GetProgressiveChunk() { return progressive_chunk_; }
+};
+
+// segment client delivering local segment bytes when the test asks for them
+class LocalSegmentClient : public OmafDashSegmentClient {
+ public:
+  struct _transfer {
+    OnData dcb_;
+    OnChunkData cdcb_;
+    OnState scb_;
+  };
+
+  virtual OMAF_STATUS start() noexcept { return ERROR_NONE; }
+  virtual OMAF_STATUS stop() noexcept { return ERROR_NONE; }
+  virtual OMAF_STATUS open(const SourceParams &ds_params, OnData dcb, OnChunkData cdcb, OnState scb) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    transfers_[ds_params.dash_url_] = {dcb, cdcb, scb};
+    return ERROR_NONE;
+  }
+  virtual OMAF_STATUS remove(const SourceParams &dash_source) noexcept { return ERROR_NONE; }
+  virtual OMAF_STATUS check(const SourceParams &dash_source) noexcept { return ERROR_NONE; }
+  virtual void setStatisticsWindows(int32_t time_window) noexcept {}
+  virtual std::unique_ptr<PerfStatistics> statistics(void) noexcept { return nullptr; }
+
+  void Index(const std::string &url, const std::vector<char> &bytes, size_t size) {
+    map<uint32_t, uint32_t> index_range;
+    getTransfer(url).cdcb_(make_unique_vcd<StreamBlock>(copyBytes(bytes, 0, size), size), index_range);
+  }
+  void Data(const std::string &url, const std::vector<char> &bytes, size_t offset, size_t size) {
+    getTransfer(url).dcb_(make_unique_vcd<StreamBlock>(copyBytes(bytes, offset, size), size));
+  }
+  void End(const std::string &url, State state) { getTransfer(url).scb_(state); }
+
+ private:
+  struct _transfer getTransfer(const std::string &url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return transfers_[url];
+  }
+  static char *copyBytes(const std::vector<char> &bytes, size_t offset, size_t size) {
+    char *buf = new char[size];
+    memcpy_s(buf, size, bytes.data() + offset, size);
+    return buf;
+  }
+
+  std::mutex mutex_;
+  std::map<std::string, struct _transfer> transfers_;
+};
+
+static void appendBox(std::vector<char> &bytes, const char *type, uint32_t size) {
+  const char header[] = {(char)(size >> 24), (char)(size >> 16), (char)(size >> 8), (char)size};
+  bytes.insert(bytes.end(), header, header + 4);
+  bytes.insert(bytes.end(), type, type + 4);
+  bytes.insert(bytes.end(), size - 8, 0);
+}
+
+class CmafProgressiveChunkTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    // styp + moof + mdat of 80 bytes
+    appendBox(chunk_, "styp", 16);
+    appendBox(chunk_, "moof", 24);
+    appendBox(chunk_, "mdat", 40);
+    for (size_t i = 48; i < chunk_.size(); i++) {
+      chunk_[i] = (char)i;
+    }
+  }
+
+  std::shared_ptr<CmafSegmentProbe> createSegment(bool progressive, const std::vector<uint32_t> &sizes) {
+    DashSegmentSourceParams params;
+    params.progressive_parse_ = progressive;
+    params.chunk_info_type_ = ChunkInfoType::CHUNKINFO_SIDX_ONLY;
+    auto segment = std::make_shared<CmafSegmentProbe>(params, 1);
+    segment->SetChunkSizes(sizes);
+    segment->RegisterStateChange([this](std::shared_ptr<OmafSegment> seg, OmafSegment::State state) {
+      states_.push_back(state);
+    });
+    return segment;
+  }
+
+  std::vector<char> chunk_;
+  std::vector<OmafSegment::State> states_;
+};
+
+TEST_F(CmafProgressiveChunkTest, ChunkHeaderNeedsMoofBeforeMdat) {
+  auto segment = createSegment(false, {80});
+  segment->Receive(chunk_, 0, 30);
+  EXPECT_FALSE(segment->HasChunkHeader(0, 30));
+  segment->Receive(chunk_, 30, 18);
+  EXPECT_TRUE(segment->HasChunkHeader(0, 48));
+  // styp/prft are optional before the moof
+  EXPECT_TRUE(segment->HasChunkHeader(16, 32));
+  // an mdat without moof is no chunk header
+  EXPECT_FALSE(segment->HasChunkHeader(40, 8));
+
+  // moof with 64 bits size
+  std::vector<char> large;
+  appendBox(large, "moof", 32);
+  large[3] = 1;
+  large[15] = 32;
+  appendBox(large, "mdat", 16);
+  auto largeSegment = createSegment(false, {48});
+  largeSegment->Receive(large, 0, 40);
+  EXPECT_TRUE(largeSegment->HasChunkHeader(0, 40));
+  EXPECT_FALSE(largeSegment->HasChunkHeader(0, 12));
+
+  // broken box size
+  std::vector<char> broken;
+  appendBox(broken, "free", 8);
+  broken[3] = 4;
+  appendBox(broken, "moof", 8);
+  appendBox(broken, "mdat", 8);
+  auto brokenSegment = createSegment(false, {24});
+  brokenSegment->Receive(broken, 0, 24);
+  EXPECT_FALSE(brokenSegment->HasChunkHeader(0, 24));
+}
+
+TEST_F(CmafProgressiveChunkTest, ProgressiveChunkBeforeMdatCompletes) {
+  std::vector<char> bytes(chunk_);
+  bytes.insert(bytes.end(), chunk_.begin(), chunk_.end());
+  auto segment = createSegment(true, {80, 80});
+
+  // the moof is incomplete yet
+  EXPECT_EQ(segment->Receive(bytes, 0, 30), ERROR_NONE);
+  EXPECT_TRUE(states_.empty());
+  EXPECT_TRUE(segment->PopProgressiveChunk() == nullptr);
+
+  // StartProgressiveChunk: the chunk is handed out with the mdat header
+  EXPECT_EQ(segment->Receive(bytes, 30, 30), ERROR_NONE);
+  ASSERT_EQ(states_.size(), 1u);
+  EXPECT_EQ(states_[0], OmafSegment::State::OPEN_SUCCES);
+  OmafSegment::Ptr chunk = segment->PopProgressiveChunk();
+  ASSERT_TRUE(chunk != nullptr);
+  EXPECT_TRUE(segment->PopProgressiveChunk() == nullptr);
+  EXPECT_TRUE(segment->PopOneStreamBlock() == nullptr);
+  EXPECT_TRUE(chunk->IsProgressive());
+  EXPECT_EQ(chunk->GetState(), OmafSegment::State::OPEN_SUCCES);
+  EXPECT_EQ(chunk->GetStreamSize(), 80);
+  EXPECT_EQ(chunk->GetAvailableSize(), 60);
+  EXPECT_EQ(segment->GetProcessedChunkId(), 0);
+
+  // FeedProgressiveChunk: the rest of the mdat wakes up the parser
+  EXPECT_EQ(segment->Receive(bytes, 60, 20), ERROR_NONE);
+  ASSERT_EQ(states_.size(), 2u);
+  EXPECT_EQ(states_[1], OmafSegment::State::OPEN);
+  EXPECT_EQ(chunk->GetAvailableSize(), 80);
+  std::vector<char> read(80);
+  EXPECT_EQ(chunk->ReadStream(read.data(), 80), 80);
+  EXPECT_TRUE(read == chunk_);
+  EXPECT_TRUE(segment->GetProgressiveChunk().lock() == nullptr);
+  EXPECT_FALSE(segment->HasProcessDone());
+
+  // a chunk complete in one piece goes the whole chunk way
+  EXPECT_EQ(segment->Receive(bytes, 80, 80), ERROR_NONE);
+  ASSERT_EQ(states_.size(), 3u);
+  EXPECT_EQ(states_[2], OmafSegment::State::OPEN_SUCCES);
+  EXPECT_TRUE(segment->PopProgressiveChunk() == nullptr);
+  std::unique_ptr<StreamBlock> block = segment->PopOneStreamBlock();
+  ASSERT_TRUE(block != nullptr);
+  EXPECT_EQ(block->size(), 80);
+  EXPECT_TRUE(segment->HasProcessDone());
+}
+
+TEST_F(CmafProgressiveChunkTest, ProgressiveChunkAbortedWhenDownloadEnds) {
+  auto segment = createSegment(true, {80});
+  segment->Receive(chunk_, 0, 50);
+  std::weak_ptr<OmafSegment> chunk = segment->PopProgressiveChunk();
+  ASSERT_FALSE(chunk.expired());
+  states_.clear();
+
+  std::shared_ptr<OmafSegment> parsing = chunk.lock();
+  segment->AbortProgressiveChunk();
+  EXPECT_EQ(parsing->GetState(), OmafSegment::State::OPEN_FAILED);
+  ASSERT_EQ(states_.size(), 1u);
+  EXPECT_EQ(states_[0], OmafSegment::State::OPEN);
+
+  // the segment keeps nothing of the aborted chunk
+  parsing.reset();
+  EXPECT_TRUE(chunk.expired());
+  segment->AbortProgressiveChunk();
+  EXPECT_EQ(states_.size(), 1u);
+}
+
+TEST_F(CmafProgressiveChunkTest, WholeChunkWithoutProgressiveParse) {
+  auto segment = createSegment(false, {80});
+  segment->Receive(chunk_, 0, 60);
+  EXPECT_TRUE(states_.empty());
+  EXPECT_TRUE(segment->PopProgressiveChunk() == nullptr);
+
+  segment->Receive(chunk_, 60, 20);
+  ASSERT_EQ(states_.size(), 1u);
+  EXPECT_EQ(states_[0], OmafSegment::State::OPEN_SUCCES);
+  std::unique_ptr<StreamBlock> block = segment->PopOneStreamBlock();
+  ASSERT_TRUE(block != nullptr);
+  EXPECT_EQ(block->size(), 80);
+}
+
+TEST_F(CmafProgressiveChunkTest, ExtractorModeParsesWholeChunks) {
+  OmafReaderManager::OmafReaderParams params;
+  params.progressive_parse_ = true;
+  params.mode_ = OmafDashMode::EXTRACTOR;
+  OmafReaderManager::Ptr extractorMgr = std::make_shared<OmafReaderManager>(nullptr, params);
+  // the segments are then downloaded with progressive_parse_ off, see WholeChunkWithoutProgressiveParse
+  EXPECT_FALSE(extractorMgr->IsProgressiveParse());
+
+  params.mode_ = OmafDashMode::LATER_BINDING;
+  OmafReaderManager::Ptr laterBindingMgr = std::make_shared<OmafReaderManager>(nullptr, params);
+  EXPECT_TRUE(laterBindingMgr->IsProgressiveParse());
+}
+
+// reader manager parsing the chunks of local cmaf segments while they arrive
+class OmafReaderManagerProgressiveTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    m_clientInfo = new HeadSetInfo;
+    m_clientInfo->pose = new HeadPose;
+    m_clientInfo->pose->yaw = -90;
+    m_clientInfo->pose->pitch = 0;
+    m_clientInfo->viewPort_hFOV = 80;
+    m_clientInfo->viewPort_vFOV = 90;
+    m_clientInfo->viewPort_Width = 1024;
+    m_clientInfo->viewPort_Height = 1024;
+
+    m_source = new OmafDashSource();
+    if (!m_source) return;
+    int ret = m_source->SetupHeadSetInfo(m_clientInfo);
+    if (ret) return;
+
+    PluginDef i360ScvpPlugin;
+    i360ScvpPlugin.pluginLibPath = NULL;
+    ret = m_source->OpenMedia("./segs_for_cmaftest/Test.mpd", "./cache", NULL, i360ScvpPlugin, false, false);
+    if (ret) {
+      printf("Failed to open media \n");
+      return;
+    }
+
+    m_client = std::make_shared<LocalSegmentClient>();
+    OmafReaderManager::OmafReaderParams params;
+    params.duration_ = 1000;
+    params.mode_ = OmafDashMode::LATER_BINDING;
+    params.stream_type_ = DASH_STREAM_STATIC;
+    params.parse_worker_num_ = 2;
+    params.progressive_parse_ = true;
+    m_readerMgr = std::make_shared<OmafReaderManager>(m_client, params);
+    ret = m_readerMgr->Initialize(m_source);
+    EXPECT_TRUE(ret == ERROR_NONE);
+    m_opened = (ret == ERROR_NONE);
+  }
+
+  virtual void TearDown() {
+    if (m_readerMgr) m_readerMgr->Close();
+    delete (m_clientInfo->pose);
+    m_clientInfo->pose = NULL;
+    delete m_clientInfo;
+    m_clientInfo = NULL;
+    m_source->CloseMedia();
+    SAFE_DELETE(m_source);
+  }
+
+  static bool readFile(const std::string &name, std::vector<char> &bytes) {
+    std::ifstream file(name, std::ios::binary);
+    if (!file) return false;
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !bytes.empty();
+  }
+
+  // opens the init segments of the first two tile tracks
+  bool openInitSegments() {
+    if (!m_opened || m_source->GetStreamCount() < 1) return false;
+    std::map<int, OmafAdaptationSet *> normalAS = m_source->GetStream(0)->GetMediaAdaptationSet();
+    for (auto itAS = normalAS.begin(); itAS != normalAS.end() && m_tracks.size() < 2; itAS++) {
+      OmafAdaptationSet *pAS = itAS->second;
+      std::string initName = "./segs_for_cmaftest/" + pAS->GetRepresentationId() + ".init.mp4";
+      std::vector<char> bytes;
+      if (!readFile(initName, bytes)) return false;
+      if (pAS->LoadAssignedInitSegment(initName) != ERROR_NONE) return false;
+      OmafSegment::Ptr initSeg = pAS->GetInitSegment();
+      initSeg->SetSegSize(bytes.size());
+      if (m_readerMgr->OpenLocalInitSegment(initSeg) != ERROR_NONE) return false;
+      pAS->Enable(true);
+      m_tracks.push_back(pAS);
+    }
+    for (int i = 0; i < 100 && !m_readerMgr->IsInitSegmentsParsed(); i++) usleep(10000);
+    return m_tracks.size() == 2;
+  }
+
+  // opens the cmaf segment of a track and delivers its index, the media data comes later
+  std::shared_ptr<CmafSegmentProbe> openSegment(OmafAdaptationSet *pAS, uint32_t segID, std::vector<char> &bytes) {
+    char name[1024];
+    snprintf(name, 1024, "./segs_for_cmaftest/%s.%u.mp4", pAS->GetRepresentationId().c_str(), segID);
+    if (!readFile(name, bytes)) return nullptr;
+
+    DashSegmentSourceParams params;
+    params.dash_url_ = name;
+    params.timeline_point_ = segID;
+    params.chunk_num_ = (pAS->GetChunkDuration() == 0) ? 1 : pAS->GetSegmentDuration() * 1000 / pAS->GetChunkDuration();
+    params.chunk_info_type_ = pAS->GetChunkInfoType();
+    params.enable_byte_range_ = true;
+    params.stream_type_ = DASH_STREAM_STATIC;
+    params.progressive_parse_ = m_readerMgr->IsProgressiveParse();
+    auto segment = std::make_shared<CmafSegmentProbe>(params, segID);
+    segment->SetInitSegID(pAS->GetInitSegment()->GetInitSegID());
+    segment->SetTrackId(pAS->GetInitSegment()->GetTrackId());
+    segment->SetSegID(segID);
+    segment->SetMediaType(MediaType_Video);
+    segment->SetQualityRanking(pAS->GetRepresentationQualityRanking());
+    if (m_readerMgr->OpenSegment(segment) != ERROR_NONE) return nullptr;
+    m_client->Index(name, bytes, segment->GetIndexLength());
+    return segment;
+  }
+
+  MediaPacket *waitPacket(uint32_t trackNumber, bool requireParams) {
+    MediaPacket *packet = nullptr;
+    for (int i = 0; i < 200; i++) {
+      if (m_readerMgr->GetNextPacket(trackNumber, packet, requireParams) == ERROR_NONE && packet) return packet;
+      usleep(10000);
+    }
+    return nullptr;
+  }
+
+  HeadSetInfo *m_clientInfo = nullptr;
+  OmafMediaSource *m_source = nullptr;
+  std::shared_ptr<LocalSegmentClient> m_client;
+  OmafReaderManager::Ptr m_readerMgr;
+  std::vector<OmafAdaptationSet *> m_tracks;
+  bool m_opened = false;
+};
+
+TEST_F(OmafReaderManagerProgressiveTest, PacketsReleasedInOrderBeforeSegmentCompletes) {
+  if (!openInitSegments()) return;
+  OmafAdaptationSet *pAS = m_tracks[0];
+  std::vector<char> bytes;
+  std::shared_ptr<CmafSegmentProbe> segment = openSegment(pAS, 1, bytes);
+  ASSERT_TRUE(segment != nullptr);
+  const std::string url = segment->GetUrl();
+  const size_t dataSize = bytes.size() - segment->GetIndexLength();
+  const size_t step = 1024;
+
+  std::vector<uint64_t> pts;
+  size_t early = 0;
+  bool requireParams = true;
+  size_t pushed = 0;
+  while (pushed < dataSize) {
+    size_t size = std::min(step, dataSize - pushed);
+    m_client->Data(url, bytes, segment->GetIndexLength() + pushed, size);
+    pushed += size;
+    usleep(1000);
+    // drain what the received bytes released, without waiting on the incomplete sample
+    MediaPacket *packet = nullptr;
+    while (m_readerMgr->GetNextPacket(pAS->GetTrackNumber(), packet, requireParams) == ERROR_NONE && packet) {
+      if (pushed < dataSize) {
+        EXPECT_FALSE(segment->HasProcessDone());
+        early++;
+      }
+      pts.push_back(packet->GetPTS());
+      requireParams = false;
+      delete packet;
+      packet = nullptr;
+    }
+  }
+  m_client->End(url, OmafDashSegmentClient::State::SUCCESS);
+  MediaPacket *packet = nullptr;
+  while ((packet = waitPacket(pAS->GetTrackNumber(), requireParams)) != nullptr && !packet->GetEOS()) {
+    pts.push_back(packet->GetPTS());
+    requireParams = false;
+    delete packet;
+  }
+  delete packet;
+
+  // packets came out before the segment completed, all in presentation order
+  EXPECT_GT(early, 0u);
+  EXPECT_GT(pts.size(), early);
+  for (size_t i = 1; i < pts.size(); i++) {
+    EXPECT_LT(pts[i - 1], pts[i]);
+  }
+}
+
+TEST_F(OmafReaderManagerProgressiveTest, IncompleteNodeKeepsPacketOrder) {
+  if (!openInitSegments()) return;
+  OmafAdaptationSet *pAS = m_tracks[0];
+  std::vector<char> bytes;
+  std::shared_ptr<CmafSegmentProbe> segment = openSegment(pAS, 1, bytes);
+  ASSERT_TRUE(segment != nullptr);
+  const std::string url = segment->GetUrl();
+  const size_t indexSize = segment->GetIndexLength();
+  const size_t dataSize = bytes.size() - indexSize;
+
+  // the first half of the segment releases the leading packets only
+  m_client->Data(url, bytes, indexSize, dataSize / 2);
+  MediaPacket *first = waitPacket(pAS->GetTrackNumber(), true);
+  ASSERT_TRUE(first != nullptr);
+  const uint64_t firstPts = first->GetPTS();
+  delete first;
+  MediaPacket *packet = nullptr;
+  uint64_t lastPts = firstPts;
+  while (m_readerMgr->GetNextPacket(pAS->GetTrackNumber(), packet, false) == ERROR_NONE && packet) {
+    lastPts = packet->GetPTS();
+    delete packet;
+    packet = nullptr;
+  }
+
+  // the emptied node is incomplete, GetNextPacket stops at it instead of popping it
+  EXPECT_EQ(m_readerMgr->GetNextPacket(pAS->GetTrackNumber(), packet, false), ERROR_NULL_PACKET);
+  EXPECT_TRUE(packet == nullptr);
+
+  // the requeued node resumes on its reader with the rest of the bytes
+  m_client->Data(url, bytes, indexSize + dataSize / 2, dataSize - dataSize / 2);
+  m_client->End(url, OmafDashSegmentClient::State::SUCCESS);
+  packet = waitPacket(pAS->GetTrackNumber(), false);
+  ASSERT_TRUE(packet != nullptr);
+  EXPECT_GT(packet->GetPTS(), lastPts);
+  delete packet;
+}
+
+TEST_F(OmafReaderManagerProgressiveTest, DroppedNodeIsAbandoned) {
+  if (!openInitSegments()) return;
+  std::vector<char> bytes;
+  std::shared_ptr<CmafSegmentProbe> segment = openSegment(m_tracks[0], 1, bytes);
+  ASSERT_TRUE(segment != nullptr);
+  const std::string url = segment->GetUrl();
+  const size_t indexSize = segment->GetIndexLength();
+
+  // the first track stops in the middle of its first chunk
+  m_client->Data(url, bytes, indexSize, (bytes.size() - indexSize) / 2);
+  MediaPacket *packet = waitPacket(m_tracks[0]->GetTrackNumber(), true);
+  ASSERT_TRUE(packet != nullptr);
+  delete packet;
+  std::weak_ptr<OmafSegment> chunk = segment->GetProgressiveChunk();
+  ASSERT_FALSE(chunk.expired());
+
+  // the second track moves the timeline on, which drops the partially parsed node
+  std::vector<char> nextBytes;
+  std::shared_ptr<CmafSegmentProbe> nextSegment = openSegment(m_tracks[1], 3, nextBytes);
+  ASSERT_TRUE(nextSegment != nullptr);
+  m_client->Data(nextSegment->GetUrl(), nextBytes, nextSegment->GetIndexLength(),
+                 nextBytes.size() - nextSegment->GetIndexLength());
+  m_client->End(nextSegment->GetUrl(), OmafDashSegmentClient::State::SUCCESS);
+  packet = waitPacket(m_tracks[1]->GetTrackNumber(), true);
+  ASSERT_TRUE(packet != nullptr);
+  delete packet;
+
+  // once its download stops nothing holds the chunk anymore
+  m_client->End(url, OmafDashSegmentClient::State::STOPPED);
+  std::weak_ptr<OmafSegment> dropped = segment;
+  segment.reset();
+  for (int i = 0; i < 100 && !chunk.expired(); i++) usleep(10000);
+  EXPECT_TRUE(chunk.expired());
+  EXPECT_TRUE(dropped.expired());
+}
 }  // namespace
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testStreamBlocks.cpp
+//! \brief:  stream blocks unit test and benchmark, the benchmark runs with VR_PERF_BENCH set
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafDashDownload/Stream.h"
+#include "../../utils/PerfBench.h"
+
+#include <random>
+
+VCD_USE_VROMAF;
+
+namespace {
+
+// curl delivers the body in callbacks of at most 16KB
+const int64_t kCallbackSize = 16 * 1024;
+const uint32_t kMoofSize = 8 * 1024;
+// a few small fragments for the unit tests, a full segment for the benchmark
+const int kFragmentNum = 4;
+const uint32_t kMdatSize = 64 * 1024;
+const int kBenchFragmentNum = 60;
+const uint32_t kBenchMdatSize = 800 * 1024;
+
+class StreamBlocksTest : public testing::Test {
+ public:
+  virtual void SetUp() { buildSegment(kFragmentNum, kMdatSize); }
+
+  virtual void TearDown() {}
+
+  // moof/mdat pairs like a multi-fragment segment
+  void buildSegment(int fragmentNum, uint32_t mdatSize) {
+    segment_.clear();
+    for (int i = 0; i < fragmentNum; i++) {
+      appendBox("moof", kMoofSize);
+      appendBox("mdat", mdatSize);
+    }
+  }
+
+  void appendBox(const char *type, uint32_t size) {
+    size_t pos = segment_.size();
+    segment_.resize(pos + size);
+    for (uint32_t i = 0; i < size; i++) {
+      segment_[pos + i] = static_cast<char>((pos + i) * 131);
+    }
+    segment_[pos] = static_cast<char>(size >> 24);
+    segment_[pos + 1] = static_cast<char>(size >> 16);
+    segment_[pos + 2] = static_cast<char>(size >> 8);
+    segment_[pos + 3] = static_cast<char>(size);
+    memcpy_s(&segment_[pos + 4], 4, type, 4);
+  }
+
+  void deliver(StreamBlocks &blocks, int64_t blockSize) {
+    for (size_t pos = 0; pos < segment_.size(); pos += blockSize) {
+      int64_t size = std::min<int64_t>(blockSize, segment_.size() - pos);
+      std::unique_ptr<StreamBlock> sb = make_unique_vcd<StreamBlock>();
+      memcpy_s(static_cast<char *>(sb->resize(size)), size, &segment_[pos], size);
+      sb->size(size);
+      blocks.push_back(std::move(sb));
+    }
+  }
+
+  // the list walk StreamBlocks did before the offset index
+  static int64_t linearRead(StreamBlocks &blocks, int64_t offset, char *buffer, int64_t size) {
+    auto it = blocks.stream_blocks_.cbegin();
+    while (it != blocks.stream_blocks_.cend() && offset >= (*it)->size()) {
+      offset -= (*it)->size();
+      ++it;
+    }
+    int64_t readSize = 0;
+    for (; it != blocks.stream_blocks_.cend() && readSize < size; ++it) {
+      int64_t copySize = std::min((*it)->size() - offset, size - readSize);
+      memcpy_s(buffer + readSize, copySize, (*it)->cbuf() + offset, copySize);
+      readSize += copySize;
+      offset = 0;
+    }
+    return readSize;
+  }
+
+  // walk the boxes, reading moof field by field and skipping mdat
+  template <typename ReadFunc>
+  void parse(ReadFunc read, uint64_t &checksum) {
+    int64_t offset = 0;
+    char field[8];
+    while (offset < static_cast<int64_t>(segment_.size())) {
+      read(offset, field, 8);
+      uint32_t boxSize = (uint32_t(uint8_t(field[0])) << 24) | (uint32_t(uint8_t(field[1])) << 16) |
+                         (uint32_t(uint8_t(field[2])) << 8) | uint32_t(uint8_t(field[3]));
+      if (memcmp(field + 4, "moof", 4) == 0) {
+        for (int64_t pos = offset + 8; pos + 4 <= offset + boxSize; pos += 4) {
+          read(pos, field, 4);
+          checksum += uint8_t(field[0]);
+        }
+      }
+      offset += boxSize;
+    }
+  }
+
+  static void indexRead(StreamBlocks &blocks, int64_t offset, char *buffer, int64_t size) {
+    blocks.SeekAbsoluteOffset(offset);
+    blocks.ReadStream(buffer, size);
+  }
+
+  std::vector<char> segment_;
+};
+
+TEST_F(StreamBlocksTest, ReadAtAnyOffset) {
+  StreamBlocks blocks;
+  deliver(blocks, 1000);
+  EXPECT_EQ(blocks.GetStreamSize(), static_cast<int64_t>(segment_.size()));
+
+  std::mt19937 gen(2020);
+  std::uniform_int_distribution<int64_t> offset_dist(0, segment_.size() - 1);
+  std::vector<char> buffer(5000);
+  for (int i = 0; i < 1000; i++) {
+    int64_t offset = offset_dist(gen);
+    int64_t size = std::min<int64_t>(buffer.size(), segment_.size() - offset);
+    EXPECT_TRUE(blocks.SeekAbsoluteOffset(offset));
+    ASSERT_EQ(blocks.ReadStream(buffer.data(), buffer.size()), size);
+    ASSERT_EQ(memcmp(buffer.data(), &segment_[offset], size), 0);
+    EXPECT_EQ(blocks.TellOffset(), offset + size);
+  }
+
+  // reading at the end or out of the stream gives nothing
+  blocks.SeekAbsoluteOffset(segment_.size());
+  EXPECT_EQ(blocks.ReadStream(buffer.data(), 1), 0);
+  EXPECT_EQ(blocks.ReadStreamFromOffset(buffer.data(), segment_.size() - 1, 2), 0);
+}
+
+TEST_F(StreamBlocksTest, PopFrontMovesStreamStart) {
+  StreamBlocks blocks;
+  deliver(blocks, 1000);
+  std::unique_ptr<StreamBlock> sb = blocks.pop_front();
+  EXPECT_EQ(sb->size(), 1000);
+  sb = blocks.pop_front();
+
+  char buffer[1500];
+  EXPECT_EQ(blocks.ReadStreamFromOffset(buffer, 500, sizeof(buffer)), static_cast<int64_t>(sizeof(buffer)));
+  EXPECT_EQ(memcmp(buffer, &segment_[2500], sizeof(buffer)), 0);
+
+  blocks.clear();
+  EXPECT_EQ(blocks.GetStreamSize(), 0);
+  deliver(blocks, 4096);
+  EXPECT_EQ(blocks.ReadStreamFromOffset(buffer, 0, sizeof(buffer)), static_cast<int64_t>(sizeof(buffer)));
+  EXPECT_EQ(memcmp(buffer, &segment_[0], sizeof(buffer)), 0);
+}
+
+TEST_F(StreamBlocksTest, IndexedParseMatchesLinear) {
+  // odd sized blocks split the box fields between blocks
+  int64_t blockSizes[] = {kCallbackSize, 1000};
+  for (int64_t blockSize : blockSizes) {
+    StreamBlocks blocks;
+    deliver(blocks, blockSize);
+
+    uint64_t linearSum = 0;
+    uint64_t indexSum = 0;
+    parse([&blocks](int64_t offset, char *buf, int64_t size) { linearRead(blocks, offset, buf, size); }, linearSum);
+    parse([&blocks](int64_t offset, char *buf, int64_t size) { indexRead(blocks, offset, buf, size); }, indexSum);
+    EXPECT_TRUE(linearSum != 0);
+    EXPECT_EQ(linearSum, indexSum);
+  }
+}
+
+TEST_F(StreamBlocksTest, Benchmark) {
+  if (!VCD::PerfBench::Enabled()) return;
+
+  buildSegment(kBenchFragmentNum, kBenchMdatSize);
+  StreamBlocks blocks;
+  deliver(blocks, kCallbackSize);
+
+  uint64_t linearSum = 0;
+  uint64_t indexSum = 0;
+  double linearMs = VCD::PerfBench::MeasureMs([&]() {
+    parse([&blocks](int64_t offset, char *buf, int64_t size) { linearRead(blocks, offset, buf, size); }, linearSum);
+  });
+  double indexMs = VCD::PerfBench::MeasureMs([&]() {
+    parse([&blocks](int64_t offset, char *buf, int64_t size) { indexRead(blocks, offset, buf, size); }, indexSum);
+  });
+  VCD::PerfBench::PerfReport("StreamBlocks")
+      .Add("segment_kb", static_cast<uint64_t>(segment_.size() / 1024))
+      .Add("blocks", static_cast<uint64_t>(blocks.GetStreamBlockSize()))
+      .Add("linear_ms", linearMs)
+      .Add("index_ms", indexMs)
+      .Print();
+  EXPECT_EQ(linearSum, indexSum);
+}
+
+}  // namespace
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testStreamSpans.cpp
+//! \brief:  zero-copy sample spans unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../MediaPacket.h"
+#include "../OmafDashDownload/Stream.h"
+
+VCD_USE_VROMAF;
+
+namespace {
+
+class StreamSpansTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    // two NAL units of 6 and 3 bytes, split over three downloaded blocks
+    const char sample[] = {0, 0, 0, 2, 0x26, 0x01, 0, 0, 0, 1, 0x40};
+    sample_.assign(sample, sample + sizeof(sample));
+    pushBlock(sample_.data(), 3);
+    pushBlock(sample_.data() + 3, 5);
+    pushBlock(sample_.data() + 8, 3);
+  }
+
+  virtual void TearDown() {}
+
+  void pushBlock(const char *data, int64_t size) {
+    std::unique_ptr<StreamBlock> sb = make_unique_vcd<StreamBlock>();
+    memcpy_s(static_cast<char *>(sb->resize(size)), size, data, size);
+    sb->size(size);
+    blocks_.push_back(std::move(sb));
+  }
+
+  std::vector<char> sample_;
+  StreamBlocks blocks_;
+};
+
+TEST_F(StreamSpansTest, SpansCoverRange) {
+  std::vector<VCD::MP4::StreamSpan> spans;
+  EXPECT_TRUE(blocks_.GetStreamSpans(2, 7, spans));
+  ASSERT_EQ(spans.size(), 3u);
+  EXPECT_EQ(spans[0].data, blocks_.stream_blocks_.front()->cbuf() + 2);
+  EXPECT_EQ(spans[0].size, 1);
+  EXPECT_EQ(spans[1].size, 5);
+  EXPECT_EQ(spans[2].size, 1);
+
+  // the read position is not touched
+  EXPECT_EQ(blocks_.TellOffset(), 0);
+
+  // ranges not fully downloaded are refused
+  EXPECT_FALSE(blocks_.GetStreamSpans(8, 4, spans));
+  EXPECT_TRUE(spans.empty());
+}
+
+TEST_F(StreamSpansTest, PacketCopiesOnlyOnDemand) {
+  MediaPacketPool::Ptr pool = std::make_shared<MediaPacketPool>();
+  std::shared_ptr<int> holder = std::make_shared<int>(0);
+  std::vector<VCD::MP4::StreamSpan> spans;
+  ASSERT_TRUE(blocks_.GetStreamSpans(0, sample_.size(), spans));
+
+  MediaPacket *packet = new MediaPacket();
+  EXPECT_EQ(packet->SetPayloadSpans(pool, spans, holder, true), sample_.size());
+  EXPECT_TRUE(packet->HasPayloadSpans());
+  EXPECT_EQ(packet->Size(), sample_.size());
+  EXPECT_EQ(holder.use_count(), 2);
+  EXPECT_EQ(pool->AllocatedNum(), 0u);
+
+  // the first access copies the data and turns the length prefixes into start codes
+  char *payload = packet->Payload();
+  ASSERT_TRUE(payload != nullptr);
+  EXPECT_FALSE(packet->HasPayloadSpans());
+  EXPECT_EQ(holder.use_count(), 1);
+  const char expected[] = {0, 0, 0, 1, 0x26, 0x01, 0, 0, 0, 1, 0x40};
+  EXPECT_EQ(memcmp(payload, expected, sizeof(expected)), 0);
+  EXPECT_EQ(packet->Size(), sizeof(expected));
+
+  // the source blocks stay untouched
+  EXPECT_EQ(spans[1].data[0], 2);
+  delete packet;
+}
+
+TEST_F(StreamSpansTest, CopyPayloadFromSpans) {
+  std::shared_ptr<int> holder = std::make_shared<int>(0);
+  std::vector<VCD::MP4::StreamSpan> spans;
+  ASSERT_TRUE(blocks_.GetStreamSpans(0, sample_.size(), spans));
+
+  MediaPacket *packet = new MediaPacket();
+  packet->SetPayloadSpans(nullptr, spans, holder, true);
+  EXPECT_EQ(packet->FirstNalSize(), 6u);
+
+  // ranges starting inside a length prefix get the start code bytes they cover
+  const char expected[] = {0, 0, 0, 1, 0x26, 0x01, 0, 0, 0, 1, 0x40};
+  char dst[sizeof(expected)] = {0};
+  EXPECT_EQ(packet->CopyPayload(2, 7, dst), 7u);
+  EXPECT_EQ(memcmp(dst, expected + 2, 7), 0);
+  EXPECT_EQ(packet->CopyPayload(0, sizeof(dst) + 4, dst), sizeof(dst));
+  EXPECT_EQ(memcmp(dst, expected, sizeof(expected)), 0);
+
+  // reading does not materialize the packet nor touch the source blocks
+  EXPECT_TRUE(packet->HasPayloadSpans());
+  EXPECT_EQ(spans[1].data[0], 2);
+  delete packet;
+}
+
+TEST_F(StreamSpansTest, InsertParamsOnSpans) {
+  std::shared_ptr<int> holder = std::make_shared<int>(0);
+  std::vector<VCD::MP4::StreamSpan> spans;
+  ASSERT_TRUE(blocks_.GetStreamSpans(0, sample_.size(), spans));
+
+  MediaPacket *packet = new MediaPacket();
+  packet->SetPayloadSpans(nullptr, spans, holder, false);
+  std::vector<uint8_t> params(4, 7);
+  packet->InsertParams(params);
+  EXPECT_EQ(packet->Size(), sample_.size() + params.size());
+  EXPECT_EQ(packet->Payload()[0], 7);
+  EXPECT_EQ(memcmp(packet->Payload() + params.size(), sample_.data(), sample_.size()), 0);
+  delete packet;
+  EXPECT_EQ(holder.use_count(), 1);
+}
+
+}  // namespace
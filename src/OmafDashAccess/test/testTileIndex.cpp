@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+//!
+//! \file:   testTileIndex.cpp
+//! \brief:  tile index unit test and benchmark, the benchmark runs with VR_PERF_BENCH set
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafTileIndex.h"
+#include "../OmafMediaStream.h"
+#include "../../utils/PerfBench.h"
+
+#include <map>
+
+VCD_USE_VROMAF;
+
+namespace {
+
+// 8K ERP with 48x24 high quality tiles and 12x6 low quality tiles
+const int32_t kTileSize = 160;
+const int32_t kHighTileCols = 48;
+const int32_t kHighTileRows = 24;
+const int32_t kLowTileCols = 12;
+const int32_t kLowTileRows = 6;
+const int32_t kViewportTiles = 96;
+// the unit test compares a few poses, the benchmark runs all of them
+const int kCheckPoseNum = 100;
+const int kPoseNum = 2000;
+
+struct TileTrack {
+  uint32_t qualityRanking;
+  int32_t faceId;
+  int32_t x;
+  int32_t y;
+};
+
+// adaptation sets are only used as keys here
+OmafAdaptationSet *FakeAdaptationSet(int id) { return reinterpret_cast<OmafAdaptationSet *>(static_cast<uintptr_t>(id) * 16); }
+
+class TileIndexTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    int id = 1;
+    for (int32_t row = 0; row < kHighTileRows; row++) {
+      for (int32_t col = 0; col < kHighTileCols; col++) {
+        tracks_[id++] = {HIGHEST_QUALITY_RANKING, 0, col * kTileSize, row * kTileSize};
+      }
+    }
+    for (int32_t row = 0; row < kLowTileRows; row++) {
+      for (int32_t col = 0; col < kLowTileCols; col++) {
+        tracks_[id++] = {SECOND_QUALITY_RANKING, 0, col * kTileSize, row * kTileSize};
+      }
+    }
+    for (auto &it : tracks_) {
+      index_.Add(it.second.qualityRanking, it.second.faceId, it.second.x, it.second.y, FakeAdaptationSet(it.first));
+    }
+  }
+
+  virtual void TearDown() {}
+
+  // tiles in the viewport of one pose, a 12x8 window moving over the high quality tiles
+  void ViewportTiles(int pose, std::vector<TileTrack> &tiles) {
+    tiles.clear();
+    int32_t startCol = (pose * 7) % kHighTileCols;
+    int32_t startRow = (pose * 3) % (kHighTileRows - 8);
+    for (int32_t i = 0; i < kViewportTiles; i++) {
+      int32_t col = (startCol + i % 12) % kHighTileCols;
+      int32_t row = startRow + i / 12;
+      tiles.push_back({HIGHEST_QUALITY_RANKING, 0, col * kTileSize, row * kTileSize});
+    }
+  }
+
+  // copy the adaptation sets and go through all of them for each tile in viewport
+  void ScanSelect(int poseNum, std::vector<OmafAdaptationSet *> &selected) {
+    std::vector<TileTrack> tiles;
+    selected.clear();
+    for (int pose = 0; pose < poseNum; pose++) {
+      ViewportTiles(pose, tiles);
+      std::map<int, TileTrack> asMap = tracks_;
+      for (auto &tile : tiles) {
+        for (auto &it : asMap) {
+          if (it.second.qualityRanking == tile.qualityRanking && it.second.x == tile.x && it.second.y == tile.y) {
+            selected.push_back(FakeAdaptationSet(it.first));
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  void IndexSelect(int poseNum, std::vector<OmafAdaptationSet *> &selected) {
+    std::vector<TileTrack> tiles;
+    selected.clear();
+    for (int pose = 0; pose < poseNum; pose++) {
+      ViewportTiles(pose, tiles);
+      for (auto &tile : tiles) {
+        OmafAdaptationSet *as = index_.Find(tile.qualityRanking, tile.faceId, tile.x, tile.y);
+        if (as) selected.push_back(as);
+      }
+    }
+  }
+
+  std::map<int, TileTrack> tracks_;
+  OmafTileIndex index_;
+};
+
+TEST_F(TileIndexTest, FindTile) {
+  EXPECT_EQ(index_.Size(), tracks_.size());
+  EXPECT_EQ(index_.Find(HIGHEST_QUALITY_RANKING, 0, 0, 0), FakeAdaptationSet(1));
+  EXPECT_EQ(index_.Find(HIGHEST_QUALITY_RANKING, 0, kTileSize, kTileSize), FakeAdaptationSet(kHighTileCols + 2));
+  EXPECT_EQ(index_.Find(SECOND_QUALITY_RANKING, 0, 0, 0), FakeAdaptationSet(kHighTileCols * kHighTileRows + 1));
+  EXPECT_TRUE(index_.Find(SECOND_QUALITY_RANKING, 0, kLowTileCols * kTileSize, 0) == nullptr);
+  EXPECT_TRUE(index_.Find(HIGHEST_QUALITY_RANKING, 1, 0, 0) == nullptr);
+  EXPECT_TRUE(index_.Find(THIRD_QUALITY_RANKING, 0, 0, 0) == nullptr);
+}
+
+TEST_F(TileIndexTest, AdaptationSetsOfQuality) {
+  const std::vector<OmafAdaptationSet *> &lowSets = index_.GetAdaptationSets(SECOND_QUALITY_RANKING);
+  EXPECT_EQ(lowSets.size(), static_cast<size_t>(kLowTileCols * kLowTileRows));
+  EXPECT_EQ(lowSets.front(), FakeAdaptationSet(kHighTileCols * kHighTileRows + 1));
+  EXPECT_TRUE(index_.GetAdaptationSets(THIRD_QUALITY_RANKING).empty());
+
+  // the first added one is kept for the same position
+  OmafTileIndex index;
+  index.Add(HIGHEST_QUALITY_RANKING, 2, 320, 160, FakeAdaptationSet(5));
+  index.Add(HIGHEST_QUALITY_RANKING, 2, 320, 160, FakeAdaptationSet(6));
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 2, 320, 160), FakeAdaptationSet(5));
+  EXPECT_EQ(index.GetAdaptationSets(HIGHEST_QUALITY_RANKING).size(), 2u);
+  index.Clear();
+  EXPECT_EQ(index.Size(), 0u);
+}
+
+TEST_F(TileIndexTest, IndexSelectsSameTilesAsScan) {
+  std::vector<OmafAdaptationSet *> scanSelected;
+  std::vector<OmafAdaptationSet *> indexSelected;
+  ScanSelect(kCheckPoseNum, scanSelected);
+  IndexSelect(kCheckPoseNum, indexSelected);
+  EXPECT_EQ(indexSelected.size(), static_cast<size_t>(kCheckPoseNum * kViewportTiles));
+  EXPECT_TRUE(scanSelected == indexSelected);
+}
+
+// 2880x1920 cube map in 3x2 faces of 960x960, 480x480 tiles
+const int32_t kFaceSize = 960;
+const int32_t kCubeTileSize = 480;
+
+// tile track of a cube map with the fields the stream reads from the mpd
+class CubeTileAdaptationSet : public OmafAdaptationSet {
+ public:
+  CubeTileAdaptationSet(int id, int qualityRanking, int32_t x, int32_t y) {
+    char srd[64];
+    snprintf(srd, sizeof(srd), "0,%d,%d,%d,%d", x, y, kCubeTileSize, kCubeTileSize);
+    mID = id;
+    mPF = PF_CUBEMAP;
+    mMimeType = "video/mp4";
+    mCodec.push_back("hvc1");
+    mVideoInfo.width = kFaceSize * 3;
+    mVideoInfo.height = kFaceSize * 2;
+    mRepresentation = new RepresentationElement();
+    mRepresentation->SetQualityRanking(std::to_string(qualityRanking));
+    mSRD = new OmafSrd();
+    mSRD->SetInfo(srd);
+    mTileInfo = new TileDef();
+    mTileInfo->x = x;
+    mTileInfo->y = y;
+  }
+
+  virtual ~CubeTileAdaptationSet() {
+    delete mRepresentation;
+    delete mSRD;
+    delete mTileInfo;
+  }
+};
+
+TEST(TileIndexCubeMapTest, StreamIndexesFaceLocalTiles) {
+  OmafMediaStream *stream = new OmafMediaStream();
+  stream->SetDashMode(OmafDashMode::MULTI_VIEW);
+  stream->SetMainAdaptationSet(new CubeTileAdaptationSet(0, 1, 0, 0));
+  int id = 1;
+  for (int32_t y = 0; y < kFaceSize * 2; y += kCubeTileSize) {
+    for (int32_t x = 0; x < kFaceSize * 3; x += kCubeTileSize) {
+      stream->AddAdaptationSet(new CubeTileAdaptationSet(id++, 1, x, y));
+    }
+  }
+  // low quality tiles keep their position in the packed picture
+  stream->AddAdaptationSet(new CubeTileAdaptationSet(id, 2, kFaceSize, kFaceSize));
+  EXPECT_EQ(stream->InitStream("video"), ERROR_NONE);
+
+  const OmafTileIndex &index = stream->GetTileIndex();
+  EXPECT_EQ(index.Size(), 25u);
+  EXPECT_EQ(index.GetAdaptationSets(HIGHEST_QUALITY_RANKING).size(), 24u);
+  // top row faces are not rotated: face 2, 0, 3 from the left
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 2, 0, 0)->GetID(), 1);
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 0, kCubeTileSize, 0)->GetID(), 4);
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 3, 0, kCubeTileSize)->GetID(), 11);
+  // bottom row faces 5 and 4 are rotated, face 1 in the middle is not
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 5, kCubeTileSize, 0)->GetID(), 13);
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 5, 0, kCubeTileSize)->GetID(), 20);
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 1, kCubeTileSize, kCubeTileSize)->GetID(), 22);
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 4, 0, kCubeTileSize)->GetID(), 17);
+  EXPECT_EQ(index.Find(HIGHEST_QUALITY_RANKING, 4, kCubeTileSize, 0)->GetID(), 24);
+  // global positions are not keys of the high quality tiles
+  EXPECT_TRUE(index.Find(HIGHEST_QUALITY_RANKING, 0, kFaceSize, 0) == nullptr);
+  EXPECT_EQ(index.Find(SECOND_QUALITY_RANKING, 0, kFaceSize, kFaceSize)->GetID(), 25);
+
+  delete stream;
+}
+
+TEST_F(TileIndexTest, Benchmark) {
+  if (!VCD::PerfBench::Enabled()) return;
+
+  std::vector<OmafAdaptationSet *> scanSelected;
+  std::vector<OmafAdaptationSet *> indexSelected;
+  double scanMs = VCD::PerfBench::MeasureMs([&]() { ScanSelect(kPoseNum, scanSelected); });
+  double indexMs = VCD::PerfBench::MeasureMs([&]() { IndexSelect(kPoseNum, indexSelected); });
+  EXPECT_TRUE(scanSelected == indexSelected);
+  VCD::PerfBench::PerfReport("TileIndex")
+      .Add("adaptation_sets", static_cast<uint64_t>(tracks_.size()))
+      .Add("poses", static_cast<uint64_t>(kPoseNum))
+      .Add("viewport_tiles", static_cast<uint64_t>(kViewportTiles))
+      .Add("scan_ms", scanMs)
+      .Add("index_ms", indexMs)
+      .Print();
+}
+
+}  // namespace
@@ -118,8 +118,7 @@ ExtractorTrackGenerator::~ExtractorTrackGenerator()
     m_360scvpHandle = NULL;
 }
 
-int32_t ExtractorTrackGenerator::SelectTilesInView(
-    float yaw, float pitch,
+int32_t ExtractorTrackGenerator::SelectTilesInViews(
     uint8_t tileInRow, uint8_t tileInCol)
 {
     if (!m_360scvpParam || !m_360scvpHandle)
@@ -128,32 +127,57 @@ int32_t ExtractorTrackGenerator::SelectTilesInView(
         return OMAF_ERROR_NULL_PTR;
     }
 
-    if ((yaw < -180.0) || (yaw > 180.0))
+    std::vector<HeadPose> poses;
+    for (float one_yaw = -180.0; one_yaw <= 180.0; )
     {
-        OMAF_LOG(LOG_ERROR, "Invalid yaw in selecting tiles based on viewport !\n");
-        return OMAF_ERROR_INVALID_DATA;
-    }
+        for (float one_pitch = -90.0; one_pitch <= 90.0; )
+        {
+            HeadPose pose;
+            memset(&pose, 0, sizeof(HeadPose));
+            pose.yaw = one_yaw;
+            pose.pitch = one_pitch;
+            poses.push_back(pose);
 
-    if ((pitch < -90.0) || (pitch > 90.0))
-    {
-        OMAF_LOG(LOG_ERROR, "Invalid pitch in selecting tiles based on viewport !\n");
-        return OMAF_ERROR_INVALID_DATA;
+            one_pitch += m_pitchStep;
+        }
+
+        one_yaw += m_yawStep;
     }
 
-    int32_t ret = I360SCVP_setViewPort(m_360scvpHandle, yaw, pitch);
+    // the tiles and the content coverage of all the viewports are selected in one call
+    uint32_t poseNum = poses.size();
+    uint32_t totalTiles = tileInRow * tileInCol;
+    std::vector<TileDef> poseTiles(poseNum * totalTiles);
+    std::vector<int32_t> poseTilesNum(poseNum, 0);
+    std::vector<Param_ViewportOutput> poseOutputs(poseNum);
+    std::vector<CCDef> poseCCs(poseNum);
+    int32_t ret = I360SCVP_getTilesInViewportBatch(poses.data(), poseNum, poseTiles.data(), totalTiles,
+                      poseTilesNum.data(), poseOutputs.data(), poseCCs.data(), m_360scvpHandle);
     if (ret)
     {
-        OMAF_LOG(LOG_ERROR, "Failed to set viewport !\n");
-        return OMAF_ERROR_SCVP_SET_FAILED;
+        OMAF_LOG(LOG_ERROR, "Failed to select tiles of all viewports !\n");
+        return OMAF_ERROR_SCVP_PROCESS_FAILED;
     }
 
-    ret = I360SCVP_process(m_360scvpParam, m_360scvpHandle);
-    if (ret)
+    for (uint32_t i = 0; i < poseNum; i++)
     {
-        OMAF_LOG(LOG_ERROR, "Failed in 360SCVP process !\n");
-        return OMAF_ERROR_SCVP_PROCESS_FAILED;
+        ret = SelectTilesInView(&(poseTiles[i * totalTiles]), poseTilesNum[i],
+                  &(poseOutputs[i]), &(poseCCs[i]), tileInRow, tileInCol);
+        if (ret)
+            return ret;
     }
 
+    return ERROR_NONE;
+}
+
+int32_t ExtractorTrackGenerator::SelectTilesInView(
+    TileDef *poseTiles, int32_t selectedTilesNum,
+    Param_ViewportOutput *poseOutput, CCDef *poseCC,
+    uint8_t tileInRow, uint8_t tileInCol)
+{
+    if (!poseTiles || !poseOutput || !poseCC)
+        return OMAF_ERROR_NULL_PTR;
+
     uint64_t totalTiles = tileInRow * tileInCol;
     TileDef *tilesInView = new TileDef[1024];
     if (!tilesInView)
@@ -163,19 +187,17 @@ int32_t ExtractorTrackGenerator::SelectTilesInView(
     }
 
     memset(tilesInView, 0, 1024 * sizeof(TileDef));
-
-    Param_ViewportOutput paramViewport;
-    int32_t selectedTilesNum = 0;
-    selectedTilesNum = I360SCVP_getTilesInViewport(tilesInView, &paramViewport, m_360scvpHandle);
+    if ((selectedTilesNum > 0) && ((uint64_t)(selectedTilesNum) <= totalTiles))
+        memcpy(tilesInView, poseTiles, selectedTilesNum * sizeof(TileDef));
 
     #ifdef _USE_TRACE_
         tracepoint(bandwidth_tp_provider, tiles_selection_redundancy,
-            paramViewport.dstWidthNet,
-            paramViewport.dstHeightNet,
-            paramViewport.dstWidthAlignTile,
-            paramViewport.dstHeightAlignTile,
-            paramViewport.dstWidthAlignTile / (m_initInfo->viewportInfo)->viewportWidth,
-            paramViewport.dstHeightAlignTile / (m_initInfo->viewportInfo)->viewportHeight);
+            poseOutput->dstWidthNet,
+            poseOutput->dstHeightNet,
+            poseOutput->dstWidthAlignTile,
+            poseOutput->dstHeightAlignTile,
+            poseOutput->dstWidthAlignTile / (m_initInfo->viewportInfo)->viewportWidth,
+            poseOutput->dstHeightAlignTile / (m_initInfo->viewportInfo)->viewportHeight);
     #endif
 
     if ((selectedTilesNum <= 0) || ((uint64_t)(selectedTilesNum) > totalTiles))
@@ -273,16 +295,7 @@ int32_t ExtractorTrackGenerator::SelectTilesInView(
         tilesInView = NULL;
         return OMAF_ERROR_NULL_PTR;
     }
-    ret = I360SCVP_getContentCoverage(m_360scvpHandle, outCC);
-    if (ret)
-    {
-        OMAF_LOG(LOG_ERROR, "Failed to calculate Content coverage information !\n");
-        delete [] tilesInView;
-        tilesInView = NULL;
-        delete outCC;
-        outCC = NULL;
-        return OMAF_ERROR_SCVP_INCORRECT_RESULT;
-    }
+    *outCC = *poseCC;
 
     std::map<uint16_t, std::map<uint16_t, TileDef*>>::iterator it;
     it = m_middleSelection.find((uint16_t)selectedTilesNum);
@@ -616,19 +629,9 @@ int32_t ExtractorTrackGenerator::CalculateViewportNum()
         return OMAF_ERROR_SCVP_INIT_FAILED;
     }
 
-    for (float one_yaw = -180.0; one_yaw <= 180.0; )
-    {
-        for (float one_pitch = -90.0; one_pitch <= 90.0; )
-        {
-            int ret = SelectTilesInView(one_yaw, one_pitch, tileInRow, tileInCol);
-            if (ret)
-                return ret;
-
-            one_pitch += m_pitchStep;
-        }
-
-        one_yaw += m_yawStep;
-    }
+    int32_t ret = SelectTilesInViews(tileInRow, tileInCol);
+    if (ret)
+        return ret;
 
     if (m_middleViewNum > 100)
     {
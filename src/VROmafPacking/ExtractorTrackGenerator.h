@@ -235,8 +235,44 @@ public:
 
 private:
 
+    //!
+    //! \brief  Select tiles of all viewports which are gone through
+    //!         by yaw and pitch steps
+    //!
+    //! \param  [in] tileInRow
+    //!         tiles number in one row of the picture
+    //! \param  [in] tileInCol
+    //!         tiles number in one column of the picture
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t SelectTilesInViews(
+        uint8_t tileInRow, uint8_t tileInCol);
+
+    //!
+    //! \brief  Add the selected tiles of one viewport into
+    //!         middle tiles selection
+    //!
+    //! \param  [in] poseTiles
+    //!         the tiles selected for the viewport
+    //! \param  [in] selectedTilesNum
+    //!         the number of the selected tiles
+    //! \param  [in] poseOutput
+    //!         the viewport output of the selection
+    //! \param  [in] poseCC
+    //!         the content coverage of the viewport
+    //! \param  [in] tileInRow
+    //!         tiles number in one row of the picture
+    //! \param  [in] tileInCol
+    //!         tiles number in one column of the picture
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
     int32_t SelectTilesInView(
-        float yaw, float pitch,
+        TileDef *poseTiles, int32_t selectedTilesNum,
+        Param_ViewportOutput *poseOutput, CCDef *poseCC,
         uint8_t tileInRow, uint8_t tileInCol);
 
     //!
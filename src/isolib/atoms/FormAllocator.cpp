@@ -31,6 +31,8 @@
 //! Created on April 30, 2019, 6:04 AM
 //!
 #include "FormAllocator.h"
+#include <algorithm>
+#include <cstddef>
 
 VCD_MP4_BEGIN
 
@@ -77,4 +79,81 @@ FormAllocator* GetFormAllocator()
     return formAlloc;
 }
 
+namespace
+{
+const size_t ARENA_ALIGNMENT     = alignof(std::max_align_t);
+const size_t ARENA_MAX_BLOCKSIZE = 1024 * 1024;
+
+size_t AlignUp(size_t size)
+{
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+}  // namespace
+
+SegmentArena::SegmentArena(size_t blockSize)
+    : m_blockSize(blockSize)
+{
+}
+
+SegmentArena::~SegmentArena()
+{
+    Release();
+}
+
+void* SegmentArena::allocate(size_t n, size_t size)
+{
+    const size_t bytes  = AlignUp(n * size);
+    const size_t header = AlignUp(sizeof(Block));
+    if (m_head && m_head->size - m_head->used >= bytes)
+    {
+        void* ptr = reinterpret_cast<uint8_t*>(m_head) + m_head->used;
+        m_head->used += bytes;
+        return ptr;
+    }
+
+    // requests larger than a block get one of their own, which is kept behind
+    // the current block so its free space is still used
+    const bool dedicated = header + bytes > m_blockSize;
+    const size_t blockSize = dedicated ? header + bytes : m_blockSize;
+    Block* block = static_cast<Block*>(GetDefaultAllocator()->allocate(1, blockSize));
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    block->size = blockSize;
+    block->used = header + bytes;
+    m_blockCount++;
+    if (dedicated && m_head)
+    {
+        block->next  = m_head->next;
+        m_head->next = block;
+    }
+    else
+    {
+        block->next = m_head;
+        m_head      = block;
+        if (!dedicated)
+        {
+            m_blockSize = std::min(m_blockSize * 2, ARENA_MAX_BLOCKSIZE);
+        }
+    }
+    return reinterpret_cast<uint8_t*>(block) + header;
+}
+
+void SegmentArena::deallocate(void* ptr)
+{
+    (void) ptr;
+}
+
+void SegmentArena::Release()
+{
+    while (m_head)
+    {
+        Block* next = m_head->next;
+        GetDefaultAllocator()->deallocate(m_head);
+        m_head = next;
+    }
+    m_blockCount = 0;
+}
+
 VCD_MP4_END
\ No newline at end of file
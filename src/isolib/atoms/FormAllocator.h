@@ -132,6 +132,150 @@ public:
     }
 };
 
+//!
+//! \class SegmentArena
+//! \brief Monotonic allocator for everything parsed from one segment.
+//!        Memory is taken from large blocks, deallocate does nothing and
+//!        all blocks are released at once when the arena is destroyed
+//!
+class SegmentArena : public FormAllocator
+{
+public:
+
+    //!
+    //! \brief Constructor
+    //!
+    //! \param    [in] size_t
+    //!           size of the first block, later blocks double up to a limit
+    //!
+    explicit SegmentArena(size_t blockSize = 16 * 1024);
+
+    //!
+    //! \brief Destructor
+    //!
+    ~SegmentArena();
+
+    SegmentArena(const SegmentArena&) = delete;
+    SegmentArena& operator=(const SegmentArena&) = delete;
+
+    //!
+    //! \brief    allocator function
+    //!
+    //! \param    [in] size_t
+    //!           number
+    //! \param    [in] size_t
+    //!           size
+    //!
+    //! \return   void*
+    //!
+    void* allocate(size_t n, size_t size) override;
+
+    //!
+    //! \brief    deallocate function, memory is only reclaimed by Release
+    //!
+    //! \param    [in] void*
+    //!           pointer
+    //!
+    //! \return   void
+    //!
+    void deallocate(void* ptr) override;
+
+    //!
+    //! \brief    Free all blocks of the arena
+    //!
+    //! \return   void
+    //!
+    void Release();
+
+    //!
+    //! \brief    Get the number of blocks taken from the system allocator
+    //!
+    //! \return   size_t
+    //!
+    size_t GetBlockCount() const { return m_blockCount; }
+
+private:
+    struct Block
+    {
+        Block* next;
+        size_t size;
+        size_t used;
+    };
+
+    Block* m_head      = nullptr;  //!< block currently allocated from
+    size_t m_blockSize;            //!< size of the next block
+    size_t m_blockCount = 0;
+};
+
+//!
+//! \class ArenaAllocator
+//! \brief Standard allocator bound to a FormAllocator instance, such as the
+//!        SegmentArena of a segment. Without an instance it uses the form
+//!        allocator. Copies of a container are never bound to the arena, so
+//!        they can outlive the segment
+//!
+template <typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::false_type propagate_on_container_swap;
+
+    ArenaAllocator() : m_arena(nullptr)
+    {
+    }
+    explicit ArenaAllocator(FormAllocator* arena) : m_arena(arena)
+    {
+    }
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.GetArena())
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(Get()->allocate(n, sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        (void) n;
+        Get()->deallocate(p);
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const
+    {
+        return ArenaAllocator();
+    }
+
+    FormAllocator* GetArena() const
+    {
+        return m_arena;
+    }
+
+private:
+    FormAllocator* Get() const
+    {
+        return m_arena ? m_arena : GetFormAllocator();
+    }
+
+    FormAllocator* m_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.GetArena() == b.GetArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.GetArena() != b.GetArena();
+}
+
 template <typename T>
 class FormDelete : public std::default_delete<T>
 {
@@ -40,6 +40,8 @@ VCD_MP4_BEGIN
 
 Stream::Stream()
     : m_storage()
+    , m_viewData(nullptr)
+    , m_viewSize(0)
     , m_currByte(0)
     , m_byteOffset(0)
     , m_bitOffset(0)
@@ -49,6 +51,30 @@ Stream::Stream()
 
 Stream::Stream(const std::vector<std::uint8_t>& strData)
     : m_storage(strData)
+    , m_viewData(nullptr)
+    , m_viewSize(0)
+    , m_currByte(0)
+    , m_byteOffset(0)
+    , m_bitOffset(0)
+    , m_storageAllocated(false)
+{
+}
+
+Stream::Stream(std::vector<std::uint8_t>&& strData)
+    : m_storage(std::move(strData))
+    , m_viewData(nullptr)
+    , m_viewSize(0)
+    , m_currByte(0)
+    , m_byteOffset(0)
+    , m_bitOffset(0)
+    , m_storageAllocated(true)
+{
+}
+
+Stream::Stream(const std::uint8_t* data, std::uint64_t size)
+    : m_storage()
+    , m_viewData(data)
+    , m_viewSize(size)
     , m_currByte(0)
     , m_byteOffset(0)
     , m_bitOffset(0)
@@ -58,6 +84,8 @@ Stream::Stream(const std::vector<std::uint8_t>& strData)
 
 Stream::Stream(Stream&& other)
     : m_storage(std::move(other.m_storage))
+    , m_viewData(other.m_viewData)
+    , m_viewSize(other.m_viewSize)
     , m_currByte(other.m_currByte)
     , m_byteOffset(other.m_byteOffset)
     , m_bitOffset(other.m_bitOffset)
@@ -67,6 +95,8 @@ Stream::Stream(Stream&& other)
     other.m_byteOffset       = {};
     other.m_bitOffset        = {};
     other.m_storageAllocated = {};
+    other.m_viewData         = nullptr;
+    other.m_viewSize         = 0;
     other.m_storage.clear();
 }
 
@@ -77,6 +107,10 @@ Stream& Stream::operator=(Stream&& other)
     m_bitOffset        = other.m_bitOffset;
     m_storageAllocated = other.m_storageAllocated;
     m_storage          = std::move(other.m_storage);
+    m_viewData         = other.m_viewData;
+    m_viewSize         = other.m_viewSize;
+    other.m_viewData   = nullptr;
+    other.m_viewSize   = 0;
     return *this;
 }
 
@@ -93,22 +127,48 @@ bool Stream::IsByteAligned() const
     return m_bitOffset ? false : true;
 }
 
+bool Stream::IsView() const
+{
+    return m_viewData != nullptr;
+}
+
 std::uint64_t Stream::GetSize() const
 {
-    std::uint64_t size = m_storage.size();
+    std::uint64_t size = Size();
     return size;
 }
 
 void Stream::SetSize(const std::uint64_t newSize)
 {
+    Materialize();
     m_storage.resize(newSize);
 }
 
 const std::vector<std::uint8_t>& Stream::GetStorage() const
 {
+    Materialize();
     return m_storage;
 }
 
+void Stream::Materialize() const
+{
+    if (m_viewData)
+    {
+        m_storage.assign(m_viewData, m_viewData + m_viewSize);
+        m_viewData = nullptr;
+        m_viewSize = 0;
+    }
+}
+
+std::uint8_t Stream::At(const std::uint64_t offset) const
+{
+    if (offset >= Size())
+    {
+        throw std::out_of_range("Stream::At");
+    }
+    return Data()[offset];
+}
+
 void Stream::Reset()
 {
     m_currByte   = 0;
@@ -118,6 +178,8 @@ void Stream::Reset()
 
 void Stream::Clear()
 {
+    m_viewData = nullptr;
+    m_viewSize = 0;
     m_storage.clear();
 }
 
@@ -128,12 +190,13 @@ void Stream::SkipBytes(const std::uint64_t x)
 
 void Stream::SetByte(const std::uint64_t offset, const std::uint8_t byte)
 {
+    Materialize();
     m_storage.at(offset) = byte;
 }
 
 std::uint8_t Stream::GetByte(const std::uint64_t offset) const
 {
-    std::uint8_t ret = m_storage.at(offset);
+    std::uint8_t ret = At(offset);
     return ret;
 }
 
@@ -146,16 +209,17 @@ std::uint64_t Stream::ReadAtomHeaders(FourCCInt& type)
 
 std::uint64_t Stream::BytesRemain() const
 {
-    return m_storage.size() - m_byteOffset;
+    return Size() - m_byteOffset;
 }
 void Stream::Extract(const std::uint64_t begin, const std::uint64_t end, Stream& dest) const
 {
     dest.Clear();
     dest.Reset();
-    if (begin <= m_storage.size() && end <= m_storage.size() && begin <= end)
+    if (begin <= Size() && end <= Size() && begin <= end)
     {
-        dest.m_storage.insert(dest.m_storage.begin(), m_storage.begin() + static_cast<std::int64_t>(begin),
-                                m_storage.begin() + static_cast<std::int64_t>(end));
+        // dest only references the range, this stream has to outlive it
+        dest.m_viewData = Data() + begin;
+        dest.m_viewSize = end - begin;
     }
     else
     {
@@ -166,17 +230,20 @@ void Stream::Extract(const std::uint64_t begin, const std::uint64_t end, Stream&
 
 void Stream::WriteStream(const Stream& str)
 {
-    m_storage.insert(m_storage.end(), str.m_storage.begin(), str.m_storage.end());
+    Materialize();
+    m_storage.insert(m_storage.end(), str.Data(), str.Data() + str.Size());
 }
 
 
 void Stream::Write8(const std::uint8_t bits)
 {
+    Materialize();
     m_storage.push_back(bits);
 }
 
 void Stream::Write16(const std::uint16_t bits)
 {
+    Materialize();
     for (int i=8;i>=0;)
     {
         m_storage.push_back(static_cast<uint8_t>((bits >> i) & 0xff));
@@ -186,6 +253,7 @@ void Stream::Write16(const std::uint16_t bits)
 
 void Stream::Write24(const std::uint32_t bits)
 {
+    Materialize();
     for (int i=16;i>=0;)
     {
         m_storage.push_back(static_cast<uint8_t>((bits >> i) & 0xff));
@@ -195,6 +263,7 @@ void Stream::Write24(const std::uint32_t bits)
 
 void Stream::Write32(const std::uint32_t bits)
 {
+    Materialize();
     for (int i=24;i>=0;)
     {
         m_storage.push_back(static_cast<uint8_t>((bits >> i) & 0xff));
@@ -204,6 +273,7 @@ void Stream::Write32(const std::uint32_t bits)
 
 void Stream::Write64(const std::uint64_t bits)
 {
+    Materialize();
     for (int i=56;i>=0;)
     {
         m_storage.push_back(static_cast<uint8_t>((bits >> i) & 0xff));
@@ -218,6 +288,7 @@ void Stream::WriteArray(const std::vector<std::uint8_t>& bits,
     // if len was not given, add everything until end of the vector
     auto copyLen = len == UINT64_MAX ? (bits.size() - srcOffset) : len;
 
+    Materialize();
     m_storage.insert(m_storage.end(), bits.begin() + static_cast<std::int64_t>(srcOffset),
                     bits.begin() + static_cast<std::int64_t>(srcOffset + copyLen));
 }
@@ -230,6 +301,7 @@ void Stream::Write1(std::uint64_t bits, std::uint32_t len)
     }
     else
     {
+        Materialize();
         do
         {
             const unsigned int pLeftByte = 8 - m_bitOffset;
@@ -263,6 +335,7 @@ void Stream::WriteString(const std::string& srcString)
         ISO_LOG(LOG_WARNING, "Stream::WriteString called for zero-length string.\n");
     }
 
+    Materialize();
     for (const auto character : srcString)
     {
         m_storage.push_back(static_cast<unsigned char>(character));
@@ -271,6 +344,7 @@ void Stream::WriteString(const std::string& srcString)
 
 void Stream::WriteZeroEndString(const std::string& srcString)
 {
+    Materialize();
     for (const auto character : srcString)
     {
         m_storage.push_back(static_cast<unsigned char>(character));
@@ -306,61 +380,61 @@ float Stream::ReadFloat32()
 
 std::uint8_t Stream::Read8()
 {
-    const std::uint8_t ret = m_storage.at(m_byteOffset);
+    const std::uint8_t ret = At(m_byteOffset);
     ++m_byteOffset;
     return ret;
 }
 
 std::uint16_t Stream::Read16()
 {
-    std::uint16_t ret = m_storage.at(m_byteOffset);
+    std::uint16_t ret = At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
     return ret;
 }
 
 std::uint32_t Stream::Read24()
 {
-    unsigned int ret = m_storage.at(m_byteOffset);
+    unsigned int ret = At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
     return ret;
 }
 
 std::uint32_t Stream::Read32()
 {
-    unsigned int ret = m_storage.at(m_byteOffset);
+    unsigned int ret = At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
     return ret;
 }
 
 std::uint64_t Stream::Read64()
 {
-    unsigned long long int ret = m_storage.at(m_byteOffset);
+    unsigned long long int ret = At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
-    ret = (ret << 8) | m_storage.at(m_byteOffset);
+    ret = (ret << 8) | At(m_byteOffset);
     m_byteOffset++;
 
     return ret;
@@ -368,10 +442,9 @@ std::uint64_t Stream::Read64()
 
 void Stream::ReadArray(std::vector<std::uint8_t>& bits, const std::uint64_t len)
 {
-    if (static_cast<std::size_t>(m_byteOffset + len) <= m_storage.size())
+    if (m_byteOffset + len <= Size())
     {
-        bits.insert(bits.end(), m_storage.begin() + static_cast<std::int64_t>(m_byteOffset),
-                    m_storage.begin() + static_cast<std::int64_t>(m_byteOffset + len));
+        bits.insert(bits.end(), Data() + m_byteOffset, Data() + m_byteOffset + len);
         m_byteOffset += len;
     }
     else
@@ -383,9 +456,9 @@ void Stream::ReadArray(std::vector<std::uint8_t>& bits, const std::uint64_t len)
 
 void Stream::ReadByteArrayToBuffer(char* buffer, const std::uint64_t len)
 {
-    if (static_cast<std::size_t>(m_byteOffset + len) <= m_storage.size())
+    if (m_byteOffset + len <= Size())
     {
-        std::memcpy(buffer, m_storage.data() + m_byteOffset, len);
+        std::memcpy(buffer, Data() + m_byteOffset, len);
         m_byteOffset += len;
     }
     else
@@ -407,28 +480,28 @@ std::uint32_t Stream::Read1(const std::uint32_t len)
 
     if (pLeftByte >= len)
     {
-        retBits = (unsigned int) ((m_storage).at(m_byteOffset) >> (pLeftByte - len)) &
+        retBits = (unsigned int) (At(m_byteOffset) >> (pLeftByte - len)) &
                         (unsigned int) ((1 << len) - 1);
         m_bitOffset += (unsigned int) len;
     }
     else
     {
         std::uint32_t pBitsGo = len - pLeftByte;
-        retBits                = (m_storage).at(m_byteOffset) & (((unsigned int) 1 << pLeftByte) - 1);
+        retBits                = At(m_byteOffset) & (((unsigned int) 1 << pLeftByte) - 1);
         m_byteOffset++;
         m_bitOffset = 0;
         while (pBitsGo > 0)
         {
             if (pBitsGo >= 8)
             {
-                retBits = (retBits << 8) | (m_storage).at(m_byteOffset);
+                retBits = (retBits << 8) | At(m_byteOffset);
                 m_byteOffset++;
                 pBitsGo -= 8;
             }
             else
             {
                 retBits = (retBits << pBitsGo) |
-                                ((unsigned int) ((m_storage).at(m_byteOffset) >> (8 - pBitsGo)) &
+                                ((unsigned int) (At(m_byteOffset) >> (8 - pBitsGo)) &
                                 (((unsigned int) 1 << pBitsGo) - 1));
                 m_bitOffset += (unsigned int) (pBitsGo);
                 pBitsGo = 0;
@@ -470,7 +543,7 @@ void Stream::ReadZeroEndString(std::string& pDst)
     std::uint8_t pCurr = 0xff;
     pDst.clear();
 
-    while (m_byteOffset < m_storage.size())
+    while (m_byteOffset < Size())
     {
         pCurr = Read8();
         if ((char) pCurr != '\0')
@@ -50,6 +50,17 @@ public:
     //!
     Stream();
     Stream(const std::vector<std::uint8_t>& strData);
+
+    //!
+    //! \brief Constructor taking over the given buffer without copying it
+    //!
+    Stream(std::vector<std::uint8_t>&& strData);
+
+    //!
+    //! \brief Constructor of a non-owning view over [data, data + size),
+    //!        the buffer must outlive the stream and any sub stream of it
+    //!
+    Stream(const std::uint8_t* data, std::uint64_t size);
     Stream(const Stream&) = default;
     Stream& operator=(const Stream&) = default;
     Stream(Stream&&);
@@ -76,6 +87,14 @@ public:
     //!
     MEMBER_SETANDGET_FUNC_WITH_OPTION(uint64_t, m_byteOffset, Pos, const);
 
+    //!
+    //! \brief    Is the stream a non-owning view or not
+    //!
+    //! \return   bool
+    //!           true if the stream references external data
+    //!
+    bool IsView() const;
+
     //!
     //! \brief    Get Size
     //!
@@ -95,7 +114,7 @@ public:
     void SetSize(std::uint64_t newSize);
 
     //!
-    //! \brief    Get Storage
+    //! \brief    Get Storage, a view is copied into owned storage first
     //!
     //! \return   const std::vector<std::uint8_t>&
     //!           Storage
@@ -412,7 +431,8 @@ public:
     int32_t ReadSignedExpGolombCode();
 
     //!
-    //! \brief    Read Sub Atom Stream
+    //! \brief    Read Sub Atom Stream, the returned stream is a view
+    //!           into this one and must not outlive it
     //!
     //! \param    [in] FourCCInt&
     //!           Atom Type
@@ -452,7 +472,7 @@ public:
     std::uint64_t BytesRemain() const;
 
     //!
-    //! \brief    Read String With Pos And Len
+    //! \brief    Extract [begin, end) as a view into this stream
     //!
     //! \param    [in] std::uint64_t
     //!           begin pos
@@ -473,8 +493,34 @@ public:
     //!
     bool IsByteAligned() const;
 
+    //!
+    //! \brief    Copy the viewed range into owned storage, before writing
+    //!           or when the stream is kept longer than the viewed buffer
+    //!
+    //! \return   void
+    //!
+    void Materialize() const;
+
+private:
+
+    //!
+    //! \brief    Bounds checked byte read
+    //!
+    //! \param    [in] std::uint64_t
+    //!           offset
+    //!
+    //! \return   std::uint8_t
+    //!           byte data
+    //!
+    std::uint8_t At(std::uint64_t offset) const;
+
+    const std::uint8_t* Data() const { return m_viewData ? m_viewData : m_storage.data(); };
+    std::uint64_t Size() const { return m_viewData ? m_viewSize : m_storage.size(); };
+
 private:
-    std::vector<std::uint8_t> m_storage;    //!< storage
+    mutable std::vector<std::uint8_t> m_storage;    //!< storage, unused while viewing
+    mutable const std::uint8_t* m_viewData;         //!< viewed data, nullptr when storage is owned
+    mutable std::uint64_t m_viewSize;               //!< viewed data size
     unsigned int m_currByte;                //!< current byte postion
     std::uint64_t m_byteOffset;             //!< byte offset
     unsigned int m_bitOffset;               //!< bit offset
@@ -88,6 +88,8 @@ void UserDataAtom::FromStream(Stream& str)
         FourCCInt AtomType;
         Stream subBitstr = str.ReadSubAtomStream(AtomType);
 
+        // the atom is kept after the parsed buffer is gone, so it owns a copy
+        subBitstr.Materialize();
         m_bitStreams[AtomType] = std::move(subBitstr);
     }
 }
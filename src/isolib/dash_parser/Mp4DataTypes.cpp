@@ -32,6 +32,7 @@
 #define _SCL_SECURE_NO_WARNINGS
 
 #include <algorithm>
+#include <stdexcept>
 
 #include "Mp4DataTypes.h"
 #include "../atoms/Stream.h"
@@ -92,6 +93,259 @@ VarLenArray<T>& VarLenArray<T>::operator=(const VarLenArray<T>& other)
     return *this;
 }
 
+void CompactTimeArray::Clear()
+{
+    m_base   = 0;
+    m_isWide = false;
+    m_deltas.clear();
+    m_wide.clear();
+}
+
+void CompactTimeArray::Reserve(size_t n)
+{
+    if (m_isWide)
+    {
+        m_wide.reserve(n);
+    }
+    else
+    {
+        m_deltas.reserve(n);
+    }
+}
+
+void CompactTimeArray::SetBase(uint64_t base)
+{
+    if (Size() == 0)
+    {
+        m_base = base;
+    }
+}
+
+void CompactTimeArray::PushBack(uint64_t time)
+{
+    if (!m_isWide && (time < m_base || time - m_base > UINT32_MAX))
+    {
+        m_wide.reserve(m_deltas.capacity());
+        for (auto delta : m_deltas)
+        {
+            m_wide.push_back(m_base + delta);
+        }
+        ArenaVector<uint32_t>(m_deltas.get_allocator()).swap(m_deltas);
+        m_isWide = true;
+    }
+
+    if (m_isWide)
+    {
+        m_wide.push_back(time);
+    }
+    else
+    {
+        m_deltas.push_back(static_cast<uint32_t>(time - m_base));
+    }
+}
+
+uint64_t SampleTimesView::at(size_t index) const
+{
+    if (index >= m_count)
+    {
+        throw out_of_range("SampleTimesView::at");
+    }
+    return (*this)[index];
+}
+
+void SampleTimeTable::Clear()
+{
+    m_begin.assign(1, 0);
+    m_times.Clear();
+}
+
+void SampleTimeTable::Reserve(size_t n)
+{
+    m_begin.reserve(n + 1);
+}
+
+void SampleTimeTable::AddSample()
+{
+    m_begin.push_back(m_begin.back());
+}
+
+template <typename PMapType>
+void SampleTimeTable::Assign(const PMapType& pMap, size_t sampCnt)
+{
+    // walk the map once, then group the times per sample with a counting sort
+    // which keeps the ascending time order within a sample
+    vector<pair<uint64_t, uint64_t>> entries;
+    entries.reserve(pMap.size());
+    vector<uint32_t> begin(sampCnt + 1, 0);
+    uint64_t base = UINT64_MAX;
+    for (const auto& entry : pMap)
+    {
+        if (entry.second >= sampCnt)
+        {
+            ISO_LOG(LOG_ERROR, "Presentation time refers to sample %lu out of %lu!\n",
+                    (unsigned long)entry.second, (unsigned long)sampCnt);
+            throw exception();
+        }
+        entries.push_back(make_pair(uint64_t(entry.second), uint64_t(entry.first)));
+        begin[entry.second + 1]++;
+        base = min(base, uint64_t(entry.first));
+    }
+    for (size_t i = 0; i < sampCnt; i++)
+    {
+        begin[i + 1] += begin[i];
+    }
+
+    vector<uint64_t> times(entries.size());
+    vector<uint32_t> next(begin.begin(), begin.end() - 1);
+    for (const auto& entry : entries)
+    {
+        times[next[entry.first]++] = entry.second;
+    }
+
+    m_times.Clear();
+    m_times.SetBase(base);
+    m_times.Reserve(times.size());
+    for (auto time : times)
+    {
+        m_times.PushBack(time);
+    }
+    m_begin.assign(begin.begin(), begin.end());
+}
+
+SampleInfoTable::SampleInfoTable(FormAllocator* arena)
+    : m_segmentId(ArenaAllocator<SegmentId>(arena))
+    , m_sampleId(ArenaAllocator<uint32_t>(arena))
+    , m_dataOffset(ArenaAllocator<uint64_t>(arena))
+    , m_dataLength(ArenaAllocator<uint32_t>(arena))
+    , m_width(ArenaAllocator<uint32_t>(arena))
+    , m_height(ArenaAllocator<uint32_t>(arena))
+    , m_sampleDuration(ArenaAllocator<uint32_t>(arena))
+    , m_sampleEntryType(ArenaAllocator<FourCCInt>(arena))
+    , m_sampleDescriptionIndex(ArenaAllocator<SmpDesIndex>(arena))
+    , m_sampleType(ArenaAllocator<uint8_t>(arena))
+    , m_sampleFlags(ArenaAllocator<uint32_t>(arena))
+    , m_compositionTimes(arena)
+    , m_compositionTimesTS(arena)
+{
+}
+
+void SampleInfoTable::reserve(size_t n)
+{
+    m_segmentId.reserve(n);
+    m_sampleId.reserve(n);
+    m_dataOffset.reserve(n);
+    m_dataLength.reserve(n);
+    m_width.reserve(n);
+    m_height.reserve(n);
+    m_sampleDuration.reserve(n);
+    m_sampleEntryType.reserve(n);
+    m_sampleDescriptionIndex.reserve(n);
+    m_sampleType.reserve(n);
+    m_sampleFlags.reserve(n);
+    m_compositionTimes.Reserve(n);
+    m_compositionTimesTS.Reserve(n);
+}
+
+void SampleInfoTable::clear()
+{
+    m_segmentId.clear();
+    m_sampleId.clear();
+    m_dataOffset.clear();
+    m_dataLength.clear();
+    m_width.clear();
+    m_height.clear();
+    m_sampleDuration.clear();
+    m_sampleEntryType.clear();
+    m_sampleDescriptionIndex.clear();
+    m_sampleType.clear();
+    m_sampleFlags.clear();
+    m_compositionTimes.Clear();
+    m_compositionTimesTS.Clear();
+}
+
+void SampleInfoTable::push_back(const SampleInfo& info)
+{
+    m_segmentId.push_back(info.segmentId);
+    m_sampleId.push_back(info.sampleId);
+    m_dataOffset.push_back(info.dataOffset);
+    m_dataLength.push_back(info.dataLength);
+    m_width.push_back(info.width);
+    m_height.push_back(info.height);
+    m_sampleDuration.push_back(info.sampleDuration);
+    m_sampleEntryType.push_back(info.sampleEntryType);
+    m_sampleDescriptionIndex.push_back(info.sampleDescriptionIndex);
+    m_sampleType.push_back(static_cast<uint8_t>(info.sampleType));
+    m_sampleFlags.push_back(info.sampleFlags.flagsAsUInt);
+    m_compositionTimes.AddSample();
+    m_compositionTimesTS.AddSample();
+}
+
+SampleInfoView SampleInfoTable::operator[](size_t index) const
+{
+    SampleInfoView view;
+    view.segmentId              = m_segmentId[index];
+    view.sampleId               = m_sampleId[index];
+    view.dataOffset             = m_dataOffset[index];
+    view.dataLength             = m_dataLength[index];
+    view.width                  = m_width[index];
+    view.height                 = m_height[index];
+    view.sampleDuration         = m_sampleDuration[index];
+    view.sampleEntryType        = m_sampleEntryType[index];
+    view.sampleDescriptionIndex = m_sampleDescriptionIndex[index];
+    view.sampleType             = static_cast<FrameCodecType>(m_sampleType[index]);
+    view.sampleFlags.flagsAsUInt = m_sampleFlags[index];
+    view.compositionTimes       = m_compositionTimes.Get(index);
+    view.compositionTimesTS     = m_compositionTimesTS.Get(index);
+    return view;
+}
+
+SampleInfoView SampleInfoTable::at(size_t index) const
+{
+    if (index >= size())
+    {
+        throw out_of_range("SampleInfoTable::at");
+    }
+    return (*this)[index];
+}
+
+void SampleInfoTable::MarkSyncSample(size_t index)
+{
+    FlagsOfSample flags;
+    flags.flagsAsUInt                      = m_sampleFlags.at(index);
+    flags.flags.sample_is_non_sync_sample = 0;
+    m_sampleFlags[index]                   = flags.flagsAsUInt;
+    m_sampleType[index]                    = static_cast<uint8_t>(OUTPUT_REF_FRAME);
+}
+
+void SampleInfoTable::SetCompositionTimes(const PresentTimeMap& pMap, const PresentTimeTSMap& pMapTS)
+{
+    m_compositionTimes.Assign(pMap, size());
+    m_compositionTimesTS.Assign(pMapTS, size());
+}
+
+void TrackDecInfo::RefreshCompTimes()
+{
+    using PMapTSRevIt = PresentTimeTSMap::reverse_iterator;
+
+    if (pMap.size())
+    {
+        samples.SetCompositionTimes(pMap, pMapTS);
+
+        if (hasEditList)
+        {
+            PMapTSRevIt iter = pMapTS.rbegin();
+            if (iter == pMapTS.rend())
+            {
+                ISO_LOG(LOG_ERROR, "Failed to get TimeStamp !\n");
+                throw exception();
+            }
+            samples.SetSampleDuration(iter->second,
+                min(samples.GetSampleDuration(iter->second),
+                         static_cast<uint32_t>(durationTS - iter->first)));
+        }
+    }
+}
+
 template struct VarLenArray<uint8_t>;
 template struct VarLenArray<char>;
 template struct VarLenArray<uint16_t>;
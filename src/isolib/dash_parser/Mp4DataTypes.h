@@ -38,10 +38,12 @@
 #include <stdint.h>
 
 #include <cstdint>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "../include/Common.h"
@@ -648,12 +650,11 @@ struct TrackProperties
 };
 typedef std::map<ContextId, TrackProperties> TrackPropertiesMap;
 
+/// Per sample scalar fields, used to append samples to a SampleInfoTable
 struct SampleInfo
 {
     SegmentId segmentId;
     uint32_t sampleId;
-    vector<uint64_t> compositionTimes;
-    vector<uint64_t> compositionTimesTS;
     uint64_t dataOffset = 0;
     uint32_t dataLength = 0;
     uint32_t width      = 0;
@@ -665,7 +666,183 @@ struct SampleInfo
     FrameCodecType sampleType;
     FlagsOfSample sampleFlags;
 };
-typedef vector<SampleInfo> SampleInfoVector;
+
+/// Containers of the per-segment data, which live in the SegmentArena of the segment
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+template <typename K, typename V>
+using ArenaMap = std::map<K, V, std::less<K>, ArenaAllocator<std::pair<const K, V>>>;
+typedef ArenaMap<DecodePts::PresentTime, DecodePts::SampleIndex> PresentTimeMap;
+typedef ArenaMap<DecodePts::PresentTimeTS, DecodePts::SampleIndex> PresentTimeTSMap;
+
+/// Times stored as 32-bit deltas from the smallest time, widened to 64 bits only
+/// when a time does not fit
+class CompactTimeArray
+{
+public:
+    explicit CompactTimeArray(FormAllocator* arena = nullptr)
+        : m_deltas(ArenaAllocator<uint32_t>(arena)), m_wide(ArenaAllocator<uint64_t>(arena)) {}
+    void Clear();
+    void Reserve(size_t n);
+    void SetBase(uint64_t base);
+    void PushBack(uint64_t time);
+    uint64_t At(size_t index) const
+    {
+        return m_isWide ? m_wide[index] : m_base + m_deltas[index];
+    }
+    size_t Size() const
+    {
+        return m_isWide ? m_wide.size() : m_deltas.size();
+    }
+
+private:
+    uint64_t m_base = 0;
+    bool m_isWide   = false;
+    ArenaVector<uint32_t> m_deltas;
+    ArenaVector<uint64_t> m_wide;
+};
+
+/// Read only view of the composition times of one sample
+class SampleTimesView
+{
+public:
+    class const_iterator
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef uint64_t value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const uint64_t* pointer;
+        typedef uint64_t reference;
+
+        const_iterator(const CompactTimeArray* times, size_t index) : m_times(times), m_index(index) {}
+        uint64_t operator*() const { return m_times->At(m_index); }
+        const_iterator& operator++() { ++m_index; return *this; }
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+        ptrdiff_t operator-(const const_iterator& other) const { return ptrdiff_t(m_index) - ptrdiff_t(other.m_index); }
+
+    private:
+        const CompactTimeArray* m_times;
+        size_t m_index;
+    };
+    typedef const_iterator iterator;
+    typedef uint64_t value_type;
+
+    SampleTimesView() : m_times(nullptr), m_begin(0), m_count(0) {}
+    SampleTimesView(const CompactTimeArray* times, size_t begin, size_t count)
+        : m_times(times), m_begin(begin), m_count(count) {}
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    uint64_t operator[](size_t index) const { return m_times->At(m_begin + index); }
+    uint64_t at(size_t index) const;
+    const_iterator begin() const { return const_iterator(m_times, m_begin); }
+    const_iterator end() const { return const_iterator(m_times, m_begin + m_count); }
+    operator std::vector<uint64_t>() const { return std::vector<uint64_t>(begin(), end()); }
+
+private:
+    const CompactTimeArray* m_times;
+    size_t m_begin;
+    size_t m_count;
+};
+
+/// Read only view of one sample of a SampleInfoTable; it must not outlive the table
+struct SampleInfoView : SampleInfo
+{
+    SampleTimesView compositionTimes;
+    SampleTimesView compositionTimesTS;
+};
+
+/// Composition times of all samples of a table, grouped per sample
+class SampleTimeTable
+{
+public:
+    explicit SampleTimeTable(FormAllocator* arena = nullptr)
+        : m_begin(1, 0, ArenaAllocator<uint32_t>(arena)), m_times(arena) {}
+    void Clear();
+    void Reserve(size_t n);
+    void AddSample();
+    template <typename PMapType>
+    void Assign(const PMapType& pMap, size_t sampCnt);
+    SampleTimesView Get(size_t index) const
+    {
+        return SampleTimesView(&m_times, m_begin[index], m_begin[index + 1] - m_begin[index]);
+    }
+
+private:
+    ArenaVector<uint32_t> m_begin;  ///< first time of each sample, plus the end
+    CompactTimeArray m_times;
+};
+
+/// Structure-of-arrays sample table of a track in one segment. Elements are
+/// returned as SampleInfoView values, so it can be used like the vector of
+/// SampleInfo it replaces.
+class SampleInfoTable
+{
+public:
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef SampleInfoView value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const SampleInfoView* pointer;
+        typedef SampleInfoView reference;
+
+        const_iterator(const SampleInfoTable* table, size_t index) : m_table(table), m_index(index) {}
+        SampleInfoView operator*() const { return (*m_table)[m_index]; }
+        const_iterator& operator++() { ++m_index; return *this; }
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const SampleInfoTable* m_table;
+        size_t m_index;
+    };
+    typedef SampleInfoView value_type;
+
+    explicit SampleInfoTable(FormAllocator* arena = nullptr);
+
+    size_t size() const { return m_sampleId.size(); }
+    bool empty() const { return m_sampleId.empty(); }
+    void reserve(size_t n);
+    void clear();
+    void push_back(const SampleInfo& info);
+
+    SampleInfoView operator[](size_t index) const;
+    SampleInfoView at(size_t index) const;
+    SampleInfoView back() const { return (*this)[size() - 1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    uint64_t GetDataOffset(size_t index) const { return m_dataOffset.at(index); }
+    uint32_t GetDataLength(size_t index) const { return m_dataLength.at(index); }
+    uint32_t GetSampleDuration(size_t index) const { return m_sampleDuration.at(index); }
+    FourCCInt GetSampleEntryType(size_t index) const { return m_sampleEntryType.at(index); }
+    void SetSampleDuration(size_t index, uint32_t duration) { m_sampleDuration.at(index) = duration; }
+    void MarkSyncSample(size_t index);
+
+    //! \brief Replace composition times of all samples with the ones in the
+    //!        presentation maps, which map time to sample index
+    void SetCompositionTimes(const PresentTimeMap& pMap, const PresentTimeTSMap& pMapTS);
+
+private:
+    ArenaVector<SegmentId> m_segmentId;
+    ArenaVector<uint32_t> m_sampleId;
+    ArenaVector<uint64_t> m_dataOffset;
+    ArenaVector<uint32_t> m_dataLength;
+    ArenaVector<uint32_t> m_width;
+    ArenaVector<uint32_t> m_height;
+    ArenaVector<uint32_t> m_sampleDuration;
+    ArenaVector<FourCCInt> m_sampleEntryType;
+    ArenaVector<SmpDesIndex> m_sampleDescriptionIndex;
+    ArenaVector<uint8_t> m_sampleType;
+    ArenaVector<uint32_t> m_sampleFlags;
+    SampleTimeTable m_compositionTimes;
+    SampleTimeTable m_compositionTimesTS;
+};
+typedef SampleInfoTable SampleInfoVector;
 
 struct TrackBasicInfo
 {
@@ -694,6 +871,18 @@ struct TrackBasicInfo
 
 struct TrackDecInfo
 {
+    explicit TrackDecInfo(FormAllocator* arena = nullptr)
+        : samples(arena)
+        , decoderCodeTypeMap(ArenaAllocator<std::pair<const ItemId, FourCCInt>>(arena))
+        , pMap(ArenaAllocator<PresentTimeMap::value_type>(arena))
+        , pMapTS(ArenaAllocator<PresentTimeTSMap::value_type>(arena))
+    {
+    }
+
+    //! \brief Rebuild the composition times of the samples from the whole
+    //!        presentation maps, so a repeated refresh adds no duplicates
+    void RefreshCompTimes();
+
     ItemId itemIdBase;
     SampleInfoVector samples;
 
@@ -703,10 +892,10 @@ struct TrackDecInfo
 
     DecodePts::PresentTimeTS nextPTSTS = 0;
 
-    std::map<ItemId, FourCCInt> decoderCodeTypeMap;
+    ArenaMap<ItemId, FourCCInt> decoderCodeTypeMap;
 
-    DecodePts::PMap pMap;
-    DecodePts::PMapTS pMapTS;
+    PresentTimeMap pMap;
+    PresentTimeTSMap pMapTS;
 
     bool hasEditList = false;
     bool hasTtyp = false;
@@ -720,10 +909,52 @@ struct SegmentIO
     int64_t size = 0;
 };
 
-typedef std::map<InitSegTrackIdPair, SmpDesIndex> ItemToParameterSetMap;
+/// Sample lookups of one track in one segment, resolved once by
+/// Mp4Reader::GetSampCursor. It is only valid until the segment is invalidated.
+struct SampleCursor
+{
+    uint32_t trackId                     = 0;
+    ItemId itemIdBase;
+    const TrackDecInfo* trackDecInfo     = nullptr;
+    const TrackBasicInfo* basicTrackInfo = nullptr;
+    SegmentIO* io                        = nullptr;
+
+    bool IsValid() const
+    {
+        return trackDecInfo != nullptr && io != nullptr;
+    }
+    bool Contains(uint32_t itemIndex) const
+    {
+        return IsValid() && itemIndex >= itemIdBase.GetIndex() &&
+               itemIndex - itemIdBase.GetIndex() < trackDecInfo->samples.size();
+    }
+};
+
+typedef ArenaMap<InitSegTrackIdPair, SmpDesIndex> ItemToParameterSetMap;
 
+/// Everything parsed from one segment is allocated from its arena, which is
+/// released in one go when the segment is disabled
 struct SegmentProperties
 {
+    SegmentProperties()
+        : itemToParameterSetMap(ArenaAllocator<ItemToParameterSetMap::value_type>(&arena))
+    {
+    }
+
+    //! \brief Get the decoding info of a track, created in the arena on first use
+    TrackDecInfo& GetTrackDecInfo(ContextId ctxId)
+    {
+        auto it = trackDecInfos.find(ctxId);
+        if (it == trackDecInfos.end())
+        {
+            it = trackDecInfos
+                     .emplace(std::piecewise_construct, std::forward_as_tuple(ctxId), std::forward_as_tuple(&arena))
+                     .first;
+        }
+        return it->second;
+    }
+
+    SegmentArena arena;  ///< declared first, so it outlives the containers using it
     InitSegmentId initSegmentId;
     SegmentId segmentId;
     set<Sequence> sequences;
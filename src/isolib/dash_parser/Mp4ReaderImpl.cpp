@@ -305,43 +305,12 @@ void Mp4Reader::CfgSegSidxFallback(InitSegmentId initSegId, SegmentTrackId segTr
 
 void Mp4Reader::RefreshCompTimes(InitSegmentId initSegId, SegmentId segIndex)
 {
-    using PMapIt = DecodePts::PMap::iterator;
-    using PMapTSIt = DecodePts::PMapTS::iterator;
-    using PMapTSRevIt = DecodePts::PMapTS::reverse_iterator;
-
     std::map<ContextId, TrackDecInfo>::iterator iter;
     for (iter = m_initSegProps.at(initSegId).segPropMap.at(segIndex).trackDecInfos.begin();
         iter != m_initSegProps.at(initSegId).segPropMap.at(segIndex).trackDecInfos.end();
         iter++)
     {
-        auto& trackDecInfo = iter->second;
-        if (trackDecInfo.pMap.size())
-        {
-            PMapIt iter1 = trackDecInfo.pMap.begin();
-            for ( ; iter1 != trackDecInfo.pMap.end(); iter1++)
-            {
-                trackDecInfo.samples.at(iter1->second).compositionTimes.push_back(uint64_t(iter1->first));
-            }
-
-            PMapTSIt iter2 = trackDecInfo.pMapTS.begin();
-            for ( ; iter2 != trackDecInfo.pMapTS.end(); iter2++)
-            {
-                trackDecInfo.samples.at(iter2->second).compositionTimesTS.push_back(uint64_t(iter2->first));
-            }
-
-            if (trackDecInfo.hasEditList)
-            {
-                PMapTSRevIt iter3 = trackDecInfo.pMapTS.rbegin();
-                if (iter3 == trackDecInfo.pMapTS.rend())
-                {
-                    ISO_LOG(LOG_ERROR, "Failed to get TimeStamp !\n");
-					throw exception();
-                }
-                trackDecInfo.samples.at(iter3->second).sampleDuration =
-                    min(trackDecInfo.samples.at(iter3->second).sampleDuration,
-                             static_cast<uint32_t>(trackDecInfo.durationTS - iter3->first));
-            }
-        }
+        iter->second.RefreshCompTimes();
     }
 }
 
@@ -549,7 +518,8 @@ int32_t Mp4Reader::DisableInitSeg(uint32_t initSegId)
 int32_t Mp4Reader::ParseSeg(StreamIO* strIO,
                                           uint32_t initSegId,
                                           uint32_t segIndex,
-                                          uint64_t earliestPTSinTS)
+                                          uint64_t earliestPTSinTS,
+                                          bool headerOnly)
 {
     if (m_initSegProps.count(initSegId) &&
         m_initSegProps.at(initSegId).segPropMap.count(segIndex))
@@ -698,6 +668,11 @@ int32_t Mp4Reader::ParseSeg(StreamIO* strIO,
                 }
                 else if (boxType == "mdat")
                 {
+                    if (headerOnly)
+                    {
+                        // media data is still arriving, samples are read once present
+                        break;
+                    }
                     error = SkipAtom(io);
                 }
                 else if (boxType == "cloc")
@@ -1165,12 +1140,12 @@ int32_t Mp4Reader::ReadStream(InitSegmentId initSegId, SegmentId segIndex)
                     for (auto& trackFragmentAtom : moof.GetTrackFragmentAtoms())
                     {
                         auto ctxId = ContextId(trackFragmentAtom->GetTrackFragmentHeaderAtom().GetTrackId());
-                        TrackDecInfo& trackDecInfo = segProps.trackDecInfos[ctxId];
+                        TrackDecInfo& trackDecInfo = segProps.GetTrackDecInfo(ctxId);
 
                         if (trackDecInfo.samples.size())
                         {
                             int64_t sampleDataEndOffset = static_cast<int64_t>(
-                            trackDecInfo.samples.rbegin()->dataOffset + trackDecInfo.samples.rbegin()->dataLength);
+                            trackDecInfo.samples.back().dataOffset + trackDecInfo.samples.back().dataLength);
                             if (sampleDataEndOffset > io.size || sampleDataEndOffset < 0)
                             {
                                 ISO_LOG(LOG_ERROR, "Sample data offset exceeds movie fragment !\n");
@@ -1332,9 +1307,8 @@ int32_t Mp4Reader::ReadAtom(SegmentIO& io, Stream& bitstream)
     {
         return OMAF_FILE_READ_ERROR;
     }
-    bitstream.Clear();
-    bitstream.Reset();
-    bitstream.WriteArray(data, uint64_t(boxSize));
+    // the box buffer is handed over to the stream, nested boxes are parsed as views into it
+    bitstream = Stream(std::move(data));
     return ERROR_NONE;
 }
 
@@ -1392,7 +1366,7 @@ int Mp4Reader::GetImgDims(unsigned int trackId,
     {
         ItemId baseId;
         auto& sampInfos        = GetSampInfos(initSegId, segTrackId, baseId);
-        auto& sampInfo         = sampInfos.at((internalId - baseId).GetIndex());
+        const auto sampInfo    = sampInfos.at((internalId - baseId).GetIndex());
         imgH                   = sampInfo.height;
         imgW                   = sampInfo.width;
         break;
@@ -1487,27 +1461,7 @@ int32_t Mp4Reader::ParseAvcData(
     char* buf,
     uint32_t& bufSize)
 {
-    uint32_t outputOffset = 0;
-    uint32_t byteOffset   = 0;
-    uint32_t nalLength    = 0;
-
-    while (outputOffset < bufSize)
-    {
-        nalLength                               = (uint8_t) buf[outputOffset + byteOffset];
-        buf[outputOffset + byteOffset] = 0;
-        byteOffset++;
-        nalLength = (nalLength << 8) | (uint8_t) buf[outputOffset + byteOffset];
-        buf[outputOffset + byteOffset] = 0;
-        byteOffset++;
-        nalLength = (nalLength << 8) | (uint8_t) buf[outputOffset + byteOffset];
-        buf[outputOffset + byteOffset] = 0;
-        byteOffset++;
-        nalLength = (nalLength << 8) | (uint8_t) buf[outputOffset + byteOffset];
-        buf[outputOffset + byteOffset] = 1;
-        byteOffset++;
-        outputOffset += nalLength + 4;
-        byteOffset = 0;
-    }
+    NalLengthToStartCodes(buf, bufSize);
     return ERROR_NONE;
 }
 
@@ -1515,27 +1469,7 @@ int32_t Mp4Reader::ParseHevcData(
     char* buf,
     uint32_t& bufSize)
 {
-    uint32_t outputOffset = 0;
-    uint32_t byteOffset   = 0;
-    uint32_t nalLength    = 0;
-
-    while (outputOffset < bufSize)
-    {
-        nalLength                               = (uint8_t) buf[outputOffset + byteOffset];
-        buf[outputOffset + byteOffset] = 0;
-        byteOffset++;
-        nalLength = (nalLength << 8) | (uint8_t) buf[outputOffset + byteOffset];
-        buf[outputOffset + byteOffset] = 0;
-        byteOffset++;
-        nalLength = (nalLength << 8) | (uint8_t) buf[outputOffset + byteOffset];
-        buf[outputOffset + byteOffset] = 0;
-        byteOffset++;
-        nalLength = (nalLength << 8) | (uint8_t) buf[outputOffset + byteOffset];
-        buf[outputOffset + byteOffset] = 1;
-        byteOffset++;
-        outputOffset += nalLength + 4;
-        byteOffset = 0;
-    }
+    NalLengthToStartCodes(buf, bufSize);
     return ERROR_NONE;
 }
 
@@ -1554,7 +1488,7 @@ void Mp4Reader::RefreshDecCodeType(InitSegmentId initSegIndex,
                                    .decoderCodeTypeMap;
     for (size_t sampId = prevSampInfoSize; sampId < sampleInfo.size(); ++sampId)
     {
-        auto& info = sampleInfo[sampId];
+        const auto info = sampleInfo[sampId];
         decCodeType.insert(
             make_pair(info.sampleId, info.sampleEntryType));
     }
@@ -1616,7 +1550,7 @@ TrackPropertiesMap Mp4Reader::FillTrackProps(InitSegmentId initSegId,
                 trackDecInfo.samples);
 
             auto& storedTrackInfo =
-                initSegProps.segPropMap[segIndex].trackDecInfos[trackIdPair.second];
+                initSegProps.segPropMap[segIndex].GetTrackDecInfo(trackIdPair.second);
             storedTrackInfo = move(trackDecInfo);
             m_initSegProps[initSegId].basicTrackInfos[trackIdPair.second] =
                 move(basicTrackInfo);
@@ -1687,7 +1621,7 @@ ItemId Mp4Reader::GetSuccedentItmId(InitSegmentId initSegIndex,
             auto& trackDecInfo = segProps.trackDecInfos.at(ctxId);
             if (trackDecInfo.samples.size())
             {
-                nextItemIdBase = trackDecInfo.samples.rbegin()->sampleId + 1;
+                nextItemIdBase = trackDecInfo.samples.back().sampleId + 1;
             }
             else
             {
@@ -1740,7 +1674,7 @@ void Mp4Reader::AddTrackProps(
         auto ctxId = ContextId(trackFragmentAtom->GetTrackFragmentHeaderAtom().GetTrackId());
         SegmentId prevSegId;
 
-        TrackDecInfo& trackDecInfo      = segProps.trackDecInfos[ctxId];
+        TrackDecInfo& trackDecInfo      = segProps.GetTrackDecInfo(ctxId);
         size_t prevSampInfoSize = trackDecInfo.samples.size();
         bool hasSamps           = prevSampInfoSize > 0;
         if (auto* timeAtom = trackFragmentAtom->GetTrackFragmentBaseMediaDecodeTimeAtom())
@@ -1812,7 +1746,7 @@ void Mp4Reader::AddTrackProps(
         if (trackDecInfo.samples.size())
         {
             sampDataOffset =
-                trackDecInfo.samples.rbegin()->dataOffset + trackDecInfo.samples.rbegin()->dataLength;
+                trackDecInfo.samples.back().dataOffset + trackDecInfo.samples.back().dataLength;
         }
         firstTrackFragment = false;
     }
@@ -1862,6 +1796,13 @@ void Mp4Reader::AddSampsToTrackDecInfo(TrackDecInfo& trackDecInfo,
         trackDecInfo.pMapTS.insert(make_pair(iter2->first, iter2->second + itemIdOffset));
     }
 
+    // the sample table lives in the segment arena, so size it for the run up
+    // front instead of leaving the outgrown buffers behind
+    if (trackDecInfo.samples.empty())
+    {
+        trackDecInfo.samples.reserve(sampCnt);
+    }
+
     int64_t durTS        = 0;
     uint64_t sampDataOffset = baseDataOffset;
     for (uint32_t sampId = 0; sampId < sampCnt; ++sampId)
@@ -2171,8 +2112,10 @@ pair<TrackBasicInfo, TrackDecInfo> Mp4Reader::ExtractTrackDecInfo(TrackAtom* tra
     ptsInfo.Unravel();
 
     trackDecInfo.durationTS = PrestTS(ptsInfo.GetSpan());
-    trackDecInfo.pMap       = ptsInfo.GetTime(basicTrackInfo.timeScale);
-    trackDecInfo.pMapTS     = ptsInfo.GetTimeTS();
+    const DecodePts::PMap pMap     = ptsInfo.GetTime(basicTrackInfo.timeScale);
+    const DecodePts::PMapTS pMapTS = ptsInfo.GetTimeTS();
+    trackDecInfo.pMap.insert(pMap.begin(), pMap.end());
+    trackDecInfo.pMapTS.insert(pMapTS.begin(), pMapTS.end());
 
     if (trackAtom->GetHasTrackTypeAtom())
     {
@@ -2238,7 +2181,7 @@ SampleInfoVector Mp4Reader::GenSampInfo(TrackAtom* trackAtom) const
         }
         else
         {
-            infoOfSamp.dataOffset = sampInfos.back().dataOffset + sampInfos.back().dataLength;
+            infoOfSamp.dataOffset = sampInfos.GetDataOffset(sampId - 1) + sampInfos.GetDataLength(sampId - 1);
         }
 
         infoOfSamp.sampleDuration = sampleDeltas.at(sampId);
@@ -2283,10 +2226,8 @@ SampleInfoVector Mp4Reader::GenSampInfo(TrackAtom* trackAtom) const
         const std::vector<uint32_t> syncSamps = stbl.GetSyncSampleAtom().get()->GetSyncSampleIds();
         for (unsigned int i = 0; i < syncSamps.size(); ++i)
         {
-            uint32_t syncSamp                               = syncSamps.at(i) - 1;
-            auto& infoOfSamp                                       = sampInfos.at(syncSamp);
-            infoOfSamp.sampleType                                  = OUTPUT_REF_FRAME;
-            infoOfSamp.sampleFlags.flags.sample_is_non_sync_sample = 0;
+            uint32_t syncSamp = syncSamps.at(i) - 1;
+            sampInfos.MarkSyncSample(syncSamp);
         }
     }
 
@@ -4348,6 +4289,305 @@ int32_t Mp4Reader::GetSampOffset(uint32_t trackId,
     return ERROR_NONE;
 }
 
+int32_t Mp4Reader::GetSampSpans(uint32_t trackId,
+                                                 uint32_t itemIndex,
+                                                 std::vector<StreamSpan>& spans,
+                                                 bool& lengthPrefixed)
+{
+    spans.clear();
+    if (IsInitErr())
+    {
+        return OMAF_MP4READER_NOT_INITIALIZED;
+    }
+
+    InitSegmentTrackId trackIdPair = MakeIdPair(trackId);
+    InitSegmentId initSegId       = trackIdPair.first;
+    SegmentId segIndex;
+    int32_t result = GetSegIndex(trackIdPair, itemIndex, segIndex);
+    if (result != ERROR_NONE)
+    {
+        return result;
+    }
+    SegmentTrackId segTrackId = make_pair(segIndex, trackIdPair.second);
+    ItemId itemId             = ItemId(itemIndex) - GetTrackDecInfo(initSegId, segTrackId).itemIdBase;
+
+    CtxType ctxType;
+    int error = GetCtxTypeError(trackIdPair, ctxType);
+    if (error)
+    {
+        return error;
+    }
+    if (ctxType != CtxType::TRACK)
+    {
+        return OMAF_INVALID_MP4READER_CONTEXTID;
+    }
+    if (itemId.GetIndex() >= GetTrackDecInfo(initSegId, segTrackId).samples.size())
+    {
+        return OMAF_INVALID_ITEM_ID;
+    }
+
+    FourCC codeType;
+    error = GetDecoderCodeType(GenTrackId(trackIdPair), itemIndex, codeType);
+    if (error)
+    {
+        return error;
+    }
+    if (codeType == "avc1" || codeType == "avc3" || codeType == "hvc1" || codeType == "hev1")
+    {
+        lengthPrefixed = true;
+    }
+    else if ((codeType == "mp4a") || (codeType == "invo") || (codeType == "urim") || (codeType == "mp4v"))
+    {
+        lengthPrefixed = false;
+    }
+    else
+    {
+        // extractor samples have to be resolved into a new buffer
+        return OMAF_UNSUPPORTED_DASH_CODECS_TYPE;
+    }
+
+    const auto& sampInfo = GetTrackDecInfo(initSegId, segTrackId).samples.at(itemId.GetIndex());
+    SegmentIO& io = m_initSegProps.at(initSegId).segPropMap.at(segIndex).io;
+    if (!io.strIO->GetStreamSpans((int64_t) sampInfo.dataOffset, (int64_t) sampInfo.dataLength, spans))
+    {
+        spans.clear();
+        return OMAF_UNSUPPORTED_DASH_CODECS_TYPE;
+    }
+    return ERROR_NONE;
+}
+
+
+int32_t Mp4Reader::GetSampCursor(uint32_t trackId,
+                                                  uint32_t itemIndex,
+                                                  SampleCursor& cursor)
+{
+    cursor = SampleCursor();
+    if (IsInitErr())
+    {
+        return OMAF_MP4READER_NOT_INITIALIZED;
+    }
+
+    InitSegmentTrackId trackIdPair = MakeIdPair(trackId);
+    InitSegmentId initSegId       = trackIdPair.first;
+    SegmentId segIndex;
+    int32_t result = GetSegIndex(trackIdPair, itemIndex, segIndex);
+    if (result != ERROR_NONE)
+    {
+        return result;
+    }
+
+    CtxType ctxType;
+    int error = GetCtxTypeError(trackIdPair, ctxType);
+    if (error)
+    {
+        return error;
+    }
+    if (ctxType != CtxType::TRACK)
+    {
+        return OMAF_INVALID_MP4READER_CONTEXTID;
+    }
+
+    SegmentTrackId segTrackId        = make_pair(segIndex, trackIdPair.second);
+    const TrackDecInfo& trackDecInfo = GetTrackDecInfo(initSegId, segTrackId);
+    cursor.trackId        = trackId;
+    cursor.itemIdBase     = trackDecInfo.itemIdBase;
+    cursor.trackDecInfo   = &trackDecInfo;
+    cursor.basicTrackInfo = &GetTrackBasicInfo(trackIdPair);
+    cursor.io             = &m_initSegProps.at(initSegId).segPropMap.at(segIndex).io;
+    return ERROR_NONE;
+}
+
+int32_t Mp4Reader::GetSampOffset(const SampleCursor& cursor,
+                                                  uint32_t itemIndex,
+                                                  uint64_t& sampOffset,
+                                                  uint32_t& sampLen) const
+{
+    if (!cursor.Contains(itemIndex))
+    {
+        return OMAF_INVALID_ITEM_ID;
+    }
+    const size_t index = itemIndex - cursor.itemIdBase.GetIndex();
+    sampOffset = cursor.trackDecInfo->samples.GetDataOffset(index);
+    sampLen    = cursor.trackDecInfo->samples.GetDataLength(index);
+    return ERROR_NONE;
+}
+
+int32_t Mp4Reader::GetSampSpans(const SampleCursor& cursor,
+                                                 uint32_t itemIndex,
+                                                 std::vector<StreamSpan>& spans,
+                                                 bool& lengthPrefixed)
+{
+    spans.clear();
+    if (!cursor.Contains(itemIndex))
+    {
+        return OMAF_INVALID_ITEM_ID;
+    }
+
+    const size_t index      = itemIndex - cursor.itemIdBase.GetIndex();
+    const FourCCInt codeType = cursor.trackDecInfo->samples.GetSampleEntryType(index);
+    if (codeType == "avc1" || codeType == "avc3" || codeType == "hvc1" || codeType == "hev1")
+    {
+        lengthPrefixed = true;
+    }
+    else if ((codeType == "mp4a") || (codeType == "invo") || (codeType == "urim") || (codeType == "mp4v"))
+    {
+        lengthPrefixed = false;
+    }
+    else
+    {
+        return OMAF_UNSUPPORTED_DASH_CODECS_TYPE;
+    }
+
+    if (!cursor.io->strIO->GetStreamSpans((int64_t) cursor.trackDecInfo->samples.GetDataOffset(index),
+                                          (int64_t) cursor.trackDecInfo->samples.GetDataLength(index), spans))
+    {
+        spans.clear();
+        return OMAF_UNSUPPORTED_DASH_CODECS_TYPE;
+    }
+    return ERROR_NONE;
+}
+
+int32_t Mp4Reader::ConvertSampData(FourCCInt codeType, char* buf, uint32_t& bufSize, bool strHrd)
+{
+    if (codeType == "avc1" || codeType == "avc3")
+    {
+        return strHrd ? ParseAvcData(buf, bufSize) : ERROR_NONE;
+    }
+    else if (codeType == "hvc1" || codeType == "hev1")
+    {
+        return strHrd ? ParseHevcData(buf, bufSize) : ERROR_NONE;
+    }
+    else if ((codeType == "mp4a") || (codeType == "invo") || (codeType == "urim") || (codeType == "mp4v"))
+    {
+        return ERROR_NONE;
+    }
+    else
+    {
+        return OMAF_UNSUPPORTED_DASH_CODECS_TYPE;
+    }
+}
+
+int32_t Mp4Reader::GetSampData(const SampleCursor& cursor,
+                                                uint32_t itemIndex,
+                                                char* buf,
+                                                uint32_t& bufSize,
+                                                bool strHrd)
+{
+    if (!cursor.Contains(itemIndex))
+    {
+        return OMAF_INVALID_ITEM_ID;
+    }
+
+    const auto& samples      = cursor.trackDecInfo->samples;
+    const size_t index       = itemIndex - cursor.itemIdBase.GetIndex();
+    const FourCCInt codeType = samples.GetSampleEntryType(index);
+    if (codeType == "hvc2")
+    {
+        // extractor samples refer to other tracks, resolve them the regular way
+        return GetSampData(cursor.trackId, itemIndex, buf, bufSize, strHrd);
+    }
+
+    const uint32_t sampLen = samples.GetDataLength(index);
+    if (bufSize < sampLen)
+    {
+        bufSize = sampLen;
+        return OMAF_MEMORY_TOO_SMALL_BUFFER;
+    }
+
+    SegmentIO& io = *cursor.io;
+    LocateToOffset(io, (int64_t) samples.GetDataOffset(index));
+    io.strIO->ReadStream(buf, sampLen);
+    bufSize = sampLen;
+    if (!io.strIO->IsStreamGood())
+    {
+        return OMAF_FILE_READ_ERROR;
+    }
+
+    return ConvertSampData(codeType, buf, bufSize, strHrd);
+}
+
+int32_t Mp4Reader::GetExtractorTrackSampData(const SampleCursor& cursor,
+                                                         uint32_t itemIndex,
+                                                         char* buf,
+                                                         uint32_t& bufSize,
+                                                         bool strHrd)
+{
+    if (!cursor.Contains(itemIndex))
+    {
+        return OMAF_INVALID_ITEM_ID;
+    }
+
+    const size_t index = itemIndex - cursor.itemIdBase.GetIndex();
+    if (cursor.trackDecInfo->samples.GetSampleEntryType(index) == "hvc2")
+    {
+        return GetExtractorTrackSampData(cursor.trackId, itemIndex, buf, bufSize, strHrd);
+    }
+    return GetSampData(cursor, itemIndex, buf, bufSize, strHrd);
+}
+
+int32_t Mp4Reader::GetSampsData(const SampleCursor& cursor,
+                                                 uint32_t firstItem,
+                                                 uint32_t itemCnt,
+                                                 char* const* bufs,
+                                                 uint32_t* bufSizes,
+                                                 bool strHrd)
+{
+    if (itemCnt == 0)
+    {
+        return ERROR_NONE;
+    }
+    if (!cursor.Contains(firstItem) || !cursor.Contains(firstItem + itemCnt - 1))
+    {
+        return OMAF_INVALID_ITEM_ID;
+    }
+
+    const auto& samples = cursor.trackDecInfo->samples;
+    const size_t first  = firstItem - cursor.itemIdBase.GetIndex();
+    bool tooSmall       = false;
+    for (uint32_t i = 0; i < itemCnt; i++)
+    {
+        if (samples.GetSampleEntryType(first + i) == "hvc2")
+        {
+            return OMAF_UNSUPPORTED_DASH_CODECS_TYPE;
+        }
+        const uint32_t sampLen = samples.GetDataLength(first + i);
+        if (bufSizes[i] < sampLen)
+        {
+            bufSizes[i] = sampLen;
+            tooSmall    = true;
+        }
+    }
+    if (tooSmall)
+    {
+        return OMAF_MEMORY_TOO_SMALL_BUFFER;
+    }
+
+    SegmentIO& io       = *cursor.io;
+    uint64_t nextOffset = UINT64_MAX;
+    for (uint32_t i = 0; i < itemCnt; i++)
+    {
+        const uint64_t sampOffset = samples.GetDataOffset(first + i);
+        const uint32_t sampLen    = samples.GetDataLength(first + i);
+        if (sampOffset != nextOffset)
+        {
+            LocateToOffset(io, (int64_t) sampOffset);
+        }
+        io.strIO->ReadStream(bufs[i], sampLen);
+        if (!io.strIO->IsStreamGood())
+        {
+            return OMAF_FILE_READ_ERROR;
+        }
+        nextOffset  = sampOffset + sampLen;
+        bufSizes[i] = sampLen;
+
+        int32_t error = ConvertSampData(samples.GetSampleEntryType(first + i), bufs[i], bufSizes[i], strHrd);
+        if (error)
+        {
+            return error;
+        }
+    }
+    return ERROR_NONE;
+}
 
 int32_t Mp4Reader::GetCodecSpecInfo(uint32_t trackId,
                                                      uint32_t itemId,
@@ -405,6 +405,178 @@ public:
                                  uint64_t& sampOffset,
                                  uint32_t& sampLen);
 
+    //!
+    //! \brief  Get read-only views of the sample data for the
+    //!         specified sample in the specified normal track,
+    //!         pointing into the memory held by the segment
+    //!         stream instead of copying it out
+    //!
+    //! \param  [in]  trackId
+    //!         index of specific normal track
+    //! \param  [in]  itemIndex
+    //!         index of specified sample
+    //! \param  [out] spans
+    //!         views covering the sample data, in order
+    //! \param  [out] lengthPrefixed
+    //!         whether NAL units in sample data are still length
+    //!         prefixed and need start codes before decoding
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, OMAF_UNSUPPORTED_DASH_CODECS_TYPE
+    //!         for extractor tracks or streams not held in memory,
+    //!         else failed reason
+    //!
+    int32_t GetSampSpans(uint32_t trackId,
+                                 uint32_t itemIndex,
+                                 std::vector<StreamSpan>& spans,
+                                 bool& lengthPrefixed);
+
+    //!
+    //! \brief  Resolve the segment, track and sample table lookups
+    //!         for the segment holding the specified sample once, so
+    //!         that the samples of the segment can be read through the
+    //!         cursor without repeating them per sample
+    //!
+    //! \param  [in]  trackId
+    //!         index of specific track
+    //! \param  [in]  itemIndex
+    //!         index of any sample in the segment
+    //! \param  [out] cursor
+    //!         resolved cursor, valid until the segment is invalidated
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t GetSampCursor(uint32_t trackId,
+                                 uint32_t itemIndex,
+                                 SampleCursor& cursor);
+
+    //!
+    //! \brief  Get sample data offset and length through a cursor
+    //!
+    //! \param  [in]  cursor
+    //!         cursor of the segment holding the sample
+    //! \param  [in]  itemIndex
+    //!         index of specified sample
+    //! \param  [out] sampOffset
+    //!         output sample offset
+    //! \param  [out] sampLen
+    //!         output sample length
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t GetSampOffset(const SampleCursor& cursor,
+                                 uint32_t itemIndex,
+                                 uint64_t& sampOffset,
+                                 uint32_t& sampLen) const;
+
+    //!
+    //! \brief  Get read-only views of the sample data through a cursor
+    //!
+    //! \param  [in]  cursor
+    //!         cursor of the segment holding the sample
+    //! \param  [in]  itemIndex
+    //!         index of specified sample
+    //! \param  [out] spans
+    //!         views covering the sample data, in order
+    //! \param  [out] lengthPrefixed
+    //!         whether NAL units in sample data are still length
+    //!         prefixed and need start codes before decoding
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t GetSampSpans(const SampleCursor& cursor,
+                                 uint32_t itemIndex,
+                                 std::vector<StreamSpan>& spans,
+                                 bool& lengthPrefixed);
+
+    //!
+    //! \brief  Get complete data for specified sample through a cursor,
+    //!         extractor samples are resolved as in GetSampData
+    //!
+    //! \param  [in]  cursor
+    //!         cursor of the segment holding the sample
+    //! \param  [in]  itemIndex
+    //!         index of specified sample
+    //! \param  [out] buf
+    //!         pointer to the allocated memory to store
+    //!         the sample data
+    //! \param  [out] bufSize
+    //!         size of sample data
+    //! \param  [in]  strHrd
+    //!         whether to insert NAL unit start codes into
+    //!         sample data
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t GetSampData(const SampleCursor& cursor,
+                               uint32_t itemIndex,
+                               char* buf,
+                               uint32_t& bufSize,
+                               bool strHrd = true);
+
+    //!
+    //! \brief  Get complete data for specified sample of an extractor
+    //!         track through a cursor
+    //!
+    //! \param  [in]  cursor
+    //!         cursor of the segment holding the sample
+    //! \param  [in]  itemIndex
+    //!         index of specified sample
+    //! \param  [out] buf
+    //!         pointer to the allocated memory to store
+    //!         the sample data
+    //! \param  [out] bufSize
+    //!         size of sample data
+    //! \param  [in]  strHrd
+    //!         whether to insert NAL unit start codes into
+    //!         sample data
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t GetExtractorTrackSampData(const SampleCursor& cursor,
+                                        uint32_t itemIndex,
+                                        char* buf,
+                                        uint32_t& bufSize,
+                                        bool strHrd = true);
+
+    //!
+    //! \brief  Read the data of consecutive samples of one segment
+    //!         into caller provided buffers in one pass, seeking only
+    //!         where sample data is not contiguous. Nothing is read if
+    //!         any buffer is too small, instead the needed size of each
+    //!         such sample is written back to its bufSizes entry
+    //!
+    //! \param  [in]  cursor
+    //!         cursor of the segment holding the samples
+    //! \param  [in]  firstItem
+    //!         index of the first sample to read
+    //! \param  [in]  itemCnt
+    //!         number of samples to read
+    //! \param  [in]  bufs
+    //!         one buffer per sample
+    //! \param  [in,out] bufSizes
+    //!         capacity of each buffer, updated to the sample sizes
+    //! \param  [in]  strHrd
+    //!         whether to insert NAL unit start codes into
+    //!         sample data
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, OMAF_UNSUPPORTED_DASH_CODECS_TYPE
+    //!         for extractor samples, which have to be read one by one,
+    //!         else failed reason
+    //!
+    int32_t GetSampsData(const SampleCursor& cursor,
+                                uint32_t firstItem,
+                                uint32_t itemCnt,
+                                char* const* bufs,
+                                uint32_t* bufSizes,
+                                bool strHrd = true);
+
     //!
     //! \brief  Get media codec related specific information,
     //!         like SPS, PPS and so on, for specified sample in
@@ -755,6 +927,10 @@ public:
     //! \param  [in]  earliestPTSinTS
     //!         the earliest presentation time in timescale for
     //!         the specified sample
+    //! \param  [in]  headerOnly
+    //!         stop at the first media data atom, so that the
+    //!         sample tables are available while the media data
+    //!         of the segment is still being received
     //!
     //! \return int32_t
     //!         ERROR_NONE if success, else failed reason
@@ -762,7 +938,8 @@ public:
     int32_t ParseSeg(StreamIO* strIO,
                          uint32_t initSegId,
                          uint32_t segIndex,
-                         uint64_t earliestPTSinTS = UINT64_MAX);
+                         uint64_t earliestPTSinTS = UINT64_MAX,
+                         bool headerOnly = false);
 
     //!
     //! \brief  Disable specified segment for specified track
@@ -958,6 +1135,8 @@ private:
 
     int32_t ParseHevcData(char* buf, uint32_t& bufSize);
 
+    int32_t ConvertSampData(FourCCInt codeType, char* buf, uint32_t& bufSize, bool strHrd);
+
     std::map<SegmentTrackId, MetaAtom> m_metaMap;
 
     struct ImgInfo
@@ -31,12 +31,54 @@
 
 #include "Mp4StreamIO.h"
 #include <iostream>
+#include <cstring>
 #include "../atoms/FormAllocator.h"
 
 using namespace std;
 
 VCD_MP4_BEGIN
 
+int64_t CopyStreamSpans(const std::vector<StreamSpan>& spans, int64_t offset, int64_t size, char* dst)
+{
+    int64_t copied = 0;
+    for (auto& span : spans)
+    {
+        if (copied >= size)
+        {
+            break;
+        }
+        if (offset >= span.size)
+        {
+            offset -= span.size;
+            continue;
+        }
+        int64_t bytes = span.size - offset;
+        if (bytes > size - copied)
+        {
+            bytes = size - copied;
+        }
+        memcpy(dst + copied, span.data + offset, bytes);
+        copied += bytes;
+        offset = 0;
+    }
+    return copied;
+}
+
+void NalLengthToStartCodes(char* buf, uint64_t size)
+{
+    uint64_t pos = 0;
+    while (pos + 4 <= size)
+    {
+        uint8_t* hdr = reinterpret_cast<uint8_t*>(buf + pos);
+        uint64_t nalLength = (uint64_t(hdr[0]) << 24) | (uint64_t(hdr[1]) << 16) | (uint64_t(hdr[2]) << 8) | hdr[3];
+        hdr[0] = 0;
+        hdr[1] = 0;
+        hdr[2] = 0;
+        hdr[3] = 1;
+        pos += nalLength + 4;
+    }
+}
+
 StreamIOInternal::StreamIOInternal(StreamIO* stream)
     : m_stream(stream)
     , m_error(false)
@@ -123,6 +165,16 @@ StreamIO::offset_t StreamIOInternal::GetStreamSize()
     return m_stream->GetStreamSize();
 }
 
+bool StreamIOInternal::GetStreamSpans(StreamIO::offset_t offset, StreamIO::offset_t size, std::vector<StreamSpan>& spans)
+{
+    spans.clear();
+    if (!m_stream)
+    {
+        return false;
+    }
+    return m_stream->GetStreamSpans(offset, size, spans);
+}
+
 void StreamIOInternal::ClearStatus()
 {
     m_eof   = false;
@@ -34,11 +34,53 @@
 #define _MP4STREAMIO_H_
 
 #include <stdint.h>
+#include <vector>
 #include "../include/Common.h"
 #include "../atoms/FormAllocator.h"
 
 VCD_MP4_BEGIN
 
+//!
+//! \struct StreamSpan
+//! \brief  read-only view of contiguous bytes owned by a StreamIO
+//!
+struct StreamSpan
+{
+    const char* data;
+    int64_t     size;
+};
+
+//!
+//! \brief  Copy bytes of the data viewed by spans
+//!
+//! \param  [in]  spans
+//!         views of the data in order
+//! \param  [in]  offset
+//!         offset in the viewed data to copy from
+//! \param  [in]  size
+//!         number of bytes to copy
+//! \param  [out] dst
+//!         buffer with room for size bytes
+//!
+//! \return int64_t
+//!         number of bytes copied, less than size if spans end before
+//!
+int64_t CopyStreamSpans(const std::vector<StreamSpan>& spans, int64_t offset, int64_t size, char* dst);
+
+//!
+//! \brief  Replace the 4-byte NAL unit length prefixes of a sample by
+//!         start codes in place, a NAL unit whose prefix does not fit
+//!         in size is left as it is
+//!
+//! \param  [in]  buf
+//!         sample data starting with a length prefix
+//! \param  [in]  size
+//!         size of the sample data
+//!
+//! \return void
+//!
+void NalLengthToStartCodes(char* buf, uint64_t size);
+
 class StreamIO
 {
 public:
@@ -58,6 +100,29 @@ public:
     virtual offset_t TellOffset() = 0;
 
     virtual offset_t GetStreamSize() = 0;
+
+    //!
+    //! \brief  Get views of [offset, offset + size) in the stream memory
+    //!         without copying, the views stay valid as long as the stream
+    //!         keeps the data. Streams not backed by memory return false.
+    //!
+    //! \param  [in] offset
+    //!         absolute offset of the first byte
+    //! \param  [in] size
+    //!         number of bytes to be viewed
+    //! \param  [out] spans
+    //!         contiguous pieces covering the range, in order
+    //!
+    //! \return bool
+    //!         true if the whole range is covered by spans
+    //!
+    virtual bool GetStreamSpans(offset_t offset, offset_t size, std::vector<StreamSpan>& spans)
+    {
+        (void)offset;
+        (void)size;
+        (void)spans;
+        return false;
+    }
 };
 
 class StreamIOInternal
@@ -80,6 +145,8 @@ public:
 
     StreamIO::offset_t GetStreamSize();
 
+    bool GetStreamSpans(StreamIO::offset_t offset, StreamIO::offset_t size, std::vector<StreamSpan>& spans);
+
     bool PeekEOS();
 
     bool IsStreamGood() const;
@@ -0,0 +1,16 @@
+#!/bin/bash -e
+
+cp ../../google_test/libgtest.a .
+
+g++ -I../../utils -std=c++11 -g -c ../../utils/Log.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../ -I../common -I../../utils -I../../google_test -std=c++11 -g -c testStream.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../ -I../common -I../../utils -I../../google_test -std=c++11 -g -c testMp4DataTypes.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../ -I../common -I../../utils -I../../google_test -std=c++11 -g -c testFormAllocator.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+
+LD_FLAGS="-I/usr/local/include/ -ldashparser -lglog -lstdc++ -lpthread -lm -L../dash_parser -L/usr/local/lib"
+g++ -L/usr/local/lib testStream.o Log.o libgtest.a -o testStream ${LD_FLAGS}
+g++ -L/usr/local/lib testMp4DataTypes.o Log.o libgtest.a -o testMp4DataTypes ${LD_FLAGS}
+g++ -L/usr/local/lib testFormAllocator.o Log.o libgtest.a -o testFormAllocator ${LD_FLAGS}
+
+./run.sh
+if [ $? -ne 0 ]; then exit 1; fi
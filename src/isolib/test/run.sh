@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Run test cases
+################################
+./testStream
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testMp4DataTypes
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testFormAllocator
+if [ $? -ne 0 ]; then exit 1; fi
+
+# All caes passed
+################################
+echo "All passed!"
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   testFormAllocator.cpp
+//! \brief:  segment arena unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../atoms/FormAllocator.h"
+#include "../dash_parser/Mp4DataTypes.h"
+#include "../../utils/PerfBench.h"
+
+VCD_USE_MP4;
+
+namespace {
+
+const size_t kHeaderSize = 32;  // aligned block header
+const size_t kFirstBlockSize = 1024;
+const size_t kMaxBlockSize = 1024 * 1024;
+
+// form allocator counting the calls to the system allocator
+class CountingAllocator : public FormAllocator {
+ public:
+  void *allocate(size_t n, size_t size) override {
+    calls_++;
+    return malloc(n * size);
+  }
+  void deallocate(void *ptr) override { free(ptr); }
+
+  size_t calls_ = 0;
+};
+
+TEST(FormAllocatorTest, BlocksDoubleUpToLimit) {
+  SegmentArena arena(kFirstBlockSize);
+  size_t blockSize = kFirstBlockSize;
+  size_t blockNum = 0;
+  for (int i = 0; i < 14; i++) {
+    // fill the next block exactly in two requests, then the third one needs a new block
+    arena.allocate(1, blockSize - kHeaderSize - 16);
+    EXPECT_EQ(arena.GetBlockCount(), ++blockNum);
+    arena.allocate(1, 16);
+    EXPECT_EQ(arena.GetBlockCount(), blockNum);
+    blockSize = std::min(blockSize * 2, kMaxBlockSize);
+  }
+  arena.allocate(1, 16);
+  EXPECT_EQ(arena.GetBlockCount(), blockNum + 1);
+}
+
+TEST(FormAllocatorTest, OversizedRequestGetsDedicatedBlock) {
+  SegmentArena arena(kFirstBlockSize);
+  uint8_t *first = static_cast<uint8_t *>(arena.allocate(1, 100));
+  EXPECT_EQ(arena.GetBlockCount(), 1u);
+
+  void *large = arena.allocate(1, 4 * kFirstBlockSize);
+  EXPECT_TRUE(large != nullptr);
+  EXPECT_EQ(arena.GetBlockCount(), 2u);
+
+  // the current block keeps serving small requests
+  uint8_t *second = static_cast<uint8_t *>(arena.allocate(1, 100));
+  EXPECT_EQ(arena.GetBlockCount(), 2u);
+  EXPECT_EQ(second, first + 112);
+}
+
+TEST(FormAllocatorTest, DedicatedBlockKeepsBlockSize) {
+  SegmentArena arena(kFirstBlockSize);
+  arena.allocate(1, 4 * kFirstBlockSize);
+  EXPECT_EQ(arena.GetBlockCount(), 1u);
+
+  // the first regular block still has the first block size
+  arena.allocate(1, kFirstBlockSize - kHeaderSize);
+  EXPECT_EQ(arena.GetBlockCount(), 2u);
+  arena.allocate(1, 16);
+  EXPECT_EQ(arena.GetBlockCount(), 3u);
+}
+
+TEST(FormAllocatorTest, ReleaseFreesAllBlocks) {
+  SegmentArena arena(kFirstBlockSize);
+  for (int i = 0; i < 100; i++) {
+    arena.allocate(10, 16);
+  }
+  arena.allocate(1, 8 * kFirstBlockSize);
+  EXPECT_TRUE(arena.GetBlockCount() > 1);
+
+  arena.Release();
+  EXPECT_EQ(arena.GetBlockCount(), 0u);
+
+  // the arena can be used again, with the grown block size
+  void *ptr = arena.allocate(1, 2 * kFirstBlockSize);
+  EXPECT_TRUE(ptr != nullptr);
+  EXPECT_EQ(arena.GetBlockCount(), 1u);
+}
+
+TEST(FormAllocatorTest, CopyIsNotBoundToArena) {
+  SegmentArena arena(kFirstBlockSize);
+  ArenaVector<int> values{ArenaAllocator<int>(&arena)};
+  for (int i = 0; i < 100; i++) {
+    values.push_back(i);
+  }
+  EXPECT_EQ(values.get_allocator().GetArena(), &arena);
+  size_t blockNum = arena.GetBlockCount();
+
+  ArenaVector<int> copy(values);
+  EXPECT_TRUE(copy.get_allocator().GetArena() == nullptr);
+  EXPECT_EQ(arena.GetBlockCount(), blockNum);
+
+  ArenaVector<int> assigned;
+  assigned = values;
+  EXPECT_TRUE(assigned.get_allocator().GetArena() == nullptr);
+
+  // moving keeps the arena
+  ArenaVector<int> moved(std::move(values));
+  EXPECT_EQ(moved.get_allocator().GetArena(), &arena);
+
+  // the copies outlive the arena blocks
+  arena.Release();
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(copy[i], i);
+    EXPECT_EQ(assigned[i], i);
+  }
+}
+
+// the sample table and composition time maps of one segment with 6000 samples,
+// built with one allocator for everything, like ParseSeg does
+template <typename Alloc>
+void BuildSegmentTables(Alloc *alloc) {
+  const uint32_t sampleNum = 6000;
+  SampleInfoTable samples(alloc);
+  PresentTimeMap pMap{ArenaAllocator<PresentTimeMap::value_type>(alloc)};
+  PresentTimeTSMap pMapTS{ArenaAllocator<PresentTimeTSMap::value_type>(alloc)};
+  samples.reserve(sampleNum);
+  SampleInfo info;
+  for (uint32_t i = 0; i < sampleNum; i++) {
+    info.sampleId = i;
+    samples.push_back(info);
+    pMap[uint64_t(i) * 40] = i;
+    pMapTS[uint64_t(i) * 3600] = i;
+  }
+  samples.SetCompositionTimes(pMap, pMapTS);
+}
+
+TEST(FormAllocatorTest, SegmentTablesTakeFewBlocks) {
+  CountingAllocator heap;
+  BuildSegmentTables(&heap);
+  SegmentArena arena;
+  BuildSegmentTables(&arena);
+
+  // the maps allocate per node, the arena takes a handful of doubling blocks
+  EXPECT_TRUE(heap.calls_ > 12000);
+  EXPECT_TRUE(arena.GetBlockCount() < 16);
+
+  if (VCD::PerfBench::Enabled()) {
+    VCD::PerfBench::PerfReport("SegmentArena")
+        .Add("samples", static_cast<uint64_t>(6000))
+        .Add("heap_calls", static_cast<uint64_t>(heap.calls_))
+        .Add("arena_blocks", static_cast<uint64_t>(arena.GetBlockCount()))
+        .Print();
+  }
+}
+
+}  // namespace
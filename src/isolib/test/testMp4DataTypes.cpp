@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   testMp4DataTypes.cpp
+//! \brief:  sample table unit test and benchmark, the benchmark runs with VR_PERF_BENCH set
+//!
+
+#include "gtest/gtest.h"
+#include "../dash_parser/Mp4DataTypes.h"
+#include "../../utils/PerfBench.h"
+
+VCD_USE_MP4;
+
+namespace {
+
+const uint64_t kWideTime = (1ULL << 40) + 7;
+
+SampleInfoTable MakeTable(uint32_t sampleNum) {
+  SampleInfoTable table;
+  for (uint32_t i = 0; i < sampleNum; i++) {
+    SampleInfo info;
+    info.sampleId = i;
+    info.dataOffset = i * 100;
+    info.dataLength = 100;
+    table.push_back(info);
+  }
+  return table;
+}
+
+std::vector<uint64_t> Times(const SampleTimesView &view) { return view; }
+
+TEST(Mp4DataTypesTest, CompactTimesFitInDeltas) {
+  CompactTimeArray times;
+  times.SetBase(1000);
+  times.PushBack(1000);
+  times.PushBack(1000 + UINT32_MAX);
+  EXPECT_EQ(times.Size(), 2u);
+  EXPECT_EQ(times.At(0), 1000u);
+  EXPECT_EQ(times.At(1), 1000u + UINT32_MAX);
+}
+
+TEST(Mp4DataTypesTest, CompactTimesWidenFor64BitTimes) {
+  CompactTimeArray times;
+  times.SetBase(1000);
+  times.PushBack(1000);
+  times.PushBack(2000);
+  times.PushBack(kWideTime);
+  times.PushBack(3000);
+  ASSERT_EQ(times.Size(), 4u);
+  EXPECT_EQ(times.At(0), 1000u);
+  EXPECT_EQ(times.At(1), 2000u);
+  EXPECT_EQ(times.At(2), kWideTime);
+  EXPECT_EQ(times.At(3), 3000u);
+
+  // a time below the base widens too
+  CompactTimeArray below;
+  below.SetBase(1000);
+  below.PushBack(1500);
+  below.PushBack(10);
+  EXPECT_EQ(below.At(0), 1500u);
+  EXPECT_EQ(below.At(1), 10u);
+
+  times.Clear();
+  EXPECT_EQ(times.Size(), 0u);
+  times.PushBack(5);
+  EXPECT_EQ(times.At(0), 5u);
+}
+
+TEST(Mp4DataTypesTest, SeveralCompositionTimesPerSample) {
+  SampleInfoTable table = MakeTable(4);
+  PresentTimeMap pMap;
+  pMap[80] = 0;
+  pMap[0] = 0;
+  pMap[40] = 1;
+  pMap[160] = 1;
+  pMap[120] = 2;
+  PresentTimeTSMap pMapTS;
+  pMapTS[kWideTime] = 0;
+  pMapTS[kWideTime + 3600] = 2;
+  pMapTS[90] = 0;
+  table.SetCompositionTimes(pMap, pMapTS);
+
+  // times of a sample keep the ascending order, the last sample has none
+  EXPECT_EQ(Times(table[0].compositionTimes), std::vector<uint64_t>({0, 80}));
+  EXPECT_EQ(Times(table[1].compositionTimes), std::vector<uint64_t>({40, 160}));
+  EXPECT_EQ(Times(table[2].compositionTimes), std::vector<uint64_t>({120}));
+  EXPECT_TRUE(table[3].compositionTimes.empty());
+  EXPECT_EQ(Times(table[0].compositionTimesTS), std::vector<uint64_t>({90, kWideTime}));
+  EXPECT_TRUE(table[1].compositionTimesTS.empty());
+  EXPECT_EQ(Times(table[2].compositionTimesTS), std::vector<uint64_t>({kWideTime + 3600}));
+  EXPECT_THROW(table[2].compositionTimes.at(1), std::out_of_range);
+
+  // scalar fields are untouched
+  EXPECT_EQ(table[2].sampleId, 2u);
+  EXPECT_EQ(table[2].dataOffset, 200u);
+}
+
+TEST(Mp4DataTypesTest, SetCompositionTimesReplacesTimes) {
+  SampleInfoTable table = MakeTable(2);
+  PresentTimeMap pMap;
+  pMap[0] = 0;
+  pMap[40] = 1;
+  PresentTimeTSMap pMapTS;
+  pMapTS[0] = 0;
+  pMapTS[3600] = 1;
+  table.SetCompositionTimes(pMap, pMapTS);
+
+  // a refresh after more fragments rebuilds the times from the whole maps
+  pMap.clear();
+  pMap[100] = 1;
+  pMap[140] = 0;
+  pMapTS.clear();
+  pMapTS[9000] = 1;
+  table.SetCompositionTimes(pMap, pMapTS);
+  EXPECT_EQ(Times(table[0].compositionTimes), std::vector<uint64_t>({140}));
+  EXPECT_EQ(Times(table[1].compositionTimes), std::vector<uint64_t>({100}));
+  EXPECT_TRUE(table[0].compositionTimesTS.empty());
+  EXPECT_EQ(Times(table[1].compositionTimesTS), std::vector<uint64_t>({9000}));
+
+  // samples appended after the refresh have no times until the next one
+  SampleInfo info;
+  table.push_back(info);
+  EXPECT_TRUE(table[2].compositionTimes.empty());
+  EXPECT_EQ(Times(table[1].compositionTimes), std::vector<uint64_t>({100}));
+}
+
+TEST(Mp4DataTypesTest, RepeatedRefreshKeepsOneTimePerSample) {
+  TrackDecInfo track;
+  track.hasEditList = true;
+  track.durationTS = 2 * 3600 + 1000;
+  SampleInfo info;
+  info.sampleDuration = 3600;
+
+  // the reader refreshes after every fragment with the maps of the whole segment
+  for (uint32_t fragment = 0; fragment < 3; fragment++) {
+    track.samples.push_back(info);
+    track.pMap[fragment * 40] = fragment;
+    track.pMapTS[fragment * 3600] = fragment;
+    track.RefreshCompTimes();
+    track.RefreshCompTimes();
+  }
+
+  for (uint32_t i = 0; i < 3; i++) {
+    EXPECT_EQ(Times(track.samples[i].compositionTimes), std::vector<uint64_t>({i * 40}));
+    EXPECT_EQ(Times(track.samples[i].compositionTimesTS), std::vector<uint64_t>({i * 3600}));
+  }
+  // the edit list clips the last presented sample to the track duration
+  EXPECT_EQ(track.samples[0].sampleDuration, 3600u);
+  EXPECT_EQ(track.samples[2].sampleDuration, 1000u);
+}
+
+TEST(Mp4DataTypesTest, TimeOfUnknownSampleThrows) {
+  SampleInfoTable table = MakeTable(2);
+  PresentTimeMap pMap;
+  pMap[0] = 2;
+  PresentTimeTSMap pMapTS;
+  EXPECT_ANY_THROW(table.SetCompositionTimes(pMap, pMapTS));
+}
+
+// the sample entry before the structure of arrays table
+struct LegacySampleInfo : SampleInfo {
+  std::vector<uint64_t> compositionTimes;
+  std::vector<uint64_t> compositionTimesTS;
+};
+
+TEST(Mp4DataTypesTest, Benchmark) {
+  if (!VCD::PerfBench::Enabled()) return;
+
+  const uint32_t sampleNum = 2000000;
+  PresentTimeMap pMap;
+  PresentTimeTSMap pMapTS;
+  for (uint32_t i = 0; i < sampleNum; i++) {
+    pMap[uint64_t(i) * 40] = i;
+    pMapTS[uint64_t(i) * 3600] = i;
+  }
+
+  SampleInfo info;
+  double legacyMs = VCD::PerfBench::MeasureMs([&]() {
+    std::vector<LegacySampleInfo> samples;
+    for (uint32_t i = 0; i < sampleNum; i++) {
+      LegacySampleInfo legacy;
+      static_cast<SampleInfo &>(legacy) = info;
+      samples.push_back(legacy);
+    }
+    for (auto &entry : pMap) samples[entry.second].compositionTimes.push_back(entry.first);
+    for (auto &entry : pMapTS) samples[entry.second].compositionTimesTS.push_back(entry.first);
+  });
+  double tableMs = VCD::PerfBench::MeasureMs([&]() {
+    SampleInfoTable table;
+    for (uint32_t i = 0; i < sampleNum; i++) table.push_back(info);
+    table.SetCompositionTimes(pMap, pMapTS);
+  });
+  VCD::PerfBench::PerfReport("SampleInfoTable")
+      .Add("samples", static_cast<uint64_t>(sampleNum))
+      .Add("legacy_ms", legacyMs)
+      .Add("table_ms", tableMs)
+      .Print();
+}
+
+}  // namespace
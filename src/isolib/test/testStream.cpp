@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   testStream.cpp
+//! \brief:  Stream view and owned storage unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../atoms/Stream.h"
+#include "../atoms/UserDataAtom.h"
+
+VCD_USE_MP4;
+
+namespace {
+
+class StreamTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    // udta box holding two child boxes
+    Stream udta;
+    udta.WriteHeaders("udta", 0);
+    udta.WriteHeaders("abcd", 4);
+    udta.Write32(0x01020304);
+    udta.WriteHeaders("efgh", 2);
+    udta.Write16(0x0506);
+    udta.SetByte(3, (uint8_t)udta.GetSize());
+    buffer_ = udta.GetStorage();
+  }
+
+  std::vector<std::uint8_t> buffer_;
+};
+
+TEST_F(StreamTest, SubAtomIsViewOfParent) {
+  Stream parent(buffer_.data(), buffer_.size());
+  EXPECT_TRUE(parent.IsView());
+
+  FourCCInt type;
+  parent.ReadAtomHeaders(type);
+  EXPECT_EQ(type, FourCCInt("udta"));
+  Stream child = parent.ReadSubAtomStream(type);
+  EXPECT_EQ(type, FourCCInt("abcd"));
+  EXPECT_TRUE(child.IsView());
+  EXPECT_EQ(child.GetSize(), 12u);
+  child.SkipBytes(8);
+  EXPECT_EQ(child.Read32(), 0x01020304u);
+}
+
+TEST_F(StreamTest, WriteMaterializesView) {
+  Stream source(buffer_);
+  Stream view;
+  source.Extract(8, 20, view);
+  EXPECT_TRUE(view.IsView());
+  EXPECT_FALSE(source.IsView());
+
+  view.SetByte(8, 0xff);
+  EXPECT_FALSE(view.IsView());
+  EXPECT_EQ(view.GetByte(8), 0xff);
+  EXPECT_EQ(view.GetByte(0), buffer_[8]);
+
+  // the source keeps its bytes
+  EXPECT_EQ(source.GetByte(16), 0x01);
+  EXPECT_EQ(source.GetStorage(), buffer_);
+
+  Stream appended;
+  source.Extract(8, 20, appended);
+  appended.Write8(0x07);
+  EXPECT_FALSE(appended.IsView());
+  EXPECT_EQ(appended.GetSize(), 13u);
+  EXPECT_EQ(source.GetSize(), buffer_.size());
+}
+
+TEST_F(StreamTest, ReadOutOfViewThrows) {
+  Stream source(buffer_);
+  Stream view;
+  source.Extract(8, 12, view);
+  view.SkipBytes(4);
+  EXPECT_THROW(view.Read8(), std::out_of_range);
+}
+
+TEST_F(StreamTest, UserDataOwnsChildAtoms) {
+  UserDataAtom udta;
+  {
+    // the parsed buffer is gone before the atom is written again
+    std::vector<std::uint8_t> parsed(buffer_);
+    Stream str(parsed.data(), parsed.size());
+    udta.FromStream(str);
+    std::fill(parsed.begin(), parsed.end(), 0);
+  }
+
+  Stream out;
+  udta.ToStream(out);
+  EXPECT_EQ(out.GetStorage(), buffer_);
+}
+
+}  // namespace
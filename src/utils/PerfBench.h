@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2019, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   PerfBench.h
+//! \brief:  Timing and reporting helpers for the benchmarks of the unit tests
+//!
+//! A benchmark prints one json line prefixed by "PERF: " on stdout and records
+//! the same numbers as test properties, so that CI can collect them from the
+//! console or from --gtest_output=xml:<file>.
+//! Benchmarks inside unit tests only run when VR_PERF_BENCH is set, the unit
+//! tests keep their correctness checks without timing.
+//! VR_PERF_MIN_MS sets the minimum measuring time of RunPerf (default 200 ms).
+//!
+
+#ifndef _PERFBENCH_H_
+#define _PERFBENCH_H_
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace VCD {
+namespace PerfBench {
+
+#define PERF_DEFAULT_MIN_MS 200
+#define PERF_MIN_LOOP       10
+
+//!
+//! \brief  Is the benchmark of a unit test enabled or not
+//!
+inline bool Enabled()
+{
+    const char* bench = getenv("VR_PERF_BENCH");
+    return bench && bench[0] && bench[0] != '0';
+}
+
+//!
+//! \brief  Run op once and get the time in milliseconds
+//!
+template<typename Op>
+double MeasureMs(Op op)
+{
+    auto start = std::chrono::steady_clock::now();
+    op();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+//!
+//! \brief  One json line of results, the values are recorded as test properties
+//!         named <case>.<key>
+//!
+class PerfReport
+{
+public:
+    PerfReport(const char* caseName) : m_case(caseName) {}
+
+    PerfReport& Add(const char* key, double value)
+    {
+        char str[64];
+        snprintf(str, sizeof(str), "%.2f", value);
+        m_values.push_back(std::make_pair(std::string(key), std::string(str)));
+        return *this;
+    }
+
+    PerfReport& Add(const char* key, uint64_t value)
+    {
+        m_values.push_back(std::make_pair(std::string(key), std::to_string(value)));
+        return *this;
+    }
+
+    void Print() const
+    {
+        std::string line = "{\"case\":\"" + m_case + "\"";
+        for (auto& value : m_values)
+        {
+            line += ",\"" + value.first + "\":" + value.second;
+            testing::Test::RecordProperty(m_case + "." + value.first, value.second);
+        }
+        printf("PERF: %s}\n", line.c_str());
+    }
+
+private:
+    std::string m_case;
+    std::vector<std::pair<std::string, std::string>> m_values;
+};
+
+//!
+//! \brief  Run op once to warm up, then repeatedly until the minimum measuring
+//!         time is reached, and report ns/op and MB/s
+//!
+//! \param  [in] name
+//!         benchmark name
+//! \param  [in] bytesPerOp
+//!         bytes processed by one op, 0 for benchmarks without a data rate
+//! \param  [in] op
+//!         the measured operation
+//!
+template<typename Op>
+void RunPerf(const char* name, double bytesPerOp, Op op)
+{
+    const char* minMs = getenv("VR_PERF_MIN_MS");
+    double minNs = (minMs ? atof(minMs) : PERF_DEFAULT_MIN_MS) * 1000000.0;
+    uint64_t loopNum = 0;
+    double totalNs = 0;
+
+    op();
+    auto start = std::chrono::steady_clock::now();
+    do
+    {
+        op();
+        loopNum++;
+        totalNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    } while (totalNs < minNs || loopNum < PERF_MIN_LOOP);
+
+    double nsPerOp = totalNs / loopNum;
+    PerfReport(name)
+        .Add("iterations", loopNum)
+        .Add("ns_per_op", nsPerOp)
+        .Add("mb_per_s", bytesPerOp ? (bytesPerOp * 1000.0 / nsPerOp) : 0.0)
+        .Print();
+}
+
+}  // namespace PerfBench
+}  // namespace VCD
+
+#endif /* _PERFBENCH_H_ */
@@ -34,6 +34,7 @@
 #ifndef _DATA_TYPE_H__
 #define _DATA_TYPE_H__
 
+#include <stddef.h>
 #include <stdint.h>
 #include "360SCVPAPI.h"
 #include "ns_def.h"
@@ -109,14 +110,29 @@ typedef struct ProducerReferenceTime {
 } ProducerReferenceTime;
 
 /*
+ * The fields after immediate_bandwidth are appended to the first version of
+ * the structure. OmafAccess_Statistic only writes the first version fields,
+ * OmafAccess_StatisticEx writes the fields that fit in the given size.
+ *
  * avg_bandwidth : average bandwidth since the begin of downloading
  * immediate_bandwidth: immediate bandwidth at the moment
+ * avg_stitch_time_us : average time in microseconds of stitching tiles into one frame
+ * immediate_stitch_time_us : time in microseconds of stitching tiles into the last frame
+ * cancelled_segments_num : segment downloads cancelled since they became obsolete
+ * cancelled_bytes_saved : bytes not downloaded thanks to the cancelled segments
  */
 typedef struct DASHSTATISTICINFO {
   int32_t avg_bandwidth;
   int32_t immediate_bandwidth;
+  int32_t avg_stitch_time_us;
+  int32_t immediate_stitch_time_us;
+  int32_t cancelled_segments_num;
+  int64_t cancelled_bytes_saved;
 } DashStatisticInfo;
 
+// size of the first version of DashStatisticInfo
+#define DASH_STATISTIC_INFO_BASE_SIZE offsetof(DashStatisticInfo, avg_stitch_time_us)
+
 /*
  * stream_type : Video or Audio stream
  * height : the height of original video